@@ -0,0 +1,80 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "Benchmark.hh"
+
+#include <zenkit/Archive.hh>
+#include <zenkit/Stream.hh>
+#include <zenkit/World.hh>
+#include <zenkit/vobs/VirtualObject.hh>
+
+namespace zenkit::bench {
+	static std::vector<std::byte> encode_world(World const& world, ArchiveFormat format) {
+		std::vector<std::byte> data {};
+		auto w = Write::to(&data);
+		auto ar = WriteArchive::to_save(w.get(), format);
+		ar->write_object("%", &world, GameVersion::GOTHIC_1);
+		ar->write_header();
+		return data;
+	}
+
+	/// \brief Adds `4096 * scale` vobs to the world, each with two children.
+	static void grow_world(World& world, std::uint32_t scale) {
+		for (auto i = 0u; i < 4096 * scale; ++i) {
+			auto vob = std::make_shared<VirtualObject>();
+			vob->vob_name = "SYNTHETIC_VOB_" + std::to_string(i);
+			vob->position = glm::vec3 {static_cast<float>(i % 256) * 100, 0, static_cast<float>(i / 256) * 100};
+			vob->bbox = {vob->position - glm::vec3 {50}, vob->position + glm::vec3 {50}};
+
+			for (auto j = 0u; j < 2; ++j) {
+				auto child = std::make_shared<VirtualObject>();
+				child->vob_name = vob->vob_name + "_CHILD_" + std::to_string(j);
+				child->position = vob->position;
+				child->bbox = vob->bbox;
+				vob->children.push_back(std::move(child));
+			}
+
+			world.world_vobs.push_back(std::move(vob));
+		}
+	}
+
+	void run_archive_benchmarks(Runner& runner) {
+		auto sample = read_file(runner.options().samples / "G1" / "Save" / "WORLD.SAV");
+		runner.run("world/load(G1/Save/WORLD.SAV)", sample.size(), [&sample] {
+			World world {};
+			auto r = Read::from(sample.data(), sample.size());
+			world.load(r.get(), GameVersion::GOTHIC_1);
+			do_not_optimize(world.world_vobs.size());
+		});
+
+		World world {};
+		auto r = Read::from(sample.data(), sample.size());
+		world.load(r.get(), GameVersion::GOTHIC_1);
+		grow_world(world, runner.options().scale);
+
+		std::pair<char const*, ArchiveFormat> const formats[] = {
+		    {"BINARY", ArchiveFormat::BINARY},
+		    {"BINSAFE", ArchiveFormat::BINSAFE},
+		    {"ASCII", ArchiveFormat::ASCII},
+		};
+
+		// ASCII worlds are only written since not all objects can be read back from ASCII save archives yet.
+		for (auto [name, format] : formats) {
+			if (format == ArchiveFormat::ASCII) continue;
+
+			auto data = encode_world(world, format);
+			runner.run(std::string {"world/load(synthetic,"} + name + ")", data.size(), [&data] {
+				World loaded {};
+				auto rd = Read::from(data.data(), data.size());
+				loaded.load(rd.get(), GameVersion::GOTHIC_1);
+				do_not_optimize(loaded.world_vobs.size());
+			});
+		}
+
+		for (auto [name, format] : formats) {
+			runner.run(std::string {"world/save(synthetic,"} + name + ")", 0, [&world, format = format] {
+				auto data = encode_world(world, format);
+				do_not_optimize(data.size());
+			});
+		}
+	}
+} // namespace zenkit::bench
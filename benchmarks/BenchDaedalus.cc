@@ -0,0 +1,273 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "Benchmark.hh"
+
+#include <zenkit/DaedalusScript.hh>
+#include <zenkit/DaedalusVm.hh>
+#include <zenkit/Stream.hh>
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+namespace zenkit::bench {
+	static void write_symbol(Write* w,
+	                         std::string_view name,
+	                         DaedalusDataType type,
+	                         std::uint32_t flags,
+	                         std::uint32_t vary,
+	                         std::uint32_t count) {
+		w->write_uint(1);
+		w->write_string(name);
+		w->write_char('\n');
+		w->write_uint(vary);
+		w->write_uint(count | static_cast<std::uint32_t>(type) << 12U | flags << 16U);
+
+		for (auto i = 0; i < 5; ++i) {
+			w->write_uint(0); // File index, line and character ranges.
+		}
+	}
+
+	static void write_instruction(Write* w, DaedalusOpcode op) {
+		w->write_ubyte(static_cast<std::uint8_t>(op));
+	}
+
+	static void write_instruction(Write* w, DaedalusOpcode op, std::uint32_t arg) {
+		w->write_ubyte(static_cast<std::uint8_t>(op));
+		w->write_uint(arg);
+	}
+
+	/// \brief Generates a script containing the function `int LOOP(var int n)` which counts from zero to `n` in a
+	///        loop and returns the result.
+	static std::vector<std::byte> make_loop_script() {
+		std::vector<std::byte> data {};
+		auto w = Write::to(&data);
+
+		w->write_ubyte(50);
+		w->write_uint(3);
+
+		// Sort table
+		w->write_uint(0);
+		w->write_uint(1);
+		w->write_uint(2);
+
+		write_symbol(w.get(),
+		             "LOOP",
+		             DaedalusDataType::FUNCTION,
+		             DaedalusSymbolFlag::CONST | DaedalusSymbolFlag::RETURN,
+		             static_cast<std::uint32_t>(DaedalusDataType::INT),
+		             1);
+		w->write_int(0); // Address
+		w->write_int(-1);
+
+		write_symbol(w.get(), "LOOP.N", DaedalusDataType::INT, 0, 0, 1);
+		w->write_int(0);
+		w->write_int(-1);
+
+		write_symbol(w.get(), "LOOP.I", DaedalusDataType::INT, 0, 0, 1);
+		w->write_int(0);
+		w->write_int(-1);
+
+		std::vector<std::byte> text {};
+		auto t = Write::to(&text);
+
+		// n = <argument>; i = 0;
+		write_instruction(t.get(), DaedalusOpcode::PUSHV, 1);
+		write_instruction(t.get(), DaedalusOpcode::MOVI);
+		write_instruction(t.get(), DaedalusOpcode::PUSHI, 0);
+		write_instruction(t.get(), DaedalusOpcode::PUSHV, 2);
+		write_instruction(t.get(), DaedalusOpcode::MOVI);
+
+		// while (i < n) { i += 1; }
+		auto loop = static_cast<std::uint32_t>(t->tell());
+		write_instruction(t.get(), DaedalusOpcode::PUSHV, 1);
+		write_instruction(t.get(), DaedalusOpcode::PUSHV, 2);
+		write_instruction(t.get(), DaedalusOpcode::LT);
+		write_instruction(t.get(), DaedalusOpcode::BZ, static_cast<std::uint32_t>(t->tell()) + 5 + 11 + 5);
+		write_instruction(t.get(), DaedalusOpcode::PUSHI, 1);
+		write_instruction(t.get(), DaedalusOpcode::PUSHV, 2);
+		write_instruction(t.get(), DaedalusOpcode::ADDMOVI);
+		write_instruction(t.get(), DaedalusOpcode::B, loop);
+
+		// return i;
+		write_instruction(t.get(), DaedalusOpcode::PUSHV, 2);
+		write_instruction(t.get(), DaedalusOpcode::RSR);
+
+		w->write_uint(static_cast<std::uint32_t>(text.size()));
+		w->write(text.data(), text.size());
+		return data;
+	}
+
+	/// \brief Generates a script with the shape of a compiled `GOTHIC.DAT` of Gothic II, which has roughly 30000
+	///        symbols at a \p scale of `1`.
+	///
+	/// <p>The script contains a class with 48 members, `8192 * scale` instances of it each with a name constant and
+	/// an initializer setting 17 of its members, and `4096 * scale` functions taking two arguments.</p>
+	static std::vector<std::byte> make_large_script(std::uint32_t scale) {
+		static constexpr std::uint32_t MEMBER_COUNT = 48;
+		static constexpr std::uint32_t INT_MEMBER_COUNT = 40;
+
+		auto instance_count = 8192 * scale;
+		auto function_count = 4096 * scale;
+		auto symbol_count = 1 + MEMBER_COUNT + instance_count * 2 + function_count * 3;
+
+		// Generate the code first, since the symbols refer to it.
+		std::vector<std::byte> text {};
+		auto t = Write::to(&text);
+
+		std::vector<std::uint32_t> instance_addresses {};
+		for (auto i = 0u; i < instance_count; ++i) {
+			instance_addresses.push_back(static_cast<std::uint32_t>(t->tell()));
+
+			for (auto k = 0u; k < 16; ++k) {
+				write_instruction(t.get(), DaedalusOpcode::PUSHI, i + k);
+				write_instruction(t.get(), DaedalusOpcode::PUSHV, 1 + (i + k) % INT_MEMBER_COUNT);
+				write_instruction(t.get(), DaedalusOpcode::MOVI);
+			}
+
+			write_instruction(t.get(), DaedalusOpcode::PUSHV, 1 + MEMBER_COUNT + i * 2);
+			write_instruction(t.get(), DaedalusOpcode::PUSHV, 1 + INT_MEMBER_COUNT);
+			write_instruction(t.get(), DaedalusOpcode::MOVS);
+			write_instruction(t.get(), DaedalusOpcode::RSR);
+		}
+
+		auto first_function = 1 + MEMBER_COUNT + instance_count * 2;
+		std::vector<std::uint32_t> function_addresses {};
+		for (auto i = 0u; i < function_count; ++i) {
+			auto self = first_function + i * 3;
+			function_addresses.push_back(static_cast<std::uint32_t>(t->tell()));
+
+			// b = <argument>; a = <argument>; return a * b + i;
+			write_instruction(t.get(), DaedalusOpcode::PUSHV, self + 2);
+			write_instruction(t.get(), DaedalusOpcode::MOVI);
+			write_instruction(t.get(), DaedalusOpcode::PUSHV, self + 1);
+			write_instruction(t.get(), DaedalusOpcode::MOVI);
+			write_instruction(t.get(), DaedalusOpcode::PUSHI, i);
+			write_instruction(t.get(), DaedalusOpcode::PUSHV, self + 2);
+			write_instruction(t.get(), DaedalusOpcode::PUSHV, self + 1);
+			write_instruction(t.get(), DaedalusOpcode::MUL);
+			write_instruction(t.get(), DaedalusOpcode::ADD);
+			write_instruction(t.get(), DaedalusOpcode::RSR);
+		}
+
+		std::vector<std::byte> data {};
+		auto w = Write::to(&data);
+
+		w->write_ubyte(50);
+		w->write_uint(symbol_count);
+
+		// Sort table
+		for (auto i = 0u; i < symbol_count; ++i) {
+			w->write_uint(i);
+		}
+
+		write_symbol(w.get(), "C_NPC", DaedalusDataType::CLASS, 0, MEMBER_COUNT * 4, MEMBER_COUNT);
+		w->write_int(0); // Class offset
+		w->write_int(-1);
+
+		for (auto k = 0u; k < MEMBER_COUNT; ++k) {
+			auto type = k < INT_MEMBER_COUNT ? DaedalusDataType::INT : DaedalusDataType::STRING;
+			auto count = k % 8 == 7 ? 8u : 1u;
+			write_symbol(w.get(), "C_NPC.M" + std::to_string(k), type, DaedalusSymbolFlag::MEMBER, k * 4, count);
+			w->write_int(0); // Parent
+		}
+
+		for (auto i = 0u; i < instance_count; ++i) {
+			auto name = "NPC_" + std::to_string(i);
+
+			write_symbol(w.get(), name + "_NAME", DaedalusDataType::STRING, DaedalusSymbolFlag::CONST, 0, 1);
+			w->write_string("Synthetic character number " + std::to_string(i));
+			w->write_char('\n');
+			w->write_int(-1);
+
+			write_symbol(w.get(), name, DaedalusDataType::INSTANCE, DaedalusSymbolFlag::CONST, 0, 0);
+			w->write_uint(instance_addresses[i]);
+			w->write_int(0); // Parent
+		}
+
+		for (auto i = 0u; i < function_count; ++i) {
+			auto name = "FN_" + std::to_string(i);
+
+			write_symbol(w.get(),
+			             name,
+			             DaedalusDataType::FUNCTION,
+			             DaedalusSymbolFlag::CONST | DaedalusSymbolFlag::RETURN,
+			             static_cast<std::uint32_t>(DaedalusDataType::INT),
+			             2);
+			w->write_uint(function_addresses[i]);
+			w->write_int(-1);
+
+			for (auto* local : {".A", ".B"}) {
+				write_symbol(w.get(), name + local, DaedalusDataType::INT, 0, 0, 1);
+				w->write_int(0);
+				w->write_int(-1);
+			}
+		}
+
+		w->write_uint(static_cast<std::uint32_t>(text.size()));
+		w->write(text.data(), text.size());
+		return data;
+	}
+
+	void run_daedalus_benchmarks(Runner& runner) {
+		auto large = make_large_script(runner.options().scale);
+		runner.run("daedalus/load(synthetic)", large.size(), [&large] {
+			DaedalusScript script {};
+			auto r = Read::from(large.data(), large.size());
+			script.load(r.get());
+			do_not_optimize(script.size());
+		});
+
+		// Also benchmark a real script if one is available. See tests/samples/menu.dat.readme.
+		auto menu = runner.options().samples / "menu.proprietary.dat";
+		if (std::filesystem::exists(menu)) {
+			auto sample = read_file(menu);
+			runner.run("daedalus/load(menu.proprietary.dat)", sample.size(), [&sample] {
+				DaedalusScript script {};
+				auto r = Read::from(sample.data(), sample.size());
+				script.load(r.get());
+				do_not_optimize(script.size());
+			});
+		}
+
+		{
+			DaedalusScript script {};
+			auto r = Read::from(large.data(), large.size());
+			script.load(r.get());
+
+			runner.run("daedalus/find_symbol_by_name(synthetic)", 0, [&script] {
+				for (auto i = 0; i < 4096; ++i) {
+					do_not_optimize(script.find_symbol_by_name("NPC_" + std::to_string(i)));
+				}
+			});
+
+			DaedalusVm vm {std::move(script)};
+			if (vm.call_function<std::int32_t>(vm.find_symbol_by_name("FN_5"), 3, 4) != 3 * 4 + 5) {
+				throw std::runtime_error {"daedalus synthetic function returned an unexpected result"};
+			}
+		}
+
+		auto data = make_loop_script();
+		DaedalusScript script {};
+		auto r = Read::from(data.data(), data.size());
+		script.load(r.get());
+
+		DaedalusVm vm {std::move(script)};
+		auto* loop = vm.find_symbol_by_name("LOOP");
+
+		auto iterations = 100'000 * static_cast<std::int32_t>(runner.options().scale);
+		if (vm.call_function<std::int32_t>(loop, iterations) != iterations) {
+			throw std::runtime_error {"daedalus loop returned an unexpected result"};
+		}
+
+		runner.run("daedalus/call_function(loop," + std::to_string(iterations) + ")", 0, [&vm, loop, iterations] {
+			do_not_optimize(vm.call_function<std::int32_t>(loop, iterations));
+		});
+
+		runner.run("daedalus/call_function(loop,1)", 0, [&vm, loop] {
+			for (auto i = 0; i < 10'000; ++i) {
+				do_not_optimize(vm.call_function<std::int32_t>(loop, 1));
+			}
+		});
+	}
+} // namespace zenkit::bench
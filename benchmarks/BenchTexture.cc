@@ -0,0 +1,84 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "Benchmark.hh"
+
+#include <zenkit/Stream.hh>
+#include <zenkit/Texture.hh>
+
+#include <algorithm>
+#include <random>
+
+namespace zenkit::bench {
+	static std::size_t mipmap_size(TextureFormat format, std::uint32_t width, std::uint32_t height) {
+		switch (format) {
+		case TextureFormat::DXT1:
+			return std::max(1u, width / 4) * std::max(1u, height / 4) * 8;
+		case TextureFormat::DXT3:
+		case TextureFormat::DXT5:
+			return std::max(1u, width / 4) * std::max(1u, height / 4) * 16;
+		case TextureFormat::R5G6B5:
+		case TextureFormat::A4R4G4B4:
+		case TextureFormat::A1R5G5B5:
+			return width * height * 2;
+		case TextureFormat::R8G8B8:
+		case TextureFormat::B8G8R8:
+			return width * height * 3;
+		default:
+			return width * height * 4;
+		}
+	}
+
+	/// \brief Generates a texture file with a single mipmap filled with random data.
+	static std::vector<std::byte> make_synthetic_texture(TextureFormat format, std::uint32_t size) {
+		std::mt19937 rng {42};
+		std::vector<std::byte> data {};
+		auto w = Write::to(&data);
+
+		w->write_string("ZTEX");
+		w->write_uint(0);
+		w->write_uint(static_cast<std::uint32_t>(format));
+		w->write_uint(size);
+		w->write_uint(size);
+		w->write_uint(1);
+		w->write_uint(size);
+		w->write_uint(size);
+		w->write_uint(0);
+
+		for (auto i = mipmap_size(format, size, size); i > 0; --i) {
+			w->write_ubyte(static_cast<std::uint8_t>(rng()));
+		}
+
+		return data;
+	}
+
+	void run_texture_benchmarks(Runner& runner) {
+		auto sample = read_file(runner.options().samples / "erz.tex");
+		runner.run("texture/load(erz.tex)", sample.size(), [&sample] {
+			Texture tex {};
+			auto r = Read::from(sample.data(), sample.size());
+			tex.load(r.get());
+			do_not_optimize(tex.width());
+		});
+
+		auto size = 512u * runner.options().scale;
+		std::pair<char const*, TextureFormat> const formats[] = {
+		    {"DXT1", TextureFormat::DXT1},
+		    {"DXT5", TextureFormat::DXT5},
+		    {"R5G6B5", TextureFormat::R5G6B5},
+		    {"B8G8R8A8", TextureFormat::B8G8R8A8},
+		};
+
+		for (auto [name, format] : formats) {
+			auto data = make_synthetic_texture(format, size);
+
+			Texture tex {};
+			auto r = Read::from(data.data(), data.size());
+			tex.load(r.get());
+
+			runner.run(std::string {"texture/as_rgba8("} + name + ")", std::uint64_t {size} * size * 4, [&tex] {
+				auto rgba = tex.as_rgba8(0);
+				do_not_optimize(rgba.data());
+			});
+		}
+	}
+} // namespace zenkit::bench
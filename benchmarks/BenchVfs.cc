@@ -0,0 +1,84 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "Benchmark.hh"
+
+#include <zenkit/Stream.hh>
+#include <zenkit/Vfs.hh>
+
+#include <cstdio>
+
+namespace zenkit::bench {
+	/// \brief Generates a disk with `16 * scale` directories of 256 small files each.
+	static std::vector<std::byte> make_synthetic_disk(std::uint32_t scale, std::vector<std::string>& names) {
+		static std::byte const content[64] {};
+
+		Vfs vfs {};
+		char name[32];
+
+		for (auto d = 0u; d < 16 * scale; ++d) {
+			std::snprintf(name, sizeof name, "DIR_%05u", d);
+			auto& dir = vfs.mkdir(name);
+
+			for (auto f = 0u; f < 256; ++f) {
+				std::snprintf(name, sizeof name, "FILE_%05u_%03u.TEX", d, f);
+				dir.create(VfsNode::file(name, VfsFileDescriptor {content, sizeof content, false}));
+				names.emplace_back(name);
+			}
+		}
+
+		std::vector<std::byte> disk {};
+		auto w = Write::to(&disk);
+		vfs.save(w.get(), GameVersion::GOTHIC_2);
+		return disk;
+	}
+
+	void run_vfs_benchmarks(Runner& runner) {
+		auto sample = read_file(runner.options().samples / "basic.vdf");
+		runner.run("vfs/mount_disk(basic.vdf)", sample.size(), [&sample] {
+			Vfs vfs {};
+			auto r = Read::from(sample.data(), sample.size());
+			vfs.mount_disk(r.get());
+			do_not_optimize(vfs.root());
+		});
+
+		std::vector<std::string> names {};
+		auto disk = make_synthetic_disk(runner.options().scale, names);
+
+		runner.run("vfs/mount_disk(synthetic)", disk.size(), [&disk] {
+			Vfs vfs {};
+			auto r = Read::from(disk.data(), disk.size());
+			vfs.mount_disk(r.get());
+			do_not_optimize(vfs.root());
+		});
+
+		Vfs vfs {};
+		auto r = Read::from(disk.data(), disk.size());
+		vfs.mount_disk(r.get());
+
+		runner.run("vfs/find(synthetic)", 0, [&vfs, &names] {
+			for (auto& name : names) {
+				do_not_optimize(vfs.find(name));
+			}
+		});
+
+		runner.run("vfs/find(synthetic,case-insensitive)", 0, [&vfs, &names] {
+			std::string other_case {};
+			for (auto& name : names) {
+				other_case = name;
+				other_case[0] = 'f';
+				do_not_optimize(vfs.find(other_case));
+			}
+		});
+
+		runner.run("vfs/resolve(synthetic)", 0, [&vfs, &names] {
+			std::string path {};
+			for (auto& name : names) {
+				path.assign("DIR_");
+				path.append(name, 5, 5);
+				path += '/';
+				path += name;
+				do_not_optimize(vfs.resolve(path));
+			}
+		});
+	}
+} // namespace zenkit::bench
@@ -0,0 +1,149 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "Benchmark.hh"
+
+#include <zenkit/Logger.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+namespace zenkit::bench {
+	using Clock = std::chrono::steady_clock;
+
+	Runner::Runner(Options options) : _m_options(std::move(options)) {}
+
+	void Runner::run(std::string const& name, std::uint64_t bytes, std::function<void()> const& fn) {
+		if (!_m_options.filter.empty() && name.find(_m_options.filter) == std::string::npos) return;
+
+		// Warm up caches and allocators before measuring.
+		fn();
+
+		std::vector<double> samples {};
+		auto begin = Clock::now();
+		auto min_time = std::chrono::duration<double>(_m_options.min_time);
+
+		while (samples.size() < _m_options.min_iterations || Clock::now() - begin < min_time) {
+			auto start = Clock::now();
+			fn();
+			auto end = Clock::now();
+			samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+		}
+
+		std::sort(samples.begin(), samples.end());
+
+		Result result {};
+		result.name = name;
+		result.iterations = samples.size();
+		result.min_ns = samples.front();
+		result.median_ns = samples[samples.size() / 2];
+		result.mean_ns = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+		result.bytes = bytes;
+
+		std::printf("%-48s %8zu iters %14.0f ns/op (median)", name.c_str(), result.iterations, result.median_ns);
+		if (bytes != 0) {
+			std::printf(" %10.2f MiB/s", static_cast<double>(bytes) / (result.median_ns / 1e9) / (1024.0 * 1024.0));
+		}
+		std::printf("\n");
+		std::fflush(stdout);
+
+		_m_results.push_back(std::move(result));
+	}
+
+	static void write_json_string(std::ostream& out, std::string const& s) {
+		out << '"';
+		for (auto c : s) {
+			if (c == '"' || c == '\\') out << '\\';
+			out << c;
+		}
+		out << '"';
+	}
+
+	void Runner::write_json(std::ostream& out) const {
+		out.precision(12);
+		out << "{\n  \"context\": {\"scale\": " << _m_options.scale << ", \"min_time\": " << _m_options.min_time
+		    << "},\n  \"benchmarks\": [";
+
+		for (auto i = 0u; i < _m_results.size(); ++i) {
+			auto& r = _m_results[i];
+			out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+			write_json_string(out, r.name);
+			out << ", \"iterations\": " << r.iterations << ", \"min_ns\": " << r.min_ns
+			    << ", \"median_ns\": " << r.median_ns << ", \"mean_ns\": " << r.mean_ns << ", \"bytes\": " << r.bytes;
+
+			if (r.bytes != 0) {
+				out << ", \"bytes_per_second\": " << static_cast<double>(r.bytes) / (r.median_ns / 1e9);
+			}
+
+			out << "}";
+		}
+
+		out << "\n  ]\n}\n";
+	}
+
+	std::vector<std::byte> read_file(std::filesystem::path const& path) {
+		std::vector<std::byte> data(std::filesystem::file_size(path));
+		std::ifstream in {path, std::ios::binary};
+		in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return data;
+	}
+} // namespace zenkit::bench
+
+static void print_usage(char const* program) {
+	std::fprintf(stderr,
+	             "usage: %s [--samples DIR] [--filter TEXT] [--json FILE] [--min-time SECONDS] "
+	             "[--min-iterations N] [--scale N]\n",
+	             program);
+}
+
+int main(int argc, char** argv) {
+	zenkit::bench::Options options {};
+	std::string json_path {};
+
+	for (auto i = 1; i < argc; ++i) {
+		auto has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--samples") == 0 && has_value) {
+			options.samples = argv[++i];
+		} else if (std::strcmp(argv[i], "--filter") == 0 && has_value) {
+			options.filter = argv[++i];
+		} else if (std::strcmp(argv[i], "--json") == 0 && has_value) {
+			json_path = argv[++i];
+		} else if (std::strcmp(argv[i], "--min-time") == 0 && has_value) {
+			options.min_time = std::strtod(argv[++i], nullptr);
+		} else if (std::strcmp(argv[i], "--min-iterations") == 0 && has_value) {
+			options.min_iterations = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		} else if (std::strcmp(argv[i], "--scale") == 0 && has_value) {
+			options.scale = static_cast<std::uint32_t>(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+		} else {
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Logging is not part of what is being measured.
+	zenkit::Logger::set_default(zenkit::LogLevel::ERROR);
+
+	zenkit::bench::Runner runner {options};
+
+	try {
+		zenkit::bench::run_vfs_benchmarks(runner);
+		zenkit::bench::run_archive_benchmarks(runner);
+		zenkit::bench::run_texture_benchmarks(runner);
+		zenkit::bench::run_daedalus_benchmarks(runner);
+	} catch (std::exception const& e) {
+		std::fprintf(stderr, "benchmark failed: %s\n", e.what());
+		return 1;
+	}
+
+	if (!json_path.empty()) {
+		std::ofstream out {json_path};
+		runner.write_json(out);
+	}
+
+	return 0;
+}
@@ -0,0 +1,80 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace zenkit::bench {
+	/// \brief Prevents the compiler from optimizing away the computation of \p value.
+	template <typename T>
+	inline void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static_cast<void>(*static_cast<char const volatile*>(static_cast<void const*>(&value)));
+#endif
+	}
+
+	struct Options {
+		/// \brief The directory containing the test samples.
+		std::filesystem::path samples {"tests/samples"};
+
+		/// \brief Only benchmarks whose name contains this string are run.
+		std::string filter {};
+
+		/// \brief The minimum time to spend running each benchmark in seconds.
+		double min_time {0.5};
+
+		/// \brief The minimum number of timed iterations of each benchmark.
+		std::size_t min_iterations {5};
+
+		/// \brief A factor applied to the size of all synthetically generated inputs.
+		std::uint32_t scale {1};
+	};
+
+	struct Result {
+		std::string name;
+		std::size_t iterations;
+		double min_ns;
+		double median_ns;
+		double mean_ns;
+
+		/// \brief The number of bytes processed by a single iteration or `0` if not applicable.
+		std::uint64_t bytes;
+	};
+
+	class Runner {
+	public:
+		explicit Runner(Options options);
+
+		/// \brief Runs a single benchmark if it matches the filter.
+		/// \param name The unique name of the benchmark.
+		/// \param bytes The number of input bytes processed by each invocation of \p fn used to calculate the
+		///              throughput or `0` if not applicable.
+		/// \param fn The function to benchmark.
+		void run(std::string const& name, std::uint64_t bytes, std::function<void()> const& fn);
+
+		void write_json(std::ostream& out) const;
+
+		[[nodiscard]] Options const& options() const noexcept {
+			return _m_options;
+		}
+
+	private:
+		Options _m_options;
+		std::vector<Result> _m_results;
+	};
+
+	/// \brief Reads a whole file into memory.
+	std::vector<std::byte> read_file(std::filesystem::path const& path);
+
+	void run_archive_benchmarks(Runner& runner);
+	void run_daedalus_benchmarks(Runner& runner);
+	void run_texture_benchmarks(Runner& runner);
+	void run_vfs_benchmarks(Runner& runner);
+} // namespace zenkit::bench
@@ -0,0 +1,53 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Library.hh"
+
+#include <memory_resource>
+
+namespace zenkit {
+	/// \brief Makes ZenKit allocate the objects it creates while loading assets from a memory resource.
+	///
+	/// <p>While a scope is alive, all objects which ZenKit creates through `std::shared_ptr` on the same thread are
+	/// allocated from the given memory resource. This includes all objects read from archives, like the VObs of a
+	/// zenkit::World, and the lightmaps of a zenkit::Mesh. Loading a world can create hundreds of thousands of these,
+	/// so using a `std::pmr::monotonic_buffer_resource` or a pooled resource avoids fragmenting the global heap.</p>
+	///
+	/// <p>Containers and strings stored in these objects are still allocated using the global allocator.</p>
+	///
+	/// <p>The memory resource must outlive all objects allocated from it. If the objects are released on other
+	/// threads, the memory resource must be thread-safe. Scopes can be nested; the innermost scope wins.</p>
+	///
+	/// \code
+	/// std::pmr::monotonic_buffer_resource arena {};
+	/// zenkit::World world {};
+	///
+	/// {
+	///     zenkit::MemoryResourceScope scope {&arena};
+	///     world.load(r.get());
+	/// }
+	///
+	/// // ...
+	///
+	/// world = {};
+	/// arena.release();
+	/// \endcode
+	class MemoryResourceScope {
+	public:
+		/// \brief Installs a memory resource for the current thread.
+		/// \param resource The memory resource to use or `nullptr` to use the global allocator.
+		ZKAPI explicit MemoryResourceScope(std::pmr::memory_resource* resource) noexcept;
+
+		/// \brief Restores the memory resource which was active before this scope was created.
+		ZKAPI ~MemoryResourceScope() noexcept;
+
+		MemoryResourceScope(MemoryResourceScope const&) = delete;
+		MemoryResourceScope& operator=(MemoryResourceScope const&) = delete;
+
+		/// \return The memory resource used on the current thread or `nullptr` if the global allocator is used.
+		[[nodiscard]] ZKAPI static std::pmr::memory_resource* current() noexcept;
+
+	private:
+		std::pmr::memory_resource* _m_previous;
+	};
+} // namespace zenkit
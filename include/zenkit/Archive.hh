@@ -249,6 +249,14 @@ namespace zenkit {
 		///                     currently being read.
 		virtual void skip_object(bool skip_current);
 
+		/// \brief Releases the object with the given index and all objects read after it from the reference cache.
+		///
+		/// Objects referenced later on in the archive are normally kept alive by the reader so that the references
+		/// can be resolved. After calling this function, references to the released objects resolve to `nullptr`.
+		///
+		/// \param index The archive index of the first object to release.
+		void forget_objects(std::uint32_t index);
+
 		/// \return The header of the archive
 		[[nodiscard]] ArchiveHeader const& get_header() const noexcept {
 			return header;
@@ -278,6 +286,7 @@ namespace zenkit {
 
 	private:
 		std::unordered_map<uint32_t, std::shared_ptr<Object>> _m_cache {};
+		std::uint32_t _m_highest_index {0};
 		std::unique_ptr<Read> _m_owned;
 	};
 
@@ -0,0 +1,219 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Stream.hh"
+#include "zenkit/Vfs.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace zenkit {
+	/// \brief Usage statistics of a zenkit::AssetCache.
+	struct AssetCacheStats {
+		/// \brief The number of requests which were served from the cache, including those which waited for a
+		///        concurrent load of the same asset.
+		std::size_t hits {0};
+
+		/// \brief The number of requests which caused the asset to be loaded.
+		std::size_t misses {0};
+
+		/// \brief The number of assets which were evicted to stay within the memory budget.
+		std::size_t evictions {0};
+
+		/// \brief The estimated size of all assets currently held by the cache in bytes.
+		std::size_t size {0};
+
+		/// \brief The number of assets currently held by the cache.
+		std::size_t count {0};
+	};
+
+	/// \brief A thread-safe cache of assets loaded from a zenkit::Vfs.
+	///
+	/// <p>Assets are keyed by the identity of their zenkit::VfsNode. Since lookups by name go through Vfs::find,
+	/// names are matched case-insensitively. If multiple threads request the same asset at the same time, it is only
+	/// loaded once and all of them receive the same instance.</p>
+	///
+	/// <p>The cache tries to keep the estimated size of its assets within a memory budget by evicting the least
+	/// recently used ones. By default, the size of an asset is estimated to be the size of the file it was loaded
+	/// from. Evicted assets stay alive for as long as they are referenced elsewhere.</p>
+	///
+	/// \tparam T The type of asset to cache. It must be default-constructible and provide `void load(Read*)`.
+	template <typename T>
+	class AssetCache {
+	public:
+		using Pointer = std::shared_ptr<T const>;
+		using SizeFunction = std::function<std::size_t(T const&, VfsNode const&)>;
+
+		/// \brief Creates a new cache.
+		/// \param vfs The file system to load assets from. It must outlive the cache.
+		/// \param budget The maximum estimated size of all cached assets in bytes.
+		/// \param size A function estimating the in-memory size of an asset or an empty function to use the size of
+		///             the file the asset was loaded from.
+		explicit AssetCache(Vfs const& vfs, std::size_t budget = SIZE_MAX, SizeFunction size = {})
+		    : _m_vfs(&vfs), _m_budget(budget), _m_size(std::move(size)) {}
+
+		AssetCache(AssetCache const&) = delete;
+		AssetCache& operator=(AssetCache const&) = delete;
+
+		/// \brief Retrieves the asset with the given name, loading it if required.
+		/// \param name The name of the file to load the asset from.
+		/// \return The asset or `nullptr` if no file with the given name exists.
+		/// \throws ParserError if the asset fails to load.
+		[[nodiscard]] Pointer get(std::string_view name) {
+			auto* node = _m_vfs->find(name);
+			if (node == nullptr || node->type() != VfsNodeType::FILE) return nullptr;
+			return this->get(node);
+		}
+
+		/// \brief Retrieves the asset stored in the given node, loading it if required.
+		/// \param node The node to load the asset from.
+		/// \return The asset.
+		/// \throws ParserError if the asset fails to load.
+		[[nodiscard]] Pointer get(VfsNode const* node) {
+			std::unique_lock lock {_m_lock};
+
+			if (auto it = _m_entries.find(node); it != _m_entries.end()) {
+				_m_stats.hits += 1;
+				_m_lru.splice(_m_lru.begin(), _m_lru, it->second.lru);
+
+				auto future = it->second.value;
+				lock.unlock();
+				return future.get();
+			}
+
+			_m_stats.misses += 1;
+			_m_lru.push_front(node);
+
+			std::promise<Pointer> promise {};
+			auto& entry = _m_entries[node];
+			auto id = entry.id = _m_next_id++;
+			entry.value = promise.get_future().share();
+			entry.lru = _m_lru.begin();
+			lock.unlock();
+
+			// Load the asset without holding the lock. Concurrent requests for the same node wait on the future.
+			std::shared_ptr<T> asset;
+			std::size_t size = 0;
+
+			try {
+				auto r = node->open_read();
+
+				if (!_m_size) {
+					r->seek(0, Whence::END);
+					size = r->tell();
+					r->seek(0, Whence::BEG);
+				}
+
+				asset = std::make_shared<T>();
+				asset->load(r.get());
+
+				if (_m_size) size = _m_size(*asset, *node);
+			} catch (...) {
+				lock.lock();
+				if (auto it = _m_entries.find(node); it != _m_entries.end() && it->second.id == id) {
+					this->erase(node);
+				}
+				lock.unlock();
+
+				promise.set_exception(std::current_exception());
+				throw;
+			}
+
+			promise.set_value(asset);
+
+			// The entry might have been evicted and possibly re-created while loading.
+			lock.lock();
+			if (auto it = _m_entries.find(node); it != _m_entries.end() && it->second.id == id) {
+				it->second.loaded = true;
+				it->second.size = size;
+				_m_stats.size += size;
+				_m_stats.count += 1;
+				this->trim(node);
+			}
+
+			return asset;
+		}
+
+		/// \brief Removes the asset stored in the given node from the cache.
+		/// \param node The node to remove.
+		void evict(VfsNode const* node) {
+			std::lock_guard lock {_m_lock};
+			this->erase(node);
+		}
+
+		/// \brief Removes all assets from the cache.
+		void clear() {
+			std::lock_guard lock {_m_lock};
+			while (!_m_lru.empty()) {
+				this->erase(_m_lru.back());
+			}
+		}
+
+		/// \brief Changes the memory budget of the cache, evicting assets if required.
+		/// \param budget The maximum estimated size of all cached assets in bytes.
+		void budget(std::size_t budget) {
+			std::lock_guard lock {_m_lock};
+			_m_budget = budget;
+			this->trim(nullptr);
+		}
+
+		/// \return The current usage statistics of the cache.
+		[[nodiscard]] AssetCacheStats stats() const {
+			std::lock_guard lock {_m_lock};
+			return _m_stats;
+		}
+
+	private:
+		struct Entry {
+			std::shared_future<Pointer> value;
+			typename std::list<VfsNode const*>::iterator lru;
+			std::uint64_t id {0};
+			std::size_t size {0};
+			bool loaded {false};
+		};
+
+		void erase(VfsNode const* node) {
+			auto it = _m_entries.find(node);
+			if (it == _m_entries.end()) return;
+
+			// Entries which are still loading have no size and are not counted yet.
+			if (it->second.loaded) {
+				_m_stats.size -= it->second.size;
+				_m_stats.count -= 1;
+			}
+
+			_m_lru.erase(it->second.lru);
+			_m_entries.erase(it);
+		}
+
+		void trim(VfsNode const* keep) {
+			auto it = _m_lru.end();
+
+			while (_m_stats.size > _m_budget && it != _m_lru.begin()) {
+				auto* node = *--it;
+				if (node == keep || !_m_entries.at(node).loaded) continue;
+
+				it = std::next(it);
+				this->erase(node);
+				_m_stats.evictions += 1;
+			}
+		}
+
+		Vfs const* _m_vfs;
+		std::size_t _m_budget;
+		SizeFunction _m_size;
+
+		mutable std::mutex _m_lock;
+		std::unordered_map<VfsNode const*, Entry> _m_entries;
+		std::list<VfsNode const*> _m_lru;
+		std::uint64_t _m_next_id {0};
+		AssetCacheStats _m_stats;
+	};
+} // namespace zenkit
@@ -3,8 +3,11 @@
 #pragma once
 #include "zenkit/Library.hh"
 
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace phoenix {
@@ -61,4 +64,103 @@ namespace zenkit {
 		/// \return The parsed bounding box.
 		[[nodiscard]] ZKREM("use ::load()") ZKAPI static OrientedBoundingBox parse(phoenix::buffer& in);
 	};
+
+	/// \brief The closest leaf hit by a ray cast against an OrientedBoundingBoxTree.
+	struct OrientedBoundingBoxHit {
+		/// \brief The index of the hierarchy the leaf belongs to.
+		std::uint32_t root;
+
+		/// \brief The index of the leaf in the tree.
+		std::uint32_t node;
+
+		/// \brief The ray parameter at which the ray enters the leaf. The point of entry is
+		///        `origin + direction * distance`.
+		float distance;
+	};
+
+	/// \brief One or more OrientedBoundingBox hierarchies flattened for fast intersection tests.
+	///
+	/// <p>The boxes of each hierarchy are stored in depth-first order. Every node knows the index of the node following
+	/// its subtree, so that a hierarchy can be descended in a single forward pass without recursion or a stack. Only
+	/// the leaves of a hierarchy are treated as solid. A leaf is hit if it and all of its ancestors are hit.</p>
+	///
+	/// <p>The boxes are stored in blocks of four, component by component, and each test checks a whole block at once
+	/// using SIMD instructions where available. Blocks are only tested once the traversal reaches them, so subtrees
+	/// which are skipped are mostly never tested at all.</p>
+	///
+	/// <p>The axes of all boxes must be orthonormal. Queries never allocate and may be run concurrently.</p>
+	class OrientedBoundingBoxTree {
+	public:
+		/// \brief Replaces the contents of the tree with a single hierarchy.
+		ZKAPI void build(OrientedBoundingBox const& root);
+
+		/// \brief Replaces the contents of the tree with multiple hierarchies, e.g. SoftSkinMesh::bboxes.
+		ZKAPI void build(std::vector<OrientedBoundingBox> const& roots);
+
+		/// \brief Replaces the contents of the tree with a transformed copy of another tree.
+		///
+		/// <p>This is used to move hit volumes defined relative to the nodes of a model into world space, for
+		/// example using the current pose of its skeleton.</p>
+		///
+		/// \param source The tree to copy. Must not be this tree.
+		/// \param transforms One rigid transform for each hierarchy of \p source.
+		ZKAPI void transform(OrientedBoundingBoxTree const& source, glm::mat4 const* transforms);
+
+		/// \brief Finds the hierarchies overlapping a box.
+		/// \param box The box to test. Its children are ignored.
+		/// \param roots Receives the indices of up to \p capacity overlapping hierarchies in ascending order.
+		/// \param capacity The number of elements \p roots can hold.
+		/// \return The number of overlapping hierarchies, which may be larger than \p capacity.
+		[[nodiscard]] ZKAPI std::size_t
+		overlaps(OrientedBoundingBox const& box, std::uint32_t* roots, std::size_t capacity) const noexcept;
+
+		/// \brief Finds the hierarchies overlapping a sphere.
+		/// \see #overlaps(OrientedBoundingBox const&, std::uint32_t*, std::size_t) const
+		[[nodiscard]] ZKAPI std::size_t
+		overlaps(glm::vec3 center, float radius, std::uint32_t* roots, std::size_t capacity) const noexcept;
+
+		/// \brief Finds the closest leaf hit by a ray.
+		/// \param origin The origin of the ray.
+		/// \param direction The direction of the ray.
+		/// \param max_distance The largest ray parameter to consider, in multiples of \p direction.
+		/// \param hit Receives the closest leaf hit.
+		/// \return `true` if a leaf was hit.
+		[[nodiscard]] ZKAPI bool raycast(glm::vec3 origin,
+		                                 glm::vec3 direction,
+		                                 float max_distance,
+		                                 OrientedBoundingBoxHit& hit) const noexcept;
+
+		/// \return The box of the given node without its children.
+		[[nodiscard]] ZKAPI OrientedBoundingBox node(std::uint32_t index) const noexcept;
+
+		/// \return The number of boxes in the tree.
+		[[nodiscard]] std::size_t size() const noexcept {
+			return _m_next.size();
+		}
+
+		/// \return The number of hierarchies in the tree.
+		[[nodiscard]] std::size_t root_count() const noexcept {
+			return _m_roots.empty() ? 0 : _m_roots.size() - 1;
+		}
+
+	private:
+		struct Block {
+			float center[3][4];
+			float axes[3][3][4];
+			float half_width[3][4];
+		};
+
+		ZKINT void flatten(OrientedBoundingBox const& box);
+
+		template <typename Evaluate, typename Leaf>
+		void traverse(std::uint32_t root, Evaluate&& evaluate, Leaf&& leaf) const noexcept;
+
+		std::vector<Block> _m_blocks;
+
+		/// \brief The index of the node following the subtree of each node.
+		std::vector<std::uint32_t> _m_next;
+
+		/// \brief The index of the first node of each hierarchy, followed by the total number of nodes.
+		std::vector<std::uint32_t> _m_roots;
+	};
 } // namespace zenkit
@@ -0,0 +1,178 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Boxes.hh"
+#include "zenkit/Library.hh"
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zenkit {
+	class Mesh;
+	class MultiResolutionMesh;
+	class SoftSkinMesh;
+
+	/// \brief The largest distance between a unit normal and its decoded CompactNormal.
+	constexpr float COMPACT_NORMAL_MAX_ERROR = 8e-5f;
+
+	/// \brief The largest relative error of a value in the normal range of a half-precision float. Smaller values have
+	///        an absolute error of at most `2^-25`, larger ones than `65504` become infinite.
+	constexpr float COMPACT_HALF_MAX_RELATIVE_ERROR = 1.0f / 2048.0f;
+
+	/// \brief A position quantised to 16 bits per component.
+	/// \see PositionQuantization
+	struct CompactPosition {
+		std::uint16_t x;
+		std::uint16_t y;
+		std::uint16_t z;
+	};
+
+	/// \brief A unit normal encoded using the octahedral mapping with 16 bits per component.
+	struct CompactNormal {
+		std::int16_t x;
+		std::int16_t y;
+	};
+
+	/// \brief The compact form of a VertexFeature.
+	struct CompactFeature {
+		/// \brief The texture coordinates as half-precision floats.
+		std::uint16_t texture[2];
+
+		/// \brief The packed light color, as in VertexFeature::light.
+		std::uint32_t light;
+
+		CompactNormal normal;
+	};
+
+	/// \brief The compact form of a MeshWedge.
+	struct CompactWedge {
+		CompactNormal normal;
+
+		/// \brief The texture coordinates as half-precision floats.
+		std::uint16_t texture[2];
+		std::uint16_t index;
+	};
+
+	/// \brief The compact form of a SoftSkinWedgeNormal.
+	struct CompactWedgeNormal {
+		CompactNormal normal;
+		std::uint32_t index;
+	};
+
+	/// \brief The compact form of a SoftSkinWeightEntry.
+	struct CompactWeightEntry {
+		/// \brief The weight quantised to 16 bits, where `65535` is a weight of `1`.
+		std::uint16_t weight;
+		CompactPosition position;
+		std::uint8_t node_index;
+	};
+
+	/// \brief Maps positions within a bounding box to 16-bit integers.
+	///
+	/// <p>The box is divided into 65535 steps along each axis. A position is decoded as `origin + q * step`, so the
+	/// error of each component is at most half a step, up to floating-point rounding. Positions outside of the box
+	/// are clamped to it.</p>
+	struct PositionQuantization {
+		/// \brief The position of the integer coordinate `(0, 0, 0)`.
+		glm::vec3 origin;
+
+		/// \brief The distance between two consecutive integer coordinates along each axis.
+		glm::vec3 step;
+
+		[[nodiscard]] ZKAPI static PositionQuantization from_bounds(AxisAlignedBoundingBox const& bbox) noexcept;
+
+		/// \brief Creates a quantization covering the bounding box of the given points.
+		[[nodiscard]] ZKAPI static PositionQuantization from_points(glm::vec3 const* points,
+		                                                            std::size_t count) noexcept;
+
+		/// \return The largest error of each component of a position inside of the box.
+		[[nodiscard]] glm::vec3 max_error() const noexcept {
+			return step * 0.5f;
+		}
+	};
+
+	/// \brief Quantises \p count positions. Positions outside of the box of \p q are clamped to it.
+	ZKAPI void encode_positions(PositionQuantization const& q,
+	                            glm::vec3 const* in,
+	                            std::size_t count,
+	                            CompactPosition* out) noexcept;
+
+	ZKAPI void decode_positions(PositionQuantization const& q,
+	                            CompactPosition const* in,
+	                            std::size_t count,
+	                            glm::vec3* out) noexcept;
+
+	/// \brief Encodes \p count normals. The normals do not need to be of unit length. Zero vectors are encoded as
+	///        `(0, 0, 1)`.
+	/// \see COMPACT_NORMAL_MAX_ERROR
+	ZKAPI void encode_normals(glm::vec3 const* in, std::size_t count, CompactNormal* out) noexcept;
+
+	/// \brief Decodes \p count normals to unit length.
+	ZKAPI void decode_normals(CompactNormal const* in, std::size_t count, glm::vec3* out) noexcept;
+
+	/// \brief Converts \p count floats to half-precision, rounding to the nearest representable value.
+	/// \see COMPACT_HALF_MAX_RELATIVE_ERROR
+	ZKAPI void encode_halfs(float const* in, std::size_t count, std::uint16_t* out) noexcept;
+
+	/// \brief Converts \p count half-precision floats back to single-precision. The conversion is exact.
+	ZKAPI void decode_halfs(std::uint16_t const* in, std::size_t count, float* out) noexcept;
+
+	/// \brief A compact copy of the vertices and vertex features of a Mesh.
+	///
+	/// <p>Positions are quantised to the bounding box of the mesh, normals are octahedral-encoded and texture
+	/// coordinates are stored as half-precision floats. This reduces the size of each vertex from 12 to 6 bytes and
+	/// of each feature from 24 to 12 bytes. Applications keeping many meshes resident may encode them and then
+	/// release Mesh::vertices and Mesh::features until they are needed again.</p>
+	class CompactMesh {
+	public:
+		ZKAPI void encode(Mesh const& mesh);
+
+		/// \brief Replaces Mesh::vertices and Mesh::features of \p mesh with the decoded data.
+		ZKAPI void decode(Mesh& mesh) const;
+
+		PositionQuantization quantization;
+		std::vector<CompactPosition> vertices;
+		std::vector<CompactFeature> features;
+	};
+
+	/// \brief A compact copy of the vertex data of a MultiResolutionMesh.
+	/// \see CompactMesh
+	class CompactMultiResolutionMesh {
+	public:
+		ZKAPI void encode(MultiResolutionMesh const& mesh);
+
+		/// \brief Replaces MultiResolutionMesh::positions, MultiResolutionMesh::normals and the SubMesh::wedges of
+		///        \p mesh with the decoded data. Sub-meshes are added to \p mesh if it has too few.
+		ZKAPI void decode(MultiResolutionMesh& mesh) const;
+
+		PositionQuantization quantization;
+		std::vector<CompactPosition> positions;
+		std::vector<CompactNormal> normals;
+
+		/// \brief The wedges of each sub-mesh.
+		std::vector<std::vector<CompactWedge>> wedges;
+	};
+
+	/// \brief A compact copy of the vertex data of a SoftSkinMesh.
+	///
+	/// <p>The positions of the weights are relative to their nodes rather than the mesh and thus use their own
+	/// quantization.</p>
+	/// \see CompactMesh
+	class CompactSoftSkinMesh {
+	public:
+		ZKAPI void encode(SoftSkinMesh const& mesh);
+
+		/// \brief Replaces the vertex data of \p mesh, its SoftSkinMesh::wedge_normals and its SoftSkinMesh::weights
+		///        with the decoded data.
+		ZKAPI void decode(SoftSkinMesh& mesh) const;
+
+		CompactMultiResolutionMesh mesh;
+		std::vector<CompactWedgeNormal> wedge_normals;
+
+		PositionQuantization weight_quantization;
+		std::vector<std::vector<CompactWeightEntry>> weights;
+	};
+} // namespace zenkit
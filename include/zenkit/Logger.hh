@@ -3,6 +3,7 @@
 #pragma once
 #include "zenkit/Library.hh"
 
+#include <atomic>
 #include <cstdarg>
 #include <cstdint>
 #include <functional>
@@ -40,13 +41,28 @@ namespace zenkit {
 		/// \brief Use the default logger callback for ZenKit.
 		ZKREM("renamed to ::set_default") ZKAPI static void use_default_logger();
 
+		/// \brief Formats a message and passes it to the logger callback.
+		///
+		/// Messages are formatted into a buffer local to the calling thread, so this function may be called from
+		/// multiple threads at the same time. Messages longer than 4095 characters are truncated.
 		ZK_PRINTF_LIKE(3, 4) ZKAPI static void log(LogLevel lvl, char const* name, char const* fmt, ...);
 		ZKAPI static void logv(LogLevel lvl, char const* name, char const* fmt, va_list ap);
+
+		/// \brief Sets the logger callback and the most verbose level passed to it.
+		///
+		/// The callback may be invoked from multiple threads at the same time. This function must not be called
+		/// while other threads might be logging.
 		ZKAPI static void set(LogLevel lvl, std::function<void(LogLevel, char const*, char const*)> const& cb);
 		ZKAPI static void set_default(LogLevel lvl);
 
+		/// \return Whether messages of the given level are passed to the logger callback. Checking this before
+		///         building an expensive message avoids formatting it only for it to be discarded.
+		[[nodiscard]] ZKAPI static bool enabled(LogLevel lvl) noexcept;
+
 	private:
 		static std::function<void(LogLevel, char const*, char const*)> _s_callback;
-		static LogLevel _s_level;
+
+		/// \brief The most verbose level passed to the callback or `-1` if there is no callback.
+		static std::atomic_int _s_threshold;
 	};
 } // namespace zenkit
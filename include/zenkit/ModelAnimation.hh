@@ -8,6 +8,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/vec3.hpp>
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -17,6 +18,7 @@ namespace phoenix {
 
 namespace zenkit {
 	class Read;
+	class Write;
 
 	/// \brief A single sample of an Animation.
 	///
@@ -190,4 +192,127 @@ namespace zenkit {
 		/// \brief A list of model hierarchy node indices.
 		std::vector<std::uint32_t> node_indices;
 	};
+
+	/// \brief The maximum error allowed when compressing the samples of a single skeleton node.
+	struct AnimationTrackTolerance {
+		/// \brief The maximum distance between an original and a compressed sample position.
+		float position {0.05f};
+
+		/// \brief The maximum difference of any component of an original and a compressed sample rotation.
+		float rotation {0.001f};
+	};
+
+	/// \brief Settings for compressing a ModelAnimation.
+	/// \see CompressedModelAnimation::compress
+	struct AnimationCompressionSettings {
+		/// \brief The tolerance to apply to all nodes without an entry in #node_tolerances.
+		AnimationTrackTolerance tolerance {};
+
+		/// \brief Per-node tolerances, indexed in the same way as ModelAnimation::node_indices.
+		std::vector<AnimationTrackTolerance> node_tolerances {};
+	};
+
+	/// \brief A compressed, directly sampleable form of a ModelAnimation.
+	///
+	/// <p>The position and rotation of every skeleton node are stored as separate tracks of keyframes. Tracks which do
+	/// not change within the configured tolerance are reduced to a single key, all other tracks only keep the keys
+	/// which can not be linearly interpolated from their neighbours. Positions are quantized to 16 bits per component
+	/// relative to the extents of their track and rotations are stored using the "smallest three" encoding with 15 bits
+	/// per component. Keys are selected using the quantized values, so the tolerance holds for the decoded samples as
+	/// long as it is larger than the quantization error itself (about `extent / 131070` per position component).</p>
+	///
+	/// <p>Samples can be retrieved for any (fractional) frame using #sample without decompressing the animation. The
+	/// compressed form can be stored using #save and loaded back using #load. This format is specific to ZenKit and is
+	/// not understood by the original engine.</p>
+	class CompressedModelAnimation {
+	public:
+		/// \brief Compresses the samples of the given animation.
+		/// \param anim The animation to compress.
+		/// \param settings The error tolerances to apply.
+		/// \return The compressed animation.
+		/// \throws zenkit::Error if the animation has more than 65535 frames.
+		[[nodiscard]] ZKAPI static CompressedModelAnimation compress(ModelAnimation const& anim,
+		                                                            AnimationCompressionSettings const& settings = {});
+
+		/// \brief Loads a compressed animation previously written using #save.
+		/// \param r The reader to read from.
+		/// \throws zenkit::ParserError if the data is truncated or a track references keys which do not exist.
+		ZKAPI void load(Read* r);
+		ZKAPI void save(Write* w) const;
+
+		/// \brief Samples the position and rotation of a single node.
+		/// \param node The index of the node in #node_indices.
+		/// \param frame The frame to sample. Clamped to `[0, frame_count - 1]`.
+		/// \return The interpolated sample.
+		[[nodiscard]] ZKAPI AnimationSample sample(std::uint32_t node, float frame) const noexcept;
+
+		/// \brief Samples the position and rotation of all nodes.
+		/// \param frame The frame to sample. Clamped to `[0, frame_count - 1]`.
+		/// \param out A buffer of at least #node_count elements to write the samples into.
+		ZKAPI void sample(float frame, AnimationSample* out) const noexcept;
+
+		/// \brief Restores all samples of the animation.
+		/// \return The samples, laid out like ModelAnimation::samples.
+		[[nodiscard]] ZKAPI std::vector<AnimationSample> decompress() const;
+
+		/// \return The total number of position and rotation keys stored.
+		[[nodiscard]] ZKAPI std::size_t key_count() const noexcept;
+
+		/// \return The number of bytes of heap memory used to store the compressed tracks.
+		[[nodiscard]] ZKAPI std::size_t size_bytes() const noexcept;
+
+		/// \brief The name of the animation
+		std::string name {};
+
+		/// \brief The next animation in queue.
+		std::string next {};
+
+		/// \brief The layer this animation is played in.
+		std::uint32_t layer {};
+
+		/// \brief The number of frames of this animation.
+		std::uint32_t frame_count {};
+
+		/// \brief The number of skeleton nodes this animation requires.
+		std::uint32_t node_count {};
+
+		/// \brief The number of frames of this animation to play per second.
+		float fps {};
+
+		/// \brief The number of frames per second the original model was animated with before being converted.
+		float fps_source {};
+
+		/// \brief The bounding box of the animation.
+		AxisAlignedBoundingBox bbox {};
+
+		/// \brief The checksum of the model hierarchy this animation was made for.
+		std::uint32_t checksum {};
+
+		/// \brief A list of model hierarchy node indices.
+		std::vector<std::uint32_t> node_indices;
+
+	private:
+		struct Track {
+			std::uint32_t first_key;
+			std::uint32_t key_count;
+		};
+
+		struct PositionRange {
+			glm::vec3 min;
+			glm::vec3 scale;
+		};
+
+		[[nodiscard]] ZKINT glm::vec3 sample_position(std::uint32_t node, float frame) const noexcept;
+		[[nodiscard]] ZKINT glm::quat sample_rotation(std::uint32_t node, float frame) const noexcept;
+
+		std::vector<Track> _m_position_tracks;
+		std::vector<PositionRange> _m_position_ranges;
+		std::vector<Track> _m_rotation_tracks;
+
+		/// \brief The frame of each key, shared by all tracks.
+		std::vector<std::uint16_t> _m_frames;
+
+		/// \brief The three quantized components of each key, shared by all tracks.
+		std::vector<std::uint16_t> _m_values;
+	};
 } // namespace zenkit
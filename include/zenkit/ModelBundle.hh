@@ -0,0 +1,76 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Library.hh"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace zenkit {
+	class Vfs;
+	class ModelScript;
+	class ModelHierarchy;
+	class ModelMesh;
+	class ModelAnimation;
+	class Texture;
+
+	/// \brief All assets required to display and animate a single model.
+	///
+	/// Assets are shared between all bundles returned from the same call to ModelBundleLoader::load, i.e. if two
+	/// models reference the same texture, both bundles point to the same zenkit::Texture instance.
+	struct ModelBundle {
+		/// \brief The name the bundle was requested with.
+		std::string name;
+
+		/// \brief The model script of the model or `nullptr` if the model was loaded from an `MDL` file.
+		std::shared_ptr<ModelScript const> script;
+
+		/// \brief The hierarchy of the model.
+		std::shared_ptr<ModelHierarchy const> hierarchy;
+
+		/// \brief All meshes of the model by the file name they were loaded from.
+		std::unordered_map<std::string, std::shared_ptr<ModelMesh const>> meshes;
+
+		/// \brief All animations of the model by animation name.
+		std::unordered_map<std::string, std::shared_ptr<ModelAnimation const>> animations;
+
+		/// \brief All textures used by the meshes of the model by the texture name referenced in their materials.
+		std::unordered_map<std::string, std::shared_ptr<Texture const>> textures;
+
+		/// \brief The names of all referenced files which could not be found or failed to load.
+		std::vector<std::string> missing;
+	};
+
+	/// \brief Loads models and all their dependencies from a zenkit::Vfs concurrently.
+	///
+	/// <p>Given the name of a model script (`MDS` or `MSB`) or model (`MDL`), the loader collects the hierarchy,
+	/// meshes and animations referenced by it, followed by all textures referenced by the meshes. Each of these
+	/// stages is loaded on a pool of worker threads. Every file is only loaded once per call, even if it is referenced
+	/// by more than one model.</p>
+	///
+	/// <p>The zenkit::Vfs must not be modified while a load is in progress.</p>
+	class ModelBundleLoader {
+	public:
+		/// \brief Creates a new loader.
+		/// \param vfs The file system to load assets from.
+		/// \param threads The number of threads to use or `0` to use the number of hardware threads.
+		ZKAPI explicit ModelBundleLoader(Vfs const& vfs, unsigned threads = 0);
+
+		/// \brief Loads a single model and its dependencies.
+		/// \param name The file name of the model script or model to load.
+		/// \return The loaded bundle.
+		[[nodiscard]] ZKAPI ModelBundle load(std::string_view name) const;
+
+		/// \brief Loads a set of models and their dependencies, sharing assets common to them.
+		/// \param names The file names of the model scripts or models to load.
+		/// \return The loaded bundles in the same order as \p names.
+		[[nodiscard]] ZKAPI std::vector<ModelBundle> load(std::vector<std::string> const& names) const;
+
+	private:
+		Vfs const* _m_vfs;
+		unsigned _m_threads;
+	};
+} // namespace zenkit
@@ -3,8 +3,12 @@
 #pragma once
 #include "zenkit/Library.hh"
 
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace phoenix {
@@ -13,6 +17,8 @@ namespace phoenix {
 
 namespace zenkit {
 	class Read;
+	class Write;
+	class ModelScriptCache;
 
 	enum class MdsEventType : uint8_t {
 		UNKNOWN = 0,
@@ -285,6 +291,19 @@ namespace zenkit {
 
 		ZKAPI void load(Read* r);
 
+		/// \brief Loads a model script, re-using a compiled binary form of source scripts if possible.
+		///
+		/// Binary scripts are loaded directly. For source scripts the content hash of the remaining input is looked
+		/// up in \p cache first; on a miss the source is parsed and its compiled form is stored in the cache.
+		///
+		/// \param r The reader to read from.
+		/// \param cache The cache to use or `nullptr` to always parse the script.
+		ZKAPI void load(Read* r, ModelScriptCache* cache);
+
+		/// \brief Writes the model script in its binary (MSB) form.
+		/// \param w The writer to write to.
+		ZKAPI void save(Write* w) const;
+
 	private:
 		ZKINT void load_binary(Read* r);
 		ZKINT void load_source(Read* r);
@@ -305,4 +324,51 @@ namespace zenkit {
 		std::vector<MdsModelTag> model_tags {};
 		std::vector<MdsAnimation> animations {};
 	};
+
+	/// \brief A cache of compiled model scripts keyed by the content hash of their source.
+	///
+	/// Model script sources are comparatively slow to parse. The cache remembers the compiled (MSB) form of every
+	/// source script passed to ModelScript::load(Read*, ModelScriptCache*) so that loading the same source again only
+	/// costs a binary parse. If a directory is given, compiled scripts are additionally stored on disk as
+	/// `<hash>.v<version>.msb` and are thus retained across runs. Entries written by other versions of the cache and
+	/// damaged entries are ignored and replaced. The cache may be shared between threads and processes.
+	class ModelScriptCache {
+	public:
+		ModelScriptCache() = default;
+
+		/// \brief Creates a cache which persists compiled scripts to the given directory.
+		/// \param directory The directory to store compiled scripts in. It is created if it does not exist.
+		ZKAPI explicit ModelScriptCache(std::filesystem::path directory);
+
+		/// \brief Retrieves the compiled script for the given source hash.
+		/// \param hash The hash of the source script.
+		/// \param out Receives the compiled script if found.
+		/// \return `true` if a compiled script was found, `false` if not.
+		[[nodiscard]] ZKAPI bool get(std::uint64_t hash, std::vector<std::byte>& out);
+
+		/// \brief Stores the compiled script for the given source hash.
+		/// \param hash The hash of the source script.
+		/// \param data The compiled script.
+		ZKAPI void put(std::uint64_t hash, std::vector<std::byte> data);
+
+		/// \brief Removes the compiled script for the given source hash from memory and disk.
+		/// \param hash The hash of the source script.
+		ZKAPI void evict(std::uint64_t hash);
+
+		/// \brief Removes all entries from the in-memory cache.
+		ZKAPI void clear();
+
+		[[nodiscard]] ZKAPI std::size_t hits() const;
+		[[nodiscard]] ZKAPI std::size_t misses() const;
+
+		/// \brief Computes the hash used to identify a source script.
+		[[nodiscard]] ZKAPI static std::uint64_t hash(std::byte const* data, std::size_t size) noexcept;
+
+	private:
+		mutable std::mutex _m_lock;
+		std::filesystem::path _m_directory;
+		std::unordered_map<std::uint64_t, std::vector<std::byte>> _m_entries;
+		std::size_t _m_hits {0};
+		std::size_t _m_misses {0};
+	};
 } // namespace zenkit
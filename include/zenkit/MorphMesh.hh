@@ -7,6 +7,7 @@
 
 #include <glm/vec3.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -40,6 +41,9 @@ namespace zenkit {
 		std::vector<std::uint32_t> vertices;
 
 		/// \brief The set of samples of the animation.
+		///
+		/// The samples are stored frame by frame, each frame containing one position offset for each entry in
+		/// #vertices. The offset of vertex `vertices[i]` in frame `f` is thus found at `samples[f * vertices.size() + i]`.
 		std::vector<glm::vec3> samples;
 	};
 
@@ -92,4 +96,81 @@ namespace zenkit {
 		/// \brief A list of source files this morph mesh was compiled from.
 		std::vector<MorphSource> sources {};
 	};
+
+	/// \brief The playback state of a single morph animation passed to MorphBlender::blend.
+	struct MorphBlend {
+		/// \brief The index of the animation in MorphMesh::animations.
+		std::size_t animation;
+
+		/// \brief The frame to sample. Fractional frames are linearly interpolated.
+		///
+		/// Values outside of `[0, frame_count - 1]` are clamped to the first or last frame respectively.
+		float frame;
+
+		/// \brief The weight to apply to the animation's offsets.
+		float weight;
+	};
+
+	/// \brief Evaluates blended morph animations of a MorphMesh.
+	///
+	/// <p>On construction, the sparse offsets of every animation are converted into streams sorted by vertex index.
+	/// Vertices with consecutive indices are merged into runs so that the offsets of a frame can be added to the
+	/// output buffer using contiguous, vectorized multiply-add operations instead of a scatter per vertex.</p>
+	///
+	/// <p>The blender only keeps a copy of the data it needs, the source mesh may be destroyed after construction.
+	/// Calls to #blend do not allocate memory and may run concurrently on the same blender.</p>
+	class MorphBlender {
+	public:
+		/// \brief Prepares the animations of the given morph mesh for blending.
+		/// \param mesh The morph mesh to prepare.
+		ZKAPI explicit MorphBlender(MorphMesh const& mesh);
+
+		/// \brief Computes the vertex positions of the mesh with the given animations applied.
+		///
+		/// The output is initialized to MorphMesh::morph_positions and the offsets of all given animations, scaled by
+		/// their weight, are added to it. Blends with an invalid animation index or a weight of zero are ignored.
+		///
+		/// \param blends The animations to apply.
+		/// \param count The number of elements in \p blends.
+		/// \param out A buffer of at least #vertex_count() elements to write the resulting positions into.
+		ZKAPI void blend(MorphBlend const* blends, std::size_t count, glm::vec3* out) const noexcept;
+
+		/// \brief Computes the vertex positions of the mesh with the given animations applied.
+		/// \param blends The animations to apply.
+		/// \return The resulting vertex positions.
+		/// \see #blend(MorphBlend const*, std::size_t, glm::vec3*)
+		[[nodiscard]] ZKAPI std::vector<glm::vec3> blend(std::vector<MorphBlend> const& blends) const;
+
+		/// \return The number of vertices written by #blend.
+		[[nodiscard]] ZKAPI std::size_t vertex_count() const noexcept {
+			return _m_base.size() / 3;
+		}
+
+	private:
+		/// \brief A range of consecutive vertices affected by an animation.
+		struct Run {
+			/// \brief The offset of the first float of the run in the output buffer.
+			std::uint32_t target;
+
+			/// \brief The offset of the first float of the run in each frame of the stream.
+			std::uint32_t source;
+
+			/// \brief The number of floats in the run.
+			std::uint32_t length;
+		};
+
+		/// \brief The sorted offsets of a single animation.
+		struct Stream {
+			std::uint32_t frame_count;
+
+			/// \brief The number of floats per frame in #offsets.
+			std::uint32_t stride;
+
+			std::vector<Run> runs;
+			std::vector<float> offsets;
+		};
+
+		std::vector<float> _m_base;
+		std::vector<Stream> _m_streams;
+	};
 } // namespace zenkit
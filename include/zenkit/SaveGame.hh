@@ -2,14 +2,20 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include "Object.hh"
+#include "zenkit/Archive.hh"
 #include "zenkit/Library.hh"
 #include "zenkit/Stream.hh"
 #include "zenkit/Texture.hh"
 
+#include <atomic>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace phoenix {
@@ -130,16 +136,155 @@ namespace zenkit {
 		ZKINT void save(WriteArchive& w, GameVersion version) const;
 	};
 
+	enum class SaveGameLoadMode : std::uint8_t {
+		/// \brief All files of the save game are loaded before SaveGame::load returns.
+		EAGER = 0,
+
+		/// \brief Only SAVEINFO.SAV is loaded before SaveGame::load returns. SAVEDAT.SAV is parsed on a background
+		///        thread and the thumbnail is decoded on first access.
+		///
+		/// SaveGame::state and SaveGame::thumbnail may only be accessed after calling SaveGame::resolve_state and
+		/// SaveGame::resolve_thumbnail respectively.
+		DEFERRED = 1,
+	};
+
+	struct SaveGameWriteOptions {
+		/// \brief The archive format to write SAVEDAT.SAV in.
+		///
+		/// The original game writes SAVEDAT.SAV as a ArchiveFormat::BINSAFE archive which is considerably smaller and
+		/// faster to write than the ASCII default.
+		ArchiveFormat state_format {ArchiveFormat::ASCII};
+
+		/// \brief Whether files carried over from the previous save may be hard-linked if they can't be cloned.
+		///
+		/// Files written by ZenKit are always replaced atomically, so hard links are never modified through the new
+		/// save. They are, however, shared with the old save which might be modified in-place by other tools.
+		bool allow_hardlinks {false};
+	};
+
+	/// \brief The result of writing a save game in the background.
+	enum class SaveGameWriteStatus : std::uint8_t {
+		/// \brief All files have been written.
+		COMPLETED = 0,
+
+		/// \brief The write was cancelled before the new files were renamed into place.
+		CANCELLED = 1,
+
+		/// \brief Writing a file failed. The new files have not been renamed into place.
+		FAILED = 2,
+	};
+
+	/// \brief A function called from the background thread once a save game has been written.
+	/// \param status The result of the write.
+	/// \param error A description of the error if \p status is SaveGameWriteStatus::FAILED.
+	using SaveGameWriteCallback = std::function<void(SaveGameWriteStatus status, std::string const& error)>;
+
+	struct SaveGameWriteJob;
+
+	/// \brief A handle to a save game being written in the background.
+	///
+	/// The background thread is owned by the handles to the write and by the SaveGame which started it. Destroying
+	/// the last of them waits for the write to finish, so a write started before `main` returns is never cut short.
+	class SaveGameWriteTask {
+	public:
+		/// \brief Requests the write to be cancelled.
+		///
+		/// Cancellation is checked between files, so the write might still complete.
+		ZKAPI void cancel();
+
+		/// \return Whether the write has finished, including the completion callback.
+		[[nodiscard]] ZKAPI bool done() const;
+
+		/// \brief Waits for the write to finish.
+		/// \return The result of the write.
+		ZKAPI SaveGameWriteStatus wait() const;
+
+	private:
+		friend class SaveGame;
+
+		explicit SaveGameWriteTask(std::shared_ptr<SaveGameWriteJob> job);
+
+		std::shared_ptr<SaveGameWriteJob> _m_job;
+	};
+
 	class SaveGame {
 	public:
 		ZKAPI explicit SaveGame(GameVersion version);
 
 		ZKAPI void load(std::filesystem::path const& path);
+		ZKAPI void load(std::filesystem::path const& path, SaveGameLoadMode mode);
 		ZKAPI void save(std::filesystem::path const& path, World& world, std::string const& world_name);
 
+		/// \brief Writes the save game to the given directory.
+		///
+		/// <p>Every file is first written to a temporary file next to its final location. Existing files in \p path
+		/// are only replaced once all new files have been written, so a save which fails before that leaves the
+		/// directory untouched. The files are then renamed into place one at a time, which means that a crash while
+		/// renaming may still leave a mix of old and new files behind, but never a partially written file.</p>
+		///
+		/// <p>When saving to a different directory than the save game was loaded from, files which are not re-written,
+		/// like the other worlds visited, are carried over as copy-on-write clones where the file system supports them
+		/// and copied otherwise. Any other files previously stored in \p path are removed.</p>
+		///
+		/// \param path The directory to write the save game to.
+		/// \param world The current world.
+		/// \param world_name The name of the current world without extension.
+		/// \param options Options for writing the save game.
+		ZKAPI void save(std::filesystem::path const& path,
+		                World& world,
+		                std::string const& world_name,
+		                SaveGameWriteOptions const& options);
+
+		/// \brief Writes the save game to the given directory on a background thread.
+		///
+		/// <p>A snapshot of the save game and the world is taken on the calling thread. The world has no cheap copy, so
+		/// it is encoded into memory right away and this function blocks for about as long as encoding the world takes
+		/// in #save. All other data is copied. Once this function returns, the save game and the world may be modified
+		/// freely. Only encoding the script state and writing the files to disk happens in the background.</p>
+		///
+		/// <p>The files are staged in the same way as in #save. A write which fails or is cancelled leaves \p path
+		/// untouched. Only one write to the same directory may be in progress at a time.</p>
+		///
+		/// <p>Once the write has completed successfully, this save game refers to \p path. Calls to #save_async,
+		/// #save, #load_world and #load_world_async wait for a pending write first, so they must not be made from
+		/// \p callback. Destroying this save game and all handles to the write also waits for it to finish, so
+		/// \p callback must not own a handle to the write or this save game.</p>
+		///
+		/// \param path The directory to write the save game to.
+		/// \param world The current world.
+		/// \param world_name The name of the current world without extension.
+		/// \param options Options for writing the save game.
+		/// \param callback A function to call from the background thread once the write has finished.
+		/// \return A handle to the background write.
+		ZKAPI SaveGameWriteTask save_async(std::filesystem::path const& path,
+		                                   World const& world,
+		                                   std::string const& world_name,
+		                                   SaveGameWriteOptions const& options = {},
+		                                   SaveGameWriteCallback callback = {});
+
 		[[nodiscard]] ZKAPI std::shared_ptr<World> load_world() const;
 		[[nodiscard]] ZKAPI std::shared_ptr<World> load_world(std::string_view name) const;
 
+		/// \brief Loads the world with the given name on a background thread.
+		///
+		/// This can be called right after loading the save game with SaveGameLoadMode::DEFERRED so that the world
+		/// and SAVEDAT.SAV are parsed concurrently.
+		///
+		/// \param name The name of the world to load.
+		/// \return A future which resolves to the world or `nullptr` if it does not exist in the save.
+		[[nodiscard]] ZKAPI std::future<std::shared_ptr<World>> load_world_async(std::string_view name) const;
+		[[nodiscard]] ZKAPI std::future<std::shared_ptr<World>> load_world_async() const;
+
+		/// \brief Waits for SAVEDAT.SAV to be parsed if it was loaded using SaveGameLoadMode::DEFERRED.
+		/// \return A reference to #state.
+		/// \throws ParserError if parsing SAVEDAT.SAV failed.
+		ZKAPI SaveState& resolve_state();
+
+		/// \brief Decodes THUMB.SAV if it was loaded using SaveGameLoadMode::DEFERRED and was not decoded yet.
+		/// \return A reference to #thumbnail.
+		/// \throws ParserError if parsing THUMB.SAV failed.
+		ZKAPI std::optional<Texture>& resolve_thumbnail();
+
 		SaveMetadata metadata {};
 		SaveState state {};
 		std::optional<Texture> thumbnail {};
@@ -147,5 +292,69 @@ namespace zenkit {
 	private:
 		GameVersion _m_version;
 		std::filesystem::path _m_path;
+
+		/// \return The directory of the save game, waiting for a pending #save_async to finish first.
+		[[nodiscard]] ZKINT std::filesystem::path const& resolve_path() const;
+
+		std::shared_future<std::shared_ptr<SaveState>> _m_state_pending {};
+		std::optional<std::filesystem::path> _m_thumbnail_pending {};
+
+		std::shared_ptr<SaveGameWriteJob> _m_write_pending {};
+		std::filesystem::path _m_write_path {};
+	};
+
+	/// \brief Summary information about a single save game for displaying it in a save or load menu.
+	struct SaveSlot {
+		/// \brief The path of the save game directory.
+		std::filesystem::path path;
+
+		/// \brief The metadata of the save game.
+		SaveMetadata metadata;
+
+		/// \brief The thumbnail of the save game as RGBA8 pixels or empty, if not requested or not available.
+		std::vector<std::uint8_t> thumbnail {};
+		std::uint32_t thumbnail_width {0};
+		std::uint32_t thumbnail_height {0};
+	};
+
+	/// \brief Enumerates the save games in a directory by only loading their metadata and, optionally, thumbnail.
+	///
+	/// Save games are loaded in parallel. Results are cached by the modification time and size of their files, so
+	/// repeated scans only load save games which have changed since. An index may be shared between threads.
+	class SaveSlotIndex {
+	public:
+		/// \brief Creates a new index.
+		/// \param version The game version of the save games.
+		/// \param threads The number of threads to use or `0` to use the number of hardware threads.
+		ZKAPI explicit SaveSlotIndex(GameVersion version, unsigned threads = 0);
+
+		/// \brief Enumerates all save games in the direct sub-directories of the given directory.
+		///
+		/// Sub-directories which do not contain a `SAVEINFO.SAV` file or which fail to load are skipped.
+		///
+		/// \param root The directory containing the save games.
+		/// \param thumbnail_size The maximum width and height of the thumbnails to decode or `0` to skip thumbnails.
+		/// \return The save games sorted by directory name.
+		[[nodiscard]] ZKAPI std::vector<SaveSlot> scan(std::filesystem::path const& root,
+		                                               std::uint32_t thumbnail_size = 0);
+
+		/// \brief Removes all cached entries.
+		ZKAPI void clear();
+
+	private:
+		struct Entry {
+			std::filesystem::file_time_type info_time {};
+			std::uintmax_t info_size {0};
+			std::filesystem::file_time_type thumb_time {};
+			std::uintmax_t thumb_size {0};
+			std::uint32_t thumbnail_size {0};
+			SaveSlot slot {};
+		};
+
+		GameVersion _m_version;
+		unsigned _m_threads;
+
+		std::mutex _m_lock;
+		std::unordered_map<std::string, Entry> _m_entries;
 	};
 } // namespace zenkit
@@ -0,0 +1,60 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Archive.hh"
+#include "zenkit/Library.hh"
+#include "zenkit/Misc.hh"
+
+#include <optional>
+
+namespace zenkit {
+	class Read;
+
+	/// \brief The types of files recognized by zenkit::sniff.
+	enum class FileFormat {
+		UNKNOWN,               ///< The file is not recognized.
+		ARCHIVE,               ///< A ZenGin archive not otherwise recognized, e.g. a stand-alone VOb or material.
+		WORLD,                 ///< A world archive (`ZEN`), loaded using zenkit::World.
+		CUTSCENE_LIBRARY,      ///< A cutscene library archive (`CSL` or `BIN`), loaded using zenkit::CutsceneLibrary.
+		MESH,                  ///< A mesh (`MSH`), loaded using zenkit::Mesh.
+		MULTI_RESOLUTION_MESH, ///< A multi-resolution mesh (`MRM`), loaded using zenkit::MultiResolutionMesh.
+		MORPH_MESH,            ///< A morph mesh (`MMB`), loaded using zenkit::MorphMesh.
+		MODEL,                 ///< A model (`MDL`), loaded using zenkit::Model.
+		MODEL_MESH,            ///< A model mesh (`MDM`), loaded using zenkit::ModelMesh.
+		MODEL_HIERARCHY,       ///< A model hierarchy (`MDH`), loaded using zenkit::ModelHierarchy.
+		MODEL_ANIMATION,       ///< A model animation (`MAN`), loaded using zenkit::ModelAnimation.
+		MODEL_SCRIPT,          ///< A compiled model script (`MSB`), loaded using zenkit::ModelScript.
+		TEXTURE,               ///< A texture (`TEX`), loaded using zenkit::Texture.
+		FONT,                  ///< A font (`FNT`), loaded using zenkit::Font.
+		SCRIPT,                ///< A compiled Daedalus script (`DAT`), loaded using zenkit::DaedalusScript.
+	};
+
+	/// \brief The result of zenkit::sniff.
+	struct FileInfo {
+		/// \brief The type of the file.
+		FileFormat format {FileFormat::UNKNOWN};
+
+		/// \brief The game version the file was made for or `std::nullopt` if the file does not encode it.
+		std::optional<GameVersion> version {};
+
+		/// \brief The encoding of the archive. Only valid for archive-based formats.
+		ArchiveFormat archive_format {ArchiveFormat::BINARY};
+
+		/// \brief Whether the archive was created from a save-game. Only valid for archive-based formats.
+		bool save {false};
+	};
+
+	/// \brief Determines the type and game version of a file without loading it.
+	///
+	/// <p>Only the first few bytes of most files are inspected. World archives are an exception since their version
+	/// is stored in the `MeshAndBsp` section which may follow other sections. In binary archives, these sections are
+	/// skipped using their stored sizes. In ASCII and BIN_SAFE archives, the section is located by a byte scan which
+	/// does not decode any of the preceding data.</p>
+	///
+	/// <p>Many formats are identical across game versions. For those, and for save-game worlds, which do not contain
+	/// the world mesh, FileInfo::version is `std::nullopt`.</p>
+	///
+	/// \param r The stream to inspect. Its position is restored before returning.
+	/// \return Information about the file.
+	[[nodiscard]] ZKAPI FileInfo sniff(Read* r);
+} // namespace zenkit
@@ -0,0 +1,119 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Library.hh"
+#include "zenkit/Object.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zenkit {
+	/// \brief The parts of ZenKit statistics are collected for.
+	enum class StatsSubsystem : std::uint8_t {
+		ARCHIVE = 0,
+		VFS = 1,
+		WORLD = 2,
+		MESH = 3,
+		MODEL = 4,
+		TEXTURE = 5,
+		SCRIPT = 6,
+		SAVE_GAME = 7,
+	};
+
+	/// \brief The implementations of zenkit::Read statistics are collected for.
+	enum class StatsReadBackend : std::uint8_t {
+		FILE = 0,
+		STREAM = 1,
+		MEMORY = 2,
+		VECTOR = 3,
+		MMAP = 4,
+		BUFFER = 5,
+	};
+
+	struct StatsSubsystemReport {
+		StatsSubsystem subsystem;
+
+		/// \brief The number of allocations reported through Stats::record_allocation while the subsystem was active.
+		std::uint64_t allocations;
+
+		/// \brief The total size of all allocations reported while the subsystem was active in bytes.
+		std::uint64_t allocated_bytes;
+	};
+
+	struct StatsSectionReport {
+		/// \brief The name of the section, usually the function it measures, e.g. `World.load`.
+		std::string name;
+		StatsSubsystem subsystem;
+
+		/// \brief The number of times the section was run.
+		std::uint64_t count;
+
+		/// \brief The total time spent in the section in nanoseconds, including nested sections.
+		std::uint64_t total_ns;
+
+		/// \brief The longest single run of the section in nanoseconds.
+		std::uint64_t max_ns;
+	};
+
+	struct StatsReadReport {
+		StatsReadBackend backend;
+
+		/// \brief The number of calls to zenkit::Read::read.
+		std::uint64_t reads;
+
+		/// \brief The number of bytes read.
+		std::uint64_t bytes;
+	};
+
+	struct StatsObjectReport {
+		ObjectType type;
+
+		/// \brief The number of objects of this type created while reading archives.
+		std::uint64_t count;
+	};
+
+	/// \brief A snapshot of all statistics collected since the last call to Stats::reset.
+	///
+	/// Entries which have never been recorded are omitted.
+	struct StatsReport {
+		std::vector<StatsSubsystemReport> subsystems;
+		std::vector<StatsSectionReport> sections;
+		std::vector<StatsReadReport> reads;
+		std::vector<StatsObjectReport> objects;
+	};
+
+	/// \brief Opt-in instrumentation of ZenKit's parsers.
+	///
+	/// <p>Statistics are only collected if ZenKit was built with `ZK_ENABLE_STATS`. Otherwise all instrumentation is
+	/// compiled out and Stats::report always returns an empty report.</p>
+	///
+	/// <p>ZenKit can not observe memory allocations by itself. To attribute allocations to subsystems, applications
+	/// may call Stats::record_allocation from a replacement of the global `operator new`. Allocations are attributed
+	/// to the innermost subsystem active on the allocating thread and ignored if there is none.</p>
+	class Stats {
+	public:
+		/// \return Whether ZenKit was built with statistics enabled.
+		[[nodiscard]] ZKAPI static bool enabled() noexcept;
+
+		/// \return A snapshot of all statistics collected so far.
+		[[nodiscard]] ZKAPI static StatsReport report();
+
+		/// \brief Resets all statistics to zero.
+		ZKAPI static void reset();
+
+		/// \brief Records an allocation for the subsystem active on the calling thread.
+		///
+		/// This function does not allocate memory itself and can safely be called from `operator new`.
+		///
+		/// \param size The size of the allocation in bytes.
+		ZKAPI static void record_allocation(std::size_t size) noexcept;
+
+		/// \return The name of the given subsystem.
+		[[nodiscard]] ZKAPI static char const* name(StatsSubsystem subsystem) noexcept;
+
+		/// \return The name of the given read backend.
+		[[nodiscard]] ZKAPI static char const* name(StatsReadBackend backend) noexcept;
+	};
+} // namespace zenkit
@@ -226,10 +226,10 @@ namespace zenkit {
 
 			cb(w);
 
-			auto len = static_cast<ssize_t>(w->tell()) - size_off;
+			auto end_off = static_cast<ssize_t>(w->tell());
 			w->seek(size_off, Whence::BEG);
-			w->write_uint(static_cast<uint32_t>(len) - sizeof(uint32_t));
-			w->seek(len, Whence::CUR);
+			w->write_uint(static_cast<uint32_t>(end_off - size_off) - sizeof(uint32_t));
+			w->seek(end_off, Whence::BEG);
 		}
 	} // namespace proto
 } // namespace zenkit
@@ -0,0 +1,76 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Library.hh"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zenkit {
+	class Mesh;
+	class MultiResolutionMesh;
+
+	/// \brief Settings for TangentFrames::build.
+	struct TangentFrameSettings {
+		/// \brief The largest angle in radians between two faces across which their normals are smoothed. Faces
+		///        meeting at a larger angle form a hard edge.
+		float crease_angle {1.04719755f};
+
+		/// \brief Whether to generate tangents in addition to normals.
+		bool tangents {true};
+
+		/// \brief The number of threads to use or `0` to use the number of hardware threads.
+		unsigned threads {0};
+	};
+
+	/// \brief Generated normals and tangents for every corner of a triangle list.
+	///
+	/// <p>Normals are the average of the normals of all faces sharing a position, weighted by the angle of each face
+	/// at that position. Only faces meeting the face of the corner at no more than TangentFrameSettings::crease_angle
+	/// are averaged, so hard edges are kept.</p>
+	///
+	/// <p>Tangents follow MikkTSpace with its default settings, so normal maps baked by tools using it render
+	/// without seams. Corners with the same position, normal and texture coordinates are grouped if their faces have
+	/// the same texture orientation and are connected by edges, and the texture-space directions of the faces in each
+	/// group are projected onto the normal's plane and averaged, weighted by the angle of each face at the corner. The
+	/// `w` component holds the sign of the bitangent, which is `w * cross(normal, tangent)`. Unlike MikkTSpace, which
+	/// emits +X, corners of faces without a usable texture mapping get an arbitrary tangent perpendicular to their
+	/// normal.</p>
+	///
+	/// <p>The output only depends on the input and never on the number of threads or whether SIMD instructions are
+	/// available, so it can be cached.</p>
+	class TangentFrames {
+	public:
+		/// \brief Generates frames for the triangles in Mesh::polygons or, if it is empty, for all polygons in
+		///        Mesh::geometry, triangulated as fans.
+		ZKAPI void build(Mesh const& mesh, TangentFrameSettings const& settings = {});
+
+		/// \brief Generates frames for the triangles of all sub-meshes, in order.
+		ZKAPI void build(MultiResolutionMesh const& mesh, TangentFrameSettings const& settings = {});
+
+		/// \brief Generates frames for an arbitrary triangle list.
+		/// \param positions The positions of the vertices.
+		/// \param position_count The number of positions.
+		/// \param indices The index into \p positions of each corner. Three consecutive corners form a triangle.
+		/// \param texcoords The texture coordinates of each corner. Only required if tangents are generated.
+		/// \param corner_count The number of corners, a multiple of three.
+		/// \param settings The settings to use.
+		ZKAPI void build(glm::vec3 const* positions,
+		                 std::size_t position_count,
+		                 std::uint32_t const* indices,
+		                 glm::vec2 const* texcoords,
+		                 std::size_t corner_count,
+		                 TangentFrameSettings const& settings = {});
+
+		/// \brief The unit normal of each corner.
+		std::vector<glm::vec3> normals;
+
+		/// \brief The unit tangent and bitangent sign of each corner. Empty if no tangents were generated.
+		std::vector<glm::vec4> tangents;
+	};
+} // namespace zenkit
@@ -0,0 +1,61 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Library.hh"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zenkit {
+	class Write;
+
+	/// \brief A single timed section recorded by zenkit::Trace.
+	struct TraceEvent {
+		/// \brief The name of the section, e.g. `World.load`.
+		char const* name;
+
+		/// \brief The category of the section, e.g. `world` or `vfs`.
+		char const* category;
+
+		/// \brief Additional information about this particular event, like the class name of an archive object.
+		std::string detail;
+
+		/// \brief The time the section was entered at in nanoseconds since Trace::start was called.
+		std::uint64_t start_ns;
+
+		/// \brief The time spent in the section in nanoseconds.
+		std::uint64_t duration_ns;
+
+		/// \brief A small number uniquely identifying the thread the section was run on. Ids are never reused, even
+		///        by threads started after another one has exited.
+		std::uint32_t thread;
+	};
+
+	/// \brief Records a timeline of the work done by ZenKit.
+	///
+	/// <p>While tracing is active, the major entry points and phases of ZenKit's loaders record TraceEvent entries
+	/// into buffers local to each thread. While tracing is inactive, each of these sections only costs a predictable
+	/// branch on entry and exit. The buffers of exited threads are reused by new threads.</p>
+	///
+	/// <p>The recorded events can be retrieved using Trace::events or written to a file in the Chrome trace event
+	/// format using Trace::write_chrome_json. These files can be viewed using `chrome://tracing` or the Perfetto UI.</p>
+	class Trace {
+	public:
+		/// \brief Starts recording events, discarding all previously recorded events.
+		ZKAPI static void start();
+
+		/// \brief Stops recording events. Recorded events are kept until the next call to Trace::start.
+		ZKAPI static void stop() noexcept;
+
+		/// \return Whether events are currently being recorded.
+		[[nodiscard]] ZKAPI static bool active() noexcept;
+
+		/// \return All events recorded since the last call to Trace::start, ordered by their start time.
+		[[nodiscard]] ZKAPI static std::vector<TraceEvent> events();
+
+		/// \brief Writes all events recorded since the last call to Trace::start as a Chrome trace event JSON file.
+		/// \param w The stream to write to.
+		ZKAPI static void write_chrome_json(Write* w);
+	};
+} // namespace zenkit
@@ -9,6 +9,8 @@
 #include "zenkit/world/VobTree.hh"
 #include "zenkit/world/WayNet.hh"
 
+#include <cstddef>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -66,6 +68,67 @@ namespace zenkit {
 		float timer;
 	};
 
+	/// \brief The heap memory held by all VObs of a single type.
+	struct WorldVobMemory {
+		/// \brief The number of VObs of this type.
+		std::size_t count {0};
+
+		/// \brief The number of bytes allocated for these VObs, including the VObs themselves.
+		std::size_t bytes {0};
+	};
+
+	/// \brief The heap memory held by a zenkit::World, broken down by component.
+	///
+	/// All values estimate the number of bytes requested from the allocator, i.e. they include unused vector capacity
+	/// but not the bookkeeping overhead of the allocator itself. Containers are counted by their capacity. The size of
+	/// the `std::shared_ptr` control blocks is measured at runtime for objects created using `std::make_shared`, but
+	/// may be off by a few bytes of padding per object. Objects shared between multiple owners are only counted once,
+	/// for the first owner visited.
+	struct WorldMemoryReport {
+		/// \brief Mesh::vertices.
+		std::size_t mesh_vertices {0};
+
+		/// \brief Mesh::features.
+		std::size_t mesh_features {0};
+
+		/// \brief Mesh::geometry, Mesh::polygons and the polygon index lists.
+		std::size_t mesh_polygons {0};
+
+		/// \brief Mesh::lightmaps including their textures.
+		std::size_t mesh_lightmaps {0};
+
+		/// \brief Mesh::materials.
+		std::size_t mesh_materials {0};
+
+		/// \brief World::world_bsp_tree.
+		std::size_t bsp_tree {0};
+
+		/// \brief World::world_vobs and all of their children.
+		std::size_t vobs {0};
+
+		/// \brief World::npcs and World::npc_spawns. Only populated for save-games.
+		std::size_t npcs {0};
+
+		/// \brief The way-net of the world.
+		std::size_t way_net {0};
+
+		/// \brief World::player and World::sky_controller. Only populated for save-games.
+		std::size_t other {0};
+
+		/// \brief The memory used by VObs by their type. Includes all VObs counted in #vobs and #npcs.
+		std::map<VirtualObjectType, WorldVobMemory> vob_types {};
+
+		/// \return The memory used by the world mesh.
+		[[nodiscard]] std::size_t mesh() const noexcept {
+			return mesh_vertices + mesh_features + mesh_polygons + mesh_lightmaps + mesh_materials;
+		}
+
+		/// \return The memory used by all components of the world.
+		[[nodiscard]] std::size_t total() const noexcept {
+			return mesh() + bsp_tree + vobs + npcs + way_net + other;
+		}
+	};
+
 	/// \brief Represents a ZenGin world.
 	class World : public Object {
 		ZK_OBJECT(ObjectType::oCWorld);
@@ -79,9 +142,61 @@ namespace zenkit {
 		ZKAPI void load(Read* r, GameVersion version);
 
 		ZKAPI void load(ReadArchive& r, GameVersion version) override;
+
+		/// \brief Streams the VObs of a world to a visitor without loading the rest of the world.
+		///
+		/// The mesh, BSP-tree and way-net of the world are skipped. See zenkit::visit_vob_tree for details.
+		///
+		/// \param r The reader to read the world from.
+		/// \param version The version of Gothic the world was made for.
+		/// \param visitor The visitor to pass VObs to.
+		/// \return All VObs kept by the visitor without a kept ancestor.
+		/// \throws ParserError if the world is malformed.
+		[[nodiscard]] ZKAPI static std::vector<std::shared_ptr<VirtualObject>>
+		visit_vobs(Read* r, GameVersion version, VobVisitor& visitor);
 		ZKAPI void save(WriteArchive& w, GameVersion version) const override;
 		[[nodiscard]] ZKAPI uint16_t get_version_identifier(GameVersion game) const override;
 
+		/// \brief Calculates the heap memory held by each component of the world.
+		/// \return A report of the memory used.
+		[[nodiscard]] ZKAPI WorldMemoryReport memory_report() const;
+
+		/// \brief Releases the vertices, features and polygons of the world mesh.
+		///
+		/// Materials, bounding boxes and lightmaps are kept. Call this after extracting the geometry into a
+		/// format suitable for rendering or collision detection. A trimmed world can no longer be saved.
+		ZKAPI void trim_geometry();
+
+		/// \brief Releases the lightmaps of the world mesh and removes all references to them from its polygons.
+		ZKAPI void trim_lightmaps();
+
+		/// \brief Releases the BSP-tree of the world. A trimmed world can no longer be saved.
+		ZKAPI void trim_bsp_tree();
+
+		/// \brief Releases unused capacity of all containers in the world, including those of all VObs.
+		ZKAPI void shrink_to_fit();
+
+		/// \brief Returns an index for finding VObs by id, name or type, building it if required.
+		///
+		/// The index is kept up to date by World::add_vob and World::remove_vob. If #world_vobs or the children of
+		/// any VOb are modified directly, World::invalidate_vob_index must be called afterwards.
+		///
+		/// \return The index of all VObs in #world_vobs and their children.
+		[[nodiscard]] ZKAPI VobIndex const& vob_index();
+
+		/// \brief Discards the VOb index so that it is rebuilt by the next call to World::vob_index.
+		ZKAPI void invalidate_vob_index() noexcept;
+
+		/// \brief Adds a VOb and all of its children to the world.
+		/// \param vob The VOb to add.
+		/// \param parent The VOb to add \p vob as a child of or `nullptr` to add it to #world_vobs.
+		ZKAPI void add_vob(std::shared_ptr<VirtualObject> vob, VirtualObject* parent = nullptr);
+
+		/// \brief Removes a VOb and all of its children from the world.
+		/// \param vob The VOb to remove.
+		/// \return The removed VOb or `nullptr` if it is not part of the world.
+		ZKAPI std::shared_ptr<VirtualObject> remove_vob(VirtualObject const* vob);
+
 		/// \brief The list of VObs defined in this world.
 		std::vector<std::shared_ptr<VirtualObject>> world_vobs;
 
@@ -110,5 +225,9 @@ namespace zenkit {
 
 		// \note Only available in save-games, otherwise null.
 		std::shared_ptr<SkyController> sky_controller;
+
+	private:
+		VobIndex _m_vob_index {};
+		bool _m_vob_index_valid {false};
 	};
 } // namespace zenkit
@@ -95,6 +95,13 @@ namespace zenkit {
 	struct VTrigger : VirtualObject {
 		ZK_OBJECT(ObjectType::zCTrigger);
 
+		/// \brief Default constructor. Defined out-of-line so that creating triggers does not trigger deprecation
+		///        warnings for the deprecated fields.
+		ZKAPI VTrigger();
+		VTrigger(VTrigger const&) = default;
+		VTrigger(VTrigger&&) = default;
+		ZKAPI ~VTrigger() override;
+
 		/// \brief The name of VObject to send `OnTrigger` and `OnUntrigger` events to after processing.
 		/// \see https://zk.gothickit.dev/engine/objects/zCTrigger/#triggerTarget
 		std::string target;
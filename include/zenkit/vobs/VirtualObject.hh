@@ -313,7 +313,9 @@ namespace zenkit {
 	struct VirtualObject : Object {
 		ZK_OBJECT(ObjectType::zCVob);
 
-		VirtualObject() = default;
+		/// \brief Default constructor. Defined out-of-line so that creating VObjects does not trigger deprecation
+		///        warnings for the deprecated fields.
+		ZKAPI VirtualObject();
 
 		/// \brief Implicit copy-constructor.
 		VirtualObject(VirtualObject const&) = default;
@@ -322,7 +324,7 @@ namespace zenkit {
 		VirtualObject(VirtualObject&&) = default;
 
 		/// \brief Default virtual destructor.
-		~VirtualObject() override = default;
+		ZKAPI ~VirtualObject() override;
 
 		/// \brief The type of this VObject.
 		///
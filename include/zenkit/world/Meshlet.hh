@@ -0,0 +1,96 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Library.hh"
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace zenkit {
+	class BspTree;
+	class Mesh;
+
+	/// \brief A small cluster of triangles of the world mesh sharing one material and BSP leaf.
+	struct Meshlet {
+		/// \brief The index of the first vertex of the meshlet in MeshletSet::vertex_indices.
+		std::uint32_t vertex_offset;
+
+		/// \brief The number of distinct vertices of the meshlet.
+		std::uint32_t vertex_count;
+
+		/// \brief The index of the first triangle of the meshlet. Its local vertex indices start at
+		///        `MeshletSet::triangles[triangle_offset * 3]`.
+		std::uint32_t triangle_offset;
+
+		/// \brief The number of triangles of the meshlet.
+		std::uint32_t triangle_count;
+
+		/// \brief The index of the material of all triangles in Mesh::materials.
+		std::uint32_t material;
+
+		/// \brief The index of the BSP leaf node the triangles were taken from.
+		std::uint32_t leaf;
+
+		/// \brief The center of the bounding sphere of the meshlet.
+		glm::vec3 center;
+
+		/// \brief The radius of the bounding sphere of the meshlet.
+		float radius;
+
+		/// \brief The apex of the normal cone of the meshlet.
+		glm::vec3 cone_apex;
+
+		/// \brief The axis of the normal cone of the meshlet.
+		glm::vec3 cone_axis;
+
+		/// \brief The sine of the half-angle of the normal cone or `1` if the normals are too spread out for the
+		///        meshlet to ever be culled using the cone.
+		float cone_cutoff;
+
+		/// \brief Tests whether all triangles of the meshlet face away from a viewer.
+		/// \param camera The position of the viewer.
+		/// \return `true` if the meshlet can be culled as back-facing.
+		[[nodiscard]] ZKAPI bool is_backfacing(glm::vec3 camera) const noexcept;
+	};
+
+	/// \brief The triangles of the world mesh partitioned into meshlets.
+	///
+	/// <p>The polygons of each BSP leaf are triangulated like Mesh::polygons, grouped by material and then split into
+	/// meshlets of a bounded number of vertices and triangles. A vertex is a distinct combination of a position and a
+	/// vertex feature. Meshlets of the same leaf are stored consecutively, so all meshlets of a leaf can be found
+	/// using #leaf_offsets.</p>
+	///
+	/// <p>Portals, ghost occluders and outdoor polygons are skipped since they are not rendered. Polygons shared
+	/// by multiple leaves are included once per leaf.</p>
+	class MeshletSet {
+	public:
+		/// \brief Replaces the contents of the set with the partitioned triangles of a world mesh.
+		/// \param mesh The world mesh. Its Mesh::geometry must be present.
+		/// \param tree The BSP tree of the world.
+		/// \param max_vertices The maximum number of vertices per meshlet, at most 256.
+		/// \param max_triangles The maximum number of triangles per meshlet.
+		ZKAPI void build(Mesh const& mesh,
+		                 BspTree const& tree,
+		                 std::uint32_t max_vertices = 64,
+		                 std::uint32_t max_triangles = 124);
+
+		/// \brief All meshlets, ordered by leaf.
+		std::vector<Meshlet> meshlets;
+
+		/// \brief The index into Mesh::vertices of each meshlet vertex.
+		std::vector<std::uint32_t> vertex_indices;
+
+		/// \brief The index into Mesh::features of each meshlet vertex.
+		std::vector<std::uint32_t> feature_indices;
+
+		/// \brief The vertices of each triangle, relative to Meshlet::vertex_offset. Three consecutive values form one
+		///        triangle.
+		std::vector<std::uint8_t> triangles;
+
+		/// \brief The meshlets of the BSP node `i` are found at `meshlets[leaf_offsets[i]]` up to
+		///        `meshlets[leaf_offsets[i + 1]]`. Contains one more element than BspTree::nodes.
+		std::vector<std::uint32_t> leaf_offsets;
+	};
+} // namespace zenkit
@@ -0,0 +1,87 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Library.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace zenkit {
+	class Read;
+	class Write;
+	class BspTree;
+	class Mesh;
+
+	/// \brief Precomputed sector-to-sector visibility of a world.
+	///
+	/// <p>Every BspSector forms one cell. All BSP nodes not belonging to any sector form an additional outdoor cell,
+	/// which is always the last one. Cells are connected by the portal polygons listed by the sectors. A portal
+	/// listed by only one sector connects it to the outdoor cell.</p>
+	///
+	/// <p>Visibility is computed conservatively by flooding through the portals from every cell. A portal is
+	/// only passed if part of it lies in front of the portal the flood left the source cell through and in front of
+	/// the portal it entered the current cell through, since no line of sight can turn back through a portal it has
+	/// already crossed. Each portal is passed at most once per portal of the source cell, so building takes
+	/// polynomial time in the number of portals. Cells are never reported as hidden if they might be visible, but not
+	/// all reported cells are necessarily visible. Portals lying in the plane of one of these two portals are
+	/// considered hidden.</p>
+	///
+	/// <p>Each row of the visibility matrix is stored as a bitset. Identical rows are stored only once, which is
+	/// common since neighbouring interiors tend to see the same cells.</p>
+	class PotentiallyVisibleSet {
+	public:
+		/// \brief Computes the visibility of all sectors of a world.
+		/// \param tree The BSP tree of the world.
+		/// \param mesh The world mesh. Its Mesh::geometry must contain the portal polygons.
+		ZKAPI void build(BspTree const& tree, Mesh const& mesh);
+
+		/// \brief Loads visibility data previously stored using #save.
+		/// \throws ParserError if the data is invalid.
+		ZKAPI void load(Read* r);
+
+		/// \brief Stores the visibility data so that it can be loaded without rebuilding it.
+		ZKAPI void save(Write* w) const;
+
+		/// \param from The cell to look from.
+		/// \param to The cell to look at.
+		/// \return Whether \p to might be visible from \p from. Cells not covered by the set are always reported as
+		///         visible, so that an empty set does not hide anything.
+		[[nodiscard]] bool is_visible(std::uint32_t from, std::uint32_t to) const noexcept {
+			if (from >= _m_cell_rows.size() || to >= _m_cell_count) return true;
+
+			auto* row = _m_rows.data() + static_cast<std::size_t>(_m_cell_rows[from]) * _m_row_size;
+			return (row[to / 32] >> (to % 32) & 1) != 0;
+		}
+
+		/// \param from The index of the BSP node to look from.
+		/// \param to The index of the BSP node to look at.
+		/// \return Whether the node \p to might be visible from the node \p from. Nodes not covered by the set are
+		///         always reported as visible.
+		[[nodiscard]] bool is_node_visible(std::uint32_t from, std::uint32_t to) const noexcept {
+			return this->is_visible(this->cell_of(from), this->cell_of(to));
+		}
+
+		/// \param node The index of a BSP node.
+		/// \return The cell containing the node or #cell_count if the node is not covered by the set.
+		[[nodiscard]] std::uint32_t cell_of(std::uint32_t node) const noexcept {
+			return node < _m_node_cells.size() ? _m_node_cells[node] : _m_cell_count;
+		}
+
+		/// \return The number of cells including the outdoor cell.
+		[[nodiscard]] std::uint32_t cell_count() const noexcept {
+			return _m_cell_count;
+		}
+
+		/// \return The number of distinct visibility bitsets stored.
+		[[nodiscard]] std::size_t unique_row_count() const noexcept {
+			return _m_row_size == 0 ? 0 : _m_rows.size() / _m_row_size;
+		}
+
+	private:
+		std::uint32_t _m_cell_count {0};
+		std::uint32_t _m_row_size {0};
+		std::vector<std::uint32_t> _m_node_cells;
+		std::vector<std::uint32_t> _m_cell_rows;
+		std::vector<std::uint32_t> _m_rows;
+	};
+} // namespace zenkit
@@ -5,7 +5,14 @@
 #include "zenkit/Misc.hh"
 #include "zenkit/vobs/VirtualObject.hh"
 
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace zenkit {
 	/// \brief Parses a VOB tree from the given reader.
@@ -14,4 +21,181 @@ namespace zenkit {
 	/// \return The tree parsed.
 	ZKAPI std::shared_ptr<VirtualObject> parse_vob_tree(ReadArchive& in, GameVersion version);
 	ZKAPI void save_vob_tree(WriteArchive& w, GameVersion version, std::shared_ptr<VirtualObject> const& obj);
+
+	/// \brief Hashed lookup tables for finding VObs by id, name or type.
+	///
+	/// <p>The index holds references to every VOb in the trees it was built from, including all children. Lookups by
+	/// name are case-insensitive. If multiple VObs share the same id, the one inserted last is found by id. Once it is
+	/// erased, the one inserted before it is found again. The order of the VObs returned by #find_by_name and
+	/// #find_by_type is unspecified.</p>
+	///
+	/// <p>Each VOb remembers its position in its buckets, so inserting and erasing a VOb takes constant time. The id,
+	/// name and type of a VOb are recorded when it is inserted, so changing them afterwards does not prevent it from
+	/// being erased, but it is only found using the old values until it is inserted again.</p>
+	///
+	/// <p>The index must be updated using #insert and #erase whenever VObs are added to or removed from the trees.
+	/// zenkit::World does this automatically for VObs added or removed through World::add_vob and
+	/// World::remove_vob.</p>
+	class VobIndex {
+	public:
+		using Bucket = std::vector<std::shared_ptr<VirtualObject>>;
+
+		/// \brief Replaces the contents of the index with the given VOb trees.
+		/// \param roots The root VObs of the trees, e.g. World::world_vobs.
+		ZKAPI void build(std::vector<std::shared_ptr<VirtualObject>> const& roots);
+
+		/// \brief Adds a VOb and all of its children to the index. VObs which are already in the index are skipped.
+		/// \param vob The VOb to add.
+		ZKAPI void insert(std::shared_ptr<VirtualObject> const& vob);
+
+		/// \brief Removes a VOb and all of its children from the index.
+		/// \param vob The VOb to remove.
+		ZKAPI void erase(VirtualObject const& vob);
+
+		/// \brief Removes all VObs from the index.
+		ZKAPI void clear() noexcept;
+
+		/// \param id The VirtualObject::id to search for.
+		/// \return The VOb with the given id or `nullptr` if there is none.
+		[[nodiscard]] ZKAPI std::shared_ptr<VirtualObject> find_by_id(std::uint32_t id) const;
+
+		/// \param name The VirtualObject::vob_name to search for, ignoring case.
+		/// \return All VObs with the given name.
+		[[nodiscard]] ZKAPI Bucket const& find_by_name(std::string_view name) const;
+
+		/// \param type The VirtualObject::type to search for.
+		/// \return All VObs of the given type.
+		[[nodiscard]] ZKAPI Bucket const& find_by_type(VirtualObjectType type) const;
+
+		/// \return The number of VObs in the index.
+		[[nodiscard]] std::size_t size() const noexcept {
+			return _m_entries.size();
+		}
+
+	private:
+		/// \brief The keys a VOb was inserted with and its position in the name and type buckets.
+		struct Entry {
+			std::uint32_t id;
+			VirtualObjectType type;
+			std::string name;
+			std::size_t type_slot;
+			std::size_t name_slot;
+		};
+
+		ZKINT void erase_one(VirtualObject const* vob);
+		ZKINT void erase_from_bucket(Bucket& bucket, std::size_t slot, bool by_name);
+
+		std::unordered_map<VirtualObject const*, Entry> _m_entries;
+
+		/// \brief All VObs with each id in the order they were inserted in.
+		std::unordered_map<std::uint32_t, Bucket> _m_ids;
+		std::unordered_map<std::string, Bucket> _m_names;
+		std::unordered_map<VirtualObjectType, Bucket> _m_types;
+	};
+
+	/// \brief Determines what happens to a VOb after it has been passed to VobVisitor::enter.
+	enum class VobVisitAction {
+		/// \brief Keep the VOb. It is attached to its closest kept ancestor or returned as a root.
+		KEEP,
+
+		/// \brief Release the VOb once its children have been visited.
+		DISCARD,
+
+		/// \brief Release the VOb and skip all of its children without decoding them.
+		SKIP,
+	};
+
+	/// \brief Receives the VObs of a VOb tree while it is being read.
+	/// \see visit_vob_tree
+	class VobVisitor {
+	public:
+		virtual ~VobVisitor() = default;
+
+		/// \brief Called for every VOb right after it has been decoded and before its children are read.
+		/// \param vob The VOb. Its VirtualObject::children are not populated yet.
+		/// \param depth The depth of the VOb in the tree. Roots have a depth of `0`.
+		/// \return What to do with the VOb and its children.
+		virtual VobVisitAction enter(std::shared_ptr<VirtualObject> const& vob, std::size_t depth) = 0;
+
+		/// \brief Called for every VOb which was not skipped after all of its children have been visited.
+		/// \param vob The VOb. Its VirtualObject::children contains all kept children.
+		/// \param depth The depth of the VOb in the tree. Roots have a depth of `0`.
+		virtual void leave(std::shared_ptr<VirtualObject> const& vob, std::size_t depth) {
+			(void) vob;
+			(void) depth;
+		}
+	};
+
+	/// \brief Reads the VOb trees of a `VobTree` section without materializing the VObs which are not needed.
+	///
+	/// <p>Every VOb is passed to the visitor as soon as it has been decoded. Unless the visitor chooses to keep a
+	/// VOb, it is released again once its children have been visited, so memory use is bounded by the depth of the
+	/// tree rather than its size. References to VObs which were discarded or skipped resolve to `nullptr`.</p>
+	///
+	/// \param in The archive to read from, positioned right at the start of the contents of a `VobTree` section.
+	/// \param version The version of Gothic being used.
+	/// \param visitor The visitor to pass VObs to.
+	/// \return All kept VObs without a kept ancestor.
+	ZKAPI std::vector<std::shared_ptr<VirtualObject>>
+	visit_vob_tree(ReadArchive& in, GameVersion version, VobVisitor& visitor);
+
+	/// \brief A flat, structure-of-arrays copy of the hot data of a VOb tree.
+	///
+	/// <p>VObs are stored in depth-first pre-order, so every subtree occupies a contiguous range of indices and
+	/// every parent comes before its children. All arrays have the same length and the data of the VOb at index
+	/// `i` is found at index `i` of every array. This allows whole-world passes like transform updates or visual
+	/// collection to scan memory linearly instead of chasing pointers through the tree.</p>
+	///
+	/// <p>The table does not own the VObs. It must be rebuilt whenever the tree it was built from changes.</p>
+	class VobTable {
+	public:
+		/// \brief The index used to indicate that there is no parent, child, sibling or visual name.
+		static constexpr std::uint32_t NONE = 0xFFFFFFFF;
+
+		/// \brief Replaces the contents of the table with the given VOb trees.
+		/// \param roots The root VObs of the trees, e.g. World::world_vobs.
+		ZKAPI void build(std::vector<std::shared_ptr<VirtualObject>> const& roots);
+
+		/// \brief Removes all VObs from the table.
+		ZKAPI void clear() noexcept;
+
+		/// \return The number of VObs in the table.
+		[[nodiscard]] std::size_t size() const noexcept {
+			return objects.size();
+		}
+
+		/// \brief The VirtualObject::id of each VOb.
+		std::vector<std::uint32_t> ids;
+
+		/// \brief The type of each VOb.
+		std::vector<VirtualObjectType> types;
+
+		/// \brief The index of the parent of each VOb or #NONE for root VObs.
+		std::vector<std::uint32_t> parents;
+
+		/// \brief The index of the first child of each VOb or #NONE if it has no children.
+		std::vector<std::uint32_t> first_children;
+
+		/// \brief The index of the next VOb with the same parent or #NONE for the last child. Root VObs are linked
+		///        with each other as well.
+		std::vector<std::uint32_t> next_siblings;
+
+		/// \brief The world transform of each VOb, built from VirtualObject::rotation and VirtualObject::position.
+		std::vector<glm::mat4> transforms;
+
+		/// \brief The world-space bounding box of each VOb.
+		std::vector<AxisAlignedBoundingBox> bboxes;
+
+		/// \brief The type of visual of each VOb or VisualType::UNKNOWN if it has no visual.
+		std::vector<VisualType> visual_types;
+
+		/// \brief The index of the name of the visual of each VOb into #visual_names or #NONE if it has no visual.
+		std::vector<std::uint32_t> visual_name_indices;
+
+		/// \brief All distinct visual names referenced by the table.
+		std::vector<std::string> visual_names;
+
+		/// \brief The VOb each entry was created from.
+		std::vector<VirtualObject*> objects;
+	};
 } // namespace zenkit
@@ -0,0 +1,99 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "zenkit/Boxes.hh"
+#include "zenkit/Library.hh"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zenkit {
+	struct VirtualObject;
+
+	/// \brief The kinds of volumes stored in a zenkit::VolumeIndex.
+	enum class VolumeKind : std::uint8_t {
+		NONE = 0,
+		MUSIC = 1,     ///< VZoneMusic and VZoneMusicDefault.
+		FOG = 2,       ///< VZoneFog and VZoneFogDefault.
+		FAR_PLANE = 4, ///< VZoneFarPlane and VZoneFarPlaneDefault.
+		SOUND = 8,     ///< VSound and VSoundDaytime.
+		TRIGGER = 16,  ///< VTrigger and all of its subclasses as well as VTriggerUntouch.
+		ALL = MUSIC | FOG | FAR_PLANE | SOUND | TRIGGER,
+	};
+
+	[[nodiscard]] ZKAPI bool operator&(VolumeKind a, VolumeKind b);
+	[[nodiscard]] ZKAPI VolumeKind operator|(VolumeKind a, VolumeKind b);
+	ZKAPI VolumeKind& operator|=(VolumeKind& a, VolumeKind b);
+
+	/// \brief A static index for finding the zone, sound and trigger VObs containing a point.
+	///
+	/// <p>Volumes are bucketed into a uniform grid on the XZ-plane. Default zones, which apply everywhere, are kept
+	/// outside of the grid. Music zones and spherical or ellipsoidal sounds are tested against their actual shape,
+	/// all other volumes against their bounding box.</p>
+	///
+	/// <p>Queries return volumes in order of precedence: zones come before default zones, music zones with a higher
+	/// VZoneMusic::priority come first and otherwise, smaller volumes come before larger ones since they describe a more
+	/// specific area. Queries never allocate and may be run concurrently.</p>
+	///
+	/// <p>The index does not own the VObs. It must be rebuilt whenever the VObs or their positions change.</p>
+	class VolumeIndex {
+	public:
+		/// \brief Replaces the contents of the index with all volumes in the given VOb trees.
+		/// \param roots The root VObs of the trees, e.g. World::world_vobs.
+		/// \param cell_size The edge length of a single grid cell in world units.
+		ZKAPI void build(std::vector<std::shared_ptr<VirtualObject>> const& roots, float cell_size = 2000.0f);
+
+		/// \brief Finds all volumes of the given kinds containing a point.
+		/// \param point The point to test.
+		/// \param kinds The kinds of volumes to consider.
+		/// \param out Receives up to \p capacity volumes in order of precedence.
+		/// \param capacity The number of elements \p out can hold.
+		/// \return The number of volumes containing the point, which may be larger than \p capacity.
+		[[nodiscard]] ZKAPI std::size_t
+		query(glm::vec3 point, VolumeKind kinds, VirtualObject** out, std::size_t capacity) const noexcept;
+
+		/// \brief Finds all volumes of the given kinds containing each of a set of points.
+		/// \param points The points to test.
+		/// \param count The number of points.
+		/// \param kinds The kinds of volumes to consider.
+		/// \param out Receives up to \p capacity volumes per point. The volumes of the point `i` are stored
+		///            beginning at `out[i * capacity]`.
+		/// \param capacity The number of volumes to store per point.
+		/// \param counts Receives the number of volumes containing each point, which may be larger than \p capacity.
+		ZKAPI void query(glm::vec3 const* points,
+		                 std::size_t count,
+		                 VolumeKind kinds,
+		                 VirtualObject** out,
+		                 std::size_t capacity,
+		                 std::size_t* counts) const noexcept;
+
+		/// \return The number of volumes in the index.
+		[[nodiscard]] std::size_t size() const noexcept {
+			return _m_volumes.size();
+		}
+
+	private:
+		struct Volume {
+			AxisAlignedBoundingBox bbox;
+			VirtualObject* vob;
+			VolumeKind kind;
+			bool ellipsoid;
+		};
+
+		[[nodiscard]] ZKINT bool contains(Volume const& volume, glm::vec3 point) const noexcept;
+
+		std::vector<Volume> _m_volumes;
+		std::vector<std::uint32_t> _m_global;
+		std::vector<std::uint32_t> _m_cell_offsets;
+		std::vector<std::uint32_t> _m_cell_volumes;
+		glm::vec2 _m_origin {0};
+		float _m_cell_size {1};
+		std::uint32_t _m_cells_x {0};
+		std::uint32_t _m_cells_z {0};
+	};
+} // namespace zenkit
@@ -0,0 +1,20 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/Allocator.hh"
+
+namespace zenkit {
+	static thread_local std::pmr::memory_resource* zk_memory_resource = nullptr;
+
+	MemoryResourceScope::MemoryResourceScope(std::pmr::memory_resource* resource) noexcept
+	    : _m_previous(zk_memory_resource) {
+		zk_memory_resource = resource;
+	}
+
+	MemoryResourceScope::~MemoryResourceScope() noexcept {
+		zk_memory_resource = _m_previous;
+	}
+
+	std::pmr::memory_resource* MemoryResourceScope::current() noexcept {
+		return zk_memory_resource;
+	}
+} // namespace zenkit
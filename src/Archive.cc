@@ -24,6 +24,7 @@
 #include "zenkit/SaveGame.hh"
 #include "zenkit/World.hh"
 
+#include <algorithm>
 #include <iostream>
 
 namespace zenkit {
@@ -304,6 +305,9 @@ namespace zenkit {
 			return nullptr;
 		}
 
+		// Objects of unknown classes are never cached but are numbered all the same.
+		_m_highest_index = std::max(_m_highest_index, obj.index);
+
 		auto it = OBJECTS.find(obj.class_name);
 		auto type = ObjectType::unknown;
 		if (it != OBJECTS.end()) {
@@ -313,218 +317,218 @@ namespace zenkit {
 		std::shared_ptr<Object> syn;
 		switch (type) {
 		case ObjectType::oCNpcTalent:
-			syn = std::make_shared<VNpc::Talent>();
+			syn = make_object<VNpc::Talent>();
 			break;
 		case ObjectType::zCEventManager:
-			syn = std::make_shared<EventManager>();
+			syn = make_object<EventManager>();
 			break;
 		case ObjectType::zCDecal:
-			syn = std::make_shared<VisualDecal>();
+			syn = make_object<VisualDecal>();
 			break;
 		case ObjectType::zCMesh:
-			syn = std::make_shared<VisualMesh>();
+			syn = make_object<VisualMesh>();
 			break;
 		case ObjectType::zCProgMeshProto:
-			syn = std::make_shared<VisualMultiResolutionMesh>();
+			syn = make_object<VisualMultiResolutionMesh>();
 			break;
 		case ObjectType::zCParticleFX:
-			syn = std::make_shared<VisualParticleEffect>();
+			syn = make_object<VisualParticleEffect>();
 			break;
 		case ObjectType::zCAICamera:
-			syn = std::make_shared<VisualCamera>();
+			syn = make_object<VisualCamera>();
 			break;
 		case ObjectType::zCModel:
-			syn = std::make_shared<VisualModel>();
+			syn = make_object<VisualModel>();
 			break;
 		case ObjectType::zCMorphMesh:
-			syn = std::make_shared<VisualMorphMesh>();
+			syn = make_object<VisualMorphMesh>();
 			break;
 		case ObjectType::oCAIHuman:
-			syn = std::make_shared<AiHuman>();
+			syn = make_object<AiHuman>();
 			break;
 		case ObjectType::oCAIVobMove:
-			syn = std::make_shared<AiMove>();
+			syn = make_object<AiMove>();
 			break;
 		case ObjectType::zCSkyControler_Outdoor:
-			syn = std::make_shared<SkyController>();
+			syn = make_object<SkyController>();
 			break;
 		case ObjectType::oCCSPlayer:
-			syn = std::make_shared<CutscenePlayer>();
+			syn = make_object<CutscenePlayer>();
 			break;
 		case ObjectType::zCVobLevelCompo:
-			syn = std::make_shared<VLevel>();
+			syn = make_object<VLevel>();
 			break;
 		case ObjectType::zCVobStartpoint:
-			syn = std::make_shared<VStartPoint>();
+			syn = make_object<VStartPoint>();
 			break;
 		case ObjectType::zCVobStair:
-			syn = std::make_shared<VStair>();
+			syn = make_object<VStair>();
 			break;
 		case ObjectType::zCVobSpot:
-			syn = std::make_shared<VSpot>();
+			syn = make_object<VSpot>();
 			break;
 		case ObjectType::zCVob:
-			syn = std::make_shared<VirtualObject>();
+			syn = make_object<VirtualObject>();
 			break;
 		case ObjectType::zCVobScreenFX:
-			syn = std::make_shared<VScreenEffect>();
+			syn = make_object<VScreenEffect>();
 			break;
 		case ObjectType::zCCSCamera:
-			syn = std::make_shared<VCutsceneCamera>();
+			syn = make_object<VCutsceneCamera>();
 			break;
 		case ObjectType::zCCamTrj_KeyFrame:
-			syn = std::make_shared<VCameraTrajectoryFrame>();
+			syn = make_object<VCameraTrajectoryFrame>();
 			break;
 		case ObjectType::zCVobAnimate:
-			syn = std::make_shared<VAnimate>();
+			syn = make_object<VAnimate>();
 			break;
 		case ObjectType::zCZoneVobFarPlane:
-			syn = std::make_shared<VZoneFarPlane>();
+			syn = make_object<VZoneFarPlane>();
 			break;
 		case ObjectType::zCZoneVobFarPlaneDefault:
-			syn = std::make_shared<VZoneFarPlaneDefault>();
+			syn = make_object<VZoneFarPlaneDefault>();
 			break;
 		case ObjectType::zCZoneZFogDefault:
-			syn = std::make_shared<VZoneFogDefault>();
+			syn = make_object<VZoneFogDefault>();
 			break;
 		case ObjectType::zCZoneZFog:
-			syn = std::make_shared<VZoneFog>();
+			syn = make_object<VZoneFog>();
 			break;
 		case ObjectType::zCVobLensFlare:
-			syn = std::make_shared<VLensFlare>();
+			syn = make_object<VLensFlare>();
 			break;
 		case ObjectType::oCItem:
-			syn = std::make_shared<VItem>();
+			syn = make_object<VItem>();
 			break;
 		case ObjectType::zCTrigger:
-			syn = std::make_shared<VTrigger>();
+			syn = make_object<VTrigger>();
 			break;
 		case ObjectType::oCCSTrigger:
-			syn = std::make_shared<VCutsceneTrigger>();
+			syn = make_object<VCutsceneTrigger>();
 			break;
 		case ObjectType::oCMOB:
-			syn = std::make_shared<VMovableObject>();
+			syn = make_object<VMovableObject>();
 			break;
 		case ObjectType::oCMobInter:
-			syn = std::make_shared<VInteractiveObject>();
+			syn = make_object<VInteractiveObject>();
 			break;
 		case ObjectType::oCMobLadder:
-			syn = std::make_shared<VLadder>();
+			syn = make_object<VLadder>();
 			break;
 		case ObjectType::oCMobSwitch:
-			syn = std::make_shared<VSwitch>();
+			syn = make_object<VSwitch>();
 			break;
 		case ObjectType::oCMobWheel:
-			syn = std::make_shared<VWheel>();
+			syn = make_object<VWheel>();
 			break;
 		case ObjectType::oCMobBed:
-			syn = std::make_shared<VBed>();
+			syn = make_object<VBed>();
 			break;
 		case ObjectType::oCMobFire:
-			syn = std::make_shared<VFire>();
+			syn = make_object<VFire>();
 			break;
 		case ObjectType::oCMobContainer:
-			syn = std::make_shared<VContainer>();
+			syn = make_object<VContainer>();
 			break;
 		case ObjectType::oCMobDoor:
-			syn = std::make_shared<VDoor>();
+			syn = make_object<VDoor>();
 			break;
 		case ObjectType::zCPFXController:
-			syn = std::make_shared<VParticleEffectController>();
+			syn = make_object<VParticleEffectController>();
 			break;
 		case ObjectType::zCVobLight:
-			syn = std::make_shared<VLight>();
+			syn = make_object<VLight>();
 			break;
 		case ObjectType::zCVobSound:
-			syn = std::make_shared<VSound>();
+			syn = make_object<VSound>();
 			break;
 		case ObjectType::zCVobSoundDaytime:
-			syn = std::make_shared<VSoundDaytime>();
+			syn = make_object<VSoundDaytime>();
 			break;
 		case ObjectType::oCZoneMusic:
-			syn = std::make_shared<VZoneMusic>();
+			syn = make_object<VZoneMusic>();
 			break;
 		case ObjectType::oCZoneMusicDefault:
-			syn = std::make_shared<VZoneMusicDefault>();
+			syn = make_object<VZoneMusicDefault>();
 			break;
 		case ObjectType::zCMessageFilter:
-			syn = std::make_shared<VMessageFilter>();
+			syn = make_object<VMessageFilter>();
 			break;
 		case ObjectType::zCCodeMaster:
-			syn = std::make_shared<VCodeMaster>();
+			syn = make_object<VCodeMaster>();
 			break;
 		case ObjectType::zCTriggerList:
-			syn = std::make_shared<VTriggerList>();
+			syn = make_object<VTriggerList>();
 			break;
 		case ObjectType::oCTriggerScript:
-			syn = std::make_shared<VTriggerScript>();
+			syn = make_object<VTriggerScript>();
 			break;
 		case ObjectType::zCMover:
-			syn = std::make_shared<VMover>();
+			syn = make_object<VMover>();
 			break;
 		case ObjectType::oCTriggerChangeLevel:
-			syn = std::make_shared<VTriggerChangeLevel>();
+			syn = make_object<VTriggerChangeLevel>();
 			break;
 		case ObjectType::zCTriggerWorldStart:
-			syn = std::make_shared<VTriggerWorldStart>();
+			syn = make_object<VTriggerWorldStart>();
 			break;
 		case ObjectType::oCTouchDamage:
-			syn = std::make_shared<VTouchDamage>();
+			syn = make_object<VTouchDamage>();
 			break;
 		case ObjectType::zCTriggerUntouch:
-			syn = std::make_shared<VTriggerUntouch>();
+			syn = make_object<VTriggerUntouch>();
 			break;
 		case ObjectType::zCEarthquake:
-			syn = std::make_shared<VEarthquake>();
+			syn = make_object<VEarthquake>();
 			break;
 		case ObjectType::zCMoverController:
-			syn = std::make_shared<VMoverController>();
+			syn = make_object<VMoverController>();
 			break;
 		case ObjectType::oCNpc:
-			syn = std::make_shared<VNpc>();
+			syn = make_object<VNpc>();
 			break;
 		case ObjectType::oCWorld:
-			syn = std::make_shared<World>();
+			syn = make_object<World>();
 			break;
 		case ObjectType::zCMaterial:
-			syn = std::make_shared<Material>();
+			syn = make_object<Material>();
 			break;
 		case ObjectType::oCSavegameInfo:
-			syn = std::make_shared<SaveMetadata>();
+			syn = make_object<SaveMetadata>();
 			break;
 		case ObjectType::oCCSManager:
-			syn = std::make_shared<CutsceneManager>();
+			syn = make_object<CutsceneManager>();
 			break;
 		case ObjectType::zCCSPoolItem:
-			syn = std::make_shared<CutscenePoolItem>();
+			syn = make_object<CutscenePoolItem>();
 			break;
 		case ObjectType::zCCutscene:
-			syn = std::make_shared<Cutscene>();
+			syn = make_object<Cutscene>();
 			break;
 		case ObjectType::zCCSCutsceneContext:
-			syn = std::make_shared<CutsceneContext>();
+			syn = make_object<CutsceneContext>();
 			break;
 		case ObjectType::zCCSBlock:
-			syn = std::make_shared<CutsceneBlock>();
+			syn = make_object<CutsceneBlock>();
 			break;
 		case ObjectType::zCCSAtomicBlock:
-			syn = std::make_shared<CutsceneAtomicBlock>();
+			syn = make_object<CutsceneAtomicBlock>();
 			break;
 		case ObjectType::zCCSLib:
-			syn = std::make_shared<CutsceneLibrary>();
+			syn = make_object<CutsceneLibrary>();
 			break;
 		case ObjectType::oCMsgConversation:
-			syn = std::make_shared<ConversationMessageEvent>();
+			syn = make_object<ConversationMessageEvent>();
 			break;
 		case ObjectType::zCCSProps:
-			syn = std::make_shared<CutsceneProps>();
+			syn = make_object<CutsceneProps>();
 			break;
 #ifdef ZK_FUTURE
 		case ObjectType::zCWayNet:
-			syn = std::make_shared<WayNet>();
+			syn = make_object<WayNet>();
 			break;
 		case ObjectType::zCWaypoint:
-			syn = std::make_shared<WayPoint>();
+			syn = make_object<WayPoint>();
 			break;
 #endif
 		default:
@@ -540,6 +544,8 @@ namespace zenkit {
 				reinterpret_cast<VirtualObject*>(syn.get())->id = obj.index;
 			}
 
+			ZKSTATS_OBJECT(type);
+			ZKTRACE_SCOPE_DETAIL("archive", "ReadArchive.read_object", obj.class_name);
 			_m_cache.insert_or_assign(obj.index, syn);
 			syn->load(*this, version);
 		}
@@ -552,6 +558,13 @@ namespace zenkit {
 		return syn;
 	}
 
+	void ReadArchive::forget_objects(std::uint32_t index) {
+		// Objects are numbered in the order they appear in the archive.
+		for (std::uint64_t i = index; i <= _m_highest_index; ++i) {
+			_m_cache.erase(static_cast<std::uint32_t>(i));
+		}
+	}
+
 	void ReadArchive::skip_object(bool skip_current) {
 		ArchiveObject tmp;
 		int32_t level = skip_current ? 1 : 0;
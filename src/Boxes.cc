@@ -5,6 +5,13 @@
 
 #include "phoenix/buffer.hh"
 
+#include "Simd.hh"
+
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace zenkit {
@@ -102,4 +109,452 @@ namespace zenkit {
 
 		return box;
 	}
+
+	/// \brief Added to the absolute rotation terms of the separating axis test to handle parallel edges robustly.
+	static constexpr float SAT_EPSILON = 1e-6f;
+
+	/// \brief The parameters of a ray cast shared by all tested blocks.
+	struct ObbRay {
+		glm::vec3 origin;
+		glm::vec3 direction;
+		float max_distance;
+	};
+
+#ifdef ZK_SSE2
+	struct ObbLanes {
+		__m128 c[3];
+		__m128 u[3][3];
+		__m128 e[3];
+	};
+
+	static ObbLanes load_lanes(float const (&center)[3][4],
+	                           float const (&axes)[3][3][4],
+	                           float const (&half_width)[3][4]) noexcept {
+		ObbLanes b;
+		for (auto k = 0; k < 3; ++k) {
+			b.c[k] = _mm_loadu_ps(center[k]);
+			b.e[k] = _mm_loadu_ps(half_width[k]);
+
+			for (auto j = 0; j < 3; ++j) {
+				b.u[k][j] = _mm_loadu_ps(axes[k][j]);
+			}
+		}
+		return b;
+	}
+
+	/// \brief Computes the dot product of a vector in all lanes with a different vector in each lane.
+	static __m128 dot_lanes(__m128 const (&v)[3], glm::vec3 const& w) noexcept {
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(v[0], _mm_set1_ps(w.x)), _mm_mul_ps(v[1], _mm_set1_ps(w.y))),
+		                  _mm_mul_ps(v[2], _mm_set1_ps(w.z)));
+	}
+
+	static __m128 dot_lanes(__m128 const (&a)[3], __m128 const (&b)[3]) noexcept {
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+	}
+
+	/// \brief Tests whether two boxes overlap using the separating axis theorem.
+	/// \see Christer Ericson, Real-Time Collision Detection, 4.4.1
+	static unsigned test_box(ObbLanes const& b, OrientedBoundingBox const& a) noexcept {
+		__m128 d[3] = {
+		    _mm_sub_ps(b.c[0], _mm_set1_ps(a.center.x)),
+		    _mm_sub_ps(b.c[1], _mm_set1_ps(a.center.y)),
+		    _mm_sub_ps(b.c[2], _mm_set1_ps(a.center.z)),
+		};
+
+		auto epsilon = _mm_set1_ps(SAT_EPSILON);
+		__m128 t[3], r[3][3], ar[3][3], ae[3];
+
+		for (auto i = 0; i < 3; ++i) {
+			t[i] = dot_lanes(d, a.axes[i]);
+			ae[i] = _mm_set1_ps(a.half_width[i]);
+
+			for (auto j = 0; j < 3; ++j) {
+				r[i][j] = dot_lanes(b.u[j], a.axes[i]);
+				ar[i][j] = _mm_add_ps(abs_ps(r[i][j]), epsilon);
+			}
+		}
+
+		auto separated = _mm_setzero_ps();
+		auto sum3 = [](__m128 x, __m128 y, __m128 z) { return _mm_add_ps(_mm_add_ps(x, y), z); };
+
+		for (auto i = 0; i < 3; ++i) {
+			auto rb = sum3(_mm_mul_ps(b.e[0], ar[i][0]), _mm_mul_ps(b.e[1], ar[i][1]), _mm_mul_ps(b.e[2], ar[i][2]));
+			separated = _mm_or_ps(separated, _mm_cmpgt_ps(abs_ps(t[i]), _mm_add_ps(ae[i], rb)));
+		}
+
+		for (auto j = 0; j < 3; ++j) {
+			auto ra = sum3(_mm_mul_ps(ae[0], ar[0][j]), _mm_mul_ps(ae[1], ar[1][j]), _mm_mul_ps(ae[2], ar[2][j]));
+			auto dist = sum3(_mm_mul_ps(t[0], r[0][j]), _mm_mul_ps(t[1], r[1][j]), _mm_mul_ps(t[2], r[2][j]));
+			separated = _mm_or_ps(separated, _mm_cmpgt_ps(abs_ps(dist), _mm_add_ps(ra, b.e[j])));
+		}
+
+		for (auto i = 0; i < 3; ++i) {
+			auto i1 = (i + 1) % 3;
+			auto i2 = (i + 2) % 3;
+
+			for (auto j = 0; j < 3; ++j) {
+				auto j1 = (j + 1) % 3;
+				auto j2 = (j + 2) % 3;
+
+				auto ra = _mm_add_ps(_mm_mul_ps(ae[i1], ar[i2][j]), _mm_mul_ps(ae[i2], ar[i1][j]));
+				auto rb = _mm_add_ps(_mm_mul_ps(b.e[j1], ar[i][j2]), _mm_mul_ps(b.e[j2], ar[i][j1]));
+				auto dist = _mm_sub_ps(_mm_mul_ps(t[i2], r[i1][j]), _mm_mul_ps(t[i1], r[i2][j]));
+				separated = _mm_or_ps(separated, _mm_cmpgt_ps(abs_ps(dist), _mm_add_ps(ra, rb)));
+			}
+		}
+
+		return ~static_cast<unsigned>(_mm_movemask_ps(separated)) & 0xFu;
+	}
+
+	static unsigned test_sphere(ObbLanes const& b, glm::vec4 const& sphere) noexcept {
+		__m128 d[3] = {
+		    _mm_sub_ps(_mm_set1_ps(sphere.x), b.c[0]),
+		    _mm_sub_ps(_mm_set1_ps(sphere.y), b.c[1]),
+		    _mm_sub_ps(_mm_set1_ps(sphere.z), b.c[2]),
+		};
+
+		auto sum = _mm_setzero_ps();
+		for (auto k = 0; k < 3; ++k) {
+			auto excess = _mm_max_ps(_mm_sub_ps(abs_ps(dot_lanes(d, b.u[k])), b.e[k]), _mm_setzero_ps());
+			sum = _mm_add_ps(sum, _mm_mul_ps(excess, excess));
+		}
+
+		return static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(sum, _mm_set1_ps(sphere.w * sphere.w))));
+	}
+
+	static unsigned test_ray(ObbLanes const& b, ObbRay const& ray, float (&distances)[4]) noexcept {
+		__m128 p[3] = {
+		    _mm_sub_ps(b.c[0], _mm_set1_ps(ray.origin.x)),
+		    _mm_sub_ps(b.c[1], _mm_set1_ps(ray.origin.y)),
+		    _mm_sub_ps(b.c[2], _mm_set1_ps(ray.origin.z)),
+		};
+
+		auto zero = _mm_setzero_ps();
+		auto t_min = zero;
+		auto t_max = _mm_set1_ps(ray.max_distance);
+		auto miss = zero;
+
+		for (auto k = 0; k < 3; ++k) {
+			auto e = dot_lanes(b.u[k], p);
+			auto f = dot_lanes(b.u[k], ray.direction);
+
+			// Rays parallel to a slab miss if they start outside of it and are otherwise unaffected by it.
+			auto parallel = _mm_cmpeq_ps(f, zero);
+			miss = _mm_or_ps(miss, _mm_and_ps(parallel, _mm_cmpgt_ps(abs_ps(e), b.e[k])));
+
+			f = select_ps(parallel, _mm_set1_ps(1.0f), f);
+			auto t1 = _mm_div_ps(_mm_add_ps(e, b.e[k]), f);
+			auto t2 = _mm_div_ps(_mm_sub_ps(e, b.e[k]), f);
+			t_min = select_ps(parallel, t_min, _mm_max_ps(t_min, _mm_min_ps(t1, t2)));
+			t_max = select_ps(parallel, t_max, _mm_min_ps(t_max, _mm_max_ps(t1, t2)));
+		}
+
+		_mm_storeu_ps(distances, t_min);
+		return static_cast<unsigned>(_mm_movemask_ps(_mm_andnot_ps(miss, _mm_cmple_ps(t_min, t_max))));
+	}
+#else
+	/// \brief Tests whether two boxes overlap using the separating axis theorem.
+	/// \see Christer Ericson, Real-Time Collision Detection, 4.4.1
+	static bool test_box(glm::vec3 const& bc, glm::vec3 const bu[3], glm::vec3 const& be, OrientedBoundingBox const& a) {
+		auto d = bc - a.center;
+		float t[3], r[3][3], ar[3][3];
+
+		for (auto i = 0; i < 3; ++i) {
+			t[i] = glm::dot(d, a.axes[i]);
+
+			for (auto j = 0; j < 3; ++j) {
+				r[i][j] = glm::dot(a.axes[i], bu[j]);
+				ar[i][j] = std::abs(r[i][j]) + SAT_EPSILON;
+			}
+		}
+
+		for (auto i = 0; i < 3; ++i) {
+			auto rb = be[0] * ar[i][0] + be[1] * ar[i][1] + be[2] * ar[i][2];
+			if (std::abs(t[i]) > a.half_width[i] + rb) return false;
+		}
+
+		for (auto j = 0; j < 3; ++j) {
+			auto ra = a.half_width[0] * ar[0][j] + a.half_width[1] * ar[1][j] + a.half_width[2] * ar[2][j];
+			if (std::abs(t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j]) > ra + be[j]) return false;
+		}
+
+		for (auto i = 0; i < 3; ++i) {
+			auto i1 = (i + 1) % 3;
+			auto i2 = (i + 2) % 3;
+
+			for (auto j = 0; j < 3; ++j) {
+				auto j1 = (j + 1) % 3;
+				auto j2 = (j + 2) % 3;
+
+				auto ra = a.half_width[i1] * ar[i2][j] + a.half_width[i2] * ar[i1][j];
+				auto rb = be[j1] * ar[i][j2] + be[j2] * ar[i][j1];
+				if (std::abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) > ra + rb) return false;
+			}
+		}
+
+		return true;
+	}
+
+	static bool test_sphere(glm::vec3 const& bc, glm::vec3 const bu[3], glm::vec3 const& be, glm::vec4 const& sphere) {
+		auto d = glm::vec3 {sphere} - bc;
+		auto sum = 0.0f;
+
+		for (auto k = 0; k < 3; ++k) {
+			auto excess = std::max(std::abs(glm::dot(d, bu[k])) - be[k], 0.0f);
+			sum += excess * excess;
+		}
+
+		return sum <= sphere.w * sphere.w;
+	}
+
+	/// \brief Intersects a ray with a box using the slab method.
+	/// \param distance Receives the ray parameter at which the ray enters the box.
+	static bool
+	test_ray(glm::vec3 const& bc, glm::vec3 const bu[3], glm::vec3 const& be, ObbRay const& ray, float& distance) {
+		auto p = bc - ray.origin;
+		auto t_min = 0.0f;
+		auto t_max = ray.max_distance;
+
+		for (auto k = 0; k < 3; ++k) {
+			auto e = glm::dot(bu[k], p);
+			auto f = glm::dot(bu[k], ray.direction);
+
+			if (f == 0) {
+				if (std::abs(e) > be[k]) return false;
+				continue;
+			}
+
+			auto t1 = (e + be[k]) / f;
+			auto t2 = (e - be[k]) / f;
+			t_min = std::max(t_min, std::min(t1, t2));
+			t_max = std::min(t_max, std::max(t1, t2));
+		}
+
+		distance = t_min;
+		return t_min <= t_max;
+	}
+#endif
+
+	void OrientedBoundingBoxTree::flatten(OrientedBoundingBox const& box) {
+		auto index = static_cast<std::uint32_t>(_m_next.size());
+		_m_next.push_back(0);
+
+		if (index % 4 == 0) _m_blocks.emplace_back();
+		auto& block = _m_blocks.back();
+		auto lane = index % 4;
+
+		for (auto k = 0; k < 3; ++k) {
+			block.center[k][lane] = box.center[k];
+			block.half_width[k][lane] = box.half_width[k];
+
+			for (auto j = 0; j < 3; ++j) {
+				block.axes[k][j][lane] = box.axes[k][j];
+			}
+		}
+
+		for (auto& child : box.children) {
+			this->flatten(child);
+		}
+
+		_m_next[index] = static_cast<std::uint32_t>(_m_next.size());
+	}
+
+	void OrientedBoundingBoxTree::build(OrientedBoundingBox const& root) {
+		_m_blocks.clear();
+		_m_next.clear();
+		_m_roots.clear();
+
+		this->flatten(root);
+		_m_roots = {0, static_cast<std::uint32_t>(_m_next.size())};
+	}
+
+	void OrientedBoundingBoxTree::build(std::vector<OrientedBoundingBox> const& roots) {
+		_m_blocks.clear();
+		_m_next.clear();
+		_m_roots.clear();
+
+		for (auto& root : roots) {
+			_m_roots.push_back(static_cast<std::uint32_t>(_m_next.size()));
+			this->flatten(root);
+		}
+
+		_m_roots.push_back(static_cast<std::uint32_t>(_m_next.size()));
+	}
+
+	void OrientedBoundingBoxTree::transform(OrientedBoundingBoxTree const& source, glm::mat4 const* transforms) {
+		_m_blocks.resize(source._m_blocks.size());
+		_m_next = source._m_next;
+		_m_roots = source._m_roots;
+
+		for (auto root = 0u; root < source.root_count(); ++root) {
+			auto& m = transforms[root];
+			glm::mat3 rotation {m};
+
+			for (auto i = _m_roots[root]; i < _m_roots[root + 1]; ++i) {
+				auto& from = source._m_blocks[i / 4];
+				auto& to = _m_blocks[i / 4];
+				auto lane = i % 4;
+
+				glm::vec3 center {from.center[0][lane], from.center[1][lane], from.center[2][lane]};
+				center = glm::vec3 {m * glm::vec4 {center, 1}};
+
+				for (auto k = 0; k < 3; ++k) {
+					glm::vec3 axis {from.axes[k][0][lane], from.axes[k][1][lane], from.axes[k][2][lane]};
+					axis = rotation * axis;
+
+					to.center[k][lane] = center[k];
+					to.half_width[k][lane] = from.half_width[k][lane];
+
+					for (auto j = 0; j < 3; ++j) {
+						to.axes[k][j][lane] = axis[j];
+					}
+				}
+			}
+		}
+	}
+
+	template <typename Evaluate, typename Leaf>
+	void OrientedBoundingBoxTree::traverse(std::uint32_t root, Evaluate&& evaluate, Leaf&& leaf) const noexcept {
+		auto block = std::numeric_limits<std::uint32_t>::max();
+		unsigned mask = 0;
+		float distances[4] = {0, 0, 0, 0};
+
+		for (auto i = _m_roots[root]; i < _m_roots[root + 1];) {
+			// The traversal only moves forward, so every block is tested at most once.
+			if (i / 4 != block) {
+				block = i / 4;
+				mask = evaluate(_m_blocks[block], distances);
+			}
+
+			auto lane = i % 4;
+			if ((mask >> lane & 1u) == 0) {
+				i = _m_next[i];
+				continue;
+			}
+
+			if (_m_next[i] == i + 1 && leaf(i, distances[lane])) return;
+			i += 1;
+		}
+	}
+
+#ifndef ZK_SSE2
+	/// \brief Tests all lanes of a block using a scalar test function.
+	template <typename Block, typename Test>
+	static unsigned test_lanes(Block const& block, Test&& test) noexcept {
+		unsigned mask = 0;
+
+		for (auto lane = 0u; lane < 4; ++lane) {
+			glm::vec3 c {block.center[0][lane], block.center[1][lane], block.center[2][lane]};
+			glm::vec3 e {block.half_width[0][lane], block.half_width[1][lane], block.half_width[2][lane]};
+			glm::vec3 u[3];
+
+			for (auto k = 0; k < 3; ++k) {
+				u[k] = glm::vec3 {block.axes[k][0][lane], block.axes[k][1][lane], block.axes[k][2][lane]};
+			}
+
+			if (test(lane, c, u, e)) mask |= 1u << lane;
+		}
+
+		return mask;
+	}
+#endif
+
+	std::size_t OrientedBoundingBoxTree::overlaps(OrientedBoundingBox const& box,
+	                                              std::uint32_t* roots,
+	                                              std::size_t capacity) const noexcept {
+		auto evaluate = [&box](Block const& block, float(&)[4]) {
+#ifdef ZK_SSE2
+			return test_box(load_lanes(block.center, block.axes, block.half_width), box);
+#else
+			return test_lanes(block, [&box](unsigned, auto& c, auto& u, auto& e) { return test_box(c, u, e, box); });
+#endif
+		};
+
+		std::size_t count = 0;
+		for (auto root = 0u; root < this->root_count(); ++root) {
+			this->traverse(root, evaluate, [&](std::uint32_t, float) {
+				if (count < capacity) roots[count] = root;
+				count += 1;
+				return true;
+			});
+		}
+
+		return count;
+	}
+
+	std::size_t OrientedBoundingBoxTree::overlaps(glm::vec3 center,
+	                                              float radius,
+	                                              std::uint32_t* roots,
+	                                              std::size_t capacity) const noexcept {
+		glm::vec4 sphere {center, radius};
+		auto evaluate = [&sphere](Block const& block, float(&)[4]) {
+#ifdef ZK_SSE2
+			return test_sphere(load_lanes(block.center, block.axes, block.half_width), sphere);
+#else
+			return test_lanes(block,
+			                  [&sphere](unsigned, auto& c, auto& u, auto& e) { return test_sphere(c, u, e, sphere); });
+#endif
+		};
+
+		std::size_t count = 0;
+		for (auto root = 0u; root < this->root_count(); ++root) {
+			this->traverse(root, evaluate, [&](std::uint32_t, float) {
+				if (count < capacity) roots[count] = root;
+				count += 1;
+				return true;
+			});
+		}
+
+		return count;
+	}
+
+	bool OrientedBoundingBoxTree::raycast(glm::vec3 origin,
+	                                      glm::vec3 direction,
+	                                      float max_distance,
+	                                      OrientedBoundingBoxHit& hit) const noexcept {
+		ObbRay ray {origin, direction, max_distance};
+		auto evaluate = [&ray](Block const& block, float(&distances)[4]) {
+#ifdef ZK_SSE2
+			return test_ray(load_lanes(block.center, block.axes, block.half_width), ray, distances);
+#else
+			return test_lanes(block, [&ray, &distances](unsigned lane, auto& c, auto& u, auto& e) {
+				return test_ray(c, u, e, ray, distances[lane]);
+			});
+#endif
+		};
+
+		auto found = false;
+		for (auto root = 0u; root < this->root_count(); ++root) {
+			this->traverse(root, evaluate, [&](std::uint32_t node, float distance) {
+				// Leaves of an already evaluated block may be further away than the closest hit so far.
+				if (found && distance >= hit.distance) return false;
+
+				hit = OrientedBoundingBoxHit {root, node, distance};
+				found = true;
+
+				// Nothing further away than the closest hit needs to be tested.
+				ray.max_distance = std::min(ray.max_distance, distance);
+				return false;
+			});
+		}
+
+		return found;
+	}
+
+	OrientedBoundingBox OrientedBoundingBoxTree::node(std::uint32_t index) const noexcept {
+		auto& block = _m_blocks[index / 4];
+		auto lane = index % 4;
+
+		OrientedBoundingBox box {};
+		for (auto k = 0; k < 3; ++k) {
+			box.center[k] = block.center[k][lane];
+			box.half_width[k] = block.half_width[k][lane];
+
+			for (auto j = 0; j < 3; ++j) {
+				box.axes[k][j] = block.axes[k][j][lane];
+			}
+		}
+
+		return box;
+	}
 } // namespace zenkit
@@ -0,0 +1,638 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/CompactMesh.hh"
+#include "zenkit/Mesh.hh"
+#include "zenkit/MultiResolutionMesh.hh"
+#include "zenkit/SoftSkinMesh.hh"
+
+#include "Internal.hh"
+#include "Simd.hh"
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace zenkit {
+	/// \brief The largest value of a 16-bit quantized position component.
+	static constexpr float POSITION_STEPS = static_cast<float>((1 << 16) - 1);
+
+	/// \brief The largest value of a 16-bit signed normalized normal component.
+	static constexpr float NORMAL_STEPS = static_cast<float>((1 << 15) - 1);
+
+	/// \brief The number of elements converted at once when encoding or decoding interleaved data.
+	static constexpr std::size_t CHUNK_SIZE = 256;
+
+	static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+	static_assert(sizeof(CompactPosition) == 3 * sizeof(std::uint16_t), "CompactPosition must be tightly packed");
+	static_assert(sizeof(CompactNormal) == 2 * sizeof(std::int16_t), "CompactNormal must be tightly packed");
+
+	static std::uint32_t as_uint(float f) noexcept {
+		std::uint32_t u;
+		std::memcpy(&u, &f, sizeof u);
+		return u;
+	}
+
+	static float as_float(std::uint32_t u) noexcept {
+		float f;
+		std::memcpy(&f, &u, sizeof f);
+		return f;
+	}
+
+	// All scalar code below performs the same operations in the same order as the SIMD code, so that the result is
+	// identical regardless of which of them is used for an element.
+
+	static std::uint16_t encode_position(float p, float origin, float inverse_step) noexcept {
+		auto q = std::clamp((p - origin) * inverse_step, 0.0f, POSITION_STEPS);
+		return static_cast<std::uint16_t>(std::lrint(q));
+	}
+
+	static CompactNormal encode_normal(glm::vec3 n) noexcept {
+		auto l1 = std::max(std::abs(n.x) + std::abs(n.y) + std::abs(n.z), FLT_MIN);
+		auto x = n.x / l1;
+		auto y = n.y / l1;
+
+		// Fold the lower hemisphere over the diagonals of the octahedron.
+		if (n.z < 0) {
+			auto fx = (1.0f - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+			auto fy = (1.0f - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+			x = fx;
+			y = fy;
+		}
+
+		return CompactNormal {static_cast<std::int16_t>(std::lrint(x * NORMAL_STEPS)),
+		                      static_cast<std::int16_t>(std::lrint(y * NORMAL_STEPS))};
+	}
+
+	static glm::vec3 decode_normal(CompactNormal n) noexcept {
+		auto x = std::max(static_cast<float>(n.x) / NORMAL_STEPS, -1.0f);
+		auto y = std::max(static_cast<float>(n.y) / NORMAL_STEPS, -1.0f);
+		auto z = 1.0f - std::abs(x) - std::abs(y);
+
+		auto t = std::max(-z, 0.0f);
+		x += x >= 0 ? -t : t;
+		y += y >= 0 ? -t : t;
+
+		auto length = std::sqrt(x * x + y * y + z * z);
+		return glm::vec3 {x / length, y / length, z / length};
+	}
+
+	/// \brief Converts a float to half-precision, rounding to nearest even.
+	/// \see https://gist.github.com/rygorous/2156668
+	static std::uint16_t encode_half(float f) noexcept {
+		auto u = as_uint(f);
+		auto sign = u & 0x80000000u;
+		u ^= sign;
+
+		std::uint32_t h;
+		if (u >= (127u + 16u) << 23) {
+			// Too large for a half or NaN.
+			h = u > 255u << 23 ? 0x7E00u : 0x7C00u;
+		} else if (u < (127u - 14u) << 23) {
+			// Subnormal half; let the FPU do the rounding by adding a magic number.
+			constexpr std::uint32_t magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+			h = as_uint(as_float(u) + as_float(magic)) - magic;
+		} else {
+			auto odd = (u >> 13) & 1u;
+			u += 0xFFFu - ((127u - 15u) << 23);
+			u += odd;
+			h = u >> 13;
+		}
+
+		return static_cast<std::uint16_t>(h | (sign >> 16));
+	}
+
+	/// \brief Converts a half-precision float to single-precision.
+	/// \see https://gist.github.com/rygorous/2144712
+	static float decode_half(std::uint16_t h) noexcept {
+		std::uint32_t exponent_mantissa = h & 0x7FFFu;
+		auto f = as_uint(as_float(exponent_mantissa << 13) * as_float((254u - 15u) << 23));
+		if (exponent_mantissa > 0x7BFFu) f |= 255u << 23;
+		return as_float(f | (static_cast<std::uint32_t>(h & 0x8000u) << 16));
+	}
+
+#ifdef ZK_SSE2
+	static __m128i select_si128(__m128i mask, __m128i a, __m128i b) noexcept {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	/// \brief Packs four 16-bit values stored in 32-bit lanes into the low half of the result.
+	static __m128i pack_low16(__m128i v) noexcept {
+		// Sign-extend so that the saturating pack keeps the bit pattern.
+		v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+		return _mm_packs_epi32(v, v);
+	}
+#endif
+
+	PositionQuantization PositionQuantization::from_bounds(AxisAlignedBoundingBox const& bbox) noexcept {
+		return PositionQuantization {bbox.min, glm::max(bbox.max - bbox.min, glm::vec3 {0}) / POSITION_STEPS};
+	}
+
+	PositionQuantization PositionQuantization::from_points(glm::vec3 const* points, std::size_t count) noexcept {
+		if (count == 0) return PositionQuantization {glm::vec3 {0}, glm::vec3 {0}};
+
+		AxisAlignedBoundingBox bbox {points[0], points[0]};
+		for (auto i = 1u; i < count; ++i) {
+			bbox.min = glm::min(bbox.min, points[i]);
+			bbox.max = glm::max(bbox.max, points[i]);
+		}
+
+		return from_bounds(bbox);
+	}
+
+	void encode_positions(PositionQuantization const& q,
+	                      glm::vec3 const* in,
+	                      std::size_t count,
+	                      CompactPosition* out) noexcept {
+		glm::vec3 inverse {
+		    q.step.x > 0 ? 1.0f / q.step.x : 0.0f,
+		    q.step.y > 0 ? 1.0f / q.step.y : 0.0f,
+		    q.step.z > 0 ? 1.0f / q.step.z : 0.0f,
+		};
+
+		std::size_t i = 0;
+
+#ifdef ZK_SSE2
+		// Four positions are twelve consecutive floats, so the components repeat every three lanes.
+		auto* src = reinterpret_cast<float const*>(in);
+		auto* dst = reinterpret_cast<std::uint16_t*>(out);
+
+		__m128 origins[3] = {
+		    _mm_setr_ps(q.origin.x, q.origin.y, q.origin.z, q.origin.x),
+		    _mm_setr_ps(q.origin.y, q.origin.z, q.origin.x, q.origin.y),
+		    _mm_setr_ps(q.origin.z, q.origin.x, q.origin.y, q.origin.z),
+		};
+		__m128 scales[3] = {
+		    _mm_setr_ps(inverse.x, inverse.y, inverse.z, inverse.x),
+		    _mm_setr_ps(inverse.y, inverse.z, inverse.x, inverse.y),
+		    _mm_setr_ps(inverse.z, inverse.x, inverse.y, inverse.z),
+		};
+
+		auto zero = _mm_setzero_ps();
+		auto steps = _mm_set1_ps(POSITION_STEPS);
+		auto bias = _mm_set1_epi32(0x8000);
+		auto flip = _mm_set1_epi16(static_cast<short>(0x8000));
+
+		for (; i + 4 <= count; i += 4) {
+			__m128i words[3];
+			for (auto j = 0; j < 3; ++j) {
+				auto v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i * 3 + j * 4), origins[j]), scales[j]);
+				v = _mm_min_ps(_mm_max_ps(v, zero), steps);
+
+				// Shift into the signed range since there is no unsigned saturating pack in SSE2.
+				words[j] = _mm_sub_epi32(_mm_cvtps_epi32(v), bias);
+			}
+
+			auto lo = _mm_xor_si128(_mm_packs_epi32(words[0], words[1]), flip);
+			auto hi = _mm_xor_si128(_mm_packs_epi32(words[2], words[2]), flip);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3), lo);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 3 + 8), hi);
+		}
+#endif
+
+		for (; i < count; ++i) {
+			out[i].x = encode_position(in[i].x, q.origin.x, inverse.x);
+			out[i].y = encode_position(in[i].y, q.origin.y, inverse.y);
+			out[i].z = encode_position(in[i].z, q.origin.z, inverse.z);
+		}
+	}
+
+	void decode_positions(PositionQuantization const& q,
+	                      CompactPosition const* in,
+	                      std::size_t count,
+	                      glm::vec3* out) noexcept {
+		std::size_t i = 0;
+
+#ifdef ZK_SSE2
+		auto* src = reinterpret_cast<std::uint16_t const*>(in);
+		auto* dst = reinterpret_cast<float*>(out);
+
+		__m128 origins[3] = {
+		    _mm_setr_ps(q.origin.x, q.origin.y, q.origin.z, q.origin.x),
+		    _mm_setr_ps(q.origin.y, q.origin.z, q.origin.x, q.origin.y),
+		    _mm_setr_ps(q.origin.z, q.origin.x, q.origin.y, q.origin.z),
+		};
+		__m128 scales[3] = {
+		    _mm_setr_ps(q.step.x, q.step.y, q.step.z, q.step.x),
+		    _mm_setr_ps(q.step.y, q.step.z, q.step.x, q.step.y),
+		    _mm_setr_ps(q.step.z, q.step.x, q.step.y, q.step.z),
+		};
+
+		auto zero = _mm_setzero_si128();
+		for (; i + 4 <= count; i += 4) {
+			auto lo = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i * 3));
+			auto hi = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(src + i * 3 + 8));
+
+			__m128i words[3] = {
+			    _mm_unpacklo_epi16(lo, zero),
+			    _mm_unpackhi_epi16(lo, zero),
+			    _mm_unpacklo_epi16(hi, zero),
+			};
+
+			for (auto j = 0; j < 3; ++j) {
+				auto v = _mm_add_ps(origins[j], _mm_mul_ps(_mm_cvtepi32_ps(words[j]), scales[j]));
+				_mm_storeu_ps(dst + i * 3 + j * 4, v);
+			}
+		}
+#endif
+
+		for (; i < count; ++i) {
+			out[i].x = q.origin.x + static_cast<float>(in[i].x) * q.step.x;
+			out[i].y = q.origin.y + static_cast<float>(in[i].y) * q.step.y;
+			out[i].z = q.origin.z + static_cast<float>(in[i].z) * q.step.z;
+		}
+	}
+
+	void encode_normals(glm::vec3 const* in, std::size_t count, CompactNormal* out) noexcept {
+		std::size_t i = 0;
+
+#ifdef ZK_SSE2
+		auto* src = reinterpret_cast<float const*>(in);
+		auto min = _mm_set1_ps(FLT_MIN);
+		auto one = _mm_set1_ps(1.0f);
+		auto zero = _mm_setzero_ps();
+		auto steps = _mm_set1_ps(NORMAL_STEPS);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 xs, ys, zs;
+			load_vec3x4(src + i * 3, xs, ys, zs);
+
+			auto l1 = _mm_max_ps(_mm_add_ps(_mm_add_ps(abs_ps(xs), abs_ps(ys)), abs_ps(zs)), min);
+			auto x = _mm_div_ps(xs, l1);
+			auto y = _mm_div_ps(ys, l1);
+
+			auto sign_x = select_ps(_mm_cmpge_ps(x, zero), one, _mm_sub_ps(zero, one));
+			auto sign_y = select_ps(_mm_cmpge_ps(y, zero), one, _mm_sub_ps(zero, one));
+			auto fx = _mm_mul_ps(_mm_sub_ps(one, abs_ps(y)), sign_x);
+			auto fy = _mm_mul_ps(_mm_sub_ps(one, abs_ps(x)), sign_y);
+
+			auto lower = _mm_cmplt_ps(zs, zero);
+			x = select_ps(lower, fx, x);
+			y = select_ps(lower, fy, y);
+
+			auto qx = _mm_cvtps_epi32(_mm_mul_ps(x, steps));
+			auto qy = _mm_cvtps_epi32(_mm_mul_ps(y, steps));
+			auto packed = _mm_packs_epi32(_mm_unpacklo_epi32(qx, qy), _mm_unpackhi_epi32(qx, qy));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+		}
+#endif
+
+		for (; i < count; ++i) {
+			out[i] = encode_normal(in[i]);
+		}
+	}
+
+	void decode_normals(CompactNormal const* in, std::size_t count, glm::vec3* out) noexcept {
+		std::size_t i = 0;
+
+#ifdef ZK_SSE2
+		auto* dst = reinterpret_cast<float*>(out);
+		auto minus_one = _mm_set1_ps(-1.0f);
+		auto one = _mm_set1_ps(1.0f);
+		auto zero = _mm_setzero_ps();
+		auto steps = _mm_set1_ps(NORMAL_STEPS);
+
+		for (; i + 4 <= count; i += 4) {
+			auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+			auto lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)); // x0 y0 x1 y1
+			auto hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)); // x2 y2 x3 y3
+
+			auto x = _mm_max_ps(_mm_div_ps(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)), steps), minus_one);
+			auto y = _mm_max_ps(_mm_div_ps(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)), steps), minus_one);
+			auto z = _mm_sub_ps(_mm_sub_ps(one, abs_ps(x)), abs_ps(y));
+
+			auto t = _mm_max_ps(_mm_sub_ps(zero, z), zero);
+			x = _mm_add_ps(x, select_ps(_mm_cmpge_ps(x, zero), _mm_sub_ps(zero, t), t));
+			y = _mm_add_ps(y, select_ps(_mm_cmpge_ps(y, zero), _mm_sub_ps(zero, t), t));
+
+			auto length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+			store_vec3x4(dst + i * 3, _mm_div_ps(x, length), _mm_div_ps(y, length), _mm_div_ps(z, length));
+		}
+#endif
+
+		for (; i < count; ++i) {
+			out[i] = decode_normal(in[i]);
+		}
+	}
+
+	void encode_halfs(float const* in, std::size_t count, std::uint16_t* out) noexcept {
+		std::size_t i = 0;
+
+#ifdef ZK_SSE2
+		auto sign_mask = _mm_set1_epi32(static_cast<int>(0x80000000u));
+		auto f32_infinity = _mm_set1_epi32(255 << 23);
+		auto f16_max = _mm_set1_epi32((127 + 16) << 23);
+		auto f16_min_normal = _mm_set1_epi32((127 - 14) << 23);
+		auto subnormal_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+		auto normal_bias = _mm_set1_epi32(static_cast<int>(0xFFFu - ((127u - 15u) << 23)));
+		auto nan_bit = _mm_set1_epi32(0x200);
+		auto f16_infinity = _mm_set1_epi32(0x7C00);
+		auto one = _mm_set1_epi32(1);
+
+		for (; i + 4 <= count; i += 4) {
+			auto f = _mm_castps_si128(_mm_loadu_ps(in + i));
+			auto sign = _mm_and_si128(f, sign_mask);
+			auto u = _mm_xor_si128(f, sign);
+
+			auto is_nan = _mm_cmpgt_epi32(u, f32_infinity);
+			auto is_regular = _mm_cmpgt_epi32(f16_max, u);
+			auto is_subnormal = _mm_cmpgt_epi32(f16_min_normal, u);
+
+			auto inf_or_nan = _mm_or_si128(_mm_and_si128(is_nan, nan_bit), f16_infinity);
+
+			auto subnormal = _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), _mm_castsi128_ps(subnormal_magic)));
+			subnormal = _mm_sub_epi32(subnormal, subnormal_magic);
+
+			auto odd = _mm_and_si128(_mm_srli_epi32(u, 13), one);
+			auto normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(u, normal_bias), odd), 13);
+
+			auto h = select_si128(is_regular, select_si128(is_subnormal, subnormal, normal), inf_or_nan);
+			h = _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), pack_low16(h));
+		}
+#endif
+
+		for (; i < count; ++i) {
+			out[i] = encode_half(in[i]);
+		}
+	}
+
+	void decode_halfs(std::uint16_t const* in, std::size_t count, float* out) noexcept {
+		std::size_t i = 0;
+
+#ifdef ZK_SSE2
+		auto zero = _mm_setzero_si128();
+		auto no_sign = _mm_set1_epi32(0x7FFF);
+		auto magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+		auto max_finite = _mm_set1_epi32(0x7BFF);
+		auto f32_infinity = _mm_set1_epi32(255 << 23);
+
+		for (; i + 4 <= count; i += 4) {
+			auto h = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(in + i)), zero);
+			auto exponent_mantissa = _mm_and_si128(h, no_sign);
+			auto sign = _mm_slli_epi32(_mm_xor_si128(h, exponent_mantissa), 16);
+
+			auto f = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponent_mantissa, 13)), magic);
+			auto inf_or_nan = _mm_and_si128(_mm_cmpgt_epi32(exponent_mantissa, max_finite), f32_infinity);
+			f = _mm_or_ps(f, _mm_castsi128_ps(_mm_or_si128(sign, inf_or_nan)));
+			_mm_storeu_ps(out + i, f);
+		}
+#endif
+
+		for (; i < count; ++i) {
+			out[i] = decode_half(in[i]);
+		}
+	}
+
+	void CompactMesh::encode(Mesh const& mesh) {
+		ZKTRACE_SCOPE("mesh", "CompactMesh.encode");
+
+		this->quantization = PositionQuantization::from_points(mesh.vertices.data(), mesh.vertices.size());
+		this->vertices.resize(mesh.vertices.size());
+		encode_positions(this->quantization, mesh.vertices.data(), mesh.vertices.size(), this->vertices.data());
+
+		// The features are interleaved, so they are encoded in chunks through contiguous buffers.
+		glm::vec3 normals[CHUNK_SIZE];
+		CompactNormal compact_normals[CHUNK_SIZE];
+		float textures[CHUNK_SIZE * 2];
+		std::uint16_t compact_textures[CHUNK_SIZE * 2];
+
+		this->features.resize(mesh.features.size());
+		for (std::size_t i = 0; i < mesh.features.size(); i += CHUNK_SIZE) {
+			auto count = std::min(CHUNK_SIZE, mesh.features.size() - i);
+
+			for (auto j = 0u; j < count; ++j) {
+				auto& feature = mesh.features[i + j];
+				normals[j] = feature.normal;
+				textures[j * 2 + 0] = feature.texture.x;
+				textures[j * 2 + 1] = feature.texture.y;
+			}
+
+			encode_normals(normals, count, compact_normals);
+			encode_halfs(textures, count * 2, compact_textures);
+
+			for (auto j = 0u; j < count; ++j) {
+				auto& feature = this->features[i + j];
+				feature.texture[0] = compact_textures[j * 2 + 0];
+				feature.texture[1] = compact_textures[j * 2 + 1];
+				feature.light = mesh.features[i + j].light;
+				feature.normal = compact_normals[j];
+			}
+		}
+	}
+
+	void CompactMesh::decode(Mesh& mesh) const {
+		ZKTRACE_SCOPE("mesh", "CompactMesh.decode");
+
+		mesh.vertices.resize(this->vertices.size());
+		decode_positions(this->quantization, this->vertices.data(), this->vertices.size(), mesh.vertices.data());
+
+		CompactNormal compact_normals[CHUNK_SIZE];
+		glm::vec3 normals[CHUNK_SIZE];
+		std::uint16_t compact_textures[CHUNK_SIZE * 2];
+		float textures[CHUNK_SIZE * 2];
+
+		mesh.features.resize(this->features.size());
+		for (std::size_t i = 0; i < this->features.size(); i += CHUNK_SIZE) {
+			auto count = std::min(CHUNK_SIZE, this->features.size() - i);
+
+			for (auto j = 0u; j < count; ++j) {
+				auto& feature = this->features[i + j];
+				compact_normals[j] = feature.normal;
+				compact_textures[j * 2 + 0] = feature.texture[0];
+				compact_textures[j * 2 + 1] = feature.texture[1];
+			}
+
+			decode_normals(compact_normals, count, normals);
+			decode_halfs(compact_textures, count * 2, textures);
+
+			for (auto j = 0u; j < count; ++j) {
+				auto& feature = mesh.features[i + j];
+				feature.texture = glm::vec2 {textures[j * 2 + 0], textures[j * 2 + 1]};
+				feature.light = this->features[i + j].light;
+				feature.normal = normals[j];
+			}
+		}
+	}
+
+	/// \brief Encodes the wedges of a sub-mesh.
+	static void encode_wedges(std::vector<MeshWedge> const& wedges, std::vector<CompactWedge>& out) {
+		glm::vec3 normals[CHUNK_SIZE];
+		CompactNormal compact_normals[CHUNK_SIZE];
+		float textures[CHUNK_SIZE * 2];
+		std::uint16_t compact_textures[CHUNK_SIZE * 2];
+
+		out.resize(wedges.size());
+		for (std::size_t i = 0; i < wedges.size(); i += CHUNK_SIZE) {
+			auto count = std::min(CHUNK_SIZE, wedges.size() - i);
+
+			for (auto j = 0u; j < count; ++j) {
+				auto& wedge = wedges[i + j];
+				normals[j] = wedge.normal;
+				textures[j * 2 + 0] = wedge.texture.x;
+				textures[j * 2 + 1] = wedge.texture.y;
+			}
+
+			encode_normals(normals, count, compact_normals);
+			encode_halfs(textures, count * 2, compact_textures);
+
+			for (auto j = 0u; j < count; ++j) {
+				auto& wedge = out[i + j];
+				wedge.normal = compact_normals[j];
+				wedge.texture[0] = compact_textures[j * 2 + 0];
+				wedge.texture[1] = compact_textures[j * 2 + 1];
+				wedge.index = wedges[i + j].index;
+			}
+		}
+	}
+
+	/// \brief Decodes the wedges of a sub-mesh.
+	static void decode_wedges(std::vector<CompactWedge> const& wedges, std::vector<MeshWedge>& out) {
+		CompactNormal compact_normals[CHUNK_SIZE];
+		glm::vec3 normals[CHUNK_SIZE];
+		std::uint16_t compact_textures[CHUNK_SIZE * 2];
+		float textures[CHUNK_SIZE * 2];
+
+		out.resize(wedges.size());
+		for (std::size_t i = 0; i < wedges.size(); i += CHUNK_SIZE) {
+			auto count = std::min(CHUNK_SIZE, wedges.size() - i);
+
+			for (auto j = 0u; j < count; ++j) {
+				auto& wedge = wedges[i + j];
+				compact_normals[j] = wedge.normal;
+				compact_textures[j * 2 + 0] = wedge.texture[0];
+				compact_textures[j * 2 + 1] = wedge.texture[1];
+			}
+
+			decode_normals(compact_normals, count, normals);
+			decode_halfs(compact_textures, count * 2, textures);
+
+			for (auto j = 0u; j < count; ++j) {
+				auto& wedge = out[i + j];
+				wedge.normal = normals[j];
+				wedge.texture = glm::vec2 {textures[j * 2 + 0], textures[j * 2 + 1]};
+				wedge.index = wedges[i + j].index;
+			}
+		}
+	}
+
+	void CompactMultiResolutionMesh::encode(MultiResolutionMesh const& mesh) {
+		ZKTRACE_SCOPE("mesh", "CompactMultiResolutionMesh.encode");
+
+		this->quantization = PositionQuantization::from_points(mesh.positions.data(), mesh.positions.size());
+		this->positions.resize(mesh.positions.size());
+		encode_positions(this->quantization, mesh.positions.data(), mesh.positions.size(), this->positions.data());
+
+		this->normals.resize(mesh.normals.size());
+		encode_normals(mesh.normals.data(), mesh.normals.size(), this->normals.data());
+
+		this->wedges.resize(mesh.sub_meshes.size());
+		for (auto i = 0u; i < mesh.sub_meshes.size(); ++i) {
+			encode_wedges(mesh.sub_meshes[i].wedges, this->wedges[i]);
+		}
+	}
+
+	void CompactMultiResolutionMesh::decode(MultiResolutionMesh& mesh) const {
+		ZKTRACE_SCOPE("mesh", "CompactMultiResolutionMesh.decode");
+
+		mesh.positions.resize(this->positions.size());
+		decode_positions(this->quantization, this->positions.data(), this->positions.size(), mesh.positions.data());
+
+		mesh.normals.resize(this->normals.size());
+		decode_normals(this->normals.data(), this->normals.size(), mesh.normals.data());
+
+		if (mesh.sub_meshes.size() < this->wedges.size()) mesh.sub_meshes.resize(this->wedges.size());
+		for (auto i = 0u; i < this->wedges.size(); ++i) {
+			decode_wedges(this->wedges[i], mesh.sub_meshes[i].wedges);
+		}
+	}
+
+	void CompactSoftSkinMesh::encode(SoftSkinMesh const& mesh) {
+		ZKTRACE_SCOPE("mesh", "CompactSoftSkinMesh.encode");
+		this->mesh.encode(mesh.mesh);
+
+		glm::vec3 normals[CHUNK_SIZE];
+		CompactNormal compact_normals[CHUNK_SIZE];
+
+		this->wedge_normals.resize(mesh.wedge_normals.size());
+		for (std::size_t i = 0; i < mesh.wedge_normals.size(); i += CHUNK_SIZE) {
+			auto count = std::min(CHUNK_SIZE, mesh.wedge_normals.size() - i);
+
+			for (auto j = 0u; j < count; ++j) {
+				normals[j] = mesh.wedge_normals[i + j].normal;
+			}
+
+			encode_normals(normals, count, compact_normals);
+
+			for (auto j = 0u; j < count; ++j) {
+				this->wedge_normals[i + j] = CompactWedgeNormal {compact_normals[j], mesh.wedge_normals[i + j].index};
+			}
+		}
+
+		AxisAlignedBoundingBox bbox {glm::vec3 {std::numeric_limits<float>::max()},
+		                             glm::vec3 {std::numeric_limits<float>::lowest()}};
+		for (auto& entries : mesh.weights) {
+			for (auto& entry : entries) {
+				bbox.min = glm::min(bbox.min, entry.position);
+				bbox.max = glm::max(bbox.max, entry.position);
+			}
+		}
+
+		if (bbox.min.x > bbox.max.x) bbox = AxisAlignedBoundingBox::zero();
+
+		this->weight_quantization = PositionQuantization::from_bounds(bbox);
+		this->weights.resize(mesh.weights.size());
+
+		for (auto i = 0u; i < mesh.weights.size(); ++i) {
+			auto& entries = mesh.weights[i];
+			auto& out = this->weights[i];
+			out.resize(entries.size());
+
+			for (auto j = 0u; j < entries.size(); ++j) {
+				auto weight = std::clamp(entries[j].weight, 0.0f, 1.0f) * POSITION_STEPS;
+				out[j].weight = static_cast<std::uint16_t>(std::lrint(weight));
+				out[j].node_index = entries[j].node_index;
+				encode_positions(this->weight_quantization, &entries[j].position, 1, &out[j].position);
+			}
+		}
+	}
+
+	void CompactSoftSkinMesh::decode(SoftSkinMesh& mesh) const {
+		ZKTRACE_SCOPE("mesh", "CompactSoftSkinMesh.decode");
+		this->mesh.decode(mesh.mesh);
+
+		CompactNormal compact_normals[CHUNK_SIZE];
+		glm::vec3 normals[CHUNK_SIZE];
+
+		mesh.wedge_normals.resize(this->wedge_normals.size());
+		for (std::size_t i = 0; i < this->wedge_normals.size(); i += CHUNK_SIZE) {
+			auto count = std::min(CHUNK_SIZE, this->wedge_normals.size() - i);
+
+			for (auto j = 0u; j < count; ++j) {
+				compact_normals[j] = this->wedge_normals[i + j].normal;
+			}
+
+			decode_normals(compact_normals, count, normals);
+
+			for (auto j = 0u; j < count; ++j) {
+				mesh.wedge_normals[i + j] = SoftSkinWedgeNormal {normals[j], this->wedge_normals[i + j].index};
+			}
+		}
+
+		mesh.weights.resize(this->weights.size());
+		for (auto i = 0u; i < this->weights.size(); ++i) {
+			auto& entries = this->weights[i];
+			auto& out = mesh.weights[i];
+			out.resize(entries.size());
+
+			for (auto j = 0u; j < entries.size(); ++j) {
+				out[j].weight = static_cast<float>(entries[j].weight) / POSITION_STEPS;
+				out[j].node_index = entries[j].node_index;
+				decode_positions(this->weight_quantization, &entries[j].position, 1, &out[j].position);
+			}
+		}
+	}
+} // namespace zenkit
@@ -169,7 +169,7 @@ namespace zenkit {
 	}
 
 	Cutscene::Cutscene() {
-		this->block = std::make_shared<CutsceneBlock>();
+		this->block = make_object<CutsceneBlock>();
 	}
 
 	void Cutscene::load(ReadArchive& r, GameVersion version) {
@@ -108,6 +108,9 @@ namespace zenkit {
 	}
 
 	void DaedalusScript::load(Read* r) {
+		ZKSTATS_SCOPE(SCRIPT, "DaedalusScript.load");
+		ZKTRACE_SCOPE("script", "DaedalusScript.load");
+
 		this->_m_version = r->read_ubyte();
 		auto symbol_count = r->read_uint();
 
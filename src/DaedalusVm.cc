@@ -102,6 +102,7 @@ namespace zenkit {
 	}
 
 	void DaedalusVm::unsafe_call(DaedalusSymbol const* sym) {
+		ZKTRACE_SCOPE_DETAIL("script", "DaedalusVm.call_function", sym->name());
 		push_call(sym);
 		jump(sym->address());
 
@@ -1,19 +1,148 @@
 // Copyright © 2023 GothicKit Contributors.
 // SPDX-License-Identifier: MIT
 #pragma once
+#include "zenkit/Allocator.hh"
+#include "zenkit/Library.hh"
 #include "zenkit/Logger.hh"
+#include "zenkit/Stats.hh"
+#include "zenkit/Trace.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/// \brief The most verbose log level compiled into the library. Calls to more verbose ZKLOG* macros are removed
+///        entirely, including the evaluation of their arguments.
+#ifndef ZK_LOG_LEVEL
+	#define ZK_LOG_LEVEL 4
+#endif
 
 #ifndef _MSC_VER
-	#define ZKLOGT(...) zenkit::Logger::log(zenkit::LogLevel::TRACE, __VA_ARGS__)
-	#define ZKLOGD(...) zenkit::Logger::log(zenkit::LogLevel::DEBUG, __VA_ARGS__)
-	#define ZKLOGI(...) zenkit::Logger::log(zenkit::LogLevel::INFO, __VA_ARGS__)
-	#define ZKLOGW(...) zenkit::Logger::log(zenkit::LogLevel::WARNING, __VA_ARGS__)
-	#define ZKLOGE(...) zenkit::Logger::log(zenkit::LogLevel::ERROR, __VA_ARGS__)
+	#define ZKLOG(lvl, ...)                                                                                            \
+		do {                                                                                                           \
+			if constexpr (static_cast<int>(lvl) <= ZK_LOG_LEVEL) {                                                     \
+				if (zenkit::Logger::enabled(lvl)) zenkit::Logger::log(lvl, __VA_ARGS__);                               \
+			}                                                                                                          \
+		} while (false)
+#else
+	#define ZKLOG(lvl, ...)                                                                                            \
+		do {                                                                                                           \
+			if constexpr (static_cast<int>(lvl) <= ZK_LOG_LEVEL) {                                                     \
+				if (zenkit::Logger::enabled(lvl)) zenkit::Logger::log(lvl, ##__VA_ARGS__);                             \
+			}                                                                                                          \
+		} while (false)
+#endif
+
+#define ZKLOGT(...) ZKLOG(zenkit::LogLevel::TRACE, __VA_ARGS__)
+#define ZKLOGD(...) ZKLOG(zenkit::LogLevel::DEBUG, __VA_ARGS__)
+#define ZKLOGI(...) ZKLOG(zenkit::LogLevel::INFO, __VA_ARGS__)
+#define ZKLOGW(...) ZKLOG(zenkit::LogLevel::WARNING, __VA_ARGS__)
+#define ZKLOGE(...) ZKLOG(zenkit::LogLevel::ERROR, __VA_ARGS__)
+
+/// \brief Instrumentation macros for zenkit::Stats, which compile to nothing unless ZenKit is built with statistics.
+#ifdef ZK_WITH_STATS
+	#define ZKSTATS_SCOPE(subsystem, name)                                                                             \
+		zenkit::StatsScope _zk_stats_scope {zenkit::StatsSubsystem::subsystem, name}
+	#define ZKSTATS_OBJECT(type) zenkit::stats_record_object(type)
+	#define ZKSTATS_READ(backend, len) zenkit::stats_record_read(zenkit::StatsReadBackend::backend, len)
 #else
-	#define ZKLOGT(...) zenkit::Logger::log(zenkit::LogLevel::TRACE, ##__VA_ARGS__)
-	#define ZKLOGD(...) zenkit::Logger::log(zenkit::LogLevel::DEBUG, ##__VA_ARGS__)
-	#define ZKLOGI(...) zenkit::Logger::log(zenkit::LogLevel::INFO, ##__VA_ARGS__)
-	#define ZKLOGW(...) zenkit::Logger::log(zenkit::LogLevel::WARNING, ##__VA_ARGS__)
-	#define ZKLOGE(...) zenkit::Logger::log(zenkit::LogLevel::ERROR, ##__VA_ARGS__)
+	#define ZKSTATS_SCOPE(subsystem, name) static_cast<void>(0)
+	#define ZKSTATS_OBJECT(type) static_cast<void>(0)
+	#define ZKSTATS_READ(backend, len) static_cast<void>(0)
+#endif
+
+/// \brief Records a zenkit::TraceEvent for the rest of the enclosing scope while tracing is active.
+#define ZKTRACE_SCOPE(category, name) zenkit::TraceScope _zk_trace_scope {category, name}
+
+/// \brief Like ZKTRACE_SCOPE but also records \p text, which is only evaluated while tracing is active. The text is
+///        not copied until the scope ends, so it must outlive the enclosing scope.
+#define ZKTRACE_SCOPE_DETAIL(category, name, text)                                                                     \
+	zenkit::TraceScope _zk_trace_scope {category, name};                                                               \
+	if (_zk_trace_scope.active()) _zk_trace_scope.detail(text)
+
+namespace zenkit {
+	ZKINT extern std::atomic_bool zk_trace_active;
+
+	/// \brief Records a zenkit::TraceEvent spanning its lifetime if tracing was active when it was created.
+	///
+	/// All members are trivially destructible, so while tracing is inactive a scope only costs the check of
+	/// zk_trace_active when it is entered and the check of that result when it is left.
+	class TraceScope {
+	public:
+		TraceScope(char const* category, char const* name) noexcept {
+			if (zk_trace_active.load(std::memory_order_relaxed)) {
+				_m_category = category;
+				_m_name = name;
+				_m_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		~TraceScope() noexcept {
+			if (_m_name != nullptr) this->record();
+		}
+
+		TraceScope(TraceScope const&) = delete;
+		TraceScope& operator=(TraceScope const&) = delete;
+
+		[[nodiscard]] bool active() const noexcept {
+			return _m_name != nullptr;
+		}
+
+		/// \brief Sets the detail text of the event. \p detail must outlive this scope.
+		void detail(std::string_view detail) noexcept {
+			_m_detail = detail;
+		}
+
+	private:
+		ZKINT void record() noexcept;
+
+		char const* _m_category {nullptr};
+		char const* _m_name {nullptr};
+		std::string_view _m_detail {};
+		std::chrono::steady_clock::time_point _m_start {};
+	};
+
+#ifdef ZK_WITH_STATS
+	/// \brief Measures the time spent in a parser section and attributes allocations made on the calling thread to
+	///        its subsystem while it is alive.
+	class StatsScope {
+	public:
+		ZKINT StatsScope(StatsSubsystem subsystem, char const* name) noexcept;
+		ZKINT ~StatsScope() noexcept;
+
+		StatsScope(StatsScope const&) = delete;
+		StatsScope& operator=(StatsScope const&) = delete;
+
+	private:
+		char const* _m_name;
+		StatsSubsystem _m_subsystem;
+		int _m_previous;
+		std::chrono::steady_clock::time_point _m_start;
+	};
+
+	ZKINT void stats_record_object(ObjectType type) noexcept;
+	ZKINT void stats_record_read(StatsReadBackend backend, std::size_t len) noexcept;
 #endif
+
+	/// \brief Creates an object using the memory resource of the current zenkit::MemoryResourceScope, if any.
+	template <typename T, typename... Args>
+	std::shared_ptr<T> make_object(Args&&... args) {
+		if (auto* resource = MemoryResourceScope::current(); resource != nullptr) {
+			return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T> {resource}, std::forward<Args>(args)...);
+		}
+
+		return std::make_shared<T>(std::forward<Args>(args)...);
+	}
+
+	/// \brief Calls \p fn for every index in `[0, count)` on up to \p threads threads, including the calling thread.
+	/// \note \p fn must not throw.
+	ZKINT void parallel_for(std::size_t count, unsigned threads, std::function<void(std::size_t)> const& fn);
+
+	/// \return The number of threads to use for parallel work if \p threads is `0`, otherwise \p threads.
+	ZKINT unsigned default_thread_count(unsigned threads = 0) noexcept;
+} // namespace zenkit
@@ -18,41 +18,56 @@
 #define PREFIX "[" ANSI_MAGENTA ANSI_BOLD "ZenKit" ANSI_RESET "]"
 
 namespace zenkit {
-	static char zk_global_logger_buffer[4096];
+	// Each thread formats into its own buffer so that logging does not require synchronization.
+	static thread_local char zk_logger_buffer[4096];
 
 	std::function<void(LogLevel, char const*, char const*)> Logger::_s_callback {};
-	LogLevel Logger::_s_level {LogLevel::INFO};
+	std::atomic_int Logger::_s_threshold {-1};
 
 	ZKINT static void zk_internal_logger_default(LogLevel level, char const* name, char const* message) {
 		time_t now_t = time(nullptr);
-		tm* now = gmtime(&now_t);
+		tm now {};
 
-		fprintf(stderr,
-		        ANSI_GRAY "%04d-%02d-%02d %02d:%02d:%02d " ANSI_RESET,
-		        now->tm_year + 1900,
-		        now->tm_mon + 1,
-		        now->tm_mday,
-		        now->tm_hour,
-		        now->tm_min,
-		        now->tm_sec);
+#ifdef _WIN32
+		gmtime_s(&now, &now_t);
+#else
+		gmtime_r(&now_t, &now);
+#endif
 
+		char const* label = "";
 		switch (level) {
 		case LogLevel::ERROR:
-			fprintf(stderr, PREFIX " (" ANSI_RED "ERROR  " ANSI_RESET ") › %s: %s\n", name, message);
+			label = ANSI_RED "ERROR  " ANSI_RESET;
 			break;
 		case LogLevel::WARNING:
-			fprintf(stderr, PREFIX " (" ANSI_YELLOW "WARNING" ANSI_RESET ") › %s: %s\n", name, message);
+			label = ANSI_YELLOW "WARNING" ANSI_RESET;
 			break;
 		case LogLevel::INFO:
-			fprintf(stderr, PREFIX " (" ANSI_BLUE "INFO   " ANSI_RESET ") › %s: %s\n", name, message);
+			label = ANSI_BLUE "INFO   " ANSI_RESET;
 			break;
 		case LogLevel::DEBUG:
-			fprintf(stderr, PREFIX " (" ANSI_GREEN "DEBUG  " ANSI_RESET ") › %s: %s\n", name, message);
+			label = ANSI_GREEN "DEBUG  " ANSI_RESET;
 			break;
 		case LogLevel::TRACE:
-			fprintf(stderr, PREFIX " (TRACE  ) › %s: %s\n", name, message);
+			label = "TRACE  ";
 			break;
 		}
+
+		// Write the whole line at once so that lines logged by different threads are not interleaved.
+		static thread_local char line[sizeof zk_logger_buffer + 256];
+		snprintf(line,
+		         sizeof line,
+		         ANSI_GRAY "%04d-%02d-%02d %02d:%02d:%02d " ANSI_RESET PREFIX " (%s) › %s: %s\n",
+		         now.tm_year + 1900,
+		         now.tm_mon + 1,
+		         now.tm_mday,
+		         now.tm_hour,
+		         now.tm_min,
+		         now.tm_sec,
+		         label,
+		         name,
+		         message);
+		fputs(line, stderr);
 	}
 
 	void Logger::use_logger(std::function<void(LogLevel, std::string const&)>&& callback) {
@@ -73,19 +88,21 @@ namespace zenkit {
 	}
 
 	void Logger::logv(LogLevel lvl, char const* name, char const* fmt, va_list ap) {
-		if (!_s_callback) return;
-		if (lvl > _s_level) return;
-		vsnprintf(zk_global_logger_buffer, sizeof zk_global_logger_buffer - 1, fmt, ap);
-		_s_callback(lvl, name, zk_global_logger_buffer);
+		if (!enabled(lvl)) return;
+		vsnprintf(zk_logger_buffer, sizeof zk_logger_buffer, fmt, ap);
+		_s_callback(lvl, name, zk_logger_buffer);
 	}
 
 	void Logger::set(LogLevel lvl, std::function<void(LogLevel, char const*, char const*)> const& cb) {
-		_s_level = lvl;
 		_s_callback = cb;
+		_s_threshold = _s_callback ? static_cast<int>(lvl) : -1;
 	}
 
 	void Logger::set_default(LogLevel lvl) {
-		_s_level = lvl;
-		_s_callback = zk_internal_logger_default;
+		set(lvl, zk_internal_logger_default);
+	}
+
+	bool Logger::enabled(LogLevel lvl) noexcept {
+		return static_cast<int>(lvl) <= _s_threshold.load(std::memory_order_relaxed);
 	}
 } // namespace zenkit
@@ -4,6 +4,8 @@
 #include "zenkit/Archive.hh"
 #include "zenkit/Stream.hh"
 
+#include "Internal.hh"
+
 #include <algorithm>
 
 namespace zenkit {
@@ -43,6 +45,9 @@ namespace zenkit {
 	}
 
 	void Mesh::load(Read* r, std::vector<std::uint32_t> const& leaf_polygons, bool force_wide_indices) {
+		ZKSTATS_SCOPE(MESH, "Mesh.load");
+		ZKTRACE_SCOPE("mesh", "Mesh.load");
+
 		this->load(r, force_wide_indices);
 		this->triangulate(leaf_polygons);
 	}
@@ -157,7 +162,7 @@ namespace zenkit {
 				    lightmap_textures.resize(texture_count);
 
 				    for (std::uint32_t i = 0; i < texture_count; ++i) {
-					    lightmap_textures[i] = std::make_shared<Texture>();
+					    lightmap_textures[i] = make_object<Texture>();
 					    lightmap_textures[i]->load(c);
 				    }
 
@@ -185,9 +190,8 @@ namespace zenkit {
 					    Texture lightmap_texture {};
 					    lightmap_texture.load(c);
 
-					    this->lightmaps.emplace_back(LightMap {std::make_shared<Texture>(std::move(lightmap_texture)),
-					                                           {normal_a, normal_b},
-					                                           origin});
+					    this->lightmaps.emplace_back(
+					        LightMap {make_object<Texture>(std::move(lightmap_texture)), {normal_a, normal_b}, origin});
 				    }
 
 				    break;
@@ -5,7 +5,10 @@
 #include "Internal.hh"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <thread>
+#include <vector>
 
 namespace zenkit {
 	bool iequals(std::string_view a, std::string_view b) {
@@ -19,4 +22,30 @@ namespace zenkit {
 			return std::tolower(c1) < std::tolower(c2);
 		});
 	}
+
+	void parallel_for(size_t count, unsigned threads, std::function<void(size_t)> const& fn) {
+		std::atomic_size_t next {0};
+		auto worker = [count, &fn, &next] {
+			for (auto i = next++; i < count; i = next++) {
+				fn(i);
+			}
+		};
+
+		std::vector<std::thread> pool {};
+		auto thread_count = std::min<size_t>(default_thread_count(threads), count);
+		for (size_t i = 1; i < thread_count; ++i) {
+			pool.emplace_back(worker);
+		}
+
+		worker();
+
+		for (auto& thread : pool) {
+			thread.join();
+		}
+	}
+
+	unsigned default_thread_count(unsigned threads) noexcept {
+		if (threads != 0) return threads;
+		return std::max(std::thread::hardware_concurrency(), 1u);
+	}
 } // namespace zenkit
@@ -3,6 +3,8 @@
 #include "zenkit/Model.hh"
 #include "zenkit/Stream.hh"
 
+#include "Internal.hh"
+
 namespace zenkit {
 	Model Model::parse(phoenix::buffer& buf) {
 		Model tmp {};
@@ -14,6 +16,9 @@ namespace zenkit {
 	}
 
 	void Model::load(Read* r) {
+		ZKSTATS_SCOPE(MODEL, "Model.load");
+		ZKTRACE_SCOPE("model", "Model.load");
+
 		this->hierarchy.load(r);
 		this->mesh.load(r);
 	}
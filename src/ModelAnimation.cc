@@ -1,10 +1,15 @@
 // Copyright © 2021-2023 GothicKit Contributors.
 // SPDX-License-Identifier: MIT
 #include "zenkit/ModelAnimation.hh"
+#include "zenkit/Error.hh"
 #include "zenkit/Stream.hh"
 
 #include "phoenix/buffer.hh"
 
+#include "Internal.hh"
+
+#include <algorithm>
+#include <array>
 #include <cmath>
 
 namespace zenkit {
@@ -25,6 +30,21 @@ namespace zenkit {
 		SAMPLES = 0xa090u,
 	};
 
+	enum class CompressedAnimationChunkType : std::uint16_t {
+		HEADER = 0xa120u,
+		TRACKS = 0xa190u,
+		END = 0xa1ffu,
+	};
+
+	/// \brief The largest magnitude of the three smallest components of a unit quaternion.
+	constexpr float COMPRESSED_ROTATION_RANGE = 0.707106781f;
+
+	/// \brief The largest value of a 15-bit quantized rotation component.
+	constexpr float COMPRESSED_ROTATION_STEPS = static_cast<float>((1 << 15) - 1);
+
+	/// \brief The largest value of a 16-bit quantized position component.
+	constexpr float COMPRESSED_POSITION_STEPS = static_cast<float>((1 << 16) - 1);
+
 	/// \brief Reads the position of a single animation sample from the given buffer.
 	/// \param r The stream to read from.
 	/// \param scale The scaling factor to apply (taken from the animation's header).
@@ -83,6 +103,9 @@ namespace zenkit {
 	}
 
 	void ModelAnimation::load(Read* r) {
+		ZKSTATS_SCOPE(MODEL, "ModelAnimation.load");
+		ZKTRACE_SCOPE("model", "ModelAnimation.load");
+
 		proto::read_chunked<AnimationChunkType>(r, "ModelAnimation", [this](Read* c, AnimationChunkType type) {
 			switch (type) {
 			case AnimationChunkType::MARKER:
@@ -148,4 +171,456 @@ namespace zenkit {
 			return false;
 		});
 	}
+
+	static float quat_component(glm::quat const& q, int i) noexcept {
+		return i == 0 ? q.x : i == 1 ? q.y : i == 2 ? q.z : q.w;
+	}
+
+	static glm::quat quat_nlerp(glm::quat const& a, glm::quat const& b, float t) noexcept {
+		auto sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0 ? -1.0f : 1.0f;
+
+		glm::quat r {};
+		r.x = a.x + (b.x * sign - a.x) * t;
+		r.y = a.y + (b.y * sign - a.y) * t;
+		r.z = a.z + (b.z * sign - a.z) * t;
+		r.w = a.w + (b.w * sign - a.w) * t;
+
+		auto len = std::sqrt(r.x * r.x + r.y * r.y + r.z * r.z + r.w * r.w);
+		if (len > 0) {
+			r.x /= len;
+			r.y /= len;
+			r.z /= len;
+			r.w /= len;
+		}
+
+		return r;
+	}
+
+	/// \brief Calculates the largest component-wise difference of two rotations, ignoring the sign of the quaternion.
+	static float quat_error(glm::quat const& a, glm::quat const& b) noexcept {
+		float pos = 0, neg = 0;
+		for (int i = 0; i < 4; ++i) {
+			pos = std::max(pos, std::abs(quat_component(a, i) - quat_component(b, i)));
+			neg = std::max(neg, std::abs(quat_component(a, i) + quat_component(b, i)));
+		}
+		return std::min(pos, neg);
+	}
+
+	/// \brief Encodes a unit quaternion using the "smallest three" method.
+	///
+	/// The largest component is dropped and the remaining three are quantized to 15 bits each. The index of the
+	/// dropped component is stored in the lowest bit of the first two values.
+	static void quat_encode(glm::quat const& q, std::uint16_t* out) noexcept {
+		int largest = 0;
+		for (int i = 1; i < 4; ++i) {
+			if (std::abs(quat_component(q, i)) > std::abs(quat_component(q, largest))) largest = i;
+		}
+
+		auto sign = quat_component(q, largest) < 0 ? -1.0f : 1.0f;
+		for (int i = 0, j = 0; i < 4; ++i) {
+			if (i == largest) continue;
+
+			auto v = (quat_component(q, i) * sign + COMPRESSED_ROTATION_RANGE) / (2 * COMPRESSED_ROTATION_RANGE);
+			auto u = static_cast<std::uint16_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * COMPRESSED_ROTATION_STEPS));
+			out[j] = static_cast<std::uint16_t>(u << 1 | (j < 2 ? (largest >> j) & 1 : 0));
+			++j;
+		}
+	}
+
+	static glm::quat quat_decode(std::uint16_t const* in) noexcept {
+		auto largest = (in[0] & 1) | (in[1] & 1) << 1;
+
+		float c[4];
+		float sum = 0;
+		for (int i = 0, j = 0; i < 4; ++i) {
+			if (i == largest) continue;
+
+			auto v = static_cast<float>(in[j++] >> 1) / COMPRESSED_ROTATION_STEPS;
+			c[i] = v * 2 * COMPRESSED_ROTATION_RANGE - COMPRESSED_ROTATION_RANGE;
+			sum += c[i] * c[i];
+		}
+
+		c[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+
+		glm::quat q {};
+		q.x = c[0];
+		q.y = c[1];
+		q.z = c[2];
+		q.w = c[3];
+		return q;
+	}
+
+	/// \brief Selects the keys of a track which can not be linearly interpolated from their neighbours.
+	/// \param values The samples of the track in each frame as they are decoded after compression.
+	/// \param reference The original samples of the track in each frame.
+	/// \param tolerance The maximum error allowed between an interpolated and an original sample.
+	/// \param keys Receives the frames to keep.
+	template <typename T, typename Lerp, typename Err>
+	static void reduce_keys(std::vector<T> const& values,
+	                        std::vector<T> const& reference,
+	                        float tolerance,
+	                        Lerp lerp,
+	                        Err err,
+	                        std::vector<std::uint32_t>& keys) {
+		keys.clear();
+		keys.push_back(0);
+
+		// Constant tracks only need a single key.
+		auto constant = std::all_of(reference.begin(), reference.end(), [&](T const& v) {
+			return err(values[0], v) <= tolerance;
+		});
+		if (constant || values.size() == 1) return;
+
+		auto fits = [&](std::uint32_t start, std::uint32_t end) {
+			auto span = static_cast<float>(end - start);
+			for (auto i = start + 1; i < end; ++i) {
+				auto t = static_cast<float>(i - start) / span;
+				if (err(lerp(values[start], values[end], t), reference[i]) > tolerance) return false;
+			}
+			return true;
+		};
+
+		auto last = static_cast<std::uint32_t>(values.size() - 1);
+		for (std::uint32_t start = 0; start < last;) {
+			auto end = start + 1;
+			while (end < last && fits(start, end + 1)) {
+				++end;
+			}
+
+			keys.push_back(end);
+			start = end;
+		}
+	}
+
+	CompressedModelAnimation CompressedModelAnimation::compress(ModelAnimation const& anim,
+	                                                            AnimationCompressionSettings const& settings) {
+		if (anim.frame_count > 0xFFFF) {
+			throw Error {"CompressedModelAnimation: animations with more than 65535 frames are not supported"};
+		}
+
+		CompressedModelAnimation ca {};
+		ca.name = anim.name;
+		ca.next = anim.next;
+		ca.layer = anim.layer;
+		ca.frame_count = anim.frame_count;
+		ca.node_count = anim.node_count;
+		ca.fps = anim.fps;
+		ca.fps_source = anim.fps_source;
+		ca.bbox = anim.bbox;
+		ca.checksum = anim.checksum;
+		ca.node_indices = anim.node_indices;
+
+		if (anim.samples.size() < static_cast<std::size_t>(anim.frame_count) * anim.node_count) {
+			ca.frame_count = 0;
+		}
+
+		ca._m_position_tracks.resize(ca.node_count);
+		ca._m_position_ranges.resize(ca.node_count);
+		ca._m_rotation_tracks.resize(ca.node_count);
+
+		std::vector<glm::vec3> positions(ca.frame_count);
+		std::vector<glm::quat> rotations(ca.frame_count);
+		std::vector<std::array<std::uint16_t, 3>> quantized_positions(ca.frame_count);
+		std::vector<std::array<std::uint16_t, 3>> quantized_rotations(ca.frame_count);
+		std::vector<glm::vec3> decoded_positions(ca.frame_count);
+		std::vector<glm::quat> decoded_rotations(ca.frame_count);
+		std::vector<std::uint32_t> keys;
+
+		auto position_lerp = [](glm::vec3 const& a, glm::vec3 const& b, float t) { return a + (b - a) * t; };
+		auto position_error = [](glm::vec3 const& a, glm::vec3 const& b) {
+			auto d = a - b;
+			return std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+		};
+
+		for (auto node = 0u; node < ca.node_count && ca.frame_count > 0; ++node) {
+			auto tolerance =
+			    node < settings.node_tolerances.size() ? settings.node_tolerances[node] : settings.tolerance;
+
+			for (auto f = 0u; f < ca.frame_count; ++f) {
+				auto& sample = anim.samples[static_cast<std::size_t>(f) * ca.node_count + node];
+				positions[f] = sample.position;
+				rotations[f] = sample.rotation;
+			}
+
+			// Positions are quantized relative to the extents of the track. The keys are selected using the
+			// quantized values, so that the tolerance also covers the quantization error.
+			auto& range = ca._m_position_ranges[node];
+			auto max = positions[0];
+			range.min = positions[0];
+			for (auto& p : positions) {
+				range.min =
+				    glm::vec3 {std::min(range.min.x, p.x), std::min(range.min.y, p.y), std::min(range.min.z, p.z)};
+				max = glm::vec3 {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+			}
+			range.scale = (max - range.min) / COMPRESSED_POSITION_STEPS;
+
+			for (auto f = 0u; f < ca.frame_count; ++f) {
+				auto* q = quantized_positions[f].data();
+				for (int i = 0; i < 3; ++i) {
+					auto v = range.scale[i] > 0 ? (positions[f][i] - range.min[i]) / range.scale[i] : 0.0f;
+					q[i] = static_cast<std::uint16_t>(std::lround(std::clamp(v, 0.0f, COMPRESSED_POSITION_STEPS)));
+				}
+
+				// This must match the decoding in sample_position.
+				auto qv = glm::vec3 {static_cast<float>(q[0]), static_cast<float>(q[1]), static_cast<float>(q[2])};
+				decoded_positions[f] = range.min + qv * range.scale;
+			}
+
+			reduce_keys(decoded_positions, positions, tolerance.position, position_lerp, position_error, keys);
+
+			ca._m_position_tracks[node] = Track {static_cast<std::uint32_t>(ca._m_frames.size()),
+			                                     static_cast<std::uint32_t>(keys.size())};
+			for (auto k : keys) {
+				ca._m_frames.push_back(static_cast<std::uint16_t>(k));
+				ca._m_values.insert(ca._m_values.end(), quantized_positions[k].begin(), quantized_positions[k].end());
+			}
+
+			for (auto f = 0u; f < ca.frame_count; ++f) {
+				quat_encode(rotations[f], quantized_rotations[f].data());
+				decoded_rotations[f] = quat_decode(quantized_rotations[f].data());
+			}
+
+			reduce_keys(decoded_rotations, rotations, tolerance.rotation, quat_nlerp, quat_error, keys);
+
+			ca._m_rotation_tracks[node] = Track {static_cast<std::uint32_t>(ca._m_frames.size()),
+			                                     static_cast<std::uint32_t>(keys.size())};
+			for (auto k : keys) {
+				ca._m_frames.push_back(static_cast<std::uint16_t>(k));
+				ca._m_values.insert(ca._m_values.end(), quantized_rotations[k].begin(), quantized_rotations[k].end());
+			}
+		}
+
+		ca._m_frames.shrink_to_fit();
+		ca._m_values.shrink_to_fit();
+		return ca;
+	}
+
+	/// \brief Finds the keys surrounding the given frame in a track.
+	/// \return The index of the first key and the interpolation factor towards the next one.
+	static std::pair<std::uint32_t, float>
+	find_keys(std::uint16_t const* frames, std::uint32_t count, float frame) noexcept {
+		auto it = std::upper_bound(frames, frames + count, frame, [](float f, std::uint16_t k) {
+			return f < static_cast<float>(k);
+		});
+
+		auto next = static_cast<std::uint32_t>(it - frames);
+		if (next == 0) return {0, 0.0f};
+		if (next >= count) return {count - 1, 0.0f};
+
+		auto prev = next - 1;
+		auto t = (frame - frames[prev]) / static_cast<float>(frames[next] - frames[prev]);
+		return {prev, t};
+	}
+
+	glm::vec3 CompressedModelAnimation::sample_position(std::uint32_t node, float frame) const noexcept {
+		auto& track = _m_position_tracks[node];
+		auto& range = _m_position_ranges[node];
+		if (track.key_count == 0) return glm::vec3 {};
+
+		auto [key, t] = find_keys(_m_frames.data() + track.first_key, track.key_count, frame);
+
+		auto decode = [&](std::uint32_t k) {
+			auto* v = _m_values.data() + static_cast<std::size_t>(track.first_key + k) * 3;
+			auto q = glm::vec3 {static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2])};
+			return range.min + q * range.scale;
+		};
+
+		auto a = decode(key);
+		if (t <= 0.0f) return a;
+		return a + (decode(key + 1) - a) * t;
+	}
+
+	glm::quat CompressedModelAnimation::sample_rotation(std::uint32_t node, float frame) const noexcept {
+		auto& track = _m_rotation_tracks[node];
+		if (track.key_count == 0) return glm::quat {1, 0, 0, 0};
+
+		auto [key, t] = find_keys(_m_frames.data() + track.first_key, track.key_count, frame);
+
+		auto* v = _m_values.data() + static_cast<std::size_t>(track.first_key + key) * 3;
+		auto a = quat_decode(v);
+		if (t <= 0.0f) return a;
+		return quat_nlerp(a, quat_decode(v + 3), t);
+	}
+
+	AnimationSample CompressedModelAnimation::sample(std::uint32_t node, float frame) const noexcept {
+		if (node >= _m_position_tracks.size() || frame_count == 0) {
+			return AnimationSample {glm::vec3 {}, glm::quat {1, 0, 0, 0}};
+		}
+
+		frame = frame >= 0.0f ? std::min(frame, static_cast<float>(frame_count - 1)) : 0.0f;
+		return AnimationSample {sample_position(node, frame), sample_rotation(node, frame)};
+	}
+
+	void CompressedModelAnimation::sample(float frame, AnimationSample* out) const noexcept {
+		for (auto i = 0u; i < node_count; ++i) {
+			out[i] = this->sample(i, frame);
+		}
+	}
+
+	std::vector<AnimationSample> CompressedModelAnimation::decompress() const {
+		std::vector<AnimationSample> samples(static_cast<std::size_t>(frame_count) * node_count);
+
+		for (auto f = 0u; f < frame_count; ++f) {
+			this->sample(static_cast<float>(f), samples.data() + static_cast<std::size_t>(f) * node_count);
+		}
+
+		return samples;
+	}
+
+	std::size_t CompressedModelAnimation::key_count() const noexcept {
+		return _m_frames.size();
+	}
+
+	std::size_t CompressedModelAnimation::size_bytes() const noexcept {
+		return _m_position_tracks.capacity() * sizeof(Track) + _m_rotation_tracks.capacity() * sizeof(Track) +
+		    _m_position_ranges.capacity() * sizeof(PositionRange) + _m_frames.capacity() * sizeof(std::uint16_t) +
+		    _m_values.capacity() * sizeof(std::uint16_t) + node_indices.capacity() * sizeof(std::uint32_t);
+	}
+
+	/// \return The number of bytes between the current position of the reader and the end of its data.
+	static std::size_t remaining_bytes(Read* r) noexcept {
+		auto pos = r->tell();
+		r->seek(0, Whence::END);
+		auto end = r->tell();
+		r->seek(static_cast<ssize_t>(pos), Whence::BEG);
+		return end > pos ? end - pos : 0;
+	}
+
+	void CompressedModelAnimation::load(Read* r) {
+		// Tracks may only reference existing keys and their frames must be strictly increasing.
+		auto is_valid_track = [this](Track const& track) {
+			if (static_cast<std::uint64_t>(track.first_key) + track.key_count > _m_frames.size()) return false;
+
+			for (auto i = 1u; i < track.key_count; ++i) {
+				if (_m_frames[track.first_key + i - 1] >= _m_frames[track.first_key + i]) return false;
+			}
+
+			return true;
+		};
+
+		proto::read_chunked<CompressedAnimationChunkType>(
+		    r,
+		    "CompressedModelAnimation",
+		    [this, &is_valid_track](Read* c, CompressedAnimationChunkType type) {
+			    switch (type) {
+			    case CompressedAnimationChunkType::HEADER:
+				    (void) /* version = */ c->read_ushort();
+				    this->name = c->read_line(false);
+				    this->next = c->read_line(false);
+				    this->layer = c->read_uint();
+				    this->frame_count = c->read_uint();
+				    this->node_count = c->read_uint();
+				    this->fps = c->read_float();
+				    this->fps_source = c->read_float();
+				    this->bbox.load(c);
+				    this->checksum = c->read_uint();
+
+				    if (static_cast<std::uint64_t>(this->node_count) * 4 > remaining_bytes(c)) {
+					    throw ParserError {"CompressedModelAnimation", "node count exceeds the available data"};
+				    }
+
+				    this->node_indices.resize(this->node_count);
+				    for (auto& i : this->node_indices) {
+					    i = c->read_uint();
+				    }
+				    break;
+			    case CompressedAnimationChunkType::TRACKS: {
+				    // Each node stores two tracks of 8 bytes and a position range of 24 bytes.
+				    if (static_cast<std::uint64_t>(this->node_count) * 40 > remaining_bytes(c)) {
+					    throw ParserError {"CompressedModelAnimation", "node count exceeds the available data"};
+				    }
+
+				    this->_m_position_tracks.resize(this->node_count);
+				    this->_m_position_ranges.resize(this->node_count);
+				    this->_m_rotation_tracks.resize(this->node_count);
+
+				    for (auto i = 0u; i < this->node_count; ++i) {
+					    this->_m_position_tracks[i].first_key = c->read_uint();
+					    this->_m_position_tracks[i].key_count = c->read_uint();
+					    this->_m_position_ranges[i].min = c->read_vec3();
+					    this->_m_position_ranges[i].scale = c->read_vec3();
+					    this->_m_rotation_tracks[i].first_key = c->read_uint();
+					    this->_m_rotation_tracks[i].key_count = c->read_uint();
+				    }
+
+				    // Each key stores its frame and three values of 2 bytes each.
+				    auto key_count = c->read_uint();
+				    if (static_cast<std::uint64_t>(key_count) * 8 > remaining_bytes(c)) {
+					    throw ParserError {"CompressedModelAnimation", "key count exceeds the available data"};
+				    }
+
+				    this->_m_frames.resize(key_count);
+				    for (auto& frame : this->_m_frames) {
+					    frame = c->read_ushort();
+				    }
+
+				    this->_m_values.resize(this->_m_frames.size() * 3);
+				    for (auto& value : this->_m_values) {
+					    value = c->read_ushort();
+				    }
+
+				    for (auto i = 0u; i < this->node_count; ++i) {
+					    if (!is_valid_track(this->_m_position_tracks[i]) ||
+					        !is_valid_track(this->_m_rotation_tracks[i])) {
+						    throw ParserError {"CompressedModelAnimation",
+						                       "invalid track for node #" + std::to_string(i)};
+					    }
+				    }
+				    break;
+			    }
+			    case CompressedAnimationChunkType::END:
+				    return true;
+			    default:
+				    break;
+			    }
+
+			    return false;
+		    });
+
+		// A header following the tracks may change the node count after the tracks have been read.
+		if (this->_m_position_tracks.size() != this->node_count || this->node_indices.size() != this->node_count) {
+			throw ParserError {"CompressedModelAnimation", "node count does not match the number of tracks"};
+		}
+	}
+
+	void CompressedModelAnimation::save(Write* w) const {
+		proto::write_chunk(w, CompressedAnimationChunkType::HEADER, [this](Write* c) {
+			c->write_ushort(0x01);
+			c->write_line(this->name);
+			c->write_line(this->next);
+			c->write_uint(this->layer);
+			c->write_uint(this->frame_count);
+			c->write_uint(this->node_count);
+			c->write_float(this->fps);
+			c->write_float(this->fps_source);
+			this->bbox.save(c);
+			c->write_uint(this->checksum);
+
+			for (auto i = 0u; i < this->node_count; ++i) {
+				c->write_uint(i < this->node_indices.size() ? this->node_indices[i] : 0);
+			}
+		});
+
+		proto::write_chunk(w, CompressedAnimationChunkType::TRACKS, [this](Write* c) {
+			for (auto i = 0u; i < this->node_count; ++i) {
+				c->write_uint(this->_m_position_tracks[i].first_key);
+				c->write_uint(this->_m_position_tracks[i].key_count);
+				c->write_vec3(this->_m_position_ranges[i].min);
+				c->write_vec3(this->_m_position_ranges[i].scale);
+				c->write_uint(this->_m_rotation_tracks[i].first_key);
+				c->write_uint(this->_m_rotation_tracks[i].key_count);
+			}
+
+			c->write_uint(static_cast<std::uint32_t>(this->_m_frames.size()));
+			for (auto frame : this->_m_frames) {
+				c->write_ushort(frame);
+			}
+
+			for (auto value : this->_m_values) {
+				c->write_ushort(value);
+			}
+		});
+
+		proto::write_chunk(w, CompressedAnimationChunkType::END, [](Write*) {});
+	}
 } // namespace zenkit
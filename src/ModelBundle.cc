@@ -0,0 +1,298 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/ModelBundle.hh"
+#include "zenkit/Misc.hh"
+#include "zenkit/Model.hh"
+#include "zenkit/ModelAnimation.hh"
+#include "zenkit/ModelScript.hh"
+#include "zenkit/Stream.hh"
+#include "zenkit/Texture.hh"
+#include "zenkit/Vfs.hh"
+
+#include "Internal.hh"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <unordered_set>
+
+namespace zenkit {
+	using LoadTask = std::function<void()>;
+
+	static void run_parallel(std::vector<LoadTask> const& tasks, unsigned threads) {
+		parallel_for(tasks.size(), threads, [&tasks](size_t i) { tasks[i](); });
+	}
+
+	/// \brief A set of files of the same type to load concurrently, de-duplicated by their Vfs node.
+	template <typename T>
+	struct AssetSet {
+		std::unordered_map<VfsNode const*, size_t> index {};
+		std::vector<VfsNode const*> nodes {};
+		std::vector<std::shared_ptr<T>> assets {};
+		std::vector<std::string> errors {};
+
+		size_t add(VfsNode const* node) {
+			auto [it, inserted] = index.try_emplace(node, nodes.size());
+			if (inserted) nodes.push_back(node);
+			return it->second;
+		}
+
+		void schedule(std::vector<LoadTask>& tasks) {
+			auto begin = assets.size();
+			assets.resize(nodes.size());
+			errors.resize(nodes.size());
+
+			for (auto i = begin; i < nodes.size(); ++i) {
+				tasks.emplace_back([this, i] {
+					try {
+						auto r = nodes[i]->open_read();
+						auto asset = std::make_shared<T>();
+						asset->load(r.get());
+						assets[i] = std::move(asset);
+					} catch (std::exception const& e) {
+						// Errors are only reported once all tasks have completed to keep logging single-threaded.
+						errors[i] = e.what();
+					}
+				});
+			}
+		}
+
+		std::shared_ptr<T> get(size_t i, std::vector<std::string>& missing) const {
+			if (assets[i] == nullptr) {
+				missing.push_back(nodes[i]->name());
+			}
+
+			return assets[i];
+		}
+
+		void report() const {
+			for (auto i = 0u; i < errors.size(); ++i) {
+				if (errors[i].empty()) continue;
+				ZKLOGE("ModelBundleLoader", "Failed to load %s: %s", nodes[i]->name().c_str(), errors[i].c_str());
+			}
+		}
+	};
+
+	static constexpr size_t NO_ASSET = static_cast<size_t>(-1);
+
+	/// \brief The indices of all assets of a single model into the shared asset sets.
+	struct BundleRequest {
+		size_t script {NO_ASSET};
+		size_t model {NO_ASSET};
+		size_t hierarchy {NO_ASSET};
+		std::vector<std::pair<std::string, size_t>> meshes {};
+		std::vector<std::pair<std::string, size_t>> animations {};
+		std::vector<std::pair<std::string, size_t>> textures {};
+	};
+
+	static std::string_view file_stem(std::string_view name) {
+		auto dot = name.rfind('.');
+		return dot == std::string_view::npos ? name : name.substr(0, dot);
+	}
+
+	static std::string_view file_extension(std::string_view name) {
+		auto dot = name.rfind('.');
+		return dot == std::string_view::npos ? std::string_view {} : name.substr(dot + 1);
+	}
+
+	static VfsNode const* find_file(Vfs const& vfs, std::string_view stem, std::string_view ext) {
+		std::string name {stem};
+		name += ext;
+
+		auto* node = vfs.find(name);
+		return node != nullptr && node->type() == VfsNodeType::FILE ? node : nullptr;
+	}
+
+	ModelBundleLoader::ModelBundleLoader(Vfs const& vfs, unsigned threads)
+	    : _m_vfs(&vfs), _m_threads(default_thread_count(threads)) {}
+
+	ModelBundle ModelBundleLoader::load(std::string_view name) const {
+		return std::move(this->load(std::vector<std::string> {std::string {name}}).front());
+	}
+
+	std::vector<ModelBundle> ModelBundleLoader::load(std::vector<std::string> const& names) const {
+		std::vector<ModelBundle> bundles(names.size());
+		std::vector<BundleRequest> requests(names.size());
+
+		AssetSet<ModelScript> scripts {};
+		AssetSet<Model> models {};
+		AssetSet<ModelHierarchy> hierarchies {};
+		AssetSet<ModelMesh> meshes {};
+		AssetSet<ModelAnimation> animations {};
+		AssetSet<Texture> textures {};
+
+		// Stage 1: Model scripts and models.
+		for (auto i = 0u; i < names.size(); ++i) {
+			auto& bundle = bundles[i];
+			auto& request = requests[i];
+			auto stem = file_stem(names[i]);
+			auto ext = file_extension(names[i]);
+
+			bundle.name = names[i];
+
+			if (!iequals(ext, "MDL")) {
+				// Prefer the compiled version of the script.
+				auto* node = find_file(*_m_vfs, stem, ".MSB");
+				if (node == nullptr) node = find_file(*_m_vfs, stem, ".MDS");
+
+				if (node != nullptr) {
+					request.script = scripts.add(node);
+					continue;
+				}
+			}
+
+			if (ext.empty() || iequals(ext, "MDL")) {
+				if (auto* node = find_file(*_m_vfs, stem, ".MDL"); node != nullptr) {
+					request.model = models.add(node);
+					continue;
+				}
+			}
+
+			bundle.missing.push_back(names[i]);
+		}
+
+		std::vector<LoadTask> tasks {};
+		scripts.schedule(tasks);
+		models.schedule(tasks);
+		run_parallel(tasks, _m_threads);
+		tasks.clear();
+
+		// Models are split into their hierarchy and mesh so that they can be shared like all other assets.
+		std::vector<std::shared_ptr<ModelHierarchy const>> model_hierarchies(models.nodes.size());
+		std::vector<std::shared_ptr<ModelMesh const>> model_meshes(models.nodes.size());
+		for (auto i = 0u; i < models.nodes.size(); ++i) {
+			if (models.assets[i] == nullptr) continue;
+			model_hierarchies[i] = std::make_shared<ModelHierarchy const>(std::move(models.assets[i]->hierarchy));
+			model_meshes[i] = std::make_shared<ModelMesh const>(std::move(models.assets[i]->mesh));
+		}
+
+		// Stage 2: Hierarchies, meshes and animations referenced by model scripts.
+		for (auto i = 0u; i < names.size(); ++i) {
+			auto& bundle = bundles[i];
+			auto& request = requests[i];
+
+			if (request.model != NO_ASSET) {
+				if (models.get(request.model, bundle.missing) != nullptr) {
+					bundle.hierarchy = model_hierarchies[request.model];
+					bundle.meshes.emplace(models.nodes[request.model]->name(), model_meshes[request.model]);
+				}
+				continue;
+			}
+
+			if (request.script == NO_ASSET) continue;
+
+			bundle.script = scripts.get(request.script, bundle.missing);
+			if (bundle.script == nullptr) continue;
+
+			auto add_mesh = [&](std::string_view mesh) {
+				auto mesh_stem = file_stem(mesh);
+				if (auto* node = find_file(*_m_vfs, mesh_stem, ".MDM"); node != nullptr) {
+					request.meshes.emplace_back(node->name(), meshes.add(node));
+				} else {
+					bundle.missing.push_back(std::string {mesh_stem} + ".MDM");
+				}
+			};
+
+			auto& skeleton = bundle.script->skeleton;
+			if (!skeleton.name.empty()) {
+				auto skeleton_stem = file_stem(skeleton.name);
+				if (auto* node = find_file(*_m_vfs, skeleton_stem, ".MDH"); node != nullptr) {
+					request.hierarchy = hierarchies.add(node);
+				} else {
+					bundle.missing.push_back(std::string {skeleton_stem} + ".MDH");
+				}
+
+				if (!skeleton.disable_mesh) add_mesh(skeleton.name);
+			}
+
+			for (auto& mesh : bundle.script->meshes) {
+				add_mesh(mesh);
+			}
+
+			// Animations are stored as `<script>-<animation>.MAN`.
+			std::unordered_set<std::string_view> seen {};
+			auto prefix = std::string {file_stem(names[i])} + "-";
+			for (auto& ani : bundle.script->animations) {
+				if (!seen.insert(ani.name).second) continue;
+
+				if (auto* node = find_file(*_m_vfs, prefix + ani.name, ".MAN"); node != nullptr) {
+					request.animations.emplace_back(ani.name, animations.add(node));
+				} else {
+					bundle.missing.push_back(prefix + ani.name + ".MAN");
+				}
+			}
+		}
+
+		hierarchies.schedule(tasks);
+		meshes.schedule(tasks);
+		animations.schedule(tasks);
+		run_parallel(tasks, _m_threads);
+		tasks.clear();
+
+		// Stage 3: Textures referenced by the materials of all meshes.
+		for (auto i = 0u; i < names.size(); ++i) {
+			auto& bundle = bundles[i];
+			auto& request = requests[i];
+
+			if (request.hierarchy != NO_ASSET) {
+				bundle.hierarchy = hierarchies.get(request.hierarchy, bundle.missing);
+			}
+
+			for (auto& [name, index] : request.meshes) {
+				if (auto mesh = meshes.get(index, bundle.missing); mesh != nullptr) {
+					bundle.meshes.emplace(name, std::move(mesh));
+				}
+			}
+
+			for (auto& [name, index] : request.animations) {
+				if (auto ani = animations.get(index, bundle.missing); ani != nullptr) {
+					bundle.animations.emplace(name, std::move(ani));
+				}
+			}
+
+			std::unordered_set<std::string> seen {};
+			auto add_materials = [&](std::vector<Material> const& materials) {
+				for (auto& material : materials) {
+					if (material.texture.empty() || !seen.insert(material.texture).second) continue;
+
+					// Compiled textures are stored as `<name>-C.TEX`.
+					auto texture_stem = std::string {file_stem(material.texture)} + "-C";
+					if (auto* node = find_file(*_m_vfs, texture_stem, ".TEX"); node != nullptr) {
+						request.textures.emplace_back(material.texture, textures.add(node));
+					} else {
+						bundle.missing.push_back(texture_stem + ".TEX");
+					}
+				}
+			};
+
+			for (auto& [name, mesh] : bundle.meshes) {
+				for (auto& softskin : mesh->meshes) {
+					add_materials(softskin.mesh.materials);
+				}
+
+				for (auto& [attachment_name, attachment] : mesh->attachments) {
+					add_materials(attachment.materials);
+				}
+			}
+		}
+
+		textures.schedule(tasks);
+		run_parallel(tasks, _m_threads);
+
+		for (auto i = 0u; i < names.size(); ++i) {
+			for (auto& [name, index] : requests[i].textures) {
+				if (auto texture = textures.get(index, bundles[i].missing); texture != nullptr) {
+					bundles[i].textures.emplace(name, std::move(texture));
+				}
+			}
+		}
+
+		scripts.report();
+		models.report();
+		hierarchies.report();
+		meshes.report();
+		animations.report();
+		textures.report();
+		return bundles;
+	}
+} // namespace zenkit
@@ -26,6 +26,9 @@ namespace zenkit {
 	}
 
 	void ModelHierarchy::load(Read* r) {
+		ZKSTATS_SCOPE(MODEL, "ModelHierarchy.load");
+		ZKTRACE_SCOPE("model", "ModelHierarchy.load");
+
 		proto::read_chunked<ModelHierarchyChunkType>( //
 		    r,
 		    "ModelHierarchy",
@@ -4,6 +4,8 @@
 #include "zenkit/Date.hh"
 #include "zenkit/Stream.hh"
 
+#include "Internal.hh"
+
 namespace zenkit {
 	static constexpr uint32_t VERSION_G1 = 0x04030506;
 	static constexpr uint32_t VERSION_G2 = 0x04030506;
@@ -27,6 +29,9 @@ namespace zenkit {
 	}
 
 	void ModelMesh::load(Read* r) {
+		ZKSTATS_SCOPE(MODEL, "ModelMesh.load");
+		ZKTRACE_SCOPE("model", "ModelMesh.load");
+
 		std::vector<std::string> attachment_names {};
 		proto::read_chunked<ModelMeshChunkType>(
 		    r,
@@ -7,6 +7,10 @@
 #include "Internal.hh"
 #include "ModelScriptDsl.hh"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
 #include <unordered_map>
 
 namespace zenkit {
@@ -15,12 +19,12 @@ namespace zenkit {
 		ROOT = 0xF000,
 		END = 0xFFFF,
 		SOURCE = 0xF100,
-		// model = 0xF200,
-		// model_end = 0xF2FF,
+		MODEL = 0xF200,
+		MODEL_END = 0xF2FF,
 		MESH_AND_TREE = 0xF300,
 		REGISTER_MESH = 0xF400,
-		// animation_enum = 0xF500,
-		// animation_enum_end = 0xF5FF,
+		ANIMATION_ENUM = 0xF500,
+		ANIMATION_ENUM_END = 0xF5FF,
 		// CHUNK_ANI_MAX_FPS           = 0xF510,
 		ANIMATION = 0xF520,
 		ANIMATION_ALIAS = 0xF530,
@@ -31,7 +35,7 @@ namespace zenkit {
 		ANIMATION_DISABLE = 0xF580,
 		MODEL_TAG = 0xF590,
 		ANIMATION_EVENTS = 0xF5A0,
-		// animation_events_end = 0xF5AF,
+		ANIMATION_EVENTS_END = 0xF5AF,
 		EVENT_SFX = 0xF5A1,
 		EVENT_SFX_GROUND = 0xF5A2,
 		EVENT_TAG = 0xF5A3,
@@ -176,6 +180,91 @@ namespace zenkit {
 
 			return flags;
 		}
+
+		std::string animation_flags_to_string(AnimationFlags flags) {
+			std::string str {};
+			if (flags & AnimationFlags::MOVE) str.push_back('M');
+			if (flags & AnimationFlags::ROTATE) str.push_back('R');
+			if (flags & AnimationFlags::QUEUE) str.push_back('E');
+			if (flags & AnimationFlags::FLY) str.push_back('F');
+			if (flags & AnimationFlags::IDLE) str.push_back('I');
+			if (flags & AnimationFlags::INPLACE) str.push_back('P');
+
+			// NOTE: The original implementation writes a single dot if no flags are set.
+			if (str.empty()) str.push_back('.');
+			return str;
+		}
+
+		std::string_view event_type_to_string(MdsEventType type) {
+			switch (type) {
+			case MdsEventType::ITEM_CREATE:
+				return "DEF_CREATE_ITEM";
+			case MdsEventType::ITEM_INSERT:
+				return "DEF_INSERT_ITEM";
+			case MdsEventType::ITEM_REMOVE:
+				return "DEF_REMOVE_ITEM";
+			case MdsEventType::ITEM_DESTROY:
+				return "DEF_DESTROY_ITEM";
+			case MdsEventType::ITEM_PLACE:
+				return "DEF_PLACE_ITEM";
+			case MdsEventType::ITEM_EXCHANGE:
+				return "DEF_EXCHANGE_ITEM";
+			case MdsEventType::SET_FIGHT_MODE:
+				return "DEF_FIGHTMODE";
+			case MdsEventType::MUNITION_PLACE:
+				return "DEF_PLACE_MUNITION";
+			case MdsEventType::MUNITION_REMOVE:
+				return "DEF_REMOVE_MUNITION";
+			case MdsEventType::SOUND_DRAW:
+				return "DEF_DRAWSOUND";
+			case MdsEventType::SOUND_UNDRAW:
+				return "DEF_UNDRAWSOUND";
+			case MdsEventType::MESH_SWAP:
+				return "DEF_SWAPMESH";
+			case MdsEventType::TORCH_DRAW:
+				return "DEF_DRAWTORCH";
+			case MdsEventType::TORCH_INVENTORY:
+				return "DEF_INV_TORCH";
+			case MdsEventType::TORCH_DROP:
+				return "DEF_DROP_TORCH";
+			case MdsEventType::HIT_LIMB:
+				return "DEF_HIT_LIMB";
+			case MdsEventType::HIT_DIRECTION:
+				return "DEF_HIT_DIR";
+			case MdsEventType::DAMAGE_MULTIPLIER:
+				return "DEF_DAM_MULTIPLY";
+			case MdsEventType::PARRY_FRAME:
+				return "DEF_PAR_FRAME";
+			case MdsEventType::OPTIMAL_FRAME:
+				return "DEF_OPT_FRAME";
+			case MdsEventType::HIT_END:
+				return "DEF_HIT_END";
+			case MdsEventType::COMBO_WINDOW:
+				return "DEF_WINDOW";
+			case MdsEventType::UNKNOWN:
+			default:
+				return "";
+			}
+		}
+
+		std::string_view fight_mode_to_string(MdsFightMode mode) {
+			switch (mode) {
+			case MdsFightMode::FIST:
+				return "FIST";
+			case MdsFightMode::SINGLE_HANDED:
+				return "1H";
+			case MdsFightMode::DUAL_HANDED:
+				return "2H";
+			case MdsFightMode::BOW:
+				return "BOW";
+			case MdsFightMode::CROSSBOW:
+				return "CBOW";
+			case MdsFightMode::MAGIC:
+				return "MAG";
+			default:
+				return "";
+			}
+		}
 	} // namespace mds
 
 	void parse_binary_script(ModelScript& script, Read* r) {
@@ -296,82 +385,23 @@ namespace zenkit {
 				    break;
 			    }
 			    case ModelScriptBinaryChunkType::EVENT_TAG: {
-				    MdsEventTag event {};
-				    event.frame = c->read_int();
-
+				    auto frame = c->read_int();
 				    auto event_type = c->read_line(false);
-				    if (auto tp = event_types.find(event_type); tp == event_types.end()) {
-					    event.type = MdsEventType::UNKNOWN;
-					    ZKLOGW("ModelScript", "Unexpected value for MdsEventType: \"%s\"", event_type.c_str());
-				    } else {
-					    event.type = tp->second;
-				    }
 
-				    switch (event.type) {
-				    case MdsEventType::ITEM_CREATE:
-				    case MdsEventType::ITEM_EXCHANGE:
-					    event.slot = c->read_line(true);
-					    event.item = c->read_line(true);
-					    break;
-				    case MdsEventType::ITEM_INSERT:
-				    case MdsEventType::MUNITION_PLACE:
-					    event.slot = c->read_line(true);
-					    break;
-				    case MdsEventType::SET_FIGHT_MODE: {
-					    if (auto mode = c->read_line(true); mode == "FIST") {
-						    event.fight_mode = MdsFightMode::FIST;
-					    } else if (mode == "1H" || mode == "1h") {
-						    event.fight_mode = MdsFightMode::SINGLE_HANDED;
-					    } else if (mode == "2H" || mode == "2h") {
-						    event.fight_mode = MdsFightMode::DUAL_HANDED;
-					    } else if (mode == "BOW") {
-						    event.fight_mode = MdsFightMode::BOW;
-					    } else if (mode == "CBOW") {
-						    event.fight_mode = MdsFightMode::CROSSBOW;
-					    } else if (mode == "MAG") {
-						    event.fight_mode = MdsFightMode::MAGIC;
-					    } else {
-						    event.fight_mode = MdsFightMode::NONE;
-					    }
-					    break;
-				    }
-				    case MdsEventType::MESH_SWAP:
-					    event.slot = c->read_line(true);
-					    event.slot2 = c->read_line(true);
-					    break;
-				    case MdsEventType::HIT_LIMB:
-					    (void) c->read_line(true); // TODO
-					    break;
-				    case MdsEventType::HIT_DIRECTION:
-					    (void) c->read_line(true); // TODO
-					    break;
-				    case MdsEventType::SOUND_DRAW:
-				    case MdsEventType::SOUND_UNDRAW:
-				    case MdsEventType::MUNITION_REMOVE:
-				    case MdsEventType::ITEM_DESTROY:
-				    case MdsEventType::TORCH_INVENTORY:
-				    case MdsEventType::ITEM_REMOVE:
-					    (void) c->read_line(true); // TODO
-					    break;
-				    case MdsEventType::DAMAGE_MULTIPLIER:
-				    case MdsEventType::PARRY_FRAME:
-				    case MdsEventType::OPTIMAL_FRAME:
-				    case MdsEventType::HIT_END:
-				    case MdsEventType::COMBO_WINDOW: {
-					    auto frames = c->read_line(true);
-					    std::istringstream stream {frames};
-
-					    int32_t frame = 0;
-					    while (!stream.eof()) {
-						    stream >> frame;
-						    event.frames.push_back(frame);
-					    }
-					    break;
-				    }
-				    default:
-					    break;
+				    // The values are stored as up to four lines, the meaning of which depends on the event type.
+				    // Unused lines are left empty and "ATTACH" occupies the first free line, if set.
+				    std::optional<std::string> values[4] {};
+				    bool attached = false;
+				    for (auto i = 0u; i < 4 && !c->eof(); ++i) {
+					    values[i] = c->read_line(false);
+					    attached = attached || values[i] == "ATTACH";
 				    }
 
+				    auto event = mds::make_event_tag(frame,
+				                                     std::move(event_type),
+				                                     std::move(values[0]),
+				                                     std::move(values[1]),
+				                                     attached);
 				    script.animations[ani_index].events.push_back(std::move(event));
 				    break;
 			    }
@@ -413,11 +443,11 @@ namespace zenkit {
 				    (void) c->read_line(false); // path
 				    break;
 			    }
-				    // case ModelScriptBinaryChunkType::model:
-				    // case ModelScriptBinaryChunkType::animation_enum:
-				    // case ModelScriptBinaryChunkType::animation_events_end:
-				    // case ModelScriptBinaryChunkType::animation_enum_end:
-				    // case ModelScriptBinaryChunkType::model_end:
+			    case ModelScriptBinaryChunkType::MODEL:
+			    case ModelScriptBinaryChunkType::ANIMATION_ENUM:
+			    case ModelScriptBinaryChunkType::ANIMATION_EVENTS_END:
+			    case ModelScriptBinaryChunkType::ANIMATION_ENUM_END:
+			    case ModelScriptBinaryChunkType::MODEL_END:
 			    case ModelScriptBinaryChunkType::END:
 				    // empty
 				    break;
@@ -466,6 +496,406 @@ namespace zenkit {
 		p.parse_script(*this);
 	}
 
+	static void write_event_tag(Write* w, MdsEventTag const& evt) {
+		std::vector<std::string> values {};
+
+		switch (evt.type) {
+		case MdsEventType::ITEM_CREATE:
+		case MdsEventType::ITEM_EXCHANGE:
+			values.push_back(evt.slot);
+			values.push_back(evt.item);
+			break;
+		case MdsEventType::ITEM_INSERT:
+		case MdsEventType::MUNITION_PLACE:
+			values.push_back(evt.slot);
+			break;
+		case MdsEventType::SET_FIGHT_MODE:
+			values.emplace_back(mds::fight_mode_to_string(evt.fight_mode));
+			break;
+		case MdsEventType::MESH_SWAP:
+			values.push_back(evt.slot);
+			values.push_back(evt.slot2);
+			break;
+		case MdsEventType::DAMAGE_MULTIPLIER:
+		case MdsEventType::PARRY_FRAME:
+		case MdsEventType::OPTIMAL_FRAME:
+		case MdsEventType::HIT_END:
+		case MdsEventType::COMBO_WINDOW: {
+			std::string frames {};
+			for (auto frame : evt.frames) {
+				if (!frames.empty()) frames.push_back(' ');
+				frames += std::to_string(frame);
+			}
+
+			values.push_back(std::move(frames));
+			break;
+		}
+		default:
+			break;
+		}
+
+		if (evt.attached) values.emplace_back("ATTACH");
+		values.resize(std::max<size_t>(values.size(), 4));
+
+		w->write_int(evt.frame);
+		w->write_line(mds::event_type_to_string(evt.type));
+		for (auto& value : values) {
+			w->write_line(value);
+		}
+	}
+
+	static void write_animation_events(Write* w, MdsAnimation const& ani) {
+		auto count = ani.events.size() + ani.pfx.size() + ani.pfx_stop.size() + ani.sfx.size() +
+		    ani.sfx_ground.size() + ani.morph.size() + ani.tremors.size();
+		if (count == 0) return;
+
+		proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION_EVENTS, [count](Write* c) {
+			c->write_uint(static_cast<uint32_t>(count));
+		});
+
+		for (auto& evt : ani.events) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::EVENT_TAG, [&evt](Write* c) { write_event_tag(c, evt); });
+		}
+
+		for (auto& sfx : ani.sfx) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::EVENT_SFX, [&sfx](Write* c) {
+				c->write_int(sfx.frame);
+				c->write_line(sfx.name);
+				c->write_float(sfx.range);
+				c->write_uint(sfx.empty_slot);
+			});
+		}
+
+		for (auto& sfx : ani.sfx_ground) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::EVENT_SFX_GROUND, [&sfx](Write* c) {
+				c->write_int(sfx.frame);
+				c->write_line(sfx.name);
+				c->write_float(sfx.range);
+				c->write_uint(sfx.empty_slot);
+			});
+		}
+
+		for (auto& pfx : ani.pfx) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::EVENT_PFX, [&pfx](Write* c) {
+				c->write_int(pfx.frame);
+				c->write_int(pfx.index);
+				c->write_line(pfx.name);
+				c->write_line(pfx.position);
+				c->write_uint(pfx.attached);
+			});
+		}
+
+		for (auto& pfx : ani.pfx_stop) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::EVENT_PFX_STOP, [&pfx](Write* c) {
+				c->write_int(pfx.frame);
+				c->write_int(pfx.index);
+			});
+		}
+
+		for (auto& mm : ani.morph) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::EVENT_MM_ANI, [&mm](Write* c) {
+				c->write_int(mm.frame);
+				c->write_line(mm.animation);
+				c->write_line(mm.node);
+				c->write_float(0);
+				c->write_float(0);
+			});
+		}
+
+		for (auto& trem : ani.tremors) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::EVENT_CAMERA_TREMOR, [&trem](Write* c) {
+				c->write_int(trem.frame);
+				c->write_int(trem.field1);
+				c->write_int(trem.field2);
+				c->write_int(trem.field3);
+				c->write_int(trem.field4);
+			});
+		}
+
+		proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION_EVENTS_END, [](Write*) {});
+	}
+
+	void ModelScript::save(Write* w) const {
+		proto::write_chunk(w, ModelScriptBinaryChunkType::ROOT, [](Write* c) {
+			c->write_uint(1);
+			c->write_line("");
+		});
+
+		proto::write_chunk(w, ModelScriptBinaryChunkType::MODEL, [](Write*) {});
+		proto::write_chunk(w, ModelScriptBinaryChunkType::MESH_AND_TREE, [this](Write* c) {
+			c->write_uint(this->skeleton.disable_mesh);
+			c->write_line(this->skeleton.name);
+		});
+
+		for (auto& mesh : this->meshes) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::REGISTER_MESH, [&mesh](Write* c) {
+				c->write_line(mesh);
+			});
+		}
+
+		proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION_ENUM, [](Write*) {});
+
+		for (auto& ani : this->animations) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION, [&ani](Write* c) {
+				c->write_line(ani.name);
+				c->write_uint(ani.layer);
+				c->write_line(ani.next);
+				c->write_float(ani.blend_in);
+				c->write_float(ani.blend_out);
+				c->write_line(mds::animation_flags_to_string(ani.flags));
+				c->write_line(ani.model);
+				c->write_line(ani.direction == AnimationDirection::BACKWARD ? "R" : "F");
+				c->write_int(ani.first_frame);
+				c->write_int(ani.last_frame);
+				c->write_float(ani.fps);
+				c->write_float(ani.speed);
+				c->write_float(ani.collision_volume_scale);
+			});
+
+			write_animation_events(w, ani);
+		}
+
+		for (auto& alias : this->aliases) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION_ALIAS, [&alias](Write* c) {
+				c->write_line(alias.name);
+				c->write_uint(alias.layer);
+				c->write_line(alias.next);
+				c->write_float(alias.blend_in);
+				c->write_float(alias.blend_out);
+				c->write_line(mds::animation_flags_to_string(alias.flags));
+				c->write_line(alias.alias);
+				c->write_line(alias.direction == AnimationDirection::BACKWARD ? "R" : "F");
+			});
+		}
+
+		for (auto& blend : this->blends) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION_BLEND, [&blend](Write* c) {
+				c->write_line(blend.name);
+				c->write_line(blend.next);
+				c->write_float(blend.blend_in);
+				c->write_float(blend.blend_out);
+			});
+		}
+
+		for (auto& combo : this->combinations) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION_COMBINE, [&combo](Write* c) {
+				c->write_line(combo.name);
+				c->write_uint(combo.layer);
+				c->write_line(combo.next);
+				c->write_float(combo.blend_in);
+				c->write_float(combo.blend_out);
+				c->write_line(mds::animation_flags_to_string(combo.flags));
+				c->write_line(combo.model);
+				c->write_int(combo.last_frame);
+			});
+		}
+
+		for (auto& name : this->disabled_animations) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION_DISABLE, [&name](Write* c) {
+				c->write_line(name);
+			});
+		}
+
+		for (auto& tag : this->model_tags) {
+			proto::write_chunk(w, ModelScriptBinaryChunkType::MODEL_TAG, [&tag](Write* c) {
+				c->write_int(0);
+				c->write_line("DEF_HIT_LIMB");
+				c->write_line(tag.bone);
+			});
+		}
+
+		proto::write_chunk(w, ModelScriptBinaryChunkType::ANIMATION_ENUM_END, [](Write*) {});
+		proto::write_chunk(w, ModelScriptBinaryChunkType::MODEL_END, [](Write*) {});
+		proto::write_chunk(w, ModelScriptBinaryChunkType::END, [](Write*) {});
+	}
+
+	void ModelScript::load(Read* r, ModelScriptCache* cache) {
+		ZKSTATS_SCOPE(MODEL, "ModelScript.load");
+		ZKTRACE_SCOPE("model", "ModelScript.load");
+
+		if (cache == nullptr) {
+			this->load(r);
+			return;
+		}
+
+		auto potential_chunk_type = r->read_ushort();
+		r->seek(-2, Whence::CUR);
+
+		if (potential_chunk_type >= 0xF000 || potential_chunk_type == 0xD000) {
+			this->load_binary(r);
+			return;
+		}
+
+		auto begin = r->tell();
+		r->seek(0, Whence::END);
+		auto end = r->tell();
+		r->seek(static_cast<ssize_t>(begin), Whence::BEG);
+
+		std::string source(end - begin, '\0');
+		source.resize(r->read(source.data(), source.size()));
+
+		auto hash = ModelScriptCache::hash(reinterpret_cast<std::byte const*>(source.data()), source.size());
+		std::vector<std::byte> compiled {};
+
+		if (cache->get(hash, compiled)) {
+			try {
+				auto rd = Read::from(&compiled);
+				this->load_binary(rd.get());
+				return;
+			} catch (std::exception const& e) {
+				ZKLOGW("ModelScriptCache", "Discarding unreadable cache entry: %s", e.what());
+				cache->evict(hash);
+				*this = ModelScript {};
+			}
+		}
+
+		MdsParser p {std::string_view {source}};
+		p.parse_script(*this);
+
+		auto wr = Write::to(&compiled);
+		this->save(wr.get());
+		wr.reset();
+
+		cache->put(hash, std::move(compiled));
+	}
+
+	ModelScriptCache::ModelScriptCache(std::filesystem::path directory) : _m_directory(std::move(directory)) {
+		std::error_code ec;
+		std::filesystem::create_directories(_m_directory, ec);
+
+		if (ec) {
+			ZKLOGW("ModelScriptCache", "Failed to create cache directory: %s", ec.message().c_str());
+		}
+	}
+
+	/// \brief The version of the on-disk cache entry format. Entries of other versions are ignored.
+	static constexpr std::uint32_t CACHE_VERSION = 1;
+
+	static std::filesystem::path cache_entry_path(std::filesystem::path const& directory, uint64_t hash) {
+		char name[48];
+		std::snprintf(name,
+		              sizeof name,
+		              "%016llx.v%u.msb",
+		              static_cast<unsigned long long>(hash),
+		              static_cast<unsigned>(CACHE_VERSION));
+		return directory / name;
+	}
+
+	bool ModelScriptCache::get(uint64_t hash, std::vector<std::byte>& out) {
+		std::lock_guard lock {_m_lock};
+
+		if (auto it = _m_entries.find(hash); it != _m_entries.end()) {
+			out = it->second;
+			_m_hits += 1;
+			return true;
+		}
+
+		if (!_m_directory.empty()) {
+			auto path = cache_entry_path(_m_directory, hash);
+			std::ifstream in {path, std::ios::binary | std::ios::ate};
+
+			if (in) {
+				// Entries start with their version, size and checksum, so that truncated or otherwise damaged
+				// entries are detected before they are parsed.
+				auto length = static_cast<size_t>(in.tellg());
+				in.seekg(0);
+
+				uint64_t header[3] {};
+				auto valid = length >= sizeof header && in.read(reinterpret_cast<char*>(header), sizeof header);
+
+				if (valid && header[0] == CACHE_VERSION && header[1] == length - sizeof header) {
+					out.resize(length - sizeof header);
+					valid = in.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(out.size())) &&
+					    header[2] == ModelScriptCache::hash(out.data(), out.size());
+				} else {
+					valid = false;
+				}
+
+				if (valid) {
+					_m_entries.emplace(hash, out);
+					_m_hits += 1;
+					return true;
+				}
+
+				ZKLOGW("ModelScriptCache", "Discarding damaged cache entry %s", path.string().c_str());
+				in.close();
+
+				std::error_code ec;
+				std::filesystem::remove(path, ec);
+			}
+		}
+
+		_m_misses += 1;
+		return false;
+	}
+
+	void ModelScriptCache::put(uint64_t hash, std::vector<std::byte> data) {
+		std::lock_guard lock {_m_lock};
+
+		if (!_m_directory.empty()) {
+			// Write to a temporary file first so that concurrent readers never observe a partial entry. Its name
+			// is unique so that other threads or processes sharing the directory never write to the same file.
+			auto path = cache_entry_path(_m_directory, hash);
+			std::random_device random {};
+			char suffix[32];
+			std::snprintf(suffix, sizeof suffix, ".%08x%08x.tmp", random(), random());
+
+			auto temp = path;
+			temp += suffix;
+
+			uint64_t header[3] {CACHE_VERSION, data.size(), ModelScriptCache::hash(data.data(), data.size())};
+			std::ofstream out {temp, std::ios::binary | std::ios::trunc};
+			out.write(reinterpret_cast<char const*>(header), sizeof header);
+			out.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+			out.close();
+
+			std::error_code ec;
+			if (out) std::filesystem::rename(temp, path, ec);
+
+			if (!out || ec) {
+				ZKLOGW("ModelScriptCache", "Failed to write cache entry %s", path.string().c_str());
+				std::filesystem::remove(temp, ec);
+			}
+		}
+
+		_m_entries.insert_or_assign(hash, std::move(data));
+	}
+
+	void ModelScriptCache::evict(uint64_t hash) {
+		std::lock_guard lock {_m_lock};
+		_m_entries.erase(hash);
+
+		if (!_m_directory.empty()) {
+			std::error_code ec;
+			std::filesystem::remove(cache_entry_path(_m_directory, hash), ec);
+		}
+	}
+
+	void ModelScriptCache::clear() {
+		std::lock_guard lock {_m_lock};
+		_m_entries.clear();
+	}
+
+	size_t ModelScriptCache::hits() const {
+		std::lock_guard lock {_m_lock};
+		return _m_hits;
+	}
+
+	size_t ModelScriptCache::misses() const {
+		std::lock_guard lock {_m_lock};
+		return _m_misses;
+	}
+
+	uint64_t ModelScriptCache::hash(std::byte const* data, size_t size) noexcept {
+		// 64-bit FNV-1a
+		uint64_t hash = 0xcbf29ce484222325;
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= static_cast<uint64_t>(data[i]);
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
 	bool operator&(AnimationFlags a, AnimationFlags b) {
 		return static_cast<bool>(static_cast<uint8_t>(a) & static_cast<uint8_t>(b));
 	}
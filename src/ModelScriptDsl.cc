@@ -5,6 +5,10 @@
 
 #include "zenkit/Stream.hh"
 
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+
 #define WARN_SYNTAX(msg) ZKLOGW("ModelScript", "Syntax error (line %d, column %d): %s", _m_line, _m_column, msg)
 
 namespace zenkit {
@@ -24,14 +28,31 @@ namespace zenkit {
 	constexpr std::string_view token_names[] =
 	    {"KEYWORD", "integer", "float", "string", "rparen", "lparen", "rbrace", "lbrace", "colon", "eof", "null"};
 
-	MdsTokenizer::MdsTokenizer(Read* buf) : _m_buffer(buf), _m_mark(0) {}
+	MdsTokenizer::MdsTokenizer(Read* buf) {
+		auto begin = buf->tell();
+		buf->seek(0, Whence::END);
+		auto end = buf->tell();
+		buf->seek(static_cast<ssize_t>(begin), Whence::BEG);
+
+		_m_owned.resize(end - begin);
+		_m_owned.resize(buf->read(_m_owned.data(), _m_owned.size()));
+		_m_source = _m_owned;
+	}
+
+	MdsTokenizer::MdsTokenizer(std::string_view source) : _m_source(source) {}
+
+	char MdsTokenizer::get() {
+		auto chr = _m_position < _m_source.size() ? _m_source[_m_position] : '\0';
+		_m_position += 1;
+		_m_column += 1;
+		return chr;
+	}
 
 	MdsToken MdsTokenizer::next() {
-		_m_value.clear();
-		while (!_m_buffer->eof()) {
-			_m_mark = _m_buffer->tell();
-			auto chr = static_cast<unsigned char>(_m_buffer->read_char());
-			_m_column += 1;
+		_m_value = {};
+		while (!this->eof()) {
+			_m_mark = _m_position;
+			auto chr = static_cast<unsigned char>(this->get());
 
 			// ignore spaces, quotation marks, semicolons and parentheses
 			// NOTE: Quirk of original implementation: parens are not significant.
@@ -47,13 +68,12 @@ namespace zenkit {
 
 			// ignore comments
 			if (chr == '/') {
-				if (_m_buffer->read_char() != '/') {
+				if (this->get() != '/') {
 					WARN_SYNTAX("comments must start with two slashes");
 				}
 
 				// skip everything until the end of the line
-				while (_m_buffer->read_char() != '\n')
-					_m_column += 1;
+				while (!this->eof() && this->get() != '\n') {}
 
 				_m_line += 1;
 				_m_column = 1;
@@ -63,32 +83,31 @@ namespace zenkit {
 			// parse keywords
 			if (std::isalpha(chr) || chr == '*' || chr == '_' || chr == '.') {
 				do {
-					_m_value.push_back(static_cast<char>(chr));
-					chr = static_cast<unsigned char>(_m_buffer->read_char());
-					_m_column += 1;
+					chr = static_cast<unsigned char>(this->get());
 				} while (std::isalnum(chr) || chr == '_' || chr == '-' || chr == '.');
 
 				// (backtrack one)
-				_m_buffer->seek(-1, Whence::CUR);
+				_m_position -= 1;
 				_m_column -= 1;
 
+				_m_value = _m_source.substr(_m_mark, _m_position - _m_mark);
 				return MdsToken::KEYWORD;
 			}
 
 			// parse strings
 			if (chr == '"') {
-				chr = static_cast<unsigned char>(_m_buffer->read_char());
-				_m_column += 1;
+				auto begin = _m_position;
+				chr = static_cast<unsigned char>(this->get());
 
-				while (chr != '"' && chr != '\n' && chr != ')') {
-					_m_value.push_back(static_cast<char>(chr));
-					chr = static_cast<unsigned char>(_m_buffer->read_char());
-					_m_column += 1;
+				while (chr != '"' && chr != '\n' && chr != ')' && chr != '\0') {
+					chr = static_cast<unsigned char>(this->get());
 				}
 
+				_m_value = _m_source.substr(begin, _m_position - begin - 1);
+
 				if (chr != '"') {
 					WARN_SYNTAX("String not terminated");
-					_m_buffer->seek(-1, Whence::CUR);
+					_m_position -= 1;
 					_m_column -= 1;
 				}
 
@@ -100,24 +119,20 @@ namespace zenkit {
 				bool floating_point = false;
 
 				do {
-					_m_value.push_back(static_cast<char>(chr));
-					chr = static_cast<unsigned char>(_m_buffer->read_char());
-					_m_column += 1;
+					chr = static_cast<unsigned char>(this->get());
 
 					// (allow floating point numbers)
 					if (chr == '.') {
 						floating_point = true;
-
-						_m_value.push_back(static_cast<char>(chr));
-						chr = static_cast<unsigned char>(_m_buffer->read_char());
-						_m_column += 1;
+						chr = static_cast<unsigned char>(this->get());
 					}
 				} while (std::isdigit(chr));
 
 				// (backtrack one)
-				_m_buffer->seek(-1, Whence::CUR);
+				_m_position -= 1;
 				_m_column -= 1;
 
+				_m_value = _m_source.substr(_m_mark, _m_position - _m_mark);
 				return floating_point ? MdsToken::FLOAT : MdsToken::INTEGER;
 			}
 
@@ -144,14 +159,14 @@ namespace zenkit {
 	}
 
 	void MdsTokenizer::backtrack() {
-		this->_m_buffer->seek(static_cast<ssize_t>(_m_mark), Whence::BEG);
+		_m_position = _m_mark;
 	}
 
 	bool MdsTokenizer::eof() const {
-		return _m_buffer->eof();
+		return _m_position >= _m_source.size();
 	}
 
-	std::string const& MdsTokenizer::token_value() const {
+	std::string_view MdsTokenizer::token_value() const {
 		return _m_value;
 	}
 
@@ -159,6 +174,34 @@ namespace zenkit {
 
 	MdsParser::MdsParser(Read* buf) : _m_stream(buf) {}
 
+	MdsParser::MdsParser(std::string_view source) : _m_stream(source) {}
+
+	int MdsParser::to_int(std::string_view value) const {
+		int v = 0;
+		auto [end, err] = std::from_chars(value.data(), value.data() + value.size(), v);
+		if (err != std::errc {} || end != value.data() + value.size()) {
+			throw ScriptSyntaxError {_m_stream.format_location(), "invalid integer: " + std::string {value}};
+		}
+
+		return v;
+	}
+
+	float MdsParser::to_float(std::string_view value) const {
+		// std::from_chars is not available for floating point numbers on all supported compilers.
+		char buf[64];
+		auto len = std::min(value.size(), sizeof buf - 1);
+		std::copy_n(value.data(), len, buf);
+		buf[len] = '\0';
+
+		char* end = nullptr;
+		auto v = std::strtof(buf, &end);
+		if (end == buf) {
+			throw ScriptSyntaxError {_m_stream.format_location(), "invalid number: " + std::string {value}};
+		}
+
+		return v;
+	}
+
 	template <MdsToken kind>
 	void MdsParser::expect() {
 		if (!this->maybe<kind>()) {
@@ -169,15 +212,15 @@ namespace zenkit {
 
 	std::string MdsParser::expect_string() {
 		this->expect<MdsToken::STRING>();
-		return _m_stream.token_value();
+		return std::string {_m_stream.token_value()};
 	}
 
-	std::string MdsParser::expect_keyword() {
+	std::string_view MdsParser::expect_keyword() {
 		this->expect<MdsToken::KEYWORD>();
 		return _m_stream.token_value();
 	}
 
-	std::optional<std::string> MdsParser::maybe_keyword() {
+	std::optional<std::string_view> MdsParser::maybe_keyword() {
 		if (this->maybe<MdsToken::KEYWORD>()) return _m_stream.token_value();
 		return std::nullopt;
 	}
@@ -200,7 +243,7 @@ namespace zenkit {
 
 	int MdsParser::expect_int() {
 		this->expect<MdsToken::INTEGER>();
-		return std::stoi(_m_stream.token_value());
+		return this->to_int(_m_stream.token_value());
 	}
 
 	AnimationFlags MdsParser::expect_flags() {
@@ -218,7 +261,7 @@ namespace zenkit {
 			return std::nullopt;
 		}
 
-		if (kw->find("ani") != std::string::npos || kw->find("model") != std::string::npos) {
+		if (kw->find("ani") != std::string_view::npos || kw->find("model") != std::string_view::npos) {
 			this->_m_stream.backtrack();
 			return std::nullopt;
 		}
@@ -244,7 +287,7 @@ namespace zenkit {
 			return std::nullopt;
 		}
 
-		return std::stoi(_m_stream.token_value());
+		return this->to_int(_m_stream.token_value());
 	}
 
 	std::optional<float> MdsParser::maybe_number() {
@@ -254,7 +297,7 @@ namespace zenkit {
 			return std::nullopt;
 		}
 
-		return std::stof(_m_stream.token_value());
+		return this->to_float(_m_stream.token_value());
 	}
 
 	std::optional<std::string> MdsParser::maybe_string() {
@@ -262,7 +305,7 @@ namespace zenkit {
 			return std::nullopt;
 		}
 
-		return _m_stream.token_value();
+		return std::string {_m_stream.token_value()};
 	}
 
 	bool MdsParser::maybe_keyword(std::string_view value) {
@@ -314,8 +357,9 @@ namespace zenkit {
 				this->parse_aniEnum(script);
 			} else {
 				ZKLOGW("ModelScript",
-				       "detected invalid use of KEYWORD \"%s\" in \"Model\" block. Ignoring rest of script.",
-				       kw.c_str());
+				       "detected invalid use of KEYWORD \"%.*s\" in \"Model\" block. Ignoring rest of script.",
+				       static_cast<int>(kw.size()),
+				       kw.data());
 				break;
 			}
 		}
@@ -356,7 +400,7 @@ namespace zenkit {
 			} else if (phoenix::iequals(kw, "modelTag")) {
 				into.model_tags.push_back(this->parse_modelTag());
 			} else {
-				throw ScriptSyntaxError {_m_stream.format_location(), "invalid KEYWORD in \"aniEnum\" block: " + kw};
+				throw ScriptSyntaxError {_m_stream.format_location(), "invalid KEYWORD in \"aniEnum\" block: " + std::string {kw}};
 			}
 		}
 	}
@@ -383,7 +427,7 @@ namespace zenkit {
 			} else if (phoenix::iequals(kw, "*eventCamTremor")) {
 				ani.tremors.push_back(this->parse_eventCamTremor());
 			} else {
-				throw ScriptSyntaxError {_m_stream.format_location(), "invalid KEYWORD in \"ani\" block: " + kw};
+				throw ScriptSyntaxError {_m_stream.format_location(), "invalid KEYWORD in \"ani\" block: " + std::string {kw}};
 			}
 		}
 	}
@@ -23,30 +23,43 @@ namespace zenkit {
 		NOTHING = 10,
 	};
 
+	/// \brief Splits MDS source code into tokens.
+	///
+	/// The tokenizer operates on a single contiguous buffer containing the whole script. Token values are views
+	/// into that buffer and are only valid until the next call to #next.
 	class MdsTokenizer {
 	public:
 		explicit MdsTokenizer(Read* buf);
+		explicit MdsTokenizer(std::string_view source);
+
+		MdsTokenizer(MdsTokenizer const&) = delete;
+		MdsTokenizer& operator=(MdsTokenizer const&) = delete;
 
 		MdsToken next();
 
 		void backtrack();
 
-		[[nodiscard]] std::string const& token_value() const;
+		[[nodiscard]] std::string_view token_value() const;
 
 		[[nodiscard]] bool eof() const;
 
 		[[nodiscard]] std::string format_location() const;
 
 	private:
-		Read* _m_buffer;
+		char get();
+
+		std::string _m_owned;
+		std::string_view _m_source;
+		std::size_t _m_position {0};
 		uint32_t _m_line {1}, _m_column {1};
-		std::string _m_value;
-		std::size_t _m_mark;
+		std::string_view _m_value;
+		std::size_t _m_mark {0};
 	};
 
 	class MdsParser {
 	public:
 		explicit MdsParser(Read* buf);
+		explicit MdsParser(std::string_view source);
 
 		ModelScript parse_script(ModelScript& script);
 		MdsSkeleton parse_meshAndTree();
@@ -77,8 +90,8 @@ namespace zenkit {
 		void expect();
 
 		[[nodiscard]] std::string expect_string();
-		[[nodiscard]] std::string expect_keyword();
-		[[nodiscard]] std::optional<std::string> maybe_keyword();
+		[[nodiscard]] std::string_view expect_keyword();
+		[[nodiscard]] std::optional<std::string_view> maybe_keyword();
 		void expect_keyword(std::string_view value);
 		[[nodiscard]] float expect_number();
 		[[nodiscard]] int expect_int();
@@ -94,6 +107,9 @@ namespace zenkit {
 		[[nodiscard]] bool maybe_keyword(std::string_view value);
 		[[nodiscard]] std::optional<float> maybe_named(std::string_view name);
 
+		[[nodiscard]] int to_int(std::string_view value) const;
+		[[nodiscard]] float to_float(std::string_view value) const;
+
 		MdsTokenizer _m_stream;
 	};
 } // namespace zenkit
@@ -3,6 +3,15 @@
 #include "zenkit/MorphMesh.hh"
 #include "zenkit/Stream.hh"
 
+#include "Internal.hh"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define ZK_MORPH_SSE 1
+#endif
+
 namespace zenkit {
 	enum class MorphMeshChunkType : std::uint16_t {
 		SOURCES = 0xE010,
@@ -26,6 +35,9 @@ namespace zenkit {
 	}
 
 	void MorphMesh::load(Read* r) {
+		ZKSTATS_SCOPE(MESH, "MorphMesh.load");
+		ZKTRACE_SCOPE("mesh", "MorphMesh.load");
+
 		proto::read_chunked<MorphMeshChunkType>(r, "MorphMesh", [this](Read* c, MorphMeshChunkType type) {
 			switch (type) {
 			case MorphMeshChunkType::SOURCES: {
@@ -90,4 +102,159 @@ namespace zenkit {
 			return false;
 		});
 	}
+
+	/// \brief Computes `out[i] += a[i] * wa` for \p n floats.
+	static void accumulate(float* out, float const* a, float wa, std::uint32_t n) noexcept {
+		std::uint32_t i = 0;
+
+#ifdef ZK_MORPH_SSE
+		auto va = _mm_set1_ps(wa);
+		for (; i + 4 <= n; i += 4) {
+			auto o = _mm_loadu_ps(out + i);
+			o = _mm_add_ps(o, _mm_mul_ps(_mm_loadu_ps(a + i), va));
+			_mm_storeu_ps(out + i, o);
+		}
+#endif
+
+		for (; i < n; ++i) {
+			out[i] += a[i] * wa;
+		}
+	}
+
+	/// \brief Computes `out[i] += a[i] * wa + b[i] * wb` for \p n floats.
+	static void accumulate(float* out, float const* a, float wa, float const* b, float wb, std::uint32_t n) noexcept {
+		std::uint32_t i = 0;
+
+#ifdef ZK_MORPH_SSE
+		auto va = _mm_set1_ps(wa);
+		auto vb = _mm_set1_ps(wb);
+		for (; i + 4 <= n; i += 4) {
+			auto o = _mm_loadu_ps(out + i);
+			o = _mm_add_ps(o, _mm_mul_ps(_mm_loadu_ps(a + i), va));
+			o = _mm_add_ps(o, _mm_mul_ps(_mm_loadu_ps(b + i), vb));
+			_mm_storeu_ps(out + i, o);
+		}
+#endif
+
+		for (; i < n; ++i) {
+			out[i] += a[i] * wa + b[i] * wb;
+		}
+	}
+
+	MorphBlender::MorphBlender(MorphMesh const& mesh) {
+		static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+
+		auto mesh_vertex_count = mesh.morph_positions.size();
+		_m_base.resize(mesh_vertex_count * 3);
+		for (auto i = 0u; i < mesh_vertex_count; ++i) {
+			_m_base[i * 3 + 0] = mesh.morph_positions[i].x;
+			_m_base[i * 3 + 1] = mesh.morph_positions[i].y;
+			_m_base[i * 3 + 2] = mesh.morph_positions[i].z;
+		}
+
+		_m_streams.reserve(mesh.animations.size());
+
+		std::vector<std::uint32_t> order;
+		std::vector<std::uint32_t> slots;
+
+		for (auto& anim : mesh.animations) {
+			auto& stream = _m_streams.emplace_back();
+			stream.frame_count = 0;
+			stream.stride = 0;
+
+			auto anim_vertex_count = anim.vertices.size();
+			if (anim_vertex_count == 0 || anim.frame_count == 0 ||
+			    anim.samples.size() < anim_vertex_count * anim.frame_count) {
+				continue;
+			}
+
+			// Sort the affected vertices by their index in the mesh, dropping any invalid ones.
+			order.clear();
+			for (auto i = 0u; i < anim_vertex_count; ++i) {
+				if (anim.vertices[i] < mesh_vertex_count) order.push_back(i);
+			}
+
+			std::stable_sort(order.begin(), order.end(), [&anim](std::uint32_t a, std::uint32_t b) {
+				return anim.vertices[a] < anim.vertices[b];
+			});
+
+			// Assign a slot in the stream to every distinct vertex and merge consecutive vertices into runs.
+			slots.resize(order.size());
+
+			std::uint32_t slot_count = 0;
+			for (auto i = 0u; i < order.size(); ++i) {
+				auto vertex = anim.vertices[order[i]];
+
+				if (i > 0 && anim.vertices[order[i - 1]] == vertex) {
+					slots[i] = slot_count - 1;
+					continue;
+				}
+
+				if (i == 0 || anim.vertices[order[i - 1]] + 1 != vertex) {
+					stream.runs.push_back(Run {vertex * 3, slot_count * 3, 0});
+				}
+
+				stream.runs.back().length += 3;
+				slots[i] = slot_count++;
+			}
+
+			stream.frame_count = anim.frame_count;
+			stream.stride = slot_count * 3;
+			stream.offsets.assign(static_cast<std::size_t>(stream.frame_count) * stream.stride, 0.0f);
+
+			for (auto f = 0u; f < stream.frame_count; ++f) {
+				auto* frame = stream.offsets.data() + static_cast<std::size_t>(f) * stream.stride;
+				auto* samples = anim.samples.data() + static_cast<std::size_t>(f) * anim_vertex_count;
+
+				for (auto i = 0u; i < order.size(); ++i) {
+					auto& sample = samples[order[i]];
+					frame[slots[i] * 3 + 0] += sample.x;
+					frame[slots[i] * 3 + 1] += sample.y;
+					frame[slots[i] * 3 + 2] += sample.z;
+				}
+			}
+		}
+	}
+
+	void MorphBlender::blend(MorphBlend const* blends, std::size_t count, glm::vec3* out) const noexcept {
+		auto* dst = reinterpret_cast<float*>(out);
+		std::copy(_m_base.begin(), _m_base.end(), dst);
+
+		for (auto i = 0u; i < count; ++i) {
+			auto& blend = blends[i];
+			if (blend.animation >= _m_streams.size() || blend.weight == 0.0f) continue;
+
+			auto& stream = _m_streams[blend.animation];
+			if (stream.frame_count == 0) continue;
+
+			auto last = static_cast<float>(stream.frame_count - 1);
+			auto frame = blend.frame >= 0.0f ? std::min(blend.frame, last) : 0.0f;
+
+			auto f0 = static_cast<std::uint32_t>(frame);
+			auto f1 = std::min(f0 + 1, stream.frame_count - 1);
+			auto alpha = frame - static_cast<float>(f0);
+
+			auto* a = stream.offsets.data() + static_cast<std::size_t>(f0) * stream.stride;
+			auto* b = stream.offsets.data() + static_cast<std::size_t>(f1) * stream.stride;
+
+			if (alpha == 0.0f || f0 == f1) {
+				for (auto& run : stream.runs) {
+					accumulate(dst + run.target, a + run.source, blend.weight, run.length);
+				}
+			} else {
+				auto wa = blend.weight * (1.0f - alpha);
+				auto wb = blend.weight * alpha;
+
+				for (auto& run : stream.runs) {
+					accumulate(dst + run.target, a + run.source, wa, b + run.source, wb, run.length);
+				}
+			}
+		}
+	}
+
+	std::vector<glm::vec3> MorphBlender::blend(std::vector<MorphBlend> const& blends) const {
+		std::vector<glm::vec3> out(this->vertex_count());
+		this->blend(blends.data(), blends.size(), out.data());
+		return out;
+	}
 } // namespace zenkit
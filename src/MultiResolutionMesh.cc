@@ -4,6 +4,8 @@
 #include "zenkit/Archive.hh"
 #include "zenkit/Stream.hh"
 
+#include "Internal.hh"
+
 namespace zenkit {
 	[[maybe_unused]] static constexpr auto VERSION_G1 = 0x305;
 	static constexpr auto VERSION_G2 = 0x905;
@@ -24,6 +26,9 @@ namespace zenkit {
 	}
 
 	void MultiResolutionMesh::load(Read* r) {
+		ZKSTATS_SCOPE(MESH, "MultiResolutionMesh.load");
+		ZKTRACE_SCOPE("mesh", "MultiResolutionMesh.load");
+
 		proto::read_chunked<MrmChunkType>(r, "MultiResolutionMesh", [this](Read* c, MrmChunkType type) {
 			switch (type) {
 			case MrmChunkType::MESH:
@@ -8,7 +8,26 @@
 #include "Internal.hh"
 
 #include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <functional>
 #include <set>
+#include <thread>
+
+#if defined(__linux__) && __has_include(<linux/fs.h>)
+	#include <fcntl.h>
+	#include <linux/fs.h>
+	#include <sys/ioctl.h>
+	#include <unistd.h>
+
+	#ifdef FICLONE
+		#define _ZK_WITH_FICLONE 1
+	#endif
+#elif defined(__APPLE__) && __has_include(<sys/clonefile.h>)
+	#include <sys/clonefile.h>
+	#define _ZK_WITH_CLONEFILE 1
+#endif
 
 namespace zenkit {
 	void SaveMetadata::load(ReadArchive& r, GameVersion version) {
@@ -218,18 +237,30 @@ namespace zenkit {
 
 		// zCParser {
 		w.write_int("numSymbols", this->symbols.size());
+
+		// Keys are formatted into a single buffer to avoid allocating new strings for every symbol value.
+		char key[64];
+		auto make_key = [&key](std::string_view prefix, uint32_t i, std::string_view suffix) {
+			auto len = prefix.copy(key, prefix.size());
+			len = static_cast<size_t>(std::to_chars(key + len, key + sizeof key, i).ptr - key);
+			len += suffix.copy(key + len, sizeof key - len);
+			return std::string_view {key, len};
+		};
+
 		for (auto i = 0u; i < this->symbols.size(); ++i) {
 			auto& sym = this->symbols[i];
-			auto iStr = std::to_string(i);
-			w.write_string("symName" + iStr, sym.name);
+			w.write_string(make_key("symName", i, ""), sym.name);
 
 			// For Gothic II saves, there is additional data stored
 			if (version == GameVersion::GOTHIC_1) {
-				w.write_int("symValue" + iStr, sym.values[0]);
+				w.write_int(make_key("symValue", i, ""), sym.values[0]);
 			} else {
-				w.write_int("symName" + iStr + "cnt", sym.values.size());
-				for (auto v : sym.values) {
-					w.write_int("symValue" + iStr + "_0", v);
+				w.write_int(make_key("symName", i, "cnt"), sym.values.size());
+
+				auto prefix_len = make_key("symValue", i, "_").size();
+				for (auto j = 0u; j < sym.values.size(); ++j) {
+					auto len = static_cast<size_t>(std::to_chars(key + prefix_len, key + sizeof key, j).ptr - key);
+					w.write_int(std::string_view {key, len}, sym.values[j]);
 				}
 			}
 		}
@@ -263,19 +294,41 @@ namespace zenkit {
 		return *result;
 	}
 
+	static std::shared_ptr<World> load_world_from(std::filesystem::path const& path, GameVersion version) {
+		if (!std::filesystem::exists(path)) return nullptr;
+
+		auto r = Read::from(path);
+		auto ar = ReadArchive::from(r.get());
+		return ar->read_object<World>(version);
+	}
+
 	std::shared_ptr<World> SaveGame::load_world(std::string_view world_name) const {
-		auto path = _m_path / world_name;
+		auto path = this->resolve_path() / world_name;
 		path.replace_extension("SAV");
+		return load_world_from(path, _m_version);
+	}
 
-		if (!std::filesystem::exists(path)) return nullptr;
+	void SaveGame::load(std::filesystem::path const& path) {
+		this->load(path, SaveGameLoadMode::EAGER);
+	}
 
+	static std::shared_ptr<SaveState> load_save_state(std::filesystem::path const& path, GameVersion version) {
 		auto r = Read::from(path);
 		auto ar = ReadArchive::from(r.get());
-		return ar->read_object<World>(_m_version);
+
+		auto state = std::make_shared<SaveState>();
+		state->load(*ar, version);
+		return state;
 	}
 
-	void SaveGame::load(std::filesystem::path const& path) {
+	void SaveGame::load(std::filesystem::path const& path, SaveGameLoadMode mode) {
+		ZKSTATS_SCOPE(SAVE_GAME, "SaveGame.load");
+		ZKTRACE_SCOPE("savegame", "SaveGame.load");
+
 		this->_m_path = path;
+		this->_m_state_pending = {};
+		this->_m_thumbnail_pending.reset();
+		this->_m_write_pending = {};
 
 		if (!std::filesystem::is_directory(path)) {
 			throw ParserError {"SaveGame", "save game path does not exist or is not a directory"};
@@ -286,102 +339,615 @@ namespace zenkit {
 			entries.emplace(file.path());
 		}
 
+		auto file_save_info = find_file_matching(entries, "SAVEINFO.SAV");
+		if (!file_save_info) {
+			throw ParserError {"SaveGame", "expected SAVEINFO.SAV not found. this is probably not a Gothic savegame"};
+		}
+
+		auto file_save_dat = find_file_matching(entries, "SAVEDAT.SAV");
+		if (!file_save_dat) {
+			throw ParserError {"SaveGame", "expected SAVEDAT.SAV not found. this is probably not a Gothic savegame"};
+		}
+
+		// Start parsing SAVEDAT.SAV in the background right away. The task only touches its own copy of the state
+		// so that this object may be moved or copied while it is running.
+		if (mode == SaveGameLoadMode::DEFERRED) {
+			ZKLOGI("SaveGame", "Loading SAVEDAT.SAV in the background");
+			this->_m_state_pending =
+			    std::async(std::launch::async, load_save_state, *file_save_dat, _m_version).share();
+		}
+
 		// Load SAVEINFO.SAV
 		{
 			ZKLOGI("SaveGame", "Loading SAVEINFO.SAV");
-			auto file_save_info = find_file_matching(entries, "SAVEINFO.SAV");
-			if (!file_save_info) {
-				throw ParserError {"SaveGame",
-				                   "expected SAVEINFO.SAV not found. this is probably not a Gothic savegame"};
-			}
-
 			auto r = Read::from(*file_save_info);
 			auto ar = ReadArchive::from(r.get());
 			this->metadata = *ar->read_object<SaveMetadata>(_m_version);
 		}
 
 		// Load THUMB.SAV
-		{
+		this->thumbnail.reset();
+		if (auto file_thumb = find_file_matching(entries, "THUMB.SAV")) {
+			this->_m_thumbnail_pending = std::move(file_thumb);
+			if (mode == SaveGameLoadMode::EAGER) this->resolve_thumbnail();
+		}
+
+		// Load SAVEDAT.SAV
+		if (mode == SaveGameLoadMode::EAGER) {
+			ZKLOGI("SaveGame", "Loading SAVEDAT.SAV");
+			this->state = std::move(*load_save_state(*file_save_dat, _m_version));
+		}
+	}
+
+	/// \brief The state of a background write shared between its handles and the SaveGame which started it.
+	struct SaveGameWriteJob {
+		std::shared_ptr<std::atomic_bool> cancelled = std::make_shared<std::atomic_bool>(false);
+		std::shared_future<SaveGameWriteStatus> result;
+		std::thread thread;
+
+		SaveGameWriteJob() = default;
+		SaveGameWriteJob(SaveGameWriteJob const&) = delete;
+		SaveGameWriteJob& operator=(SaveGameWriteJob const&) = delete;
+		~SaveGameWriteJob() noexcept;
+	};
+
+	std::filesystem::path const& SaveGame::resolve_path() const {
+		if (_m_write_pending != nullptr && _m_write_pending->result.get() == SaveGameWriteStatus::COMPLETED) {
+			return _m_write_path;
+		}
+
+		return _m_path;
+	}
+
+	SaveState& SaveGame::resolve_state() {
+		// Copies of this save game share the pending state, so it is copied rather than moved out. It is only
+		// released once parsing succeeded, so that a parser error is reported on every call.
+		if (_m_state_pending.valid()) {
+			this->state = *_m_state_pending.get();
+			_m_state_pending = {};
+		}
+
+		return this->state;
+	}
+
+	std::optional<Texture>& SaveGame::resolve_thumbnail() {
+		if (_m_thumbnail_pending) {
 			ZKLOGI("SaveGame", "Loading THUMB.SAV");
-			if (auto file_thumb = find_file_matching(entries, "THUMB.SAV")) {
-				auto r = Read::from(*file_thumb);
+			auto r = Read::from(*_m_thumbnail_pending);
+			_m_thumbnail_pending.reset();
+
+			this->thumbnail.emplace();
+			this->thumbnail->load(r.get());
+		}
+
+		return this->thumbnail;
+	}
+
+	/// \brief Tries to create a copy-on-write clone of the given file.
+	static bool clone_file(std::filesystem::path const& from, std::filesystem::path const& to) {
+#if defined(_ZK_WITH_FICLONE)
+		auto src = ::open(from.c_str(), O_RDONLY);
+		if (src < 0) return false;
+
+		auto dst = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (dst < 0) {
+			::close(src);
+			return false;
+		}
+
+		auto ok = ::ioctl(dst, FICLONE, src) == 0;
+		::close(src);
+		::close(dst);
+
+		if (!ok) ::unlink(to.c_str());
+		return ok;
+#elif defined(_ZK_WITH_CLONEFILE)
+		return ::clonefile(from.c_str(), to.c_str(), 0) == 0;
+#else
+		(void) from;
+		(void) to;
+		return false;
+#endif
+	}
+
+	/// \brief Copies a file from a previous save, re-using its data if the file system allows it.
+	static void reuse_file(std::filesystem::path const& from, std::filesystem::path const& to, bool hardlink) {
+		if (clone_file(from, to)) return;
+
+		std::error_code ec;
+		if (hardlink) {
+			std::filesystem::create_hard_link(from, to, ec);
+			if (!ec) return;
+		}
 
-				this->thumbnail.emplace();
-				this->thumbnail->load(r.get());
+		std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing);
+	}
+
+	/// \brief A set of files which are first written next to their final location and only moved into place once all
+	///        of them have been written.
+	///
+	/// Nothing in the target directory is replaced or removed before #commit. The files are renamed into place one at a
+	/// time, so a crash during #commit may still leave a mix of old and new files behind.
+	class StagedFiles {
+	public:
+		/// \param directory The directory to place the files in. Created if it does not exist.
+		/// \param replace Whether entries of \p directory which have not been staged are removed by #commit.
+		StagedFiles(std::filesystem::path directory, bool replace)
+		    : _m_directory(std::move(directory)), _m_replace(replace) {
+			_m_created = std::filesystem::create_directories(_m_directory);
+		}
+
+		StagedFiles(StagedFiles const&) = delete;
+
+		~StagedFiles() noexcept {
+			std::error_code ec;
+			for (auto& [temp, path] : _m_files) {
+				std::filesystem::remove_all(temp, ec);
 			}
+
+			// Only removes the directory if it is empty.
+			if (_m_created) std::filesystem::remove(_m_directory, ec);
 		}
 
-		// Load SAVEDAT.SAV
-		{
-			ZKLOGI("SaveGame", "Loading SAVEDAT.SAV");
-			auto file_save_dat = find_file_matching(entries, "SAVEDAT.SAV");
-			if (!file_save_dat) {
-				throw ParserError {"SaveGame",
-				                   "expected SAVEDAT.SAV not found. this is probably not a Gothic savegame"};
+		void add(std::filesystem::path const& name, std::function<void(Write*)> const& fn) {
+			auto temp = this->stage(name);
+
+			std::ofstream stream {temp, std::ios::binary | std::ios::trunc};
+			if (!stream) throw Error {"SaveGame: failed to open " + temp.string() + " for writing"};
+
+			auto w = Write::to(&stream);
+			fn(w.get());
+			w.reset();
+
+			stream.close();
+			if (!stream) throw Error {"SaveGame: failed to write " + temp.string()};
+		}
+
+		/// \brief Stages a copy of a file or directory of a previous save.
+		void carry_over(std::filesystem::path const& from, bool hardlink) {
+			auto temp = this->stage(from.filename());
+
+			if (std::filesystem::is_directory(from)) {
+				std::filesystem::copy(from, temp, std::filesystem::copy_options::recursive);
+			} else {
+				reuse_file(from, temp, hardlink);
 			}
+		}
 
-			auto r = Read::from(*file_save_dat);
-			auto ar = ReadArchive::from(r.get());
-			this->state.load(*ar, _m_version);
+		void commit() {
+			for (auto& [temp, path] : _m_files) {
+				if (std::filesystem::is_directory(path)) std::filesystem::remove_all(path);
+				std::filesystem::rename(temp, path);
+			}
+
+			if (_m_replace) {
+				std::vector<std::filesystem::path> stale {};
+				for (auto& entry : std::filesystem::directory_iterator(_m_directory)) {
+					auto is_staged = std::any_of(_m_files.begin(), _m_files.end(), [&entry](auto const& file) {
+						return file.second == entry.path();
+					});
+
+					if (!is_staged) stale.push_back(entry.path());
+				}
+
+				for (auto& path : stale) {
+					std::filesystem::remove_all(path);
+				}
+			}
+
+			_m_files.clear();
+			_m_created = false;
+		}
+
+	private:
+		std::filesystem::path stage(std::filesystem::path const& name) {
+			auto path = _m_directory / name;
+			auto temp = path;
+			temp += ".tmp";
+
+			std::filesystem::remove_all(temp);
+			_m_files.emplace_back(temp, path);
+			return temp;
+		}
+
+		std::filesystem::path _m_directory;
+		bool _m_replace;
+		bool _m_created {false};
+		std::vector<std::pair<std::filesystem::path, std::filesystem::path>> _m_files;
+	};
+
+	/// \return Whether both paths refer to the same existing directory.
+	static bool is_same_directory(std::filesystem::path const& from, std::filesystem::path const& to) {
+		std::error_code ec;
+		if (from.empty() || !std::filesystem::exists(from, ec) || !std::filesystem::exists(to, ec)) return false;
+		return std::filesystem::equivalent(from, to, ec);
+	}
+
+	/// \brief Stages all files of the previous save which are not re-written, i.e. the other worlds visited.
+	static void carry_over_files(StagedFiles& files,
+	                             std::filesystem::path const& from,
+	                             std::string const& world_file,
+	                             SaveGameWriteOptions const& options) {
+		if (from.empty() || !std::filesystem::exists(from)) return;
+
+		std::string_view const rewritten[] = {"SAVEINFO.SAV", "THUMB.SAV", "SAVEHDR.SAV", "SAVEDAT.SAV", world_file};
+
+		for (auto& entry : std::filesystem::directory_iterator(from)) {
+			auto name = entry.path().filename();
+			auto is_rewritten = std::any_of(std::begin(rewritten), std::end(rewritten), [&name](auto v) {
+				return phoenix::iequals(name.string(), v);
+			});
+
+			if (!is_rewritten) files.carry_over(entry.path(), options.allow_hardlinks);
 		}
 	}
 
+	static void write_save_info(Write* w, SaveMetadata const& metadata, GameVersion version) {
+		auto ar = WriteArchive::to(w, ArchiveFormat::ASCII);
+		ar->write_object("%", &metadata, version);
+		ar->write_header();
+	}
+
+	static void write_save_header(Write* w, std::string const& world_name) {
+		w->write_string(world_name);
+		w->write_string(".ZEN\n");
+	}
+
+	static void write_save_state(Write* w, SaveState const& state, ArchiveFormat format, GameVersion version) {
+		auto ar = WriteArchive::to_save(w, format);
+		state.save(*ar, version);
+		ar->write_header();
+	}
+
+	static void write_save_world(Write* w, World const& world, GameVersion version) {
+		auto ar = WriteArchive::to_save(w, ArchiveFormat::BINARY);
+		ar->write_object("%", &world, version);
+		ar->write_header();
+	}
+
 	void SaveGame::save(std::filesystem::path const& path, World& world, std::string const& world_name) {
-		// Copy over the current save if necessary.
-		if (_m_path != path) {
-			if (std::filesystem::exists(path)) {
-				std::filesystem::remove_all(path);
-			}
+		this->save(path, world, world_name, {});
+	}
 
-			if (!_m_path.empty() && std::filesystem::exists(_m_path)) {
-				std::filesystem::copy(_m_path, path, std::filesystem::copy_options::recursive);
-			} else {
-				std::filesystem::create_directories(path);
+	void SaveGame::save(std::filesystem::path const& path,
+	                    World& world,
+	                    std::string const& world_name,
+	                    SaveGameWriteOptions const& options) {
+		_m_path = this->resolve_path();
+		_m_write_pending = {};
+
+		auto& state = this->resolve_state();
+		auto& thumb = this->resolve_thumbnail();
+		auto world_file = world_name + ".SAV";
+
+		// When saving in-place, the files which are not re-written are already there.
+		auto in_place = is_same_directory(_m_path, path);
+		StagedFiles files {path, !in_place};
+		if (!in_place) carry_over_files(files, _m_path, world_file, options);
+
+		files.add("SAVEINFO.SAV", [this](Write* w) { write_save_info(w, this->metadata, _m_version); });
+		files.add("THUMB.SAV", [&thumb](Write* w) {
+			if (thumb) thumb->save(w);
+		});
+		files.add("SAVEHDR.SAV", [&world_name](Write* w) { write_save_header(w, world_name); });
+		files.add("SAVEDAT.SAV",
+		          [this, &state, &options](Write* w) { write_save_state(w, state, options.state_format, _m_version); });
+		files.add(world_file, [this, &world](Write* w) { write_save_world(w, world, _m_version); });
+		files.commit();
+
+		_m_path = path;
+	}
+
+	/// \brief A copy of everything written to a save game which is independent of the game's live state.
+	struct SaveSnapshot {
+		GameVersion version;
+		std::filesystem::path source;
+		std::filesystem::path path;
+		std::string world_name;
+		SaveGameWriteOptions options;
+
+		SaveMetadata metadata;
+		SaveState state;
+		std::optional<Texture> thumbnail;
+		std::vector<std::byte> world;
+	};
+
+	static SaveGameWriteStatus write_snapshot(SaveSnapshot const& snapshot,
+	                                          std::atomic_bool const& cancelled,
+	                                          std::string& error) {
+		try {
+			auto world_file = snapshot.world_name + ".SAV";
+
+			// Cancellation is checked between files. Nothing is moved into place before all files have been written.
+			if (cancelled) return SaveGameWriteStatus::CANCELLED;
+			auto in_place = is_same_directory(snapshot.source, snapshot.path);
+			StagedFiles files {snapshot.path, !in_place};
+			if (!in_place) carry_over_files(files, snapshot.source, world_file, snapshot.options);
+
+			if (cancelled) return SaveGameWriteStatus::CANCELLED;
+			files.add("SAVEINFO.SAV",
+			          [&snapshot](Write* w) { write_save_info(w, snapshot.metadata, snapshot.version); });
+
+			if (cancelled) return SaveGameWriteStatus::CANCELLED;
+			files.add("THUMB.SAV", [&snapshot](Write* w) {
+				if (snapshot.thumbnail) snapshot.thumbnail->save(w);
+			});
+
+			if (cancelled) return SaveGameWriteStatus::CANCELLED;
+			files.add("SAVEHDR.SAV", [&snapshot](Write* w) { write_save_header(w, snapshot.world_name); });
+
+			if (cancelled) return SaveGameWriteStatus::CANCELLED;
+			files.add("SAVEDAT.SAV", [&snapshot](Write* w) {
+				write_save_state(w, snapshot.state, snapshot.options.state_format, snapshot.version);
+			});
+
+			if (cancelled) return SaveGameWriteStatus::CANCELLED;
+			files.add(world_file, [&snapshot](Write* w) { w->write(snapshot.world.data(), snapshot.world.size()); });
+
+			if (cancelled) return SaveGameWriteStatus::CANCELLED;
+			files.commit();
+			return SaveGameWriteStatus::COMPLETED;
+		} catch (std::exception const& e) {
+			error = e.what();
+			return SaveGameWriteStatus::FAILED;
+		}
+	}
+
+	SaveGameWriteTask SaveGame::save_async(std::filesystem::path const& path,
+	                                       World const& world,
+	                                       std::string const& world_name,
+	                                       SaveGameWriteOptions const& options,
+	                                       SaveGameWriteCallback callback) {
+		_m_path = this->resolve_path();
+		_m_write_pending = {};
+
+		auto snapshot = std::make_shared<SaveSnapshot>();
+		snapshot->version = _m_version;
+		snapshot->source = _m_path;
+		snapshot->path = path;
+		snapshot->world_name = world_name;
+		snapshot->options = options;
+		snapshot->metadata = this->metadata;
+		snapshot->state = this->resolve_state();
+		snapshot->thumbnail = this->resolve_thumbnail();
+
+		// The cutscene manager is shared by pointer, so it is copied explicitly.
+		if (auto& csm = snapshot->state.cutscene_manager; csm != nullptr) {
+			csm = std::make_shared<CutsceneManager>(*csm);
+			for (auto& item : csm->pool_items) {
+				if (item != nullptr) item = std::make_shared<CutscenePoolItem>(*item);
 			}
 		}
 
-		{
-			auto w = Write::to(path / "SAVEINFO.SAV");
-			auto ar = WriteArchive::to(w.get(), ArchiveFormat::ASCII);
+		// The world is encoded on the calling thread since its object tree can not be copied cheaply. Since
+		// worlds are always saved as binary archives, this is the final file content.
+		auto w = Write::to(&snapshot->world);
+		write_save_world(w.get(), world, _m_version);
+		w.reset();
+
+		auto job = std::make_shared<SaveGameWriteJob>();
+		std::promise<SaveGameWriteStatus> promise {};
+		job->result = promise.get_future().share();
+
+		// The save game only refers to the new directory once the write has completed successfully.
+		_m_write_pending = job;
+		_m_write_path = path;
+
+		// The thread must not own the job, since the job joins the thread when it is destroyed.
+		job->thread = std::thread {[snapshot = std::move(snapshot),
+		                            cancelled = job->cancelled,
+		                            promise = std::move(promise),
+		                            callback = std::move(callback)]() mutable {
+			std::string error {};
+			auto status = write_snapshot(*snapshot, *cancelled, error);
+			snapshot.reset();
+
+			if (callback) {
+				try {
+					callback(status, error);
+				} catch (...) {
+				}
+			}
+
+			promise.set_value(status);
+		}};
+
+		return SaveGameWriteTask {std::move(job)};
+	}
 
-			ar->write_object("%", &this->metadata, _m_version);
-			ar->write_header();
+	SaveGameWriteJob::~SaveGameWriteJob() noexcept {
+		if (!thread.joinable()) return;
+
+		// Joining from the worker itself would deadlock. This only happens if the callback owned the last handle.
+		if (thread.get_id() == std::this_thread::get_id()) {
+			thread.detach();
+		} else {
+			thread.join();
 		}
+	}
 
-		{
-			auto w = Write::to(path / "THUMB.SAV");
+	SaveGameWriteTask::SaveGameWriteTask(std::shared_ptr<SaveGameWriteJob> job) : _m_job(std::move(job)) {}
+
+	void SaveGameWriteTask::cancel() {
+		*_m_job->cancelled = true;
+	}
+
+	bool SaveGameWriteTask::done() const {
+		return _m_job->result.wait_for(std::chrono::seconds {0}) == std::future_status::ready;
+	}
+
+	SaveGameWriteStatus SaveGameWriteTask::wait() const {
+		return _m_job->result.get();
+	}
+
+	std::shared_ptr<World> SaveGame::load_world() const {
+		return load_world(metadata.world + ".ZEN");
+	}
+
+	std::future<std::shared_ptr<World>> SaveGame::load_world_async(std::string_view name) const {
+		auto path = this->resolve_path() / name;
+		path.replace_extension("SAV");
+
+		return std::async(std::launch::async, load_world_from, std::move(path), _m_version);
+	}
+
+	std::future<std::shared_ptr<World>> SaveGame::load_world_async() const {
+		return load_world_async(metadata.world + ".ZEN");
+	}
+
+	SaveSlotIndex::SaveSlotIndex(GameVersion version, unsigned threads)
+	    : _m_version(version), _m_threads(default_thread_count(threads)) {}
+
+	/// \brief Downscales the given RGBA8 image using a box filter so that it fits into \p size by \p size pixels.
+	static std::vector<uint8_t>
+	downscale_rgba8(std::vector<uint8_t> const& src, uint32_t& width, uint32_t& height, uint32_t size) {
+		auto largest = std::max(width, height);
+		if (largest <= size) return src;
+
+		auto out_width = std::max(1u, static_cast<uint32_t>(uint64_t {width} * size / largest));
+		auto out_height = std::max(1u, static_cast<uint32_t>(uint64_t {height} * size / largest));
+		std::vector<uint8_t> out(out_width * out_height * 4);
+
+		for (auto y = 0u; y < out_height; ++y) {
+			auto y0 = y * height / out_height;
+			auto y1 = std::max(y0 + 1, (y + 1) * height / out_height);
+
+			for (auto x = 0u; x < out_width; ++x) {
+				auto x0 = x * width / out_width;
+				auto x1 = std::max(x0 + 1, (x + 1) * width / out_width);
+
+				uint32_t sum[4] {0, 0, 0, 0};
+				for (auto sy = y0; sy < y1; ++sy) {
+					for (auto sx = x0; sx < x1; ++sx) {
+						for (auto c = 0u; c < 4; ++c) {
+							sum[c] += src[(sy * width + sx) * 4 + c];
+						}
+					}
+				}
 
-			if (this->thumbnail) {
-				this->thumbnail->save(w.get());
+				auto count = (y1 - y0) * (x1 - x0);
+				for (auto c = 0u; c < 4; ++c) {
+					out[(y * out_width + x) * 4 + c] = static_cast<uint8_t>(sum[c] / count);
+				}
 			}
 		}
 
-		{
-			auto w = Write::to(path / "SAVEHDR.SAV");
-			w->write_string(world_name);
-			w->write_string(".ZEN\n");
+		width = out_width;
+		height = out_height;
+		return out;
+	}
+
+	static void load_save_slot_thumbnail(SaveSlot& slot, std::filesystem::path const& path, uint32_t size) {
+		auto r = Read::from(path);
+
+		Texture texture {};
+		texture.load(r.get());
+
+		// Start from the smallest mipmap which is still at least as large as the requested size.
+		auto level = 0u;
+		while (level + 1 < texture.mipmaps() && texture.mipmap_width(level + 1) >= size &&
+		       texture.mipmap_height(level + 1) >= size) {
+			++level;
 		}
 
-		{
-			auto w = Write::to(path / "SAVEDAT.SAV");
-			auto ar = WriteArchive::to_save(w.get(), ArchiveFormat::ASCII);
+		slot.thumbnail_width = texture.mipmap_width(level);
+		slot.thumbnail_height = texture.mipmap_height(level);
+		slot.thumbnail = downscale_rgba8(texture.as_rgba8(level), slot.thumbnail_width, slot.thumbnail_height, size);
+	}
 
-			this->state.save(*ar, _m_version);
-			ar->write_header();
+	std::vector<SaveSlot> SaveSlotIndex::scan(std::filesystem::path const& root, uint32_t thumbnail_size) {
+		struct Candidate {
+			std::string key;
+			std::filesystem::path info;
+			std::filesystem::path thumb;
+			Entry entry;
+			bool cached {false};
+			std::string error {};
+		};
+
+		std::vector<Candidate> candidates {};
+		std::error_code ec;
+
+		for (auto& dir : std::filesystem::directory_iterator(root, ec)) {
+			if (!dir.is_directory(ec)) continue;
+
+			Candidate& c = candidates.emplace_back();
+			c.key = dir.path().string();
+			c.entry.slot.path = dir.path();
+			c.entry.thumbnail_size = thumbnail_size;
+
+			for (auto& file : std::filesystem::directory_iterator(dir.path(), ec)) {
+				auto name = file.path().filename().string();
+				if (phoenix::iequals(name, "SAVEINFO.SAV")) {
+					c.info = file.path();
+					c.entry.info_time = file.last_write_time(ec);
+					c.entry.info_size = file.file_size(ec);
+				} else if (phoenix::iequals(name, "THUMB.SAV")) {
+					c.thumb = file.path();
+					c.entry.thumb_time = file.last_write_time(ec);
+					c.entry.thumb_size = file.file_size(ec);
+				}
+			}
+
+			if (c.info.empty()) candidates.pop_back();
 		}
 
+		std::sort(candidates.begin(), candidates.end(), [](Candidate const& a, Candidate const& b) {
+			return a.entry.slot.path.filename() < b.entry.slot.path.filename();
+		});
+
 		{
-			auto w = Write::to(path / (world_name + ".SAV"));
-			auto ar = WriteArchive::to_save(w.get(), ArchiveFormat::BINARY);
+			std::lock_guard lock {_m_lock};
+			for (auto& c : candidates) {
+				auto it = _m_entries.find(c.key);
+				if (it == _m_entries.end()) continue;
+
+				auto& cached = it->second;
+				c.cached = cached.info_time == c.entry.info_time && cached.info_size == c.entry.info_size &&
+				    cached.thumb_time == c.entry.thumb_time && cached.thumb_size == c.entry.thumb_size &&
+				    cached.thumbnail_size == c.entry.thumbnail_size;
 
-			ar->write_object("%", &world, _m_version);
-			ar->write_header();
+				if (c.cached) c.entry.slot = cached.slot;
+			}
 		}
 
-		_m_path = path;
+		parallel_for(candidates.size(), _m_threads, [this, &candidates, thumbnail_size](size_t i) {
+			auto& c = candidates[i];
+			if (c.cached) return;
+
+			try {
+				auto r = Read::from(c.info);
+				auto ar = ReadArchive::from(r.get());
+				c.entry.slot.metadata = *ar->read_object<SaveMetadata>(_m_version);
+
+				if (thumbnail_size != 0 && !c.thumb.empty()) {
+					load_save_slot_thumbnail(c.entry.slot, c.thumb, thumbnail_size);
+				}
+			} catch (std::exception const& e) {
+				c.error = e.what();
+			}
+		});
+
+		std::vector<SaveSlot> slots {};
+		slots.reserve(candidates.size());
+
+		std::lock_guard lock {_m_lock};
+		for (auto& c : candidates) {
+			if (!c.error.empty()) {
+				ZKLOGW("SaveGame", "Skipping save game %s: %s", c.key.c_str(), c.error.c_str());
+				_m_entries.erase(c.key);
+				continue;
+			}
+
+			slots.push_back(c.entry.slot);
+			if (!c.cached) _m_entries.insert_or_assign(c.key, std::move(c.entry));
+		}
+
+		return slots;
 	}
 
-	std::shared_ptr<World> SaveGame::load_world() const {
-		return load_world(metadata.world + ".ZEN");
+	void SaveSlotIndex::clear() {
+		std::lock_guard lock {_m_lock};
+		_m_entries.clear();
 	}
 } // namespace zenkit
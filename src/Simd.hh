@@ -0,0 +1,54 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define ZK_SSE2 1
+#endif
+
+namespace zenkit {
+#ifdef ZK_SSE2
+	/// \brief Splits four consecutive glm::vec3 into their components.
+	inline void load_vec3x4(float const* in, __m128& xs, __m128& ys, __m128& zs) noexcept {
+		auto a = _mm_loadu_ps(in + 0); // x0 y0 z0 x1
+		auto b = _mm_loadu_ps(in + 4); // y1 z1 x2 y2
+		auto c = _mm_loadu_ps(in + 8); // z2 x3 y3 z3
+
+		xs = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)),
+		                    _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)),
+		                    _MM_SHUFFLE(2, 0, 2, 0));
+		ys = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+		                    _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+		                    _MM_SHUFFLE(2, 0, 2, 0));
+		zs = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+		                    _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)),
+		                    _MM_SHUFFLE(2, 0, 2, 0));
+	}
+
+	/// \brief Interleaves the components of four vectors into four consecutive glm::vec3.
+	inline void store_vec3x4(float* out, __m128 xs, __m128 ys, __m128 zs) noexcept {
+		auto xy01 = _mm_unpacklo_ps(xs, ys); // x0 y0 x1 y1
+		auto xy23 = _mm_unpackhi_ps(xs, ys); // x2 y2 x3 y3
+
+		auto a = _mm_shuffle_ps(xy01, _mm_shuffle_ps(zs, xy01, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+		auto b = _mm_shuffle_ps(_mm_shuffle_ps(xy01, zs, _MM_SHUFFLE(1, 1, 3, 3)), xy23, _MM_SHUFFLE(1, 0, 2, 0));
+		auto c = _mm_shuffle_ps(_mm_shuffle_ps(zs, xy23, _MM_SHUFFLE(2, 2, 2, 2)),
+		                        _mm_shuffle_ps(xy23, zs, _MM_SHUFFLE(3, 3, 3, 3)),
+		                        _MM_SHUFFLE(2, 0, 2, 0));
+
+		_mm_storeu_ps(out + 0, a);
+		_mm_storeu_ps(out + 4, b);
+		_mm_storeu_ps(out + 8, c);
+	}
+
+	inline __m128 abs_ps(__m128 v) noexcept {
+		return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+	}
+
+	/// \brief Selects `a` where `mask` is set and `b` everywhere else.
+	inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) noexcept {
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+#endif
+} // namespace zenkit
@@ -0,0 +1,249 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/Sniff.hh"
+#include "zenkit/Error.hh"
+#include "zenkit/Stream.hh"
+
+#include "Internal.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace zenkit {
+	static constexpr std::string_view ARCHIVE_SIGNATURE = "ZenGin Archive\n";
+	static constexpr std::string_view TEXTURE_SIGNATURE = "ZTEX";
+	static constexpr std::string_view FONT_SIGNATURE = "1\n";
+	static constexpr std::uint8_t SCRIPT_VERSION = 50;
+
+	// Chunk types and versions of the chunked formats. See the respective loaders.
+	static constexpr std::uint16_t CHUNK_MESH = 0xB000;
+	static constexpr std::uint16_t CHUNK_MULTI_RESOLUTION_MESH = 0xB100;
+	static constexpr std::uint16_t CHUNK_MORPH_MESH = 0xE000;
+	static constexpr std::uint16_t CHUNK_MODEL_MESH = 0xD000;
+	static constexpr std::uint16_t CHUNK_MODEL_HIERARCHY = 0xD100;
+	static constexpr std::uint16_t CHUNK_MODEL_HIERARCHY_END = 0xD120;
+	static constexpr std::uint16_t CHUNK_MODEL_ANIMATION = 0xA000;
+	static constexpr std::uint16_t CHUNK_MODEL_SCRIPT = 0xF000;
+
+	static constexpr std::uint16_t MESH_VERSION_G1 = 9;
+	static constexpr std::uint16_t MESH_VERSION_G2 = 265;
+	static constexpr std::uint16_t MULTI_RESOLUTION_MESH_VERSION_G1 = 0x305;
+	static constexpr std::uint16_t MULTI_RESOLUTION_MESH_VERSION_G2 = 0x905;
+	static constexpr std::uint32_t BSP_VERSION_G1 = 0x2090000;
+	static constexpr std::uint32_t BSP_VERSION_G2 = 0x4090000;
+	static constexpr std::uint16_t VOB_VERSION_G1 = 12289;
+	static constexpr std::uint16_t VOB_VERSION_G2 = 52224;
+
+	/// \brief The maximum number of chunks to skip when looking for the end of a model hierarchy.
+	static constexpr int MAX_HIERARCHY_CHUNKS = 8;
+
+	/// \brief The number of bytes read at once while scanning archives.
+	static constexpr std::size_t SCAN_BLOCK_SIZE = 64 * 1024;
+
+	template <typename T>
+	static std::optional<GameVersion> version_of(T v, T g1, T g2) {
+		if (v == g1) return GameVersion::GOTHIC_1;
+		if (v == g2) return GameVersion::GOTHIC_2;
+		return std::nullopt;
+	}
+
+	/// \brief Finds the next occurrence of \p needle in the stream without decoding any data.
+	/// \return The offset of the first byte of the match or `-1` if there is none.
+	static ssize_t scan(Read* r, std::string_view needle) {
+		std::vector<char> buf(SCAN_BLOCK_SIZE + needle.size());
+		std::boyer_moore_horspool_searcher searcher {needle.begin(), needle.end()};
+
+		auto base = r->tell();
+		std::size_t kept = 0;
+
+		for (;;) {
+			auto n = r->read(buf.data() + kept, SCAN_BLOCK_SIZE);
+			if (n == 0) return -1;
+
+			auto end = buf.begin() + static_cast<ssize_t>(kept + n);
+			if (auto it = std::search(buf.begin(), end, searcher); it != end) {
+				return static_cast<ssize_t>(base) + (it - buf.begin());
+			}
+
+			// Keep the tail of the block in case the needle crosses the block boundary.
+			auto tail = std::min(needle.size() - 1, kept + n);
+			std::memmove(buf.data(), &*(end - static_cast<ssize_t>(tail)), tail);
+			base += kept + n - tail;
+			kept = tail;
+		}
+	}
+
+	/// \brief Reads the BSP version from the `MeshAndBsp` section of a world archive.
+	/// \param ar The archive, positioned directly after the begin of the root object.
+	static std::optional<GameVersion> sniff_world_version(ReadArchive& ar) {
+		auto* r = ar.get_stream();
+		ArchiveObject obj {};
+
+		if (ar.get_header().format == ArchiveFormat::BINARY) {
+			// Binary archives store the size of each object so sections can be skipped without decoding them.
+			while (ar.read_object_begin(obj)) {
+				if (obj.object_name == "MeshAndBsp") {
+					return version_of(r->read_uint(), BSP_VERSION_G1, BSP_VERSION_G2);
+				}
+
+				ar.skip_object(true);
+			}
+
+			return std::nullopt;
+		}
+
+		// The object header must not be preceded by anything but whitespace in ASCII archives. In BIN_SAFE
+		// archives it is a string entry with a type and length, which must not be preceded by a hash entry
+		// since that would make it a string value.
+		auto binsafe = ar.get_header().format == ArchiveFormat::BINSAFE;
+		auto context = binsafe ? 8 : 1;
+
+		for (;;) {
+			auto offset = scan(r, "[MeshAndBsp ");
+			if (offset < 0) return std::nullopt;
+
+			auto valid = offset >= context;
+			if (valid) {
+				r->seek(offset - context, Whence::BEG);
+				auto c = r->read_ubyte();
+				valid = binsafe ? c != static_cast<std::uint8_t>(ArchiveEntryType::HASH) : c == '\t' || c == '\n';
+			}
+
+			r->seek(binsafe ? offset - 3 : offset, Whence::BEG);
+			if (valid && ar.read_object_begin(obj) && obj.object_name == "MeshAndBsp") {
+				return version_of(r->read_uint(), BSP_VERSION_G1, BSP_VERSION_G2);
+			}
+
+			// The match was part of some other value, continue after it.
+			r->seek(offset + 1, Whence::BEG);
+		}
+	}
+
+	static FileInfo sniff_archive(Read* r) {
+		FileInfo info {FileFormat::ARCHIVE};
+
+		auto ar = ReadArchive::from(r);
+		info.archive_format = ar->get_header().format;
+		info.save = ar->is_save_game();
+
+		ArchiveObject root {};
+		if (!ar->read_object_begin(root)) return info;
+
+		if (root.class_name == "oCWorld:zCWorld") {
+			info.format = FileFormat::WORLD;
+
+			// Save-game worlds do not contain the world mesh.
+			if (!info.save) info.version = sniff_world_version(*ar);
+		} else if (root.class_name == "zCCSLib") {
+			info.format = FileFormat::CUTSCENE_LIBRARY;
+		} else if (root.class_name == "zCVob") {
+			info.version = version_of(root.version, VOB_VERSION_G1, VOB_VERSION_G2);
+		}
+
+		return info;
+	}
+
+	static FileInfo sniff_chunked(Read* r) {
+		FileInfo info {};
+		auto type = r->read_ushort();
+		auto size = r->read_uint();
+
+		switch (type) {
+		case CHUNK_MESH:
+			info.format = FileFormat::MESH;
+			info.version = version_of(r->read_ushort(), MESH_VERSION_G1, MESH_VERSION_G2);
+			break;
+		case CHUNK_MULTI_RESOLUTION_MESH:
+			info.format = FileFormat::MULTI_RESOLUTION_MESH;
+			info.version = version_of(r->read_ushort(),
+			                          MULTI_RESOLUTION_MESH_VERSION_G1,
+			                          MULTI_RESOLUTION_MESH_VERSION_G2);
+			break;
+		case CHUNK_MORPH_MESH:
+			info.format = FileFormat::MORPH_MESH;
+			break;
+		case CHUNK_MODEL_MESH:
+			info.format = FileFormat::MODEL_MESH;
+			break;
+		case CHUNK_MODEL_HIERARCHY: {
+			// A model is a hierarchy directly followed by a model mesh.
+			info.format = FileFormat::MODEL_HIERARCHY;
+
+			auto chunk = type;
+			for (auto i = 0; i < MAX_HIERARCHY_CHUNKS && !r->eof(); ++i) {
+				r->seek(size, Whence::CUR);
+
+				if (chunk == CHUNK_MODEL_HIERARCHY_END) {
+					if (!r->eof() && r->read_ushort() == CHUNK_MODEL_MESH) info.format = FileFormat::MODEL;
+					break;
+				}
+
+				chunk = r->read_ushort();
+				size = r->read_uint();
+			}
+			break;
+		}
+		case CHUNK_MODEL_ANIMATION:
+			info.format = FileFormat::MODEL_ANIMATION;
+			break;
+		case CHUNK_MODEL_SCRIPT:
+			info.format = FileFormat::MODEL_SCRIPT;
+			break;
+		default:
+			break;
+		}
+
+		return info;
+	}
+
+	static FileInfo sniff_script(Read* r) {
+		FileInfo info {};
+		auto begin = r->tell();
+
+		// A script starts with its version and the number of symbols, followed by a sort table for those symbols.
+		if (r->read_ubyte() != SCRIPT_VERSION) return info;
+		auto symbol_count = r->read_uint();
+
+		r->seek(0, Whence::END);
+		if (r->tell() - begin >= 5 + static_cast<std::size_t>(symbol_count) * 4) {
+			info.format = FileFormat::SCRIPT;
+		}
+
+		return info;
+	}
+
+	FileInfo sniff(Read* r) {
+		ZKTRACE_SCOPE("io", "sniff");
+
+		auto begin = r->tell();
+		char buf[16];
+		std::string_view head {buf, r->read(buf, sizeof buf)};
+		r->seek(static_cast<ssize_t>(begin), Whence::BEG);
+
+		FileInfo info {};
+		try {
+			if (head.substr(0, ARCHIVE_SIGNATURE.size()) == ARCHIVE_SIGNATURE) {
+				info = sniff_archive(r);
+			} else if (head.substr(0, TEXTURE_SIGNATURE.size()) == TEXTURE_SIGNATURE) {
+				info.format = FileFormat::TEXTURE;
+			} else if (head.substr(0, FONT_SIGNATURE.size()) == FONT_SIGNATURE) {
+				info.format = FileFormat::FONT;
+			} else if (head.size() >= 6) {
+				info = sniff_chunked(r);
+
+				if (info.format == FileFormat::UNKNOWN) {
+					r->seek(static_cast<ssize_t>(begin), Whence::BEG);
+					info = sniff_script(r);
+				}
+			}
+		} catch (ParserError const&) {
+			info = FileInfo {};
+		}
+
+		r->seek(static_cast<ssize_t>(begin), Whence::BEG);
+		return info;
+	}
+} // namespace zenkit
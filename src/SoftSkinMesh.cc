@@ -26,6 +26,9 @@ namespace zenkit {
 	}
 
 	void SoftSkinMesh::load(Read* r) {
+		ZKSTATS_SCOPE(MESH, "SoftSkinMesh.load");
+		ZKTRACE_SCOPE("mesh", "SoftSkinMesh.load");
+
 		proto::read_chunked<SoftSkinMeshChunkType>(r, "SoftSkinMesh", [this](Read* c, SoftSkinMeshChunkType type) {
 			switch (type) {
 			case SoftSkinMeshChunkType::HEADER:
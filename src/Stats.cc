@@ -0,0 +1,218 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/Stats.hh"
+
+#include "Internal.hh"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace zenkit {
+	bool Stats::enabled() noexcept {
+#ifdef ZK_WITH_STATS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	char const* Stats::name(StatsSubsystem subsystem) noexcept {
+		switch (subsystem) {
+		case StatsSubsystem::ARCHIVE:
+			return "ARCHIVE";
+		case StatsSubsystem::VFS:
+			return "VFS";
+		case StatsSubsystem::WORLD:
+			return "WORLD";
+		case StatsSubsystem::MESH:
+			return "MESH";
+		case StatsSubsystem::MODEL:
+			return "MODEL";
+		case StatsSubsystem::TEXTURE:
+			return "TEXTURE";
+		case StatsSubsystem::SCRIPT:
+			return "SCRIPT";
+		case StatsSubsystem::SAVE_GAME:
+			return "SAVE_GAME";
+		}
+
+		return "?";
+	}
+
+	char const* Stats::name(StatsReadBackend backend) noexcept {
+		switch (backend) {
+		case StatsReadBackend::FILE:
+			return "FILE";
+		case StatsReadBackend::STREAM:
+			return "STREAM";
+		case StatsReadBackend::MEMORY:
+			return "MEMORY";
+		case StatsReadBackend::VECTOR:
+			return "VECTOR";
+		case StatsReadBackend::MMAP:
+			return "MMAP";
+		case StatsReadBackend::BUFFER:
+			return "BUFFER";
+		}
+
+		return "?";
+	}
+
+#ifdef ZK_WITH_STATS
+	static constexpr std::size_t SUBSYSTEM_COUNT = static_cast<std::size_t>(StatsSubsystem::SAVE_GAME) + 1;
+	static constexpr std::size_t BACKEND_COUNT = static_cast<std::size_t>(StatsReadBackend::BUFFER) + 1;
+	static constexpr std::size_t OBJECT_COUNT = static_cast<std::size_t>(ObjectType::zCCSProps) + 1;
+
+	struct StatsSection {
+		char const* name;
+		StatsSubsystem subsystem;
+		std::uint64_t count;
+		std::uint64_t total_ns;
+		std::uint64_t max_ns;
+	};
+
+	/// \brief All counters. Hot counters are atomic, sections are only updated once per scope and use a lock.
+	struct StatsCounters {
+		std::atomic_uint64_t allocations[SUBSYSTEM_COUNT] {};
+		std::atomic_uint64_t allocated_bytes[SUBSYSTEM_COUNT] {};
+		std::atomic_uint64_t reads[BACKEND_COUNT] {};
+		std::atomic_uint64_t read_bytes[BACKEND_COUNT] {};
+		std::atomic_uint64_t objects[OBJECT_COUNT] {};
+
+		std::mutex lock;
+		std::vector<StatsSection> sections;
+	};
+
+	static StatsCounters& stats_counters() {
+		static StatsCounters counters {};
+		return counters;
+	}
+
+	/// \brief The subsystem of the innermost StatsScope on this thread or `-1` if there is none.
+	static thread_local int zk_stats_subsystem = -1;
+
+	StatsScope::StatsScope(StatsSubsystem subsystem, char const* name) noexcept
+	    : _m_name(name), _m_subsystem(subsystem), _m_previous(zk_stats_subsystem),
+	      _m_start(std::chrono::steady_clock::now()) {
+		zk_stats_subsystem = static_cast<int>(subsystem);
+	}
+
+	StatsScope::~StatsScope() noexcept {
+		auto elapsed = std::chrono::steady_clock::now() - _m_start;
+		auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		zk_stats_subsystem = _m_previous;
+
+		auto& counters = stats_counters();
+		std::lock_guard lock {counters.lock};
+
+		StatsSection* section = nullptr;
+		for (auto& s : counters.sections) {
+			if (s.subsystem == _m_subsystem && std::strcmp(s.name, _m_name) == 0) {
+				section = &s;
+				break;
+			}
+		}
+
+		if (section == nullptr) {
+			try {
+				section = &counters.sections.emplace_back(StatsSection {_m_name, _m_subsystem, 0, 0, 0});
+			} catch (...) {
+				return;
+			}
+		}
+
+		section->count += 1;
+		section->total_ns += ns;
+		section->max_ns = std::max(section->max_ns, ns);
+	}
+
+	void stats_record_object(ObjectType type) noexcept {
+		auto index = static_cast<std::size_t>(type);
+		if (index >= OBJECT_COUNT) return;
+		stats_counters().objects[index].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void stats_record_read(StatsReadBackend backend, std::size_t len) noexcept {
+		auto& counters = stats_counters();
+		auto index = static_cast<std::size_t>(backend);
+		counters.reads[index].fetch_add(1, std::memory_order_relaxed);
+		counters.read_bytes[index].fetch_add(len, std::memory_order_relaxed);
+	}
+
+	void Stats::record_allocation(std::size_t size) noexcept {
+		auto subsystem = zk_stats_subsystem;
+		if (subsystem < 0) return;
+
+		auto& counters = stats_counters();
+		counters.allocations[subsystem].fetch_add(1, std::memory_order_relaxed);
+		counters.allocated_bytes[subsystem].fetch_add(size, std::memory_order_relaxed);
+	}
+
+	StatsReport Stats::report() {
+		auto& counters = stats_counters();
+		StatsReport report {};
+
+		for (auto i = 0u; i < SUBSYSTEM_COUNT; ++i) {
+			auto allocations = counters.allocations[i].load(std::memory_order_relaxed);
+			if (allocations == 0) continue;
+
+			report.subsystems.push_back(StatsSubsystemReport {static_cast<StatsSubsystem>(i),
+			                                                  allocations,
+			                                                  counters.allocated_bytes[i].load(std::memory_order_relaxed)});
+		}
+
+		for (auto i = 0u; i < BACKEND_COUNT; ++i) {
+			auto reads = counters.reads[i].load(std::memory_order_relaxed);
+			if (reads == 0) continue;
+
+			report.reads.push_back(StatsReadReport {static_cast<StatsReadBackend>(i),
+			                                        reads,
+			                                        counters.read_bytes[i].load(std::memory_order_relaxed)});
+		}
+
+		for (auto i = 0u; i < OBJECT_COUNT; ++i) {
+			auto count = counters.objects[i].load(std::memory_order_relaxed);
+			if (count == 0) continue;
+
+			report.objects.push_back(StatsObjectReport {static_cast<ObjectType>(i), count});
+		}
+
+		std::lock_guard lock {counters.lock};
+		for (auto& s : counters.sections) {
+			report.sections.push_back(StatsSectionReport {s.name, s.subsystem, s.count, s.total_ns, s.max_ns});
+		}
+
+		return report;
+	}
+
+	void Stats::reset() {
+		auto& counters = stats_counters();
+
+		for (auto i = 0u; i < SUBSYSTEM_COUNT; ++i) {
+			counters.allocations[i] = 0;
+			counters.allocated_bytes[i] = 0;
+		}
+
+		for (auto i = 0u; i < BACKEND_COUNT; ++i) {
+			counters.reads[i] = 0;
+			counters.read_bytes[i] = 0;
+		}
+
+		for (auto& count : counters.objects) {
+			count = 0;
+		}
+
+		std::lock_guard lock {counters.lock};
+		counters.sections.clear();
+	}
+#else
+	StatsReport Stats::report() {
+		return {};
+	}
+
+	void Stats::reset() {}
+
+	void Stats::record_allocation(std::size_t) noexcept {}
+#endif
+} // namespace zenkit
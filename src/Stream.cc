@@ -214,7 +214,9 @@ namespace zenkit {
 			explicit ReadFile(FILE* stream) : _m_stream(stream) {}
 
 			size_t read(void* buf, size_t len) noexcept override {
-				return fread(buf, 1, len, _m_stream);
+				len = fread(buf, 1, len, _m_stream);
+				ZKSTATS_READ(FILE, len);
+				return len;
 			}
 
 			void seek(ssize_t off, Whence whence) noexcept override {
@@ -239,6 +241,7 @@ namespace zenkit {
 
 			size_t read(void* buf, size_t len) noexcept override {
 				_m_stream->read(static_cast<char*>(buf), static_cast<long>(len));
+				ZKSTATS_READ(STREAM, static_cast<size_t>(_m_stream->gcount()));
 				return static_cast<size_t>(_m_stream->gcount());
 			}
 
@@ -260,12 +263,17 @@ namespace zenkit {
 
 		class ReadMemory ZKINT : public Read {
 		public:
-			ReadMemory(std::byte const* byte, size_t len) : _m_bytes(byte), _m_length(len) {}
+			ReadMemory(std::byte const* byte, size_t len, StatsReadBackend backend = StatsReadBackend::MEMORY)
+			    : _m_bytes(byte), _m_length(len), _m_backend(backend) {}
 
 			size_t read(void* buf, size_t len) noexcept override {
 				len = _m_position + len > _m_length ? _m_length - _m_position : len;
 				memcpy(buf, _m_bytes + _m_position, len);
 				_m_position += len;
+
+#ifdef ZK_WITH_STATS
+				stats_record_read(_m_backend, len);
+#endif
 				return len;
 			}
 
@@ -288,6 +296,7 @@ namespace zenkit {
 		private:
 			std::byte const* _m_bytes;
 			size_t _m_length, _m_position {0};
+			[[maybe_unused]] StatsReadBackend _m_backend;
 		};
 
 		class ZKREM("Deprecated") ReadBuffer final ZKINT : public Read {
@@ -297,6 +306,7 @@ namespace zenkit {
 			size_t read(void* buf, size_t len) noexcept override {
 				try {
 					_m_buffer->get(static_cast<std::byte*>(buf), len);
+					ZKSTATS_READ(BUFFER, len);
 					return len;
 				} catch (phoenix::buffer_error const&) {
 					return 0;
@@ -334,7 +344,7 @@ namespace zenkit {
 		class ReadVector final ZKINT : public ReadMemory {
 		public:
 			explicit ReadVector(std::vector<std::byte> vec)
-			    : ReadMemory(vec.data(), vec.size()), _m_vector(std::move(vec)) {}
+			    : ReadMemory(vec.data(), vec.size(), StatsReadBackend::VECTOR), _m_vector(std::move(vec)) {}
 
 		private:
 			std::vector<std::byte> _m_vector;
@@ -345,7 +355,8 @@ namespace zenkit {
 		public:
 			explicit ReadMmap(std::filesystem::path const& path) : ReadMmap(Mmap {path}) {}
 
-			explicit ReadMmap(Mmap mmap) : ReadMemory(mmap.data(), mmap.size()), _m_mmap(std::move(mmap)) {}
+			explicit ReadMmap(Mmap mmap)
+			    : ReadMemory(mmap.data(), mmap.size(), StatsReadBackend::MMAP), _m_mmap(std::move(mmap)) {}
 
 		private:
 			Mmap _m_mmap;
@@ -0,0 +1,698 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/TangentFrames.hh"
+#include "zenkit/Mesh.hh"
+#include "zenkit/MultiResolutionMesh.hh"
+
+#include "Internal.hh"
+#include "Simd.hh"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+
+namespace zenkit {
+	/// \brief The number of elements processed by one task. Must be a multiple of four.
+	static constexpr std::size_t CHUNK_SIZE = 1024;
+
+	static constexpr float PI = 3.14159265f;
+
+	/// \brief The normal of corners not touching any non-degenerate face. ZenGin uses +Y as the up axis.
+	static constexpr glm::vec3 FALLBACK_NORMAL {0, 1, 0};
+
+	/// \brief Per-triangle data computed before smoothing.
+	struct TangentFrameFaces {
+		/// \brief The unit normal of each triangle or zero if it is degenerate.
+		std::vector<glm::vec3> normals;
+
+		/// \brief The angles of the three corners of each triangle.
+		std::vector<glm::vec3> angles;
+	};
+
+	// The scalar code below performs the same operations in the same order as the SIMD code, so that the result is
+	// identical regardless of which of them is used for a triangle.
+
+	/// \brief Approximates `acos(x)` with an absolute error of less than `7e-5`.
+	/// \see Abramowitz and Stegun, Handbook of Mathematical Functions, 4.4.45
+	static float approx_acos(float x) noexcept {
+		auto a = std::abs(x);
+		auto r = std::sqrt(1.0f - a) * (1.5707288f + a * (-0.2121144f + a * (0.0742610f + a * -0.0187293f)));
+		return x < 0 ? PI - r : r;
+	}
+
+	static float dot3(glm::vec3 a, glm::vec3 b) noexcept {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	/// \brief Computes the angle between two vectors given their dot product and the product of their squared lengths.
+	static float corner_angle(float dot, float squared_lengths) noexcept {
+		auto length = std::sqrt(squared_lengths);
+		auto c = length > 0 ? dot / length : 1.0f;
+		return approx_acos(std::min(std::max(c, -1.0f), 1.0f));
+	}
+
+	static void compute_face(TangentFrameFaces& faces, std::size_t i, glm::vec3 const p[3]) noexcept {
+		auto e01 = p[1] - p[0];
+		auto e02 = p[2] - p[0];
+		auto e12 = p[2] - p[1];
+
+		glm::vec3 n {e01.y * e02.z - e01.z * e02.y, e01.z * e02.x - e01.x * e02.z, e01.x * e02.y - e01.y * e02.x};
+		auto length = std::sqrt(dot3(n, n));
+		faces.normals[i] = length > 0 ? n / length : glm::vec3 {0};
+
+		auto l01 = dot3(e01, e01);
+		auto l02 = dot3(e02, e02);
+		auto l12 = dot3(e12, e12);
+		faces.angles[i] = glm::vec3 {
+		    corner_angle(dot3(e01, e02), l01 * l02),
+		    corner_angle(0.0f - dot3(e01, e12), l01 * l12),
+		    corner_angle(dot3(e02, e12), l02 * l12),
+		};
+	}
+
+#ifdef ZK_SSE2
+	struct Vec3x4 {
+		__m128 x, y, z;
+	};
+
+	static Vec3x4 sub(Vec3x4 const& a, Vec3x4 const& b) noexcept {
+		return {_mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z)};
+	}
+
+	static __m128 dot3(Vec3x4 const& a, Vec3x4 const& b) noexcept {
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+	}
+
+	/// \brief Divides \p a by \p length where \p length is positive and \p mask is set, otherwise returns zero.
+	static Vec3x4 normalize_or_zero(Vec3x4 const& a, __m128 length, __m128 mask) noexcept {
+		mask = _mm_and_ps(mask, _mm_cmpgt_ps(length, _mm_setzero_ps()));
+		return {_mm_and_ps(mask, _mm_div_ps(a.x, length)),
+		        _mm_and_ps(mask, _mm_div_ps(a.y, length)),
+		        _mm_and_ps(mask, _mm_div_ps(a.z, length))};
+	}
+
+	static __m128 approx_acos(__m128 x) noexcept {
+		auto a = abs_ps(x);
+		auto p = _mm_add_ps(_mm_set1_ps(0.0742610f), _mm_mul_ps(a, _mm_set1_ps(-0.0187293f)));
+		p = _mm_add_ps(_mm_set1_ps(-0.2121144f), _mm_mul_ps(a, p));
+		p = _mm_add_ps(_mm_set1_ps(1.5707288f), _mm_mul_ps(a, p));
+
+		auto r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a)), p);
+		return select_ps(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(PI), r), r);
+	}
+
+	static __m128 corner_angle(__m128 dot, __m128 squared_lengths) noexcept {
+		auto length = _mm_sqrt_ps(squared_lengths);
+		auto c = select_ps(_mm_cmpgt_ps(length, _mm_setzero_ps()), _mm_div_ps(dot, length), _mm_set1_ps(1.0f));
+		return approx_acos(_mm_min_ps(_mm_max_ps(c, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f)));
+	}
+
+	/// \brief Computes four faces starting at triangle \p i at once.
+	static void compute_faces(TangentFrameFaces& faces, std::size_t i, glm::vec3 const p[4][3]) noexcept {
+		Vec3x4 v[3];
+		for (auto k = 0; k < 3; ++k) {
+			v[k].x = _mm_setr_ps(p[0][k].x, p[1][k].x, p[2][k].x, p[3][k].x);
+			v[k].y = _mm_setr_ps(p[0][k].y, p[1][k].y, p[2][k].y, p[3][k].y);
+			v[k].z = _mm_setr_ps(p[0][k].z, p[1][k].z, p[2][k].z, p[3][k].z);
+		}
+
+		auto zero = _mm_setzero_ps();
+		auto all = _mm_cmpeq_ps(zero, zero);
+
+		auto e01 = sub(v[1], v[0]);
+		auto e02 = sub(v[2], v[0]);
+		auto e12 = sub(v[2], v[1]);
+
+		Vec3x4 n {
+		    _mm_sub_ps(_mm_mul_ps(e01.y, e02.z), _mm_mul_ps(e01.z, e02.y)),
+		    _mm_sub_ps(_mm_mul_ps(e01.z, e02.x), _mm_mul_ps(e01.x, e02.z)),
+		    _mm_sub_ps(_mm_mul_ps(e01.x, e02.y), _mm_mul_ps(e01.y, e02.x)),
+		};
+		n = normalize_or_zero(n, _mm_sqrt_ps(dot3(n, n)), all);
+		store_vec3x4(&faces.normals[i].x, n.x, n.y, n.z);
+
+		auto l01 = dot3(e01, e01);
+		auto l02 = dot3(e02, e02);
+		auto l12 = dot3(e12, e12);
+		store_vec3x4(&faces.angles[i].x,
+		             corner_angle(dot3(e01, e02), _mm_mul_ps(l01, l02)),
+		             corner_angle(_mm_sub_ps(zero, dot3(e01, e12)), _mm_mul_ps(l01, l12)),
+		             corner_angle(dot3(e02, e12), _mm_mul_ps(l02, l12)));
+	}
+#endif
+
+	/// \brief Normalizes \p count vectors, replacing zero vectors with FALLBACK_NORMAL.
+	static void normalize_normals(glm::vec3* v, std::size_t count) noexcept {
+		std::size_t i = 0;
+
+#ifdef ZK_SSE2
+		auto zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4) {
+			Vec3x4 n;
+			load_vec3x4(&v[i].x, n.x, n.y, n.z);
+
+			auto length = _mm_sqrt_ps(dot3(n, n));
+			auto valid = _mm_cmpgt_ps(length, zero);
+			n.x = select_ps(valid, _mm_div_ps(n.x, length), _mm_set1_ps(FALLBACK_NORMAL.x));
+			n.y = select_ps(valid, _mm_div_ps(n.y, length), _mm_set1_ps(FALLBACK_NORMAL.y));
+			n.z = select_ps(valid, _mm_div_ps(n.z, length), _mm_set1_ps(FALLBACK_NORMAL.z));
+			store_vec3x4(&v[i].x, n.x, n.y, n.z);
+		}
+#endif
+
+		for (; i < count; ++i) {
+			auto length = std::sqrt(dot3(v[i], v[i]));
+			v[i] = length > 0 ? v[i] / length : FALLBACK_NORMAL;
+		}
+	}
+
+	// The tangent generation below follows the reference implementation of MikkTSpace (mikktspace.c by Morten S.
+	// Mikkelsen, as used by Blender and the glTF exporters) with its default angular threshold of 180 degrees. It is
+	// reproduced step by step, including the order of floating point operations, so that normal maps baked against
+	// MikkTSpace are reproduced.
+
+	/// \brief Set on triangles with a positive texture-space area.
+	static constexpr std::uint8_t MIKK_ORIENT_PRESERVING = 1;
+
+	/// \brief Set on triangles without a usable texture mapping. They may join any group.
+	static constexpr std::uint8_t MIKK_GROUP_WITH_ANY = 2;
+
+	/// \brief The cosine of the default angular threshold of 180 degrees.
+	static constexpr float MIKK_THRESHOLD_COS = -1.0f;
+
+	/// \brief A non-degenerate triangle during tangent generation.
+	struct MikkTriangle {
+		/// \brief The index of the triangle in the mesh.
+		std::uint32_t face;
+
+		/// \brief The unit directions of increasing S and T or zero.
+		glm::vec3 os, ot;
+
+		/// \brief MIKK_ORIENT_PRESERVING and MIKK_GROUP_WITH_ANY.
+		std::uint8_t flags;
+
+		/// \brief The triangle across the edge starting at each corner or -1.
+		std::int32_t neighbors[3];
+
+		/// \brief The group each corner belongs to or -1.
+		std::int32_t groups[3];
+	};
+
+	/// \brief Triangles around one welded vertex which share an orientation and are connected by edges.
+	struct MikkGroup {
+		std::uint32_t vertex;
+		bool orient_preserving;
+		std::vector<std::uint32_t> triangles;
+	};
+
+	static bool mikk_not_zero(float x) noexcept {
+		return std::abs(x) > std::numeric_limits<float>::min();
+	}
+
+	static bool mikk_not_zero(glm::vec3 v) noexcept {
+		return mikk_not_zero(v.x) || mikk_not_zero(v.y) || mikk_not_zero(v.z);
+	}
+
+	static glm::vec3 mikk_normalize(glm::vec3 v) noexcept {
+		return v * (1.0f / std::sqrt(dot3(v, v)));
+	}
+
+	/// \brief Removes the component of \p v along the unit vector \p n and normalizes the result if it is not zero.
+	static glm::vec3 mikk_project(glm::vec3 n, glm::vec3 v) noexcept {
+		v = v - n * dot3(n, v);
+		return mikk_not_zero(v) ? mikk_normalize(v) : v;
+	}
+
+	/// \brief Assigns a tangent frame to each corner using MikkTSpace.
+	/// \param p The position of each corner.
+	/// \param n The unit normal of each corner.
+	/// \param uv The texture coordinates of each corner.
+	/// \param valid Whether each corner refers to an existing position.
+	/// \param out The tangent of each corner. Corners left uncovered have a `w` of zero.
+	static void generate_tangents(std::vector<glm::vec3> const& p,
+	                              std::vector<glm::vec3> const& n,
+	                              glm::vec2 const* uv,
+	                              std::vector<bool> const& valid,
+	                              std::vector<glm::vec4>& out,
+	                              std::uint32_t threads) {
+		auto corner_count = static_cast<std::uint32_t>(p.size());
+		auto triangle_count = corner_count / 3;
+
+		// Weld corners with identical position, normal and texture coordinates. Each is represented by the first.
+		std::vector<std::uint32_t> weld(corner_count);
+		{
+			using Key = std::array<std::uint32_t, 8>;
+			struct KeyHash {
+				std::size_t operator()(Key const& key) const noexcept {
+					std::size_t h = 0;
+					for (auto v : key) h = h * 0x9E3779B1u + v;
+					return h;
+				}
+			};
+
+			auto bits = [](float v) {
+				v = v == 0.0f ? 0.0f : v; // Weld negative and positive zero.
+				std::uint32_t b;
+				std::memcpy(&b, &v, sizeof b);
+				return b;
+			};
+
+			std::unordered_map<Key, std::uint32_t, KeyHash> first {};
+			first.reserve(corner_count);
+
+			for (auto i = 0u; i < corner_count; ++i) {
+				weld[i] = i;
+				if (!valid[i]) continue;
+
+				// NaN never compares equal, so corners containing it are never welded.
+				float values[8] = {p[i].x, p[i].y, p[i].z, n[i].x, n[i].y, n[i].z, uv[i].x, uv[i].y};
+				if (std::any_of(std::begin(values), std::end(values), [](float v) { return std::isnan(v); })) continue;
+
+				Key key {};
+				std::transform(std::begin(values), std::end(values), key.begin(), bits);
+				weld[i] = first.try_emplace(key, i).first->second;
+			}
+		}
+
+		// Set up the non-degenerate triangles, keeping their order.
+		std::vector<MikkTriangle> triangles {};
+		triangles.reserve(triangle_count);
+
+		for (auto f = 0u; f < triangle_count; ++f) {
+			auto& v1 = p[f * 3 + 0];
+			auto& v2 = p[f * 3 + 1];
+			auto& v3 = p[f * 3 + 2];
+			if (v1 == v2 || v1 == v3 || v2 == v3) continue;
+
+			auto t21 = uv[f * 3 + 1] - uv[f * 3 + 0];
+			auto t31 = uv[f * 3 + 2] - uv[f * 3 + 0];
+			auto d1 = v2 - v1;
+			auto d2 = v3 - v1;
+
+			auto area = t21.x * t31.y - t21.y * t31.x;
+			auto& tri = triangles.emplace_back();
+			tri.face = f;
+			tri.os = d1 * t31.y - d2 * t21.y;
+			tri.ot = d1 * -t31.x + d2 * t21.x;
+			tri.flags = static_cast<std::uint8_t>(MIKK_GROUP_WITH_ANY | (area > 0 ? MIKK_ORIENT_PRESERVING : 0));
+
+			for (auto i = 0; i < 3; ++i) {
+				tri.neighbors[i] = -1;
+				tri.groups[i] = -1;
+			}
+
+			if (mikk_not_zero(area)) {
+				auto abs_area = std::abs(area);
+				auto s = (tri.flags & MIKK_ORIENT_PRESERVING) != 0 ? 1.0f : -1.0f;
+				auto len_os = std::sqrt(dot3(tri.os, tri.os));
+				auto len_ot = std::sqrt(dot3(tri.ot, tri.ot));
+				if (mikk_not_zero(len_os)) tri.os = tri.os * (s / len_os);
+				if (mikk_not_zero(len_ot)) tri.ot = tri.ot * (s / len_ot);
+				if (mikk_not_zero(len_os / abs_area) && mikk_not_zero(len_ot / abs_area)) {
+					tri.flags = static_cast<std::uint8_t>(tri.flags & ~MIKK_GROUP_WITH_ANY);
+				}
+			}
+		}
+
+		auto welded = [&weld, &triangles](std::uint32_t t, std::uint32_t i) {
+			return weld[triangles[t].face * 3 + i];
+		};
+
+		// Connect triangles sharing an edge with opposite winding, pairing each edge with the first free match.
+		{
+			struct Edge {
+				std::uint32_t lo, hi, triangle, corner;
+			};
+
+			std::vector<Edge> edges {};
+			edges.reserve(triangles.size() * 3);
+
+			for (auto t = 0u; t < triangles.size(); ++t) {
+				for (auto i = 0u; i < 3; ++i) {
+					auto a = welded(t, i);
+					auto b = welded(t, (i + 1) % 3);
+					edges.push_back({std::min(a, b), std::max(a, b), t, i});
+				}
+			}
+
+			std::sort(edges.begin(), edges.end(), [](Edge const& a, Edge const& b) {
+				return std::tie(a.lo, a.hi, a.triangle, a.corner) < std::tie(b.lo, b.hi, b.triangle, b.corner);
+			});
+
+			for (auto i = 0u; i < edges.size(); ++i) {
+				auto& a = edges[i];
+				if (triangles[a.triangle].neighbors[a.corner] != -1) continue;
+
+				auto a0 = welded(a.triangle, a.corner);
+				auto a1 = welded(a.triangle, (a.corner + 1) % 3);
+
+				for (auto j = i + 1; j < edges.size() && edges[j].lo == a.lo && edges[j].hi == a.hi; ++j) {
+					auto& b = edges[j];
+					if (triangles[b.triangle].neighbors[b.corner] != -1) continue;
+					if (welded(b.triangle, b.corner) != a1 || welded(b.triangle, (b.corner + 1) % 3) != a0) continue;
+
+					triangles[a.triangle].neighbors[a.corner] = static_cast<std::int32_t>(b.triangle);
+					triangles[b.triangle].neighbors[b.corner] = static_cast<std::int32_t>(a.triangle);
+					break;
+				}
+			}
+		}
+
+		// Grow a group from each unassigned corner of every triangle with a usable texture mapping.
+		std::vector<MikkGroup> groups {};
+		std::vector<std::int32_t> stack {};
+
+		for (auto t = 0u; t < triangles.size(); ++t) {
+			if ((triangles[t].flags & MIKK_GROUP_WITH_ANY) != 0) continue;
+
+			for (auto i = 0u; i < 3; ++i) {
+				if (triangles[t].groups[i] != -1) continue;
+
+				auto g = static_cast<std::int32_t>(groups.size());
+				auto& group = groups.emplace_back();
+				group.vertex = welded(t, i);
+				group.orient_preserving = (triangles[t].flags & MIKK_ORIENT_PRESERVING) != 0;
+				group.triangles.push_back(t);
+				triangles[t].groups[i] = g;
+
+				stack.clear();
+				stack.push_back(triangles[t].neighbors[i > 0 ? i - 1 : 2]);
+				stack.push_back(triangles[t].neighbors[i]);
+
+				while (!stack.empty()) {
+					auto u = stack.back();
+					stack.pop_back();
+					if (u < 0) continue;
+
+					auto& tri = triangles[u];
+					auto k = welded(u, 0) == group.vertex ? 0u : welded(u, 1) == group.vertex ? 1u : 2u;
+					if (tri.groups[k] != -1) continue;
+
+					auto orientation = (tri.flags & MIKK_ORIENT_PRESERVING) != 0;
+					if ((tri.flags & MIKK_GROUP_WITH_ANY) != 0 && tri.groups[0] == -1 && tri.groups[1] == -1 &&
+					    tri.groups[2] == -1) {
+						orientation = group.orient_preserving;
+						auto others = tri.flags & ~MIKK_ORIENT_PRESERVING;
+						tri.flags = static_cast<std::uint8_t>(others | (orientation ? MIKK_ORIENT_PRESERVING : 0));
+					}
+
+					if (orientation != group.orient_preserving) continue;
+
+					group.triangles.push_back(static_cast<std::uint32_t>(u));
+					tri.groups[k] = g;
+
+					stack.push_back(tri.neighbors[k > 0 ? k - 1 : 2]);
+					stack.push_back(tri.neighbors[k]);
+				}
+			}
+		}
+
+		// Within each group, average over the triangles whose texture directions agree with each triangle's.
+		std::fill(out.begin(), out.end(), glm::vec4 {0});
+
+		auto group_chunks = (groups.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		parallel_for(group_chunks, threads, [&](std::size_t chunk) {
+			std::vector<std::vector<std::uint32_t>> subgroups {};
+			std::vector<glm::vec3> results {};
+			std::vector<std::uint32_t> members {};
+
+			auto end = std::min((chunk + 1) * CHUNK_SIZE, groups.size());
+			for (auto g = chunk * CHUNK_SIZE; g < end; ++g) {
+				auto& group = groups[g];
+				auto& normal = n[group.vertex];
+				subgroups.clear();
+				results.clear();
+
+				for (auto t : group.triangles) {
+					auto& tri = triangles[t];
+					auto k = 0u;
+					while (tri.groups[k] != static_cast<std::int32_t>(g)) ++k;
+
+					auto os = mikk_project(normal, tri.os);
+					auto ot = mikk_project(normal, tri.ot);
+
+					members.clear();
+					for (auto u : group.triangles) {
+						auto& other = triangles[u];
+						auto any = ((tri.flags | other.flags) & MIKK_GROUP_WITH_ANY) != 0;
+						auto same = any || u == t;
+
+						if (!same) {
+							auto cos_s = dot3(os, mikk_project(normal, other.os));
+							auto cos_t = dot3(ot, mikk_project(normal, other.ot));
+							same = cos_s > MIKK_THRESHOLD_COS && cos_t > MIKK_THRESHOLD_COS;
+						}
+
+						if (same) members.push_back(u);
+					}
+
+					std::sort(members.begin(), members.end());
+
+					auto it = std::find(subgroups.begin(), subgroups.end(), members);
+					if (it == subgroups.end()) {
+						glm::vec3 sum {0};
+
+						for (auto u : members) {
+							auto& other = triangles[u];
+							if ((other.flags & MIKK_GROUP_WITH_ANY) != 0) continue;
+
+							auto c = welded(u, 0) == group.vertex ? 0u : welded(u, 1) == group.vertex ? 1u : 2u;
+							auto p0 = p[other.face * 3 + (c > 0 ? c - 1 : 2)];
+							auto p1 = p[other.face * 3 + c];
+							auto p2 = p[other.face * 3 + (c < 2 ? c + 1 : 0)];
+
+							auto v1 = mikk_project(normal, p0 - p1);
+							auto v2 = mikk_project(normal, p2 - p1);
+							auto angle_cos = std::clamp(dot3(v1, v2), -1.0f, 1.0f);
+							auto angle = static_cast<float>(std::acos(static_cast<double>(angle_cos)));
+
+							sum = sum + mikk_project(normal, other.os) * angle;
+						}
+
+						results.push_back(mikk_not_zero(sum) ? mikk_normalize(sum) : sum);
+						subgroups.push_back(members);
+						it = subgroups.end() - 1;
+					}
+
+					auto& result = results[static_cast<std::size_t>(it - subgroups.begin())];
+					out[tri.face * 3 + k] = glm::vec4 {result, group.orient_preserving ? 1.0f : -1.0f};
+				}
+			}
+		});
+
+		// Corners of degenerate triangles copy the first non-degenerate corner welded to them.
+		std::vector<std::int32_t> first_good(corner_count, -1);
+		std::vector<bool> good(triangle_count, false);
+
+		for (auto& tri : triangles) {
+			good[tri.face] = true;
+			for (auto i = 0u; i < 3; ++i) {
+				auto& slot = first_good[weld[tri.face * 3 + i]];
+				if (slot == -1) slot = static_cast<std::int32_t>(tri.face * 3 + i);
+			}
+		}
+
+		for (auto f = 0u; f < triangle_count; ++f) {
+			if (good[f]) continue;
+
+			for (auto i = 0u; i < 3; ++i) {
+				auto source = first_good[weld[f * 3 + i]];
+				if (source != -1) out[f * 3 + i] = out[static_cast<std::size_t>(source)];
+			}
+		}
+	}
+
+	void TangentFrames::build(glm::vec3 const* positions,
+	                          std::size_t position_count,
+	                          std::uint32_t const* indices,
+	                          glm::vec2 const* texcoords,
+	                          std::size_t corner_count,
+	                          TangentFrameSettings const& settings) {
+		ZKTRACE_SCOPE("mesh", "TangentFrames.build");
+
+		auto triangle_count = corner_count / 3;
+		corner_count = triangle_count * 3;
+
+		auto with_tangents = settings.tangents && texcoords != nullptr;
+		auto cos_crease = std::cos(std::clamp(settings.crease_angle, 0.0f, PI));
+		auto chunks = [](std::size_t count) { return (count + CHUNK_SIZE - 1) / CHUNK_SIZE; };
+
+		auto fetch = [positions, position_count, indices](std::size_t corner) {
+			auto index = indices[corner];
+			return index < position_count ? positions[index] : glm::vec3 {0};
+		};
+
+		// Compute the normal and corner angles of every triangle.
+		TangentFrameFaces faces {};
+		faces.normals.resize(triangle_count);
+		faces.angles.resize(triangle_count);
+
+		parallel_for(chunks(triangle_count), settings.threads, [&](std::size_t chunk) {
+			auto i = chunk * CHUNK_SIZE;
+			auto end = std::min(i + CHUNK_SIZE, triangle_count);
+
+#ifdef ZK_SSE2
+			for (; i + 4 <= end; i += 4) {
+				glm::vec3 p[4][3];
+
+				for (auto j = 0u; j < 4; ++j) {
+					for (auto k = 0u; k < 3; ++k) {
+						p[j][k] = fetch((i + j) * 3 + k);
+					}
+				}
+
+				compute_faces(faces, i, p);
+			}
+#endif
+
+			for (; i < end; ++i) {
+				glm::vec3 p[3] = {fetch(i * 3 + 0), fetch(i * 3 + 1), fetch(i * 3 + 2)};
+				compute_face(faces, i, p);
+			}
+		});
+
+		// Collect the corners sharing each position, in ascending order so that sums are always formed the same way.
+		std::vector<std::uint32_t> offsets(position_count + 1, 0);
+		for (auto i = 0u; i < corner_count; ++i) {
+			if (indices[i] < position_count) offsets[indices[i] + 1] += 1;
+		}
+
+		for (auto i = 0u; i < position_count; ++i) {
+			offsets[i + 1] += offsets[i];
+		}
+
+		std::vector<std::uint32_t> corners(offsets.back());
+		{
+			std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (auto i = 0u; i < corner_count; ++i) {
+				if (indices[i] < position_count) corners[cursor[indices[i]]++] = i;
+			}
+		}
+
+		auto same_group = [&faces, cos_crease](std::uint32_t a, std::uint32_t b) {
+			auto& na = faces.normals[a / 3];
+			return na == glm::vec3 {0} || glm::dot(na, faces.normals[b / 3]) >= cos_crease;
+		};
+
+		// Sum the weighted face normals of each corner's smoothing group.
+		this->normals.resize(corner_count);
+		for (auto i = 0u; i < corner_count; ++i) {
+			if (indices[i] >= position_count) this->normals[i] = faces.normals[i / 3];
+		}
+
+		parallel_for(chunks(position_count), settings.threads, [&](std::size_t chunk) {
+			auto end = std::min((chunk + 1) * CHUNK_SIZE, position_count);
+
+			for (auto p = chunk * CHUNK_SIZE; p < end; ++p) {
+				for (auto i = offsets[p]; i < offsets[p + 1]; ++i) {
+					glm::vec3 sum {0};
+
+					for (auto j = offsets[p]; j < offsets[p + 1]; ++j) {
+						if (!same_group(corners[i], corners[j])) continue;
+						sum += faces.normals[corners[j] / 3] * faces.angles[corners[j] / 3][corners[j] % 3];
+					}
+
+					this->normals[corners[i]] = sum;
+				}
+			}
+		});
+
+		parallel_for(chunks(corner_count), settings.threads, [this, corner_count](std::size_t chunk) {
+			auto i = chunk * CHUNK_SIZE;
+			normalize_normals(this->normals.data() + i, std::min(CHUNK_SIZE, corner_count - i));
+		});
+
+		this->tangents.clear();
+		if (!with_tangents) return;
+
+		std::vector<glm::vec3> corner_positions(corner_count);
+		std::vector<bool> valid(corner_count);
+		for (auto i = 0u; i < corner_count; ++i) {
+			corner_positions[i] = fetch(i);
+			valid[i] = indices[i] < position_count;
+		}
+
+		this->tangents.resize(corner_count);
+		generate_tangents(corner_positions, this->normals, texcoords, valid, this->tangents, settings.threads);
+
+		// Corners without a usable texture mapping get an arbitrary tangent. MikkTSpace itself would emit +X here.
+		for (auto i = 0u; i < corner_count; ++i) {
+			auto& t = this->tangents[i];
+			if (t.w == 0) t.w = -1;
+			if (t.x != 0 || t.y != 0 || t.z != 0) continue;
+
+			auto& n = this->normals[i];
+			auto axis = std::abs(n.x) < 0.9f ? glm::vec3 {1, 0, 0} : glm::vec3 {0, 1, 0};
+			t = glm::vec4 {glm::normalize(glm::cross(n, axis)), t.w};
+		}
+	}
+
+	void TangentFrames::build(Mesh const& mesh, TangentFrameSettings const& settings) {
+		std::vector<std::uint32_t> indices {};
+		std::vector<glm::vec2> texcoords {};
+
+		auto add_corner = [&mesh, &indices, &texcoords](std::uint32_t vertex, std::uint32_t feature) {
+			indices.push_back(vertex);
+			texcoords.push_back(feature < mesh.features.size() ? mesh.features[feature].texture : glm::vec2 {0});
+		};
+
+		if (!mesh.polygons.vertex_indices.empty()) {
+			auto count = std::min(mesh.polygons.vertex_indices.size(), mesh.polygons.feature_indices.size());
+			indices.reserve(count);
+			texcoords.reserve(count);
+
+			for (auto i = 0u; i < count; ++i) {
+				add_corner(mesh.polygons.vertex_indices[i], mesh.polygons.feature_indices[i]);
+			}
+		} else {
+			for (auto& polygon : mesh.geometry) {
+				auto root = polygon.index_offset;
+				for (auto b = 2u; b < polygon.index_count; ++b) {
+					add_corner(mesh.polygon_vertex_indices[root], mesh.polygon_feature_indices[root]);
+					add_corner(mesh.polygon_vertex_indices[root + b - 1], mesh.polygon_feature_indices[root + b - 1]);
+					add_corner(mesh.polygon_vertex_indices[root + b], mesh.polygon_feature_indices[root + b]);
+				}
+			}
+		}
+
+		this->build(mesh.vertices.data(),
+		            mesh.vertices.size(),
+		            indices.data(),
+		            texcoords.data(),
+		            indices.size(),
+		            settings);
+	}
+
+	void TangentFrames::build(MultiResolutionMesh const& mesh, TangentFrameSettings const& settings) {
+		std::vector<std::uint32_t> indices {};
+		std::vector<glm::vec2> texcoords {};
+
+		for (auto& sub_mesh : mesh.sub_meshes) {
+			for (auto& triangle : sub_mesh.triangles) {
+				for (auto wedge : triangle.wedges) {
+					if (wedge < sub_mesh.wedges.size()) {
+						indices.push_back(sub_mesh.wedges[wedge].index);
+						texcoords.push_back(sub_mesh.wedges[wedge].texture);
+					} else {
+						indices.push_back(std::numeric_limits<std::uint32_t>::max());
+						texcoords.emplace_back(0);
+					}
+				}
+			}
+		}
+
+		this->build(mesh.positions.data(),
+		            mesh.positions.size(),
+		            indices.data(),
+		            texcoords.data(),
+		            indices.size(),
+		            settings);
+	}
+} // namespace zenkit
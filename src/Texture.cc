@@ -7,6 +7,8 @@
 
 #include "squish.h"
 
+#include "Internal.hh"
+
 #include <cstring>
 
 namespace zenkit {
@@ -293,6 +295,9 @@ namespace zenkit {
 	}
 
 	void Texture::load(Read* r) {
+		ZKSTATS_SCOPE(TEXTURE, "Texture.load");
+		ZKTRACE_SCOPE("texture", "Texture.load");
+
 		if (r->read_string(4) != ZTEX_SIGNATURE) {
 			throw ParserError {"texture", "invalid signature"};
 		}
@@ -0,0 +1,233 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/Trace.hh"
+#include "zenkit/Stream.hh"
+
+#include "Internal.hh"
+
+#include <algorithm>
+#include <charconv>
+#include <memory>
+#include <mutex>
+
+namespace zenkit {
+	std::atomic_bool zk_trace_active {false};
+
+	/// \brief The events recorded on a single thread. The lock is only contended while collecting events.
+	struct TraceBuffer {
+		std::mutex lock;
+		std::vector<TraceEvent> events;
+	};
+
+	struct TraceRegistry {
+		std::mutex lock;
+		std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+		/// \brief The buffers of threads which have exited. They are reused by new threads, so that the number of
+		///        buffers is bounded by the largest number of threads which have recorded events at the same time.
+		std::vector<TraceBuffer*> free;
+		std::atomic<std::chrono::steady_clock::rep> epoch {0};
+
+		/// \brief The number of threads which have recorded events so far. Used to assign thread ids.
+		std::atomic_uint32_t threads {0};
+	};
+
+	static TraceRegistry& trace_registry() {
+		static TraceRegistry registry {};
+		return registry;
+	}
+
+	/// \brief Assigns a buffer to a thread for as long as it is running. The events recorded by the thread are kept
+	///        in the buffer after it exits, so that they can still be collected. Every lease gets its own thread id,
+	///        even if its buffer was used by another thread before.
+	class TraceBufferLease {
+	public:
+		TraceBufferLease()
+		    : _m_registry(trace_registry()),
+		      _m_thread(_m_registry.threads.fetch_add(1, std::memory_order_relaxed)) {
+			std::lock_guard lock {_m_registry.lock};
+
+			if (!_m_registry.free.empty()) {
+				_m_buffer = _m_registry.free.back();
+				_m_registry.free.pop_back();
+				return;
+			}
+
+			_m_buffer = _m_registry.buffers.emplace_back(std::make_unique<TraceBuffer>()).get();
+		}
+
+		~TraceBufferLease() noexcept {
+			try {
+				std::lock_guard lock {_m_registry.lock};
+				_m_registry.free.push_back(_m_buffer);
+			} catch (...) {
+				// The buffer is not reused.
+			}
+		}
+
+		TraceBufferLease(TraceBufferLease const&) = delete;
+		TraceBufferLease& operator=(TraceBufferLease const&) = delete;
+
+		[[nodiscard]] TraceBuffer& buffer() const noexcept {
+			return *_m_buffer;
+		}
+
+		[[nodiscard]] std::uint32_t thread() const noexcept {
+			return _m_thread;
+		}
+
+	private:
+		TraceRegistry& _m_registry;
+		std::uint32_t _m_thread;
+		TraceBuffer* _m_buffer {nullptr};
+	};
+
+	static TraceBufferLease& trace_lease() {
+		thread_local TraceBufferLease lease {};
+		return lease;
+	}
+
+	void TraceScope::record() noexcept {
+		auto end = std::chrono::steady_clock::now();
+		auto epoch = std::chrono::steady_clock::time_point {
+		    std::chrono::steady_clock::duration {trace_registry().epoch.load(std::memory_order_relaxed)}};
+
+		// Sections which began before the last call to Trace::start are dropped.
+		if (_m_start < epoch) return;
+
+		try {
+			auto& lease = trace_lease();
+			auto& buffer = lease.buffer();
+			std::lock_guard lock {buffer.lock};
+			buffer.events.push_back(TraceEvent {
+			    _m_name,
+			    _m_category,
+			    std::string {_m_detail},
+			    static_cast<std::uint64_t>(std::chrono::nanoseconds {_m_start - epoch}.count()),
+			    static_cast<std::uint64_t>(std::chrono::nanoseconds {end - _m_start}.count()),
+			    lease.thread(),
+			});
+		} catch (...) {
+			// Tracing must never cause a failure. The event is simply lost.
+		}
+	}
+
+	void Trace::start() {
+		auto& registry = trace_registry();
+		std::lock_guard lock {registry.lock};
+
+		for (auto& buffer : registry.buffers) {
+			std::lock_guard buffer_lock {buffer->lock};
+			buffer->events.clear();
+		}
+
+		registry.epoch.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+		zk_trace_active.store(true, std::memory_order_relaxed);
+	}
+
+	void Trace::stop() noexcept {
+		zk_trace_active.store(false, std::memory_order_relaxed);
+	}
+
+	bool Trace::active() noexcept {
+		return zk_trace_active.load(std::memory_order_relaxed);
+	}
+
+	std::vector<TraceEvent> Trace::events() {
+		auto& registry = trace_registry();
+		std::lock_guard lock {registry.lock};
+
+		std::vector<TraceEvent> events {};
+		for (auto& buffer : registry.buffers) {
+			std::lock_guard buffer_lock {buffer->lock};
+			events.insert(events.end(), buffer->events.begin(), buffer->events.end());
+		}
+
+		std::stable_sort(events.begin(), events.end(), [](TraceEvent const& a, TraceEvent const& b) {
+			return a.start_ns < b.start_ns;
+		});
+		return events;
+	}
+
+	static void write_json_string(Write* w, std::string_view s) {
+		static constexpr char HEX[] = "0123456789abcdef";
+
+		w->write_char('"');
+		for (auto c : s) {
+			switch (c) {
+			case '"':
+				w->write_string("\\\"");
+				break;
+			case '\\':
+				w->write_string("\\\\");
+				break;
+			case '\n':
+				w->write_string("\\n");
+				break;
+			case '\r':
+				w->write_string("\\r");
+				break;
+			case '\t':
+				w->write_string("\\t");
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char escape[] = {'\\', 'u', '0', '0', HEX[(c >> 4) & 0xF], HEX[c & 0xF]};
+					w->write(escape, sizeof escape);
+				} else {
+					w->write_char(c);
+				}
+				break;
+			}
+		}
+		w->write_char('"');
+	}
+
+	static void write_json_number(Write* w, std::uint64_t v) {
+		char buf[24];
+		auto [end, ec] = std::to_chars(buf, buf + sizeof buf, v);
+		w->write(buf, static_cast<size_t>(end - buf));
+	}
+
+	/// \brief Writes a duration in nanoseconds as fractional microseconds as required by the trace event format.
+	static void write_json_micros(Write* w, std::uint64_t ns) {
+		write_json_number(w, ns / 1000);
+
+		char frac[] = {'.', '0', '0', '0'};
+		auto rem = ns % 1000;
+		frac[1] = static_cast<char>('0' + rem / 100);
+		frac[2] = static_cast<char>('0' + rem / 10 % 10);
+		frac[3] = static_cast<char>('0' + rem % 10);
+		w->write(frac, sizeof frac);
+	}
+
+	void Trace::write_chrome_json(Write* w) {
+		auto events = Trace::events();
+
+		w->write_string("{\"traceEvents\":[");
+		for (auto i = 0u; i < events.size(); ++i) {
+			auto& event = events[i];
+			if (i != 0) w->write_char(',');
+
+			w->write_string("\n{\"name\":");
+			write_json_string(w, event.name);
+			w->write_string(",\"cat\":");
+			write_json_string(w, event.category);
+			w->write_string(",\"ph\":\"X\",\"ts\":");
+			write_json_micros(w, event.start_ns);
+			w->write_string(",\"dur\":");
+			write_json_micros(w, event.duration_ns);
+			w->write_string(",\"pid\":1,\"tid\":");
+			write_json_number(w, event.thread);
+
+			if (!event.detail.empty()) {
+				w->write_string(",\"args\":{\"detail\":");
+				write_json_string(w, event.detail);
+				w->write_char('}');
+			}
+
+			w->write_char('}');
+		}
+		w->write_string("\n],\"displayTimeUnit\":\"ms\"}\n");
+	}
+} // namespace zenkit
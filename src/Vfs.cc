@@ -167,7 +167,8 @@ namespace zenkit {
 			return Read::from(buf.array(), buf.limit());
 		}
 
-		auto fd = std::get<VfsFileDescriptor>(_m_data);
+		// NOTE: Don't copy the descriptor here. Its reference count is not atomic and nodes may be read concurrently.
+		auto const& fd = std::get<VfsFileDescriptor>(_m_data);
 		return Read::from(fd.memory, fd.size);
 	}
 
@@ -512,6 +513,8 @@ namespace zenkit {
 	void Vfs::mount_host(std::filesystem::path const& sourcePath,
 	                     std::string_view mountPoint,
 	                     VfsOverwriteBehavior overwrite) {
+		std::string trace_detail {};
+		ZKTRACE_SCOPE_DETAIL("vfs", "Vfs.mount_host", trace_detail = sourcePath.string());
 		auto root = VfsNode::directory(sourcePath.filename().string());
 
 		std::function<void(VfsNode*, std::filesystem::path const&)> load_directory =
@@ -554,6 +557,9 @@ namespace zenkit {
 	}
 
 	void Vfs::mount_disk(std::byte const* buf, std::size_t size, VfsOverwriteBehavior overwrite) {
+		ZKSTATS_SCOPE(VFS, "Vfs.mount_disk");
+		ZKTRACE_SCOPE("vfs", "Vfs.mount_disk");
+
 		auto r = Read::from(buf, size);
 
 		auto comment = r->read_string(256);
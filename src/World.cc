@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 #include "zenkit/World.hh"
 #include "zenkit/Archive.hh"
+#include "zenkit/Sniff.hh"
 #include "zenkit/Stream.hh"
 #include "zenkit/vobs/Misc.hh"
 
@@ -9,42 +10,9 @@
 #include "zenkit/CutsceneLibrary.hh"
 
 namespace zenkit {
-	[[maybe_unused]] static constexpr uint32_t BSP_VERSION_G1 = 0x2090000;
+	static constexpr uint32_t BSP_VERSION_G1 = 0x2090000;
 	static constexpr uint32_t BSP_VERSION_G2 = 0x4090000;
 
-	/// \brief Tries to determine the serialization version of a game world.
-	///
-	/// This function might be very slow. If the VOb tree or way-net or both come before the mesh section in the
-	/// archive, they have to be skipped since only the `MeshAndBsp` section of the world can be used to reliably
-	/// determine the version being used.
-	///
-	/// \param buf A buffer containing the world's data.
-	/// \return The game version associated with that world.
-	static GameVersion determine_world_version(Read* buf) {
-		auto archive = ReadArchive::from(buf);
-
-		if (archive->is_save_game()) {
-			throw ParserError {"World", "cannot automatically detect world version for save-games!s"};
-		}
-
-		ArchiveObject chnk {};
-		archive->read_object_begin(chnk);
-
-		while (!archive->read_object_end()) {
-			archive->read_object_begin(chnk);
-
-			if (chnk.object_name == "MeshAndBsp") {
-				auto bsp_version = buf->read_uint();
-				return bsp_version == BSP_VERSION_G2 ? GameVersion::GOTHIC_2 : GameVersion::GOTHIC_1;
-			}
-
-			archive->skip_object(true);
-		}
-
-		ZKLOGE("World", "Failed to determine world version. Assuming Gothic 1.");
-		return GameVersion::GOTHIC_1;
-	}
-
 	World World::parse(phoenix::buffer& buf, GameVersion version) {
 		World wld {};
 
@@ -72,13 +40,22 @@ namespace zenkit {
 	}
 
 	void World::load(Read* r) {
-		auto begin = r->tell();
-		auto version = determine_world_version(r);
-		r->seek(static_cast<ssize_t>(begin), Whence::BEG);
-		this->load(r, version);
+		auto info = sniff(r);
+		if (info.save) {
+			throw ParserError {"World", "cannot automatically detect world version for save-games!s"};
+		}
+
+		if (!info.version) {
+			ZKLOGE("World", "Failed to determine world version. Assuming Gothic 1.");
+		}
+
+		this->load(r, info.version.value_or(GameVersion::GOTHIC_1));
 	}
 
 	void World::load(Read* r, GameVersion version) {
+		ZKSTATS_SCOPE(WORLD, "World.load");
+		ZKTRACE_SCOPE("world", "World.load");
+
 		ArchiveObject chnk {};
 		auto ar = ReadArchive::from(r);
 		ar->read_object_begin(chnk);
@@ -95,7 +72,57 @@ namespace zenkit {
 		}
 	}
 
+	/// \brief Skips the chunks of the world mesh and BSP-tree which make up the contents of a `MeshAndBsp` section.
+	static void skip_mesh_and_bsp(Read* r) {
+		static constexpr std::uint16_t BSP_CHUNK_END = 0xC0FF;
+
+		(void) /* bsp_version = */ r->read_uint();
+		(void) /* size = */ r->read_uint();
+
+		// The mesh chunks are immediately followed by the BSP chunks, which end with an end-chunk.
+		std::uint16_t chunk_type;
+		do {
+			chunk_type = r->read_ushort();
+			r->seek(r->read_uint(), Whence::CUR);
+		} while (chunk_type != BSP_CHUNK_END);
+	}
+
+	std::vector<std::shared_ptr<VirtualObject>> World::visit_vobs(Read* r, GameVersion version, VobVisitor& visitor) {
+		ZKTRACE_SCOPE("world", "World.visit_vobs");
+
+		ArchiveObject chnk {};
+		auto ar = ReadArchive::from(r);
+		ar->read_object_begin(chnk);
+
+		if (chnk.class_name != "oCWorld:zCWorld") {
+			throw ParserError {"World", "'oCWorld:zCWorld' chunk expected, got '" + chnk.class_name + "'"};
+		}
+
+		std::vector<std::shared_ptr<VirtualObject>> vobs {};
+		while (!ar->read_object_end()) {
+			if (!ar->read_object_begin(chnk)) {
+				throw ParserError {"World", "Failed to load zCWorld: expected object, got field!"};
+			}
+
+			if (chnk.object_name == "VobTree") {
+				vobs = visit_vob_tree(*ar, version, visitor);
+			} else if (chnk.object_name == "MeshAndBsp") {
+				skip_mesh_and_bsp(ar->get_stream());
+			} else if (chnk.object_name == "EndMarker") {
+				ar->read_object_end();
+				break;
+			}
+
+			if (!ar->read_object_end()) {
+				ar->skip_object(true);
+			}
+		}
+
+		return vobs;
+	}
+
 	void World::load(ReadArchive& r, GameVersion version) {
+		this->invalidate_vob_index();
 		ArchiveObject hdr;
 
 		// Load properties of `zCWorld`
@@ -112,6 +139,7 @@ namespace zenkit {
 			       hdr.index);
 
 			if (hdr.object_name == "MeshAndBsp") {
+				ZKTRACE_SCOPE("world", "World.load_mesh_and_bsp");
 				auto* raw = r.get_stream();
 
 				auto bsp_version = raw->read_uint();
@@ -138,6 +166,7 @@ namespace zenkit {
 
 				raw->seek(static_cast<ssize_t>(end), Whence::BEG);
 			} else if (hdr.object_name == "VobTree") {
+				ZKTRACE_SCOPE("world", "World.load_vob_tree");
 				auto count = r.read_int(); // childs0
 				for (auto i = 0; i < count; ++i) {
 					auto child = parse_vob_tree(r, version);
@@ -151,6 +180,7 @@ namespace zenkit {
 					this->world_vobs.push_back(std::move(child));
 				}
 			} else if (hdr.object_name == "WayNet") {
+				ZKTRACE_SCOPE("world", "World.load_way_net");
 #ifndef ZK_FUTURE
 				this->world_way_net.load(r);
 #else
@@ -177,6 +207,8 @@ namespace zenkit {
 		}
 
 		if (r.is_save_game()) {
+			ZKTRACE_SCOPE("world", "World.load_npcs");
+
 			// Then, read all the NPCs
 			auto npc_count = r.read_int(); // npcCount
 			this->npcs.resize(npc_count);
@@ -207,7 +239,7 @@ namespace zenkit {
 			w.write_object_begin("MeshAndBsp", "", 0);
 
 			Write* raw = w.get_stream();
-			raw->write_uint(0); // TODO: version
+			raw->write_uint(version == GameVersion::GOTHIC_1 ? BSP_VERSION_G1 : BSP_VERSION_G2);
 			raw->write_uint(0); // TODO: size
 
 			this->world_mesh.save(raw, version);
@@ -327,4 +359,50 @@ namespace zenkit {
 			w.write_int("", rain_ctr);          // rainCtr
 		}
 	}
+
+	VobIndex const& World::vob_index() {
+		if (!_m_vob_index_valid) {
+			_m_vob_index.build(this->world_vobs);
+			_m_vob_index_valid = true;
+		}
+
+		return _m_vob_index;
+	}
+
+	void World::invalidate_vob_index() noexcept {
+		_m_vob_index.clear();
+		_m_vob_index_valid = false;
+	}
+
+	void World::add_vob(std::shared_ptr<VirtualObject> vob, VirtualObject* parent) {
+		if (_m_vob_index_valid) _m_vob_index.insert(vob);
+
+		auto& siblings = parent == nullptr ? this->world_vobs : parent->children;
+		siblings.push_back(std::move(vob));
+	}
+
+	static std::shared_ptr<VirtualObject> remove_vob_from(std::vector<std::shared_ptr<VirtualObject>>& vobs,
+	                                                      VirtualObject const* vob) {
+		for (auto it = vobs.begin(); it != vobs.end(); ++it) {
+			if (*it == nullptr) continue;
+
+			if (it->get() == vob) {
+				auto removed = std::move(*it);
+				vobs.erase(it);
+				return removed;
+			}
+
+			if (auto removed = remove_vob_from((*it)->children, vob); removed != nullptr) {
+				return removed;
+			}
+		}
+
+		return nullptr;
+	}
+
+	std::shared_ptr<VirtualObject> World::remove_vob(VirtualObject const* vob) {
+		auto removed = remove_vob_from(this->world_vobs, vob);
+		if (removed != nullptr && _m_vob_index_valid) _m_vob_index.erase(*removed);
+		return removed;
+	}
 } // namespace zenkit
@@ -398,16 +398,11 @@ namespace zenkit {
 		this->_m_write->write_string(name);
 		this->_m_write->write_string("=raw:");
 
-		std::array<char, 2> buf {};
+		static constexpr char hex[] = "0123456789abcdef";
 		for (auto i = 0u; i < length; ++i) {
-			std::to_chars(buf.data(), buf.data() + buf.size(), static_cast<unsigned char>(v[i]), 16);
-
-			if (buf[1] == '\0') {
-				this->_m_write->write_char('0');
-				this->_m_write->write_char(buf[0]);
-			} else {
-				this->_m_write->write_string(buf.data());
-			}
+			auto b = static_cast<unsigned char>(v[i]);
+			this->_m_write->write_char(hex[b >> 4]);
+			this->_m_write->write_char(hex[b & 0xF]);
 		}
 
 		this->_m_write->write_char('\n');
@@ -4,6 +4,9 @@
 #include "zenkit/Archive.hh"
 
 namespace zenkit {
+	VTrigger::VTrigger() = default;
+	VTrigger::~VTrigger() = default;
+
 	void VTrigger::parse(VTrigger& obj, ReadArchive& r, GameVersion version) {
 		obj.load(r, version);
 	}
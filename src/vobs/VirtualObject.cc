@@ -21,6 +21,9 @@ namespace zenkit {
 	    {ObjectType::zCMorphMesh, VisualType::MORPH_MESH},
 	};
 
+	VirtualObject::VirtualObject() = default;
+	VirtualObject::~VirtualObject() = default;
+
 	VisualDecal VisualDecal::parse(ReadArchive& in, GameVersion version) {
 		VisualDecal dc {};
 		dc.load(in, version);
@@ -0,0 +1,493 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/World.hh"
+#include "zenkit/vobs/Camera.hh"
+#include "zenkit/vobs/Light.hh"
+#include "zenkit/vobs/Misc.hh"
+#include "zenkit/vobs/MovableObject.hh"
+#include "zenkit/vobs/Sound.hh"
+#include "zenkit/vobs/Trigger.hh"
+#include "zenkit/vobs/Zone.hh"
+
+#include "../Internal.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <unordered_set>
+
+namespace zenkit {
+	/// \brief The number of bytes requested through all CountingAllocator instances on this thread.
+	static thread_local std::size_t counted_bytes = 0;
+
+	/// \brief A stateless allocator which counts the bytes it allocates, so that it does not change the layout of
+	///        the control blocks created by `std::allocate_shared`.
+	template <typename T>
+	struct CountingAllocator {
+		using value_type = T;
+
+		CountingAllocator() noexcept = default;
+
+		template <typename U>
+		CountingAllocator(CountingAllocator<U> const&) noexcept {}
+
+		T* allocate(std::size_t n) {
+			counted_bytes += n * sizeof(T);
+			return std::allocator<T> {}.allocate(n);
+		}
+
+		void deallocate(T* p, std::size_t n) noexcept {
+			std::allocator<T> {}.deallocate(p, n);
+		}
+
+		template <typename U>
+		bool operator==(CountingAllocator<U> const&) const noexcept {
+			return true;
+		}
+
+		template <typename U>
+		bool operator!=(CountingAllocator<U> const&) const noexcept {
+			return false;
+		}
+	};
+
+	/// \brief Measures the number of bytes allocated alongside an object created using `std::make_shared`, i.e. the
+	///        size of its control block including padding.
+	///
+	/// The size is measured once using `std::allocate_shared` with an empty allocator, which lays out its control block
+	/// like `std::make_shared` does in all major standard libraries. Objects with a smaller alignment than
+	/// `std::max_align_t` may need less padding, and objects owned by a `std::shared_ptr` created from a raw pointer
+	/// have a separately allocated control block, so for them this is an estimate.
+	static std::size_t shared_control_block_size() {
+		static std::size_t const size = [] {
+			auto before = counted_bytes;
+			auto ptr = std::allocate_shared<std::max_align_t>(CountingAllocator<std::max_align_t> {});
+			return counted_bytes - before - sizeof(*ptr);
+		}();
+
+		return size;
+	}
+
+	/// \brief Counts the heap memory held by world components, counting shared objects only once.
+	class MemoryCounter {
+	public:
+		template <typename T>
+		static std::size_t of(std::vector<T> const& v) noexcept {
+			return v.capacity() * sizeof(T);
+		}
+
+		static std::size_t of(std::string const& s) noexcept {
+			// Short strings are stored inline and don't allocate.
+			static std::size_t const inline_capacity = std::string {}.capacity();
+			return s.capacity() > inline_capacity ? s.capacity() + 1 : 0;
+		}
+
+		static std::size_t of(std::vector<std::string> const& v) noexcept {
+			auto size = v.capacity() * sizeof(std::string);
+			for (auto& s : v) size += of(s);
+			return size;
+		}
+
+		/// \return Whether the given shared object has not been counted before.
+		bool first(void const* p) {
+			return p != nullptr && _m_visited.insert(p).second;
+		}
+
+		std::size_t of(Material const& m) noexcept {
+			return of(m.name) + of(m.texture) + of(m.detail_object);
+		}
+
+		std::size_t of(LightMap const& lm) {
+			if (!first(lm.image.get())) return 0;
+
+			auto size = sizeof(Texture) + shared_control_block_size();
+			size += lm.image->mipmaps() * sizeof(std::vector<std::uint8_t>);
+			for (auto i = 0u; i < lm.image->mipmaps(); ++i) {
+				size += of(lm.image->data(i));
+			}
+
+			return size;
+		}
+
+		std::size_t of(BspTree const& bsp) noexcept {
+			auto size = of(bsp.polygon_indices) + of(bsp.leaf_polygons) + of(bsp.light_points) + of(bsp.sectors) +
+			    of(bsp.portal_polygon_indices) + of(bsp.nodes) + of(bsp.leaf_node_indices);
+
+			for (auto& sector : bsp.sectors) {
+				size += of(sector.name) + of(sector.node_indices) + of(sector.portal_polygon_indices);
+			}
+
+			return size;
+		}
+
+#ifndef ZK_FUTURE
+		std::size_t of(WayNet const& wn) noexcept {
+			auto size = of(wn.waypoints) + of(wn.edges);
+			for (auto& wp : wn.waypoints) size += of(wp.name);
+			return size;
+		}
+#else
+		std::size_t of(std::shared_ptr<WayNet> const& wn) {
+			if (!first(wn.get())) return 0;
+
+			auto size = sizeof(WayNet) + shared_control_block_size() + of(wn->points) + of(wn->edges);
+			for (auto& wp : wn->points) {
+				if (!first(wp.get())) continue;
+				size += sizeof(WayPoint) + shared_control_block_size() + of(wp->name);
+			}
+			return size;
+		}
+#endif
+
+		/// \brief Counts a VOb and all its children, recording the memory of each one by its type.
+		/// \return The memory used by the VOb and all its children.
+		template <typename T>
+		std::size_t vob(std::shared_ptr<T> const& obj, WorldMemoryReport& report) {
+			auto* ptr = static_cast<VirtualObject const*>(obj.get());
+			if (!first(ptr)) return 0;
+
+			auto& vobj = *ptr;
+			auto own = shared_control_block_size() + of(vobj.preset_name) + of(vobj.vob_name) + of(vobj.children);
+			auto children = std::size_t {0};
+
+			if (first(vobj.visual.get())) {
+				own += shared_control_block_size() + of(vobj.visual->name);
+				own += vobj.visual->type == VisualType::DECAL ? sizeof(VisualDecal) : sizeof(Visual);
+			}
+
+			if (first(vobj.ai.get())) {
+				own += shared_control_block_size();
+				own += vobj.ai->get_object_type() == ObjectType::oCAIHuman ? sizeof(AiHuman) : sizeof(AiMove);
+			}
+
+			if (first(vobj.event_manager.get())) {
+				own += shared_control_block_size() + sizeof(EventManager);
+			}
+
+			own += this->vob_type_specific(vobj, report, children);
+
+			for (auto& child : vobj.children) {
+				children += this->vob(child, report);
+			}
+
+			auto& stats = report.vob_types[vobj.type];
+			stats.count += 1;
+			stats.bytes += own;
+			return own + children;
+		}
+
+	private:
+		std::size_t trigger(VTrigger const& v, WorldMemoryReport& report, std::size_t& children) {
+			children += this->vob(v.s_other_vob, report);
+			return of(v.target) + of(v.vob_target);
+		}
+
+		std::size_t movable(VMovableObject const& v) noexcept {
+			return of(v.name) + of(v.visual_destroyed) + of(v.owner) + of(v.owner_guild);
+		}
+
+		std::size_t interactive(VInteractiveObject const& v) noexcept {
+			return movable(v) + of(v.target) + of(v.item) + of(v.condition_function) +
+			    of(v.on_state_change_function);
+		}
+
+		std::size_t npc(VNpc const& v, WorldMemoryReport& report, std::size_t& children) {
+			auto size = of(v.npc_instance) + of(v.overlays) + of(v.talents) + of(v.start_ai_state) +
+			    of(v.script_waypoint) + of(v.news) + of(v.items) + of(v.slots) + of(v.current_state_name) +
+			    of(v.next_state_name) + of(v.current_routine);
+
+			for (auto& packed : v.packed) size += of(packed);
+
+			for (auto& talent : v.talents) {
+				if (first(talent.get())) size += sizeof(VNpc::Talent) + shared_control_block_size();
+			}
+
+			for (auto& news : v.news) {
+				size += sizeof(VNpc::News) + of(news->witness_name) + of(news->offender_name) + of(news->victim_name);
+			}
+
+			for (auto& slot : v.slots) {
+				size += sizeof(VNpc::Slot) + of(slot->name);
+				children += this->vob(slot->item, report);
+			}
+
+			for (auto& item : v.items) children += this->vob(item, report);
+			children += this->vob(v.carry_vob, report);
+			children += this->vob(v.enemy, report);
+			return size;
+		}
+
+		/// \return The size of the VOb itself and of all memory owned only by its concrete type.
+		std::size_t vob_type_specific(VirtualObject const& v, WorldMemoryReport& report, std::size_t& children) {
+			switch (v.type) {
+			case VirtualObjectType::zCVobLevelCompo:
+				return sizeof(VLevel);
+			case VirtualObjectType::oCItem:
+				return sizeof(VItem) + of(static_cast<VItem const&>(v).instance);
+			case VirtualObjectType::oCNpc:
+				return sizeof(VNpc) + npc(static_cast<VNpc const&>(v), report, children);
+			case VirtualObjectType::zCMoverController:
+				return sizeof(VMoverController) + of(static_cast<VMoverController const&>(v).target);
+			case VirtualObjectType::zCVobScreenFX:
+				return sizeof(VScreenEffect);
+			case VirtualObjectType::zCVobStair:
+				return sizeof(VStair);
+			case VirtualObjectType::zCPFXController:
+				return sizeof(VParticleEffectController) + of(static_cast<VParticleEffectController const&>(v).pfx_name);
+			case VirtualObjectType::zCVobAnimate:
+				return sizeof(VAnimate);
+			case VirtualObjectType::zCVobLensFlare:
+				return sizeof(VLensFlare) + of(static_cast<VLensFlare const&>(v).fx);
+			case VirtualObjectType::zCVobLight: {
+				auto& light = static_cast<VLight const&>(v);
+				return sizeof(VLight) + of(light.preset) + of(light.lensflare_fx) + of(light.range_animation_scale) +
+				    of(light.color_animation_list);
+			}
+			case VirtualObjectType::zCVobSpot:
+				return sizeof(VSpot);
+			case VirtualObjectType::zCVobStartpoint:
+				return sizeof(VStartPoint);
+			case VirtualObjectType::zCMessageFilter:
+				return sizeof(VMessageFilter) + of(static_cast<VMessageFilter const&>(v).target);
+			case VirtualObjectType::zCCodeMaster: {
+				auto& master = static_cast<VCodeMaster const&>(v);
+				return sizeof(VCodeMaster) + of(master.target) + of(master.failure_target) + of(master.slaves);
+			}
+			case VirtualObjectType::zCTriggerWorldStart:
+				return sizeof(VTriggerWorldStart) + of(static_cast<VTriggerWorldStart const&>(v).target);
+			case VirtualObjectType::zCCSCamera: {
+				auto& camera = static_cast<VCutsceneCamera const&>(v);
+				for (auto& frame : camera.trajectory_frames) children += this->vob(frame, report);
+				for (auto& frame : camera.target_frames) children += this->vob(frame, report);
+				return sizeof(VCutsceneCamera) + of(camera.auto_focus_vob) + of(camera.trajectory_frames) +
+				    of(camera.target_frames);
+			}
+			case VirtualObjectType::zCCamTrj_KeyFrame:
+				return sizeof(VCameraTrajectoryFrame);
+			case VirtualObjectType::oCTouchDamage:
+				return sizeof(VTouchDamage);
+			case VirtualObjectType::zCTriggerUntouch:
+				return sizeof(VTriggerUntouch) + of(static_cast<VTriggerUntouch const&>(v).target);
+			case VirtualObjectType::zCEarthquake:
+				return sizeof(VEarthquake);
+			case VirtualObjectType::oCMOB:
+				return sizeof(VMovableObject) + movable(static_cast<VMovableObject const&>(v));
+			case VirtualObjectType::oCMobInter:
+				return sizeof(VInteractiveObject) + interactive(static_cast<VInteractiveObject const&>(v));
+			case VirtualObjectType::oCMobBed:
+				return sizeof(VBed) + interactive(static_cast<VInteractiveObject const&>(v));
+			case VirtualObjectType::oCMobFire: {
+				auto& fire = static_cast<VFire const&>(v);
+				return sizeof(VFire) + interactive(fire) + of(fire.slot) + of(fire.vob_tree);
+			}
+			case VirtualObjectType::oCMobLadder:
+				return sizeof(VLadder) + interactive(static_cast<VInteractiveObject const&>(v));
+			case VirtualObjectType::oCMobSwitch:
+				return sizeof(VSwitch) + interactive(static_cast<VInteractiveObject const&>(v));
+			case VirtualObjectType::oCMobWheel:
+				return sizeof(VWheel) + interactive(static_cast<VInteractiveObject const&>(v));
+			case VirtualObjectType::oCMobContainer: {
+				auto& container = static_cast<VContainer const&>(v);
+				for (auto& item : container.s_items) children += this->vob(item, report);
+				return sizeof(VContainer) + interactive(container) + of(container.key) + of(container.pick_string) +
+				    of(container.contents) + of(container.s_items);
+			}
+			case VirtualObjectType::oCMobDoor: {
+				auto& door = static_cast<VDoor const&>(v);
+				return sizeof(VDoor) + interactive(door) + of(door.key) + of(door.pick_string);
+			}
+			case VirtualObjectType::zCTrigger:
+				return sizeof(VTrigger) + trigger(static_cast<VTrigger const&>(v), report, children);
+			case VirtualObjectType::zCTriggerList: {
+				auto& list = static_cast<VTriggerList const&>(v);
+				auto size = sizeof(VTriggerList) + trigger(list, report, children) + of(list.targets);
+				for (auto& target : list.targets) size += of(target.name);
+				return size;
+			}
+			case VirtualObjectType::oCTriggerScript: {
+				auto& script = static_cast<VTriggerScript const&>(v);
+				return sizeof(VTriggerScript) + trigger(script, report, children) + of(script.function);
+			}
+			case VirtualObjectType::oCTriggerChangeLevel: {
+				auto& change = static_cast<VTriggerChangeLevel const&>(v);
+				return sizeof(VTriggerChangeLevel) + trigger(change, report, children) + of(change.level_name) +
+				    of(change.start_vob);
+			}
+			case VirtualObjectType::oCCSTrigger:
+				return sizeof(VCutsceneTrigger) + trigger(static_cast<VTrigger const&>(v), report, children);
+			case VirtualObjectType::zCMover: {
+				auto& mover = static_cast<VMover const&>(v);
+				return sizeof(VMover) + trigger(mover, report, children) + of(mover.keyframes) +
+				    of(mover.sfx_open_start) + of(mover.sfx_open_end) + of(mover.sfx_transitioning) +
+				    of(mover.sfx_close_start) + of(mover.sfx_close_end) + of(mover.sfx_lock) + of(mover.sfx_unlock) +
+				    of(mover.sfx_use_locked);
+			}
+			case VirtualObjectType::zCVobSound:
+				return sizeof(VSound) + of(static_cast<VSound const&>(v).sound_name);
+			case VirtualObjectType::zCVobSoundDaytime: {
+				auto& sound = static_cast<VSoundDaytime const&>(v);
+				return sizeof(VSoundDaytime) + of(sound.sound_name) + of(sound.sound_name2);
+			}
+			case VirtualObjectType::oCZoneMusic:
+				return sizeof(VZoneMusic);
+			case VirtualObjectType::oCZoneMusicDefault:
+				return sizeof(VZoneMusicDefault);
+			case VirtualObjectType::zCZoneZFog:
+				return sizeof(VZoneFog);
+			case VirtualObjectType::zCZoneZFogDefault:
+				return sizeof(VZoneFogDefault);
+			case VirtualObjectType::zCZoneVobFarPlane:
+				return sizeof(VZoneFarPlane);
+			case VirtualObjectType::zCZoneVobFarPlaneDefault:
+				return sizeof(VZoneFarPlaneDefault);
+			case VirtualObjectType::zCVob:
+			case VirtualObjectType::UNKNOWN:
+				break;
+			}
+
+			return sizeof(VirtualObject);
+		}
+
+		std::unordered_set<void const*> _m_visited;
+	};
+
+	template <typename T>
+	static void release(std::vector<T>& v) noexcept {
+		std::vector<T> {}.swap(v);
+	}
+
+	static void shrink_vob(VirtualObject& vob) {
+		vob.children.shrink_to_fit();
+		for (auto& child : vob.children) {
+			if (child != nullptr) shrink_vob(*child);
+		}
+	}
+
+	WorldMemoryReport World::memory_report() const {
+		WorldMemoryReport report {};
+		MemoryCounter counter {};
+
+		report.mesh_vertices = MemoryCounter::of(world_mesh.vertices);
+		report.mesh_features = MemoryCounter::of(world_mesh.features);
+		report.mesh_polygons = MemoryCounter::of(world_mesh.geometry) +
+		    MemoryCounter::of(world_mesh.polygon_vertex_indices) +
+		    MemoryCounter::of(world_mesh.polygon_feature_indices) +
+		    MemoryCounter::of(world_mesh.polygons.material_indices) +
+		    MemoryCounter::of(world_mesh.polygons.lightmap_indices) +
+		    MemoryCounter::of(world_mesh.polygons.feature_indices) +
+		    MemoryCounter::of(world_mesh.polygons.vertex_indices) + MemoryCounter::of(world_mesh.polygons.flags);
+
+		report.mesh_lightmaps = MemoryCounter::of(world_mesh.lightmaps);
+		for (auto& lightmap : world_mesh.lightmaps) {
+			report.mesh_lightmaps += counter.of(lightmap);
+		}
+
+		report.mesh_materials = MemoryCounter::of(world_mesh.materials) + MemoryCounter::of(world_mesh.name);
+		for (auto& material : world_mesh.materials) {
+			report.mesh_materials += counter.of(material);
+		}
+
+		report.bsp_tree = counter.of(world_bsp_tree);
+
+		report.vobs = MemoryCounter::of(world_vobs);
+		for (auto& vob : world_vobs) {
+			report.vobs += counter.vob(vob, report);
+		}
+
+		report.npcs = MemoryCounter::of(npcs) + MemoryCounter::of(npc_spawns);
+		for (auto& npc : npcs) {
+			report.npcs += counter.vob(npc, report);
+		}
+
+		for (auto& spawn : npc_spawns) {
+			report.npcs += counter.vob(spawn.npc, report);
+		}
+
+#ifndef ZK_FUTURE
+		report.way_net = counter.of(world_way_net);
+#else
+		report.way_net = counter.of(way_net);
+#endif
+
+		if (counter.first(player.get())) {
+			report.other += sizeof(CutscenePlayer) + shared_control_block_size() + MemoryCounter::of(player->playlists);
+		}
+
+		if (counter.first(sky_controller.get())) {
+			report.other += sizeof(SkyController) + shared_control_block_size();
+		}
+
+		return report;
+	}
+
+	void World::trim_geometry() {
+		release(world_mesh.vertices);
+		release(world_mesh.features);
+		release(world_mesh.geometry);
+		release(world_mesh.polygon_vertex_indices);
+		release(world_mesh.polygon_feature_indices);
+		world_mesh.polygons = {};
+	}
+
+	void World::trim_lightmaps() {
+		release(world_mesh.lightmaps);
+
+		for (auto& polygon : world_mesh.geometry) {
+			polygon.lightmap = -1;
+		}
+
+		std::fill(world_mesh.polygons.lightmap_indices.begin(), world_mesh.polygons.lightmap_indices.end(), -1);
+	}
+
+	void World::trim_bsp_tree() {
+		auto mode = world_bsp_tree.mode;
+		world_bsp_tree = {};
+		world_bsp_tree.mode = mode;
+	}
+
+	void World::shrink_to_fit() {
+		world_mesh.materials.shrink_to_fit();
+		world_mesh.vertices.shrink_to_fit();
+		world_mesh.features.shrink_to_fit();
+		world_mesh.lightmaps.shrink_to_fit();
+		world_mesh.geometry.shrink_to_fit();
+		world_mesh.polygon_vertex_indices.shrink_to_fit();
+		world_mesh.polygon_feature_indices.shrink_to_fit();
+		world_mesh.polygons.material_indices.shrink_to_fit();
+		world_mesh.polygons.lightmap_indices.shrink_to_fit();
+		world_mesh.polygons.feature_indices.shrink_to_fit();
+		world_mesh.polygons.vertex_indices.shrink_to_fit();
+		world_mesh.polygons.flags.shrink_to_fit();
+
+		world_bsp_tree.polygon_indices.shrink_to_fit();
+		world_bsp_tree.leaf_polygons.shrink_to_fit();
+		world_bsp_tree.light_points.shrink_to_fit();
+		world_bsp_tree.sectors.shrink_to_fit();
+		world_bsp_tree.portal_polygon_indices.shrink_to_fit();
+		world_bsp_tree.nodes.shrink_to_fit();
+		world_bsp_tree.leaf_node_indices.shrink_to_fit();
+
+		for (auto& sector : world_bsp_tree.sectors) {
+			sector.node_indices.shrink_to_fit();
+			sector.portal_polygon_indices.shrink_to_fit();
+		}
+
+#ifndef ZK_FUTURE
+		world_way_net.waypoints.shrink_to_fit();
+		world_way_net.edges.shrink_to_fit();
+#else
+		if (way_net != nullptr) {
+			way_net->points.shrink_to_fit();
+			way_net->edges.shrink_to_fit();
+		}
+#endif
+
+		world_vobs.shrink_to_fit();
+		for (auto& vob : world_vobs) {
+			if (vob != nullptr) shrink_vob(*vob);
+		}
+
+		npcs.shrink_to_fit();
+		npc_spawns.shrink_to_fit();
+	}
+} // namespace zenkit
@@ -0,0 +1,228 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/world/Meshlet.hh"
+#include "zenkit/Mesh.hh"
+#include "zenkit/world/BspTree.hh"
+
+#include "../Internal.hh"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace zenkit {
+	/// \brief Normal cones with a larger half-angle are too wide to be useful for culling.
+	static constexpr float MIN_CONE_DOT = 0.1f;
+
+	struct MeshletTriangle {
+		std::uint32_t vertices[3];
+		std::uint32_t features[3];
+		std::uint32_t material;
+	};
+
+	bool Meshlet::is_backfacing(glm::vec3 camera) const noexcept {
+		return glm::dot(glm::normalize(cone_apex - camera), cone_axis) >= cone_cutoff;
+	}
+
+	/// \brief Computes the bounding sphere and normal cone of the last meshlet of a set.
+	static void finish_meshlet(MeshletSet& set, Mesh const& mesh) {
+		auto& meshlet = set.meshlets.back();
+
+		glm::vec3 min {std::numeric_limits<float>::max()};
+		glm::vec3 max {std::numeric_limits<float>::lowest()};
+		for (auto i = 0u; i < meshlet.vertex_count; ++i) {
+			auto& p = mesh.vertices[set.vertex_indices[meshlet.vertex_offset + i]];
+			min = glm::min(min, p);
+			max = glm::max(max, p);
+		}
+
+		meshlet.center = (min + max) * 0.5f;
+		meshlet.radius = 0;
+		for (auto i = 0u; i < meshlet.vertex_count; ++i) {
+			auto& p = mesh.vertices[set.vertex_indices[meshlet.vertex_offset + i]];
+			meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, p));
+		}
+
+		// Triangle normals are oriented to agree with the vertex normals since the winding is not reliable.
+		std::vector<glm::vec3> normals {};
+		std::vector<glm::vec3> points {};
+		glm::vec3 axis {0};
+
+		for (auto i = 0u; i < meshlet.triangle_count; ++i) {
+			auto* t = &set.triangles[(meshlet.triangle_offset + i) * 3];
+			glm::vec3 p[3];
+			glm::vec3 smooth {0};
+
+			for (auto j = 0; j < 3; ++j) {
+				p[j] = mesh.vertices[set.vertex_indices[meshlet.vertex_offset + t[j]]];
+				smooth += mesh.features[set.feature_indices[meshlet.vertex_offset + t[j]]].normal;
+			}
+
+			auto normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+			auto length = glm::length(normal);
+			if (length <= 0) continue;
+
+			normal /= length;
+			if (glm::dot(normal, smooth) < 0) normal = -normal;
+
+			normals.push_back(normal);
+			points.push_back(p[0]);
+			axis += normal;
+		}
+
+		meshlet.cone_apex = meshlet.center;
+		meshlet.cone_axis = glm::vec3 {0};
+		meshlet.cone_cutoff = 1;
+
+		auto axis_length = glm::length(axis);
+		if (axis_length <= 0) return;
+		axis /= axis_length;
+
+		auto min_dot = 1.0f;
+		for (auto& normal : normals) {
+			min_dot = std::min(min_dot, glm::dot(axis, normal));
+		}
+
+		meshlet.cone_axis = axis;
+		if (min_dot <= MIN_CONE_DOT) return;
+
+		// Move the apex back along the axis until it lies behind the planes of all triangles.
+		auto max_t = 0.0f;
+		for (auto i = 0u; i < normals.size(); ++i) {
+			auto t = glm::dot(meshlet.center - points[i], normals[i]) / glm::dot(axis, normals[i]);
+			max_t = std::max(max_t, t);
+		}
+
+		meshlet.cone_apex = meshlet.center - axis * max_t;
+		meshlet.cone_cutoff = std::sqrt(1 - min_dot * min_dot);
+	}
+
+	/// \brief Finds the local index of a vertex in a meshlet.
+	/// \return The local index or Meshlet::vertex_count if the meshlet does not contain the vertex.
+	static std::uint32_t
+	find_vertex(MeshletSet const& set, Meshlet const& meshlet, std::uint32_t vertex, std::uint32_t feature) {
+		auto i = 0u;
+		for (; i < meshlet.vertex_count; ++i) {
+			auto k = meshlet.vertex_offset + i;
+			if (set.vertex_indices[k] == vertex && set.feature_indices[k] == feature) break;
+		}
+		return i;
+	}
+
+	/// \brief Counts the vertices which would have to be added to a meshlet to add a triangle to it.
+	static std::uint32_t count_new_vertices(MeshletSet const& set, Meshlet const& meshlet, MeshletTriangle const& t) {
+		std::uint32_t count = 0;
+
+		for (auto j = 0; j < 3; ++j) {
+			auto seen = find_vertex(set, meshlet, t.vertices[j], t.features[j]) != meshlet.vertex_count;
+
+			// Corners repeated within the triangle are only added once.
+			for (auto k = 0; k < j && !seen; ++k) {
+				seen = t.vertices[k] == t.vertices[j] && t.features[k] == t.features[j];
+			}
+
+			if (!seen) count += 1;
+		}
+
+		return count;
+	}
+
+	void MeshletSet::build(Mesh const& mesh,
+	                       BspTree const& tree,
+	                       std::uint32_t max_vertices,
+	                       std::uint32_t max_triangles) {
+		ZKTRACE_SCOPE("world", "MeshletSet.build");
+
+		max_vertices = std::clamp(max_vertices, 3u, 256u);
+		max_triangles = std::max(max_triangles, 1u);
+
+		this->meshlets.clear();
+		this->vertex_indices.clear();
+		this->feature_indices.clear();
+		this->triangles.clear();
+		this->leaf_offsets.assign(tree.nodes.size() + 1, 0);
+
+		std::vector<MeshletTriangle> leaf_triangles {};
+
+		for (auto i = 0u; i < tree.nodes.size(); ++i) {
+			auto& node = tree.nodes[i];
+			this->leaf_offsets[i] = static_cast<std::uint32_t>(this->meshlets.size());
+			if (!node.is_leaf()) continue;
+
+			// Triangulate the polygons of the leaf the same way Mesh::triangulate does.
+			leaf_triangles.clear();
+			for (auto j = 0u; j < node.polygon_count; ++j) {
+				auto index = node.polygon_index + j;
+				if (index >= tree.polygon_indices.size()) break;
+
+				auto polygon_index = tree.polygon_indices[index];
+				if (polygon_index >= mesh.geometry.size()) continue;
+
+				auto& polygon = mesh.geometry[polygon_index];
+				if (polygon.index_count < 3 || polygon.flags.is_portal || polygon.flags.is_ghost_occluder ||
+				    polygon.flags.is_outdoor) {
+					continue;
+				}
+
+				auto root = polygon.index_offset;
+				for (auto b = 2u; b < polygon.index_count; ++b) {
+					leaf_triangles.push_back(MeshletTriangle {
+					    {mesh.polygon_vertex_indices[root],
+					     mesh.polygon_vertex_indices[root + b - 1],
+					     mesh.polygon_vertex_indices[root + b]},
+					    {mesh.polygon_feature_indices[root],
+					     mesh.polygon_feature_indices[root + b - 1],
+					     mesh.polygon_feature_indices[root + b]},
+					    polygon.material,
+					});
+				}
+			}
+
+			std::stable_sort(leaf_triangles.begin(), leaf_triangles.end(), [](auto const& a, auto const& b) {
+				return a.material < b.material;
+			});
+
+			// Greedily fill meshlets in order, starting a new one whenever a limit or the material would change.
+			Meshlet* current = nullptr;
+			for (auto& triangle : leaf_triangles) {
+				if (current != nullptr &&
+				    (current->material != triangle.material || current->triangle_count >= max_triangles ||
+				     current->vertex_count + count_new_vertices(*this, *current, triangle) > max_vertices)) {
+					finish_meshlet(*this, mesh);
+					current = nullptr;
+				}
+
+				if (current == nullptr) {
+					current = &this->meshlets.emplace_back();
+					current->vertex_offset = static_cast<std::uint32_t>(this->vertex_indices.size());
+					current->vertex_count = 0;
+					current->triangle_offset = static_cast<std::uint32_t>(this->triangles.size() / 3);
+					current->triangle_count = 0;
+					current->material = triangle.material;
+					current->leaf = i;
+				}
+
+				for (auto j = 0; j < 3; ++j) {
+					auto local = find_vertex(*this, *current, triangle.vertices[j], triangle.features[j]);
+
+					if (local == current->vertex_count) {
+						this->vertex_indices.push_back(triangle.vertices[j]);
+						this->feature_indices.push_back(triangle.features[j]);
+						current->vertex_count += 1;
+					}
+
+					this->triangles.push_back(static_cast<std::uint8_t>(local));
+				}
+
+				current->triangle_count += 1;
+			}
+
+			if (current != nullptr) finish_meshlet(*this, mesh);
+		}
+
+		this->leaf_offsets.back() = static_cast<std::uint32_t>(this->meshlets.size());
+	}
+} // namespace zenkit
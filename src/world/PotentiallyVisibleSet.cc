@@ -0,0 +1,379 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/world/PotentiallyVisibleSet.hh"
+#include "zenkit/Error.hh"
+#include "zenkit/Mesh.hh"
+#include "zenkit/Stream.hh"
+#include "zenkit/world/BspTree.hh"
+
+#include "../Internal.hh"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace zenkit {
+	static constexpr std::string_view PVS_SIGNATURE = "ZPVS";
+	static constexpr std::uint32_t PVS_VERSION = 1;
+
+	/// \brief The distance in front of a portal plane a point must have to be considered visible through it.
+	static constexpr float PLANE_EPSILON = 0.1f;
+
+	using Winding = std::vector<glm::vec3>;
+
+	struct PvsPortal {
+		std::uint32_t target;
+		Winding winding;
+
+		/// \brief The plane of the portal, facing into the target cell. Only valid if #oriented is set.
+		glm::vec4 plane;
+		bool oriented;
+	};
+
+	static float distance(glm::vec4 const& plane, glm::vec3 const& p) {
+		return glm::dot(glm::vec3 {plane}, p) - plane.w;
+	}
+
+	/// \brief Clips a convex winding to the part lying in front of a plane.
+	/// \param out Receives the clipped winding. Must not be \p winding.
+	static void clip(Winding const& winding, glm::vec4 const& plane, Winding& out) {
+		out.clear();
+
+		for (auto i = 0u; i < winding.size(); ++i) {
+			auto& a = winding[i];
+			auto& b = winding[(i + 1) % winding.size()];
+			auto da = distance(plane, a) - PLANE_EPSILON;
+			auto db = distance(plane, b) - PLANE_EPSILON;
+
+			if (da > 0) out.push_back(a);
+			if ((da > 0) != (db > 0)) out.push_back(a + (b - a) * (da / (da - db)));
+		}
+	}
+
+	/// \return Whether part of a convex winding lies in front of a plane.
+	static bool is_in_front(Winding const& winding, glm::vec4 const& plane) {
+		return std::any_of(winding.begin(), winding.end(), [&plane](glm::vec3 const& p) {
+			return distance(plane, p) - PLANE_EPSILON > 0;
+		});
+	}
+
+	/// \brief Determines the side of a portal's plane a cell lies on.
+	///
+	/// Sectors need not be convex, so only the cell's BSP leaves closest to the portal are considered. Their bounding
+	/// boxes must all lie on the same side of the plane for the result to be unambiguous.
+	///
+	/// \param leaves The bounding boxes of the cell's BSP leaves.
+	/// \param plane The plane of the portal.
+	/// \param winding The polygon of the portal.
+	/// \return `1` if the cell lies in front of the plane, `-1` if it lies behind it and `0` if that is ambiguous.
+	static int side_of(std::vector<AxisAlignedBoundingBox> const& leaves,
+	                   glm::vec4 const& plane,
+	                   Winding const& winding) {
+		glm::vec3 normal {plane};
+		if (leaves.empty() || winding.empty() || normal == glm::vec3 {0}) return 0;
+
+		glm::vec3 center {0};
+		for (auto& p : winding) {
+			center += p;
+		}
+
+		center /= static_cast<float>(winding.size());
+
+		auto gap = [&center](AxisAlignedBoundingBox const& box) {
+			return glm::length(glm::max(glm::max(box.min - center, center - box.max), glm::vec3 {0}));
+		};
+
+		auto nearest = std::numeric_limits<float>::max();
+		for (auto& box : leaves) {
+			nearest = std::min(nearest, gap(box));
+		}
+
+		auto side = 0;
+		for (auto& box : leaves) {
+			if (gap(box) > nearest + PLANE_EPSILON) continue;
+
+			auto d = distance(plane, (box.min + box.max) * 0.5f);
+			auto r = glm::dot(glm::abs(normal), (box.max - box.min) * 0.5f);
+
+			auto leaf = d - r >= -PLANE_EPSILON ? 1 : d + r <= PLANE_EPSILON ? -1 : 0;
+			if (leaf == 0 || (side != 0 && leaf != side)) return 0;
+			side = leaf;
+		}
+
+		return side;
+	}
+
+	/// \brief Computes the plane of a polygon using Newell's method, which is robust for nearly degenerate polygons.
+	static glm::vec4 plane_of(Winding const& winding) {
+		glm::vec3 normal {0};
+		glm::vec3 center {0};
+
+		for (auto i = 0u; i < winding.size(); ++i) {
+			auto& a = winding[i];
+			auto& b = winding[(i + 1) % winding.size()];
+			normal += glm::vec3 {(a.y - b.y) * (a.z + b.z), (a.z - b.z) * (a.x + b.x), (a.x - b.x) * (a.y + b.y)};
+			center += a;
+		}
+
+		auto length = glm::length(normal);
+		if (length <= 0) return glm::vec4 {0};
+
+		normal /= length;
+		center /= static_cast<float>(winding.size());
+		return glm::vec4 {normal, glm::dot(normal, center)};
+	}
+
+	/// \brief Floods through the portals of a world to find the cells visible from each cell.
+	///
+	/// <p>A line of sight leaving the source cell through a portal stays in front of that portal and in front of the
+	/// portal through which it entered the current cell. Only these two planes are used to clip the portals of the
+	/// current cell, so that every directed portal needs to be entered at most once per source portal. This keeps the
+	/// flood polynomial in the number of portals, at the cost of reporting some cells a longer chain of portals would
+	/// have hidden.</p>
+	class PvsBuilder {
+	public:
+		PvsBuilder(std::vector<std::vector<PvsPortal>> const& portals, std::uint32_t cell_count)
+		    : _m_portals(portals), _m_cell_count(cell_count), _m_portal_offsets(cell_count + 1, 0) {
+			for (auto i = 0u; i < cell_count; ++i) {
+				_m_portal_offsets[i + 1] = _m_portal_offsets[i] + static_cast<std::uint32_t>(portals[i].size());
+			}
+
+			_m_entered.assign(_m_portal_offsets.back(), 0);
+		}
+
+		std::vector<bool> flood(std::uint32_t source) {
+			_m_visible.assign(_m_cell_count, false);
+			_m_visible[source] = true;
+
+			for (auto i = 0u; i < _m_portals[source].size(); ++i) {
+				// Portals entered while flooding from a previous source portal need to be entered again.
+				if (++_m_generation == 0) {
+					std::fill(_m_entered.begin(), _m_entered.end(), 0);
+					_m_generation = 1;
+				}
+
+				auto& first = _m_portals[source][i];
+				this->enter(source, i);
+
+				while (!_m_stack.empty()) {
+					auto [cell, portal] = _m_stack.back();
+					_m_stack.pop_back();
+					this->visit(first, _m_portals[cell][portal]);
+				}
+			}
+
+			return std::move(_m_visible);
+		}
+
+	private:
+		/// \brief Schedules a portal to be passed unless it has already been passed from the current source portal.
+		void enter(std::uint32_t cell, std::uint32_t portal) {
+			auto& entered = _m_entered[_m_portal_offsets[cell] + portal];
+			if (entered == _m_generation) return;
+
+			entered = _m_generation;
+			_m_stack.emplace_back(cell, portal);
+		}
+
+		/// \brief Marks the cell behind a portal as visible and enters all portals of it which may be seen through it.
+		/// \param first The portal through which the line of sight left the source cell.
+		/// \param entry The portal through which the line of sight enters its target cell.
+		void visit(PvsPortal const& first, PvsPortal const& entry) {
+			auto cell = entry.target;
+			_m_visible[cell] = true;
+
+			auto& portals = _m_portals[cell];
+			for (auto i = 0u; i < portals.size(); ++i) {
+				auto& portal = portals[i];
+				auto* winding = &portal.winding;
+
+				if (first.oriented) {
+					clip(portal.winding, first.plane, _m_clipped);
+					winding = &_m_clipped;
+				}
+
+				if (entry.oriented && &entry != &first && !is_in_front(*winding, entry.plane)) continue;
+				if (winding->empty()) continue;
+
+				this->enter(cell, i);
+			}
+		}
+
+		std::vector<std::vector<PvsPortal>> const& _m_portals;
+		std::uint32_t _m_cell_count;
+		std::vector<std::uint32_t> _m_portal_offsets;
+		std::vector<std::uint32_t> _m_entered;
+		std::uint32_t _m_generation {0};
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> _m_stack;
+		std::vector<bool> _m_visible;
+		Winding _m_clipped;
+	};
+
+	void PotentiallyVisibleSet::build(BspTree const& tree, Mesh const& mesh) {
+		ZKTRACE_SCOPE("world", "PotentiallyVisibleSet.build");
+
+		auto sector_count = static_cast<std::uint32_t>(tree.sectors.size());
+		auto outdoor = sector_count;
+		_m_cell_count = sector_count + 1;
+
+		// Sectors reference their BSP leaves by their index into BspTree::leaf_node_indices.
+		_m_node_cells.assign(tree.nodes.size(), outdoor);
+		std::vector<std::vector<AxisAlignedBoundingBox>> leaves(_m_cell_count);
+
+		for (auto i = 0u; i < sector_count; ++i) {
+			for (auto leaf : tree.sectors[i].node_indices) {
+				if (leaf >= tree.leaf_node_indices.size()) continue;
+
+				auto node = tree.leaf_node_indices[leaf];
+				if (node >= tree.nodes.size()) continue;
+
+				_m_node_cells[node] = i;
+				leaves[i].push_back(tree.nodes[node].bbox);
+			}
+		}
+
+		// Collect the cells on either side of every portal polygon.
+		std::map<std::uint32_t, std::vector<std::uint32_t>> portal_cells {};
+		for (auto i = 0u; i < sector_count; ++i) {
+			for (auto polygon : tree.sectors[i].portal_polygon_indices) {
+				auto& cells = portal_cells[polygon];
+				if (std::find(cells.begin(), cells.end(), i) == cells.end()) cells.push_back(i);
+			}
+		}
+
+		std::vector<std::vector<PvsPortal>> portals(_m_cell_count);
+		for (auto& [polygon, cells] : portal_cells) {
+			if (polygon >= mesh.geometry.size()) continue;
+
+			auto& geometry = mesh.geometry[polygon];
+			Winding winding {};
+			for (auto j = 0u; j < geometry.index_count; ++j) {
+				auto index = mesh.polygon_vertex_indices[geometry.index_offset + j];
+				winding.push_back(mesh.vertices[index]);
+			}
+
+			auto plane = plane_of(winding);
+			if (cells.size() == 1) cells.push_back(outdoor);
+
+			// Connect all cells sharing the portal, orienting it using the leaves of the cells next to it.
+			for (auto a : cells) {
+				for (auto b : cells) {
+					if (a == b) continue;
+
+					auto side = side_of(leaves[a], plane, winding);
+					if (side == 0) side = -side_of(leaves[b], plane, winding);
+
+					PvsPortal portal {b, winding, side > 0 ? -plane : plane, side != 0};
+					portals[a].push_back(std::move(portal));
+				}
+			}
+		}
+
+		PvsBuilder builder {portals, _m_cell_count};
+		std::vector<std::vector<bool>> matrix(_m_cell_count);
+		for (auto i = 0u; i < _m_cell_count; ++i) {
+			matrix[i] = builder.flood(i);
+		}
+
+		// Visibility is symmetric. Where the flood disagrees, keep the cells visible to stay conservative.
+		for (auto i = 0u; i < _m_cell_count; ++i) {
+			for (auto j = i + 1; j < _m_cell_count; ++j) {
+				matrix[i][j] = matrix[j][i] = matrix[i][j] || matrix[j][i];
+			}
+		}
+
+		// Store the matrix as bitsets, de-duplicating identical rows.
+		_m_row_size = (_m_cell_count + 31) / 32;
+		_m_rows.clear();
+		_m_cell_rows.resize(_m_cell_count);
+
+		std::unordered_map<std::vector<bool>, std::uint32_t> rows {};
+		for (auto i = 0u; i < _m_cell_count; ++i) {
+			auto [it, inserted] = rows.try_emplace(matrix[i], static_cast<std::uint32_t>(rows.size()));
+			_m_cell_rows[i] = it->second;
+			if (!inserted) continue;
+
+			auto offset = _m_rows.size();
+			_m_rows.resize(offset + _m_row_size, 0);
+			for (auto j = 0u; j < _m_cell_count; ++j) {
+				if (matrix[i][j]) _m_rows[offset + j / 32] |= 1u << (j % 32);
+			}
+		}
+	}
+
+	/// \return The number of bytes between the current position of the reader and the end of its data.
+	static std::size_t remaining_bytes(Read* r) noexcept {
+		auto pos = r->tell();
+		r->seek(0, Whence::END);
+		auto end = r->tell();
+		r->seek(static_cast<ssize_t>(pos), Whence::BEG);
+		return end > pos ? end - pos : 0;
+	}
+
+	void PotentiallyVisibleSet::load(Read* r) {
+		if (r->read_string(PVS_SIGNATURE.size()) != PVS_SIGNATURE) {
+			throw ParserError {"PotentiallyVisibleSet", "invalid signature"};
+		}
+
+		if (auto version = r->read_uint(); version != PVS_VERSION) {
+			throw ParserError {"PotentiallyVisibleSet", "unsupported version: " + std::to_string(version)};
+		}
+
+		// All counts are checked against the remaining data before allocating anything for them.
+		auto cell_count = r->read_uint();
+		auto node_count = r->read_uint();
+		if (static_cast<std::uint64_t>(node_count) * 4 > remaining_bytes(r)) {
+			throw ParserError {"PotentiallyVisibleSet", "node count exceeds the available data"};
+		}
+
+		_m_node_cells.resize(node_count);
+		for (auto& cell : _m_node_cells) {
+			cell = r->read_uint();
+			if (cell >= cell_count) throw ParserError {"PotentiallyVisibleSet", "node cell out of range"};
+		}
+
+		auto row_count = r->read_uint();
+		auto row_size = (static_cast<std::uint64_t>(cell_count) + 31) / 32;
+		if ((cell_count + static_cast<std::uint64_t>(row_count) * row_size) * 4 > remaining_bytes(r)) {
+			throw ParserError {"PotentiallyVisibleSet", "cell count exceeds the available data"};
+		}
+
+		_m_cell_count = cell_count;
+		_m_row_size = static_cast<std::uint32_t>(row_size);
+		_m_cell_rows.resize(_m_cell_count);
+		for (auto& row : _m_cell_rows) {
+			row = r->read_uint();
+			if (row >= row_count) throw ParserError {"PotentiallyVisibleSet", "row out of range"};
+		}
+
+		_m_rows.resize(static_cast<std::size_t>(row_count) * _m_row_size);
+		for (auto& word : _m_rows) {
+			word = r->read_uint();
+		}
+	}
+
+	void PotentiallyVisibleSet::save(Write* w) const {
+		w->write_string(PVS_SIGNATURE);
+		w->write_uint(PVS_VERSION);
+		w->write_uint(_m_cell_count);
+
+		w->write_uint(static_cast<std::uint32_t>(_m_node_cells.size()));
+		for (auto cell : _m_node_cells) {
+			w->write_uint(cell);
+		}
+
+		w->write_uint(static_cast<std::uint32_t>(this->unique_row_count()));
+		for (auto row : _m_cell_rows) {
+			w->write_uint(row);
+		}
+
+		for (auto word : _m_rows) {
+			w->write_uint(word);
+		}
+	}
+} // namespace zenkit
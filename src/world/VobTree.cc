@@ -4,7 +4,20 @@
 #include "zenkit/Archive.hh"
 #include "zenkit/vobs/VirtualObject.hh"
 
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+
 namespace zenkit {
+	static void skip_vob_trees(ReadArchive& in, size_t count) {
+		for (auto i = 0u; i < count; ++i) {
+			in.skip_object(false);
+
+			auto num_children = static_cast<size_t>(in.read_int());
+			skip_vob_trees(in, num_children);
+		}
+	}
+
 	std::shared_ptr<VirtualObject> parse_vob_tree(ReadArchive& in, GameVersion version) {
 		auto obj = in.read_object(version);
 		if (!is_vobject(obj->get_object_type())) return nullptr;
@@ -14,17 +27,7 @@ namespace zenkit {
 
 		auto child_count = static_cast<size_t>(in.read_int());
 		if (object == nullptr) {
-			std::function<void(size_t)> skip;
-			skip = [&skip, &in](size_t count) {
-				for (auto i = 0u; i < count; ++i) {
-					in.skip_object(false);
-
-					auto num_children = static_cast<size_t>(in.read_int());
-					skip(num_children);
-				}
-			};
-
-			skip(child_count);
+			skip_vob_trees(in, child_count);
 			return nullptr;
 		}
 
@@ -50,4 +53,262 @@ namespace zenkit {
 			save_vob_tree(w, version, child);
 		}
 	}
+
+	static void visit_vob(ReadArchive& in,
+	                      GameVersion version,
+	                      VobVisitor& visitor,
+	                      std::size_t depth,
+	                      std::vector<std::shared_ptr<VirtualObject>>& kept) {
+		auto obj = in.read_object(version);
+		auto child_count = static_cast<size_t>(in.read_int());
+
+		if (obj == nullptr || !is_vobject(obj->get_object_type())) {
+			skip_vob_trees(in, child_count);
+			return;
+		}
+
+		std::shared_ptr<VirtualObject> vob {obj, reinterpret_cast<VirtualObject*>(obj.get())};
+		obj.reset();
+
+		auto action = visitor.enter(vob, depth);
+		if (action != VobVisitAction::KEEP) {
+			in.forget_objects(vob->id);
+		}
+
+		if (action == VobVisitAction::SKIP) {
+			skip_vob_trees(in, child_count);
+			return;
+		}
+
+		// Kept children of discarded VObs are attached to the closest kept ancestor instead.
+		auto& children = action == VobVisitAction::KEEP ? vob->children : kept;
+		for (auto i = 0u; i < child_count; ++i) {
+			visit_vob(in, version, visitor, depth + 1, children);
+		}
+
+		visitor.leave(vob, depth);
+		if (action == VobVisitAction::KEEP) kept.push_back(std::move(vob));
+	}
+
+	std::vector<std::shared_ptr<VirtualObject>>
+	visit_vob_tree(ReadArchive& in, GameVersion version, VobVisitor& visitor) {
+		std::vector<std::shared_ptr<VirtualObject>> kept {};
+
+		auto count = static_cast<size_t>(in.read_int()); // childs0
+		for (auto i = 0u; i < count; ++i) {
+			visit_vob(in, version, visitor, 0, kept);
+		}
+
+		return kept;
+	}
+
+	using VisualNameIndex = std::unordered_map<std::string_view, std::uint32_t>;
+
+	static std::uint32_t append_vob(VobTable& table, VirtualObject* vob, std::uint32_t parent, VisualNameIndex& names) {
+		auto index = static_cast<std::uint32_t>(table.objects.size());
+
+		glm::mat4 transform {vob->rotation};
+		transform[3] = glm::vec4 {vob->position, 1.0f};
+
+		auto visual_type = VisualType::UNKNOWN;
+		auto visual_name = VobTable::NONE;
+		if (vob->visual != nullptr) {
+			visual_type = vob->visual->type;
+
+			if (!vob->visual->name.empty()) {
+				// The keys view the strings owned by the VOb, which outlive the index.
+				auto [it, inserted] = names.try_emplace(vob->visual->name, table.visual_names.size());
+				if (inserted) table.visual_names.push_back(vob->visual->name);
+				visual_name = it->second;
+			}
+		}
+
+		table.ids.push_back(vob->id);
+		table.types.push_back(vob->type);
+		table.parents.push_back(parent);
+		table.first_children.push_back(VobTable::NONE);
+		table.next_siblings.push_back(VobTable::NONE);
+		table.transforms.push_back(transform);
+		table.bboxes.push_back(vob->bbox);
+		table.visual_types.push_back(visual_type);
+		table.visual_name_indices.push_back(visual_name);
+		table.objects.push_back(vob);
+
+		auto previous = VobTable::NONE;
+		for (auto& child : vob->children) {
+			if (child == nullptr) continue;
+
+			auto child_index = append_vob(table, child.get(), index, names);
+			if (previous == VobTable::NONE) {
+				table.first_children[index] = child_index;
+			} else {
+				table.next_siblings[previous] = child_index;
+			}
+
+			previous = child_index;
+		}
+
+		return index;
+	}
+
+	static std::size_t count_vobs(std::vector<std::shared_ptr<VirtualObject>> const& vobs) {
+		auto count = vobs.size();
+		for (auto& vob : vobs) {
+			if (vob != nullptr) count += count_vobs(vob->children);
+		}
+		return count;
+	}
+
+	void VobTable::build(std::vector<std::shared_ptr<VirtualObject>> const& roots) {
+		this->clear();
+
+		auto count = count_vobs(roots);
+		ids.reserve(count);
+		types.reserve(count);
+		parents.reserve(count);
+		first_children.reserve(count);
+		next_siblings.reserve(count);
+		transforms.reserve(count);
+		bboxes.reserve(count);
+		visual_types.reserve(count);
+		visual_name_indices.reserve(count);
+		objects.reserve(count);
+
+		VisualNameIndex names {};
+		auto previous = NONE;
+		for (auto& root : roots) {
+			if (root == nullptr) continue;
+
+			auto index = append_vob(*this, root.get(), NONE, names);
+			if (previous != NONE) next_siblings[previous] = index;
+			previous = index;
+		}
+	}
+
+	void VobTable::clear() noexcept {
+		ids.clear();
+		types.clear();
+		parents.clear();
+		first_children.clear();
+		next_siblings.clear();
+		transforms.clear();
+		bboxes.clear();
+		visual_types.clear();
+		visual_name_indices.clear();
+		visual_names.clear();
+		objects.clear();
+	}
+
+	static std::string vob_name_key(std::string_view name) {
+		std::string key {name};
+		std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::toupper(c); });
+		return key;
+	}
+
+	void VobIndex::build(std::vector<std::shared_ptr<VirtualObject>> const& roots) {
+		this->clear();
+
+		for (auto& root : roots) {
+			if (root != nullptr) this->insert(root);
+		}
+	}
+
+	void VobIndex::insert(std::shared_ptr<VirtualObject> const& vob) {
+		auto [it, inserted] = _m_entries.try_emplace(vob.get());
+
+		if (inserted) {
+			auto& entry = it->second;
+			entry.id = vob->id;
+			entry.type = vob->type;
+			entry.name = vob->vob_name.empty() ? std::string {} : vob_name_key(vob->vob_name);
+
+			_m_ids[entry.id].push_back(vob);
+
+			auto& types = _m_types[entry.type];
+			entry.type_slot = types.size();
+			types.push_back(vob);
+
+			if (!entry.name.empty()) {
+				auto& names = _m_names[entry.name];
+				entry.name_slot = names.size();
+				names.push_back(vob);
+			}
+		}
+
+		for (auto& child : vob->children) {
+			if (child != nullptr) this->insert(child);
+		}
+	}
+
+	void VobIndex::erase(VirtualObject const& vob) {
+		for (auto& child : vob.children) {
+			if (child != nullptr) this->erase(*child);
+		}
+
+		this->erase_one(&vob);
+	}
+
+	void VobIndex::erase_one(VirtualObject const* vob) {
+		auto it = _m_entries.find(vob);
+		if (it == _m_entries.end()) return;
+
+		auto& entry = it->second;
+
+		// Duplicate ids are rare, so the bucket is kept in insertion order to find the latest one by id.
+		if (auto ids = _m_ids.find(entry.id); ids != _m_ids.end()) {
+			auto& bucket = ids->second;
+			bucket.erase(std::find_if(bucket.begin(), bucket.end(), [vob](auto& v) { return v.get() == vob; }));
+			if (bucket.empty()) _m_ids.erase(ids);
+		}
+
+		auto types = _m_types.find(entry.type);
+		this->erase_from_bucket(types->second, entry.type_slot, false);
+		if (types->second.empty()) _m_types.erase(types);
+
+		if (!entry.name.empty()) {
+			auto names = _m_names.find(entry.name);
+			this->erase_from_bucket(names->second, entry.name_slot, true);
+			if (names->second.empty()) _m_names.erase(names);
+		}
+
+		_m_entries.erase(it);
+	}
+
+	void VobIndex::erase_from_bucket(Bucket& bucket, std::size_t slot, bool by_name) {
+		// Move the last VOb into the freed slot and update its position.
+		if (slot + 1 != bucket.size()) {
+			bucket[slot] = std::move(bucket.back());
+
+			auto& moved = _m_entries.at(bucket[slot].get());
+			(by_name ? moved.name_slot : moved.type_slot) = slot;
+		}
+
+		bucket.pop_back();
+	}
+
+	void VobIndex::clear() noexcept {
+		_m_entries.clear();
+		_m_ids.clear();
+		_m_names.clear();
+		_m_types.clear();
+	}
+
+	std::shared_ptr<VirtualObject> VobIndex::find_by_id(std::uint32_t id) const {
+		auto it = _m_ids.find(id);
+		return it == _m_ids.end() ? nullptr : it->second.back();
+	}
+
+	VobIndex::Bucket const& VobIndex::find_by_name(std::string_view name) const {
+		static Bucket const EMPTY {};
+
+		auto it = _m_names.find(vob_name_key(name));
+		return it == _m_names.end() ? EMPTY : it->second;
+	}
+
+	VobIndex::Bucket const& VobIndex::find_by_type(VirtualObjectType type) const {
+		static Bucket const EMPTY {};
+
+		auto it = _m_types.find(type);
+		return it == _m_types.end() ? EMPTY : it->second;
+	}
 } // namespace zenkit
@@ -0,0 +1,255 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include "zenkit/world/VolumeIndex.hh"
+#include "zenkit/vobs/Sound.hh"
+#include "zenkit/vobs/Zone.hh"
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace zenkit {
+	/// \brief The maximum number of grid cells along each axis. The cell size is increased to stay within it.
+	static constexpr std::uint32_t MAX_CELLS_PER_AXIS = 512;
+
+	bool operator&(VolumeKind a, VolumeKind b) {
+		return (static_cast<std::uint8_t>(a) & static_cast<std::uint8_t>(b)) != 0;
+	}
+
+	VolumeKind operator|(VolumeKind a, VolumeKind b) {
+		return static_cast<VolumeKind>(static_cast<std::uint8_t>(a) | static_cast<std::uint8_t>(b));
+	}
+
+	VolumeKind& operator|=(VolumeKind& a, VolumeKind b) {
+		a = a | b;
+		return a;
+	}
+
+	static VolumeKind volume_kind(VirtualObjectType type) noexcept {
+		switch (type) {
+		case VirtualObjectType::oCZoneMusic:
+		case VirtualObjectType::oCZoneMusicDefault:
+			return VolumeKind::MUSIC;
+		case VirtualObjectType::zCZoneZFog:
+		case VirtualObjectType::zCZoneZFogDefault:
+			return VolumeKind::FOG;
+		case VirtualObjectType::zCZoneVobFarPlane:
+		case VirtualObjectType::zCZoneVobFarPlaneDefault:
+			return VolumeKind::FAR_PLANE;
+		case VirtualObjectType::zCVobSound:
+		case VirtualObjectType::zCVobSoundDaytime:
+			return VolumeKind::SOUND;
+		case VirtualObjectType::zCTrigger:
+		case VirtualObjectType::zCTriggerList:
+		case VirtualObjectType::oCTriggerScript:
+		case VirtualObjectType::oCTriggerChangeLevel:
+		case VirtualObjectType::oCCSTrigger:
+		case VirtualObjectType::zCMover:
+		case VirtualObjectType::zCTriggerUntouch:
+			return VolumeKind::TRIGGER;
+		default:
+			return VolumeKind::NONE;
+		}
+	}
+
+	static bool is_default_zone(VirtualObjectType type) noexcept {
+		return type == VirtualObjectType::oCZoneMusicDefault || type == VirtualObjectType::zCZoneZFogDefault ||
+		    type == VirtualObjectType::zCZoneVobFarPlaneDefault;
+	}
+
+	/// \brief A volume together with the keys which determine its precedence.
+	struct VolumeCandidate {
+		AxisAlignedBoundingBox bbox;
+		VirtualObject* vob;
+		VolumeKind kind;
+		bool ellipsoid;
+		bool is_default;
+		std::int32_t priority;
+		float size;
+	};
+
+	static void collect_volumes(std::vector<std::shared_ptr<VirtualObject>> const& vobs,
+	                            std::vector<VolumeCandidate>& volumes) {
+		for (auto& vob : vobs) {
+			if (vob == nullptr) continue;
+
+			auto kind = volume_kind(vob->type);
+			if (kind != VolumeKind::NONE) {
+				VolumeCandidate volume {vob->bbox, vob.get(), kind, false, is_default_zone(vob->type), 0, 0};
+
+				if (kind == VolumeKind::MUSIC) {
+					auto& music = static_cast<VZoneMusic const&>(*vob);
+					volume.ellipsoid = music.ellipsoid;
+					volume.priority = music.priority;
+				} else if (kind == VolumeKind::SOUND) {
+					auto& sound = static_cast<VSound const&>(*vob);
+					volume.ellipsoid = true;
+
+					// Spherical sounds are described by their radius rather than their bounding box.
+					if (sound.volume_type == SoundTriggerVolumeType::SPHERICAL) {
+						volume.bbox = {vob->position - glm::vec3 {sound.radius}, vob->position + glm::vec3 {sound.radius}};
+					}
+				}
+
+				// Default zones apply everywhere, regardless of their bounding box.
+				if (volume.is_default) {
+					volume.bbox = {glm::vec3 {std::numeric_limits<float>::lowest()},
+					               glm::vec3 {std::numeric_limits<float>::max()}};
+					volume.ellipsoid = false;
+				}
+
+				auto extent = volume.bbox.max - volume.bbox.min;
+				volume.size = extent.x * extent.y * extent.z;
+				volumes.push_back(volume);
+			}
+
+			collect_volumes(vob->children, volumes);
+		}
+	}
+
+	void VolumeIndex::build(std::vector<std::shared_ptr<VirtualObject>> const& roots, float cell_size) {
+		std::vector<VolumeCandidate> candidates {};
+		collect_volumes(roots, candidates);
+
+		std::stable_sort(candidates.begin(), candidates.end(), [](auto const& a, auto const& b) {
+			if (a.is_default != b.is_default) return !a.is_default;
+			if (a.priority != b.priority) return a.priority > b.priority;
+			return a.size < b.size;
+		});
+
+		_m_volumes.clear();
+		_m_global.clear();
+		_m_cell_offsets.clear();
+		_m_cell_volumes.clear();
+		_m_volumes.reserve(candidates.size());
+
+		glm::vec2 min {std::numeric_limits<float>::max()};
+		glm::vec2 max {std::numeric_limits<float>::lowest()};
+
+		for (auto i = 0u; i < candidates.size(); ++i) {
+			auto& c = candidates[i];
+			_m_volumes.push_back(Volume {c.bbox, c.vob, c.kind, c.ellipsoid});
+
+			if (c.is_default) {
+				_m_global.push_back(i);
+			} else {
+				min = glm::min(min, glm::vec2 {c.bbox.min.x, c.bbox.min.z});
+				max = glm::max(max, glm::vec2 {c.bbox.max.x, c.bbox.max.z});
+			}
+		}
+
+		if (_m_global.size() == _m_volumes.size()) {
+			_m_cells_x = _m_cells_z = 0;
+			return;
+		}
+
+		auto extent = max - min;
+		cell_size = std::max({cell_size, extent.x / MAX_CELLS_PER_AXIS, extent.y / MAX_CELLS_PER_AXIS, 1.0f});
+
+		_m_origin = min;
+		_m_cell_size = cell_size;
+		_m_cells_x = static_cast<std::uint32_t>(extent.x / cell_size) + 1;
+		_m_cells_z = static_cast<std::uint32_t>(extent.y / cell_size) + 1;
+
+		auto cell_range = [this](Volume const& v) {
+			auto lo = glm::uvec2 {(glm::vec2 {v.bbox.min.x, v.bbox.min.z} - _m_origin) / _m_cell_size};
+			auto hi = glm::uvec2 {(glm::vec2 {v.bbox.max.x, v.bbox.max.z} - _m_origin) / _m_cell_size};
+			return std::make_pair(lo, glm::min(hi, glm::uvec2 {_m_cells_x - 1, _m_cells_z - 1}));
+		};
+
+		// Build a compressed list of volumes per cell. Volumes are visited in order of precedence, so the volumes
+		// of every cell are sorted by precedence as well.
+		_m_cell_offsets.assign(static_cast<std::size_t>(_m_cells_x) * _m_cells_z + 1, 0);
+		for (auto i = 0u; i < _m_volumes.size(); ++i) {
+			if (candidates[i].is_default) continue;
+
+			auto [lo, hi] = cell_range(_m_volumes[i]);
+			for (auto z = lo.y; z <= hi.y; ++z) {
+				for (auto x = lo.x; x <= hi.x; ++x) {
+					_m_cell_offsets[z * _m_cells_x + x + 1] += 1;
+				}
+			}
+		}
+
+		for (auto i = 1u; i < _m_cell_offsets.size(); ++i) {
+			_m_cell_offsets[i] += _m_cell_offsets[i - 1];
+		}
+
+		std::vector<std::uint32_t> fill {_m_cell_offsets.begin(), _m_cell_offsets.end() - 1};
+		_m_cell_volumes.resize(_m_cell_offsets.back());
+
+		for (auto i = 0u; i < _m_volumes.size(); ++i) {
+			if (candidates[i].is_default) continue;
+
+			auto [lo, hi] = cell_range(_m_volumes[i]);
+			for (auto z = lo.y; z <= hi.y; ++z) {
+				for (auto x = lo.x; x <= hi.x; ++x) {
+					_m_cell_volumes[fill[z * _m_cells_x + x]++] = i;
+				}
+			}
+		}
+	}
+
+	bool VolumeIndex::contains(Volume const& volume, glm::vec3 point) const noexcept {
+		auto& bbox = volume.bbox;
+		if (point.x < bbox.min.x || point.y < bbox.min.y || point.z < bbox.min.z || point.x > bbox.max.x ||
+		    point.y > bbox.max.y || point.z > bbox.max.z) {
+			return false;
+		}
+
+		if (!volume.ellipsoid) return true;
+
+		// Test against the ellipsoid inscribed into the bounding box.
+		auto radii = (bbox.max - bbox.min) * 0.5f;
+		auto d = (point - (bbox.min + radii)) / glm::max(radii, glm::vec3 {1e-6f});
+		return d.x * d.x + d.y * d.y + d.z * d.z <= 1.0f;
+	}
+
+	std::size_t VolumeIndex::query(glm::vec3 point, VolumeKind kinds, VirtualObject** out, std::size_t capacity) const
+	    noexcept {
+		std::uint32_t const* cell = nullptr;
+		std::uint32_t const* cell_end = nullptr;
+
+		auto p = (glm::vec2 {point.x, point.z} - _m_origin) / _m_cell_size;
+		if (_m_cells_x != 0 && p.x >= 0 && p.y >= 0 && p.x < static_cast<float>(_m_cells_x) &&
+		    p.y < static_cast<float>(_m_cells_z)) {
+			auto index = static_cast<std::uint32_t>(p.y) * _m_cells_x + static_cast<std::uint32_t>(p.x);
+			cell = _m_cell_volumes.data() + _m_cell_offsets[index];
+			cell_end = _m_cell_volumes.data() + _m_cell_offsets[index + 1];
+		}
+
+		auto global = _m_global.data();
+		auto global_end = _m_global.data() + _m_global.size();
+
+		// Both lists are sorted by precedence, so merging them yields the results in order of precedence.
+		std::size_t count = 0;
+		while (cell != cell_end || global != global_end) {
+			std::uint32_t i;
+			if (global == global_end || (cell != cell_end && *cell < *global)) {
+				i = *cell++;
+			} else {
+				i = *global++;
+			}
+
+			auto& volume = _m_volumes[i];
+			if (!(volume.kind & kinds) || !this->contains(volume, point)) continue;
+
+			if (count < capacity) out[count] = volume.vob;
+			count += 1;
+		}
+
+		return count;
+	}
+
+	void VolumeIndex::query(glm::vec3 const* points,
+	                        std::size_t count,
+	                        VolumeKind kinds,
+	                        VirtualObject** out,
+	                        std::size_t capacity,
+	                        std::size_t* counts) const noexcept {
+		for (auto i = 0u; i < count; ++i) {
+			counts[i] = this->query(points[i], kinds, out + i * capacity, capacity);
+		}
+	}
+} // namespace zenkit
@@ -0,0 +1,62 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/Allocator.hh>
+#include <zenkit/SaveGame.hh>
+#include <zenkit/World.hh>
+
+/// \brief A memory resource which tracks the number of bytes allocated through it.
+class CountingResource final : public std::pmr::memory_resource {
+public:
+	std::size_t allocated {0};
+	std::size_t outstanding {0};
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+		allocated += bytes;
+		outstanding += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+		outstanding -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+
+	[[nodiscard]] bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+		return this == &other;
+	}
+};
+
+TEST_SUITE("Allocator") {
+	TEST_CASE("MemoryResourceScope") {
+		CountingResource resource {};
+		CHECK_EQ(zenkit::MemoryResourceScope::current(), nullptr);
+
+		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_1};
+		save.load("./samples/G1/Save");
+
+		std::shared_ptr<zenkit::World> world;
+		{
+			zenkit::MemoryResourceScope scope {&resource};
+			CHECK_EQ(zenkit::MemoryResourceScope::current(), &resource);
+
+			{
+				zenkit::MemoryResourceScope inner {nullptr};
+				CHECK_EQ(zenkit::MemoryResourceScope::current(), nullptr);
+			}
+
+			world = save.load_world();
+		}
+
+		CHECK_EQ(zenkit::MemoryResourceScope::current(), nullptr);
+		REQUIRE_NE(world, nullptr);
+		CHECK_FALSE(world->world_vobs.empty());
+		CHECK_GT(resource.allocated, 0);
+		CHECK_EQ(resource.outstanding, resource.allocated);
+
+		// All objects are returned to the resource they were allocated from.
+		world.reset();
+		CHECK_EQ(resource.outstanding, 0);
+	}
+}
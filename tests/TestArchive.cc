@@ -1,6 +1,7 @@
 // Copyright © 2021-2023 GothicKit Contributors.
 // SPDX-License-Identifier: MIT
 #include <zenkit/Archive.hh>
+#include <zenkit/Material.hh>
 #include <zenkit/Stream.hh>
 
 #include <doctest/doctest.h>
@@ -118,7 +119,72 @@ TEST_SUITE("ReadArchive") {
 		CHECK_EQ(reader->read_float(), 0.0f);
 	}
 
+	TEST_CASE("ReadArchive.forget_objects") {
+		std::vector<std::byte> data {};
+		std::uint32_t unknown = 0;
+
+		{
+			auto w = zenkit::Write::to(&data);
+			auto ar = zenkit::WriteArchive::to(w.get(), zenkit::ArchiveFormat::ASCII);
+			auto a = std::make_shared<zenkit::Material>();
+			auto c = std::make_shared<zenkit::Material>();
+			ar->write_object("a", a, zenkit::GameVersion::GOTHIC_1);
+
+			unknown = ar->write_object_begin("b", "zCUnknown", 0);
+			ar->write_int("value", 1);
+			ar->write_object_end();
+
+			ar->write_object("c", c, zenkit::GameVersion::GOTHIC_1);
+			ar->write_ref("ref", unknown + 1);
+			ar->write_ref("ref", unknown + 1);
+			ar->write_ref("ref", unknown - 1);
+			ar->write_header();
+		}
+
+		auto in = zenkit::Read::from(data.data(), data.size());
+		auto reader = zenkit::ReadArchive::from(in.get());
+
+		auto a = reader->read_object(zenkit::GameVersion::GOTHIC_1);
+		REQUIRE_NE(a, nullptr);
+		CHECK_EQ(reader->read_object(zenkit::GameVersion::GOTHIC_1), nullptr);
+		auto c = reader->read_object(zenkit::GameVersion::GOTHIC_1);
+		REQUIRE_NE(c, nullptr);
+		CHECK_EQ(reader->read_object(zenkit::GameVersion::GOTHIC_1), c);
+
+		// Objects after the uncached object of an unknown class are released as well.
+		reader->forget_objects(unknown - 1);
+		CHECK_EQ(reader->read_object(zenkit::GameVersion::GOTHIC_1), nullptr);
+		CHECK_EQ(reader->read_object(zenkit::GameVersion::GOTHIC_1), nullptr);
+	}
+
 	TEST_CASE("ReadArchive.open(BIN_SAFE)" * doctest::skip()) {
 		// FIXME: Stub
 	}
 }
+
+TEST_SUITE("WriteArchive") {
+	TEST_CASE("WriteArchive.write_raw(ASCII)") {
+		std::vector<std::byte> raw {std::byte {0x00}, std::byte {0x05}, std::byte {0xAB}, std::byte {0xFF}};
+		std::vector<std::byte> data {};
+
+		{
+			auto w = zenkit::Write::to(&data);
+			auto ar = zenkit::WriteArchive::to(w.get(), zenkit::ArchiveFormat::ASCII);
+			ar->write_object_begin("obj", "%", 0);
+			ar->write_raw("raw", raw);
+			ar->write_object_end();
+			ar->write_header();
+		}
+
+		auto in = zenkit::Read::from(data.data(), data.size());
+		auto reader = zenkit::ReadArchive::from(in.get());
+
+		zenkit::ArchiveObject obj;
+		REQUIRE(reader->read_object_begin(obj));
+
+		auto r = reader->read_raw(raw.size());
+		std::vector<std::byte> actual(raw.size());
+		r->read(actual.data(), actual.size());
+		CHECK_EQ(actual, raw);
+	}
+}
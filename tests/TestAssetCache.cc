@@ -0,0 +1,84 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/AssetCache.hh>
+#include <zenkit/ModelHierarchy.hh>
+#include <zenkit/ModelMesh.hh>
+#include <zenkit/Texture.hh>
+
+#include <filesystem>
+#include <thread>
+
+TEST_SUITE("AssetCache") {
+	TEST_CASE("AssetCache.get") {
+		zenkit::Vfs vfs {};
+		vfs.mount_host("./samples", "/");
+
+		zenkit::AssetCache<zenkit::Texture> cache {vfs};
+		CHECK_EQ(cache.get("missing.tex"), nullptr);
+
+		auto a = cache.get("ERZ.TEX");
+		auto b = cache.get("erz.tex");
+		REQUIRE_NE(a, nullptr);
+		CHECK_EQ(a, b);
+		CHECK_EQ(a->width(), 128);
+
+		auto stats = cache.stats();
+		CHECK_EQ(stats.misses, 1);
+		CHECK_EQ(stats.hits, 1);
+		CHECK_EQ(stats.count, 1);
+		CHECK_EQ(stats.size, std::filesystem::file_size("./samples/erz.tex"));
+	}
+
+	TEST_CASE("AssetCache.get(CONCURRENT)") {
+		zenkit::Vfs vfs {};
+		vfs.mount_host("./samples", "/");
+
+		zenkit::AssetCache<zenkit::ModelHierarchy> cache {vfs};
+		std::shared_ptr<zenkit::ModelHierarchy const> results[8];
+		std::vector<std::thread> threads {};
+
+		for (auto& result : results) {
+			threads.emplace_back([&cache, &result] { result = cache.get("hierarchy0.mdh"); });
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		for (auto& result : results) {
+			CHECK_EQ(result, results[0]);
+		}
+
+		CHECK_EQ(results[0]->nodes.size(), 7);
+		CHECK_EQ(cache.stats().misses, 1);
+		CHECK_EQ(cache.stats().hits, 7);
+	}
+
+	TEST_CASE("AssetCache.budget") {
+		zenkit::Vfs vfs {};
+		vfs.mount_host("./samples", "/");
+
+		zenkit::AssetCache<zenkit::ModelMesh> cache {vfs, 1, [](auto const&, auto const&) { return 1; }};
+		auto a = cache.get("secretdoor.mdm");
+		CHECK_EQ(cache.get("secretdoor.mdm"), a);
+
+		// Loading a second asset exceeds the budget and evicts the least recently used one.
+		auto b = cache.get("smoke_waterpipe.mdm");
+
+		auto stats = cache.stats();
+		CHECK_EQ(stats.count, 1);
+		CHECK_EQ(stats.size, 1);
+		CHECK_EQ(stats.evictions, 1);
+		CHECK_EQ(cache.get("smoke_waterpipe.mdm"), b);
+
+		// Evicted assets stay alive while they are referenced and are re-loaded on the next request.
+		CHECK_EQ(a->attachments.size(), 1);
+		CHECK_NE(cache.get("secretdoor.mdm"), a);
+		CHECK_EQ(cache.stats().misses, 3);
+
+		cache.budget(0);
+		CHECK_EQ(cache.stats().count, 0);
+		CHECK_EQ(cache.stats().evictions, 3);
+	}
+}
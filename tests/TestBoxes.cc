@@ -0,0 +1,240 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/Boxes.hh>
+#include <zenkit/ModelMesh.hh>
+#include <zenkit/Stream.hh>
+
+#include <algorithm>
+#include <cmath>
+
+static zenkit::OrientedBoundingBox make_box(glm::vec3 center, glm::vec3 half_width, float yaw = 0) {
+	zenkit::OrientedBoundingBox box {};
+	box.center = center;
+	box.half_width = half_width;
+	box.axes[0] = {std::cos(yaw), 0, -std::sin(yaw)};
+	box.axes[1] = {0, 1, 0};
+	box.axes[2] = {std::sin(yaw), 0, std::cos(yaw)};
+	return box;
+}
+
+// A parent box spanning two children at x = -2 and x = 2. The right child has a child of its own.
+static zenkit::OrientedBoundingBox make_hierarchy(glm::vec3 offset = {0, 0, 0}) {
+	auto root = make_box(offset, {4, 1, 1});
+	root.children.push_back(make_box(offset + glm::vec3 {-2, 0, 0}, {1, 1, 1}));
+	root.children.push_back(make_box(offset + glm::vec3 {2, 0, 0}, {1, 1, 1}));
+	root.children[1].children.push_back(make_box(offset + glm::vec3 {2.5f, 0, 0}, {0.5f, 0.5f, 0.5f}));
+	return root;
+}
+
+TEST_SUITE("Boxes") {
+	TEST_CASE("OrientedBoundingBoxTree.build") {
+		zenkit::OrientedBoundingBoxTree tree {};
+		CHECK_EQ(tree.size(), 0);
+		CHECK_EQ(tree.root_count(), 0);
+
+		tree.build(make_hierarchy());
+		CHECK_EQ(tree.size(), 4);
+		CHECK_EQ(tree.root_count(), 1);
+
+		// Nodes are stored in depth-first order.
+		CHECK_EQ(tree.node(0).center, glm::vec3 {0, 0, 0});
+		CHECK_EQ(tree.node(1).center, glm::vec3 {-2, 0, 0});
+		CHECK_EQ(tree.node(2).center, glm::vec3 {2, 0, 0});
+		CHECK_EQ(tree.node(3).center, glm::vec3 {2.5f, 0, 0});
+		CHECK_EQ(tree.node(3).half_width, glm::vec3 {0.5f, 0.5f, 0.5f});
+		CHECK(tree.node(3).children.empty());
+
+		tree.build({make_hierarchy(), make_box({0, 10, 0}, {1, 1, 1}), make_hierarchy({0, 20, 0})});
+		CHECK_EQ(tree.size(), 9);
+		CHECK_EQ(tree.root_count(), 3);
+		CHECK_EQ(tree.node(4).center, glm::vec3 {0, 10, 0});
+		CHECK_EQ(tree.node(8).center, glm::vec3 {2.5f, 20, 0});
+	}
+
+	TEST_CASE("OrientedBoundingBoxTree.overlaps(box)") {
+		zenkit::OrientedBoundingBoxTree tree {};
+		tree.build({make_hierarchy(), make_box({0, 10, 0}, {1, 1, 1}), make_hierarchy({0, 20, 0})});
+
+		std::uint32_t roots[3];
+
+		CHECK_EQ(tree.overlaps(make_box({-2, 0, 0}, {0.1f, 0.1f, 0.1f}), roots, 3), 1);
+		CHECK_EQ(roots[0], 0);
+
+		// Inside of the parent but between the leaves.
+		CHECK_EQ(tree.overlaps(make_box({0, 0, 0}, {0.5f, 0.5f, 0.5f}), roots, 3), 0);
+
+		// Inside of the inner child but outside of its leaf.
+		CHECK_EQ(tree.overlaps(make_box({1.5f, 0, 0}, {0.2f, 0.2f, 0.2f}), roots, 3), 0);
+		CHECK_EQ(tree.overlaps(make_box({2.1f, 0, 0}, {0.2f, 0.2f, 0.2f}), roots, 3), 1);
+
+		// An unrotated box would touch the leaf at (-2, 0, 0), a rotated one does not.
+		CHECK_EQ(tree.overlaps(make_box({-0.6f, 0, 1.4f}, {0.5f, 0.5f, 0.5f}), roots, 3), 1);
+		CHECK_EQ(tree.overlaps(make_box({-0.6f, 0, 1.4f}, {0.5f, 0.5f, 0.5f}, 0.785398f), roots, 3), 0);
+
+		// A tall box hits all three hierarchies.
+		CHECK_EQ(tree.overlaps(make_box({-2, 10, 0}, {0.5f, 12, 0.5f}), roots, 3), 2);
+		CHECK_EQ(roots[0], 0);
+		CHECK_EQ(roots[1], 2);
+
+		CHECK_EQ(tree.overlaps(make_box({0, 10, 0}, {3, 12, 0.5f}), roots, 3), 3);
+		CHECK_EQ(roots[0], 0);
+		CHECK_EQ(roots[1], 1);
+		CHECK_EQ(roots[2], 2);
+
+		// The count is not limited by the capacity.
+		CHECK_EQ(tree.overlaps(make_box({0, 10, 0}, {3, 12, 0.5f}), roots, 1), 3);
+		CHECK_EQ(roots[0], 0);
+	}
+
+	TEST_CASE("OrientedBoundingBoxTree.overlaps(sphere)") {
+		zenkit::OrientedBoundingBoxTree tree {};
+		tree.build({make_hierarchy(), make_box({0, 10, 0}, {1, 1, 1}), make_hierarchy({0, 20, 0})});
+
+		std::uint32_t roots[3];
+
+		CHECK_EQ(tree.overlaps({-2, 0, 2.9f}, 2, roots, 3), 1);
+		CHECK_EQ(roots[0], 0);
+		CHECK_EQ(tree.overlaps({-2, 0, 3.1f}, 2, roots, 3), 0);
+
+		// The corner of a box is further away than its faces.
+		CHECK_EQ(tree.overlaps({2, 12.5f, 2.5f}, 2, roots, 3), 0);
+		CHECK_EQ(tree.overlaps({1.5f, 11.5f, 1.5f}, 1, roots, 3), 1);
+		CHECK_EQ(roots[0], 1);
+
+		CHECK_EQ(tree.overlaps({0, 0, 0}, 0.5f, roots, 3), 0);
+		CHECK_EQ(tree.overlaps({0, 10, 0}, 10, roots, 3), 3);
+	}
+
+	TEST_CASE("OrientedBoundingBoxTree.raycast") {
+		zenkit::OrientedBoundingBoxTree tree {};
+		tree.build({make_hierarchy(), make_box({0, 10, 0}, {1, 1, 1}, 0.785398f)});
+
+		zenkit::OrientedBoundingBoxHit hit {};
+
+		// Along the X axis, the first leaf is hit at its left face.
+		REQUIRE(tree.raycast({-10, 0, 0}, {1, 0, 0}, 100, hit));
+		CHECK_EQ(hit.root, 0);
+		CHECK_EQ(hit.node, 1);
+		CHECK_LT(std::abs(hit.distance - 7), 1e-5f);
+
+		// From the other side, the innermost leaf is hit first.
+		REQUIRE(tree.raycast({10, 0, 0}, {-2, 0, 0}, 100, hit));
+		CHECK_EQ(hit.node, 3);
+		CHECK_LT(std::abs(hit.distance - 3.5f), 1e-5f);
+
+		// The ray ends before reaching any leaf.
+		CHECK_FALSE(tree.raycast({10, 0, 0}, {-1, 0, 0}, 6.9f, hit));
+
+		// Starting inside of a leaf hits it immediately.
+		REQUIRE(tree.raycast({-2, 0, 0}, {0, 0, 1}, 100, hit));
+		CHECK_EQ(hit.node, 1);
+		CHECK_EQ(hit.distance, 0);
+
+		// Parallel to and outside of the slabs of the leaves.
+		CHECK_FALSE(tree.raycast({-10, 0, 1.5f}, {1, 0, 0}, 100, hit));
+
+		// The rotated cube reaches further along X than an unrotated one would.
+		REQUIRE(tree.raycast({-10, 10, 0}, {1, 0, 0}, 100, hit));
+		CHECK_EQ(hit.root, 1);
+		CHECK_EQ(hit.node, 4);
+		CHECK_LT(std::abs(hit.distance - (10 - std::sqrt(2.0f))), 1e-5f);
+
+		// Straight down, the closest of both hierarchies is reported.
+		REQUIRE(tree.raycast({0, 20, 0}, {0, -1, 0}, 100, hit));
+		CHECK_EQ(hit.root, 1);
+		CHECK_LT(std::abs(hit.distance - 9), 1e-5f);
+
+		CHECK_FALSE(tree.raycast({0, 20, 0}, {0, 1, 0}, 100, hit));
+	}
+
+	TEST_CASE("OrientedBoundingBoxTree.raycast(overlapping)") {
+		// A node with two pairs of leaves. The leaves of the first pair overlap, those of the second one do not.
+		auto root = make_box({0, 0, 0}, {4, 1, 1});
+		root.children.push_back(make_box({2, 0, 0}, {1, 1, 1}));
+		root.children.push_back(make_box({1, 0, 0}, {1, 1, 1}));
+		root.children.push_back(make_box({-3, 0, 0}, {0.5f, 0.5f, 0.5f}));
+		root.children.push_back(make_box({-2, 0, 0}, {0.5f, 0.5f, 0.5f}));
+
+		zenkit::OrientedBoundingBoxTree tree {};
+		tree.build(root);
+
+		zenkit::OrientedBoundingBoxHit hit {};
+
+		// The leaves are visited near then far.
+		REQUIRE(tree.raycast({10, 0, 0}, {-1, 0, 0}, 100, hit));
+		CHECK_EQ(hit.node, 1);
+		CHECK_LT(std::abs(hit.distance - 7), 1e-5f);
+
+		// The leaves are visited far then near.
+		REQUIRE(tree.raycast({-10, 0, 0}, {1, 0, 0}, 100, hit));
+		CHECK_EQ(hit.node, 3);
+		CHECK_LT(std::abs(hit.distance - 6.5f), 1e-5f);
+
+		// Starting inside of both overlapping leaves.
+		REQUIRE(tree.raycast({0.5f, 0, 0}, {1, 0, 0}, 100, hit));
+		CHECK_EQ(hit.node, 2);
+		CHECK_EQ(hit.distance, 0);
+
+		REQUIRE(tree.raycast({5, 0, 0}, {-1, 0, 0}, 100, hit));
+		CHECK_EQ(hit.node, 1);
+		CHECK_LT(std::abs(hit.distance - 2), 1e-5f);
+	}
+
+	TEST_CASE("OrientedBoundingBoxTree.transform") {
+		zenkit::OrientedBoundingBoxTree local {};
+		local.build({make_hierarchy(), make_box({0, 0, 0}, {1, 2, 3})});
+
+		// A translation by (0, 5, 0) and a rotation by 90 degrees around Z followed by a translation by (10, 0, 0).
+		glm::mat4 transforms[2] = {glm::mat4 {1}, glm::mat4 {0}};
+		transforms[0][3] = glm::vec4 {0, 5, 0, 1};
+		transforms[1][0] = glm::vec4 {0, 1, 0, 0};
+		transforms[1][1] = glm::vec4 {-1, 0, 0, 0};
+		transforms[1][2] = glm::vec4 {0, 0, 1, 0};
+		transforms[1][3] = glm::vec4 {10, 0, 0, 1};
+
+		zenkit::OrientedBoundingBoxTree world {};
+		world.transform(local, transforms);
+		REQUIRE_EQ(world.size(), local.size());
+		REQUIRE_EQ(world.root_count(), 2);
+
+		CHECK_EQ(world.node(1).center, glm::vec3 {-2, 5, 0});
+		CHECK_EQ(world.node(1).half_width, local.node(1).half_width);
+
+		std::uint32_t roots[2];
+		CHECK_EQ(world.overlaps({-2, 5, 0}, 0.1f, roots, 2), 1);
+		CHECK_EQ(world.overlaps({-2, 0, 0}, 0.1f, roots, 2), 0);
+
+		// Rotated by 90 degrees around Z, the second box is now 2 units wide along X and 1 along Y.
+		auto box = world.node(4);
+		CHECK_LT(glm::distance(box.center, glm::vec3 {10, 0, 0}), 1e-5f);
+		CHECK_LT(glm::distance(box.axes[0], glm::vec3 {0, 1, 0}), 1e-5f);
+
+		CHECK_EQ(world.overlaps({11.9f, 0, 0}, 0.05f, roots, 2), 1);
+		CHECK_EQ(roots[0], 1);
+		CHECK_EQ(world.overlaps({10, 1.2f, 0}, 0.05f, roots, 2), 0);
+	}
+
+	TEST_CASE("OrientedBoundingBoxTree.build(SoftSkinMesh)") {
+		auto in = zenkit::Read::from("./samples/smoke_waterpipe.mdm");
+		zenkit::ModelMesh mesh {};
+		mesh.load(in.get());
+
+		auto& bboxes = mesh.meshes[0].bboxes;
+		zenkit::OrientedBoundingBoxTree tree {};
+		tree.build(bboxes);
+		REQUIRE_EQ(tree.root_count(), bboxes.size());
+
+		// Each bone's volume contains its own center.
+		std::uint32_t roots[16];
+		for (auto i = 0u; i < bboxes.size(); ++i) {
+			auto count = tree.overlaps(bboxes[i].center, 0, roots, 16);
+			REQUIRE(count >= 1);
+			CHECK_NE(std::find(roots, roots + count, i), roots + count);
+
+			auto query = bboxes[i];
+			query.children.clear();
+			CHECK_GE(tree.overlaps(query, roots, 16), 1);
+		}
+	}
+}
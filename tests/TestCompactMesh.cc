@@ -0,0 +1,234 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/CompactMesh.hh>
+#include <zenkit/Mesh.hh>
+#include <zenkit/ModelMesh.hh>
+#include <zenkit/MultiResolutionMesh.hh>
+#include <zenkit/Stream.hh>
+
+#include <glm/geometric.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+static bool within(glm::vec3 a, glm::vec3 b, glm::vec3 bound) {
+	auto d = glm::abs(a - b);
+	return d.x <= bound.x && d.y <= bound.y && d.z <= bound.z;
+}
+
+static bool within_half(float original, float decoded) {
+	return std::abs(original - decoded) <= std::abs(original) * zenkit::COMPACT_HALF_MAX_RELATIVE_ERROR;
+}
+
+TEST_SUITE("CompactMesh") {
+	TEST_CASE("encode_positions") {
+		std::mt19937 rng {42};
+		std::uniform_real_distribution<float> dist {-5000, 5000};
+
+		// Use a count which is not a multiple of the SIMD width.
+		std::vector<glm::vec3> points(1003);
+		for (auto& p : points) {
+			p = glm::vec3 {dist(rng), dist(rng) * 0.1f, dist(rng)};
+		}
+
+		auto q = zenkit::PositionQuantization::from_points(points.data(), points.size());
+
+		std::vector<zenkit::CompactPosition> compact(points.size());
+		std::vector<glm::vec3> decoded(points.size());
+		zenkit::encode_positions(q, points.data(), points.size(), compact.data());
+		zenkit::decode_positions(q, compact.data(), compact.size(), decoded.data());
+
+		// Allow for the rounding of the decoded floats.
+		auto bound = q.max_error() + glm::vec3 {1e-3f};
+		for (auto i = 0u; i < points.size(); ++i) {
+			CHECK(within(points[i], decoded[i], bound));
+		}
+
+		// Positions outside of the box are clamped.
+		glm::vec3 outside {1e6f, -1e6f, 0};
+		zenkit::CompactPosition c {};
+		zenkit::encode_positions(q, &outside, 1, &c);
+		CHECK_EQ(c.x, 65535);
+		CHECK_EQ(c.y, 0);
+	}
+
+	TEST_CASE("encode_normals") {
+		std::vector<glm::vec3> normals {{0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {0, -1, 0}, {0, 0, 0}};
+		for (auto i = 0u; i < 128; ++i) {
+			for (auto j = 0u; j < 256; ++j) {
+				auto theta = static_cast<float>(i) / 127.0f * 3.14159265f;
+				auto phi = static_cast<float>(j) / 256.0f * 6.28318531f + 0.01f;
+				normals.emplace_back(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+			}
+		}
+
+		std::vector<zenkit::CompactNormal> compact(normals.size());
+		std::vector<glm::vec3> decoded(normals.size());
+		zenkit::encode_normals(normals.data(), normals.size(), compact.data());
+		zenkit::decode_normals(compact.data(), compact.size(), decoded.data());
+
+		CHECK_EQ(decoded[0], glm::vec3 {0, 0, 1});
+		CHECK_EQ(decoded[1], glm::vec3 {0, 0, -1});
+		CHECK_EQ(decoded[2], glm::vec3 {1, 0, 0});
+		CHECK_EQ(decoded[3], glm::vec3 {0, -1, 0});
+		CHECK_EQ(decoded[4], glm::vec3 {0, 0, 1});
+
+		for (auto i = 5u; i < normals.size(); ++i) {
+			CHECK_LT(glm::distance(glm::normalize(normals[i]), decoded[i]), zenkit::COMPACT_NORMAL_MAX_ERROR);
+			CHECK_LT(std::abs(glm::length(decoded[i]) - 1), 1e-6f);
+		}
+
+		// Encoding does not depend on the position of a normal in the batch.
+		std::vector<zenkit::CompactNormal> shifted(normals.size() - 1);
+		zenkit::encode_normals(normals.data() + 1, shifted.size(), shifted.data());
+		CHECK_EQ(std::memcmp(shifted.data(), compact.data() + 1, shifted.size() * sizeof(zenkit::CompactNormal)), 0);
+	}
+
+	TEST_CASE("encode_halfs") {
+		std::vector<float> values {0.0f, -0.0f, 1.0f, -2.0f, 0.5f, 65504.0f, 1e6f, -1e6f, std::ldexp(1.0f, -24), NAN};
+		std::vector<std::uint16_t> halfs(values.size());
+		zenkit::encode_halfs(values.data(), values.size(), halfs.data());
+
+		CHECK_EQ(halfs[0], 0x0000);
+		CHECK_EQ(halfs[1], 0x8000);
+		CHECK_EQ(halfs[2], 0x3C00);
+		CHECK_EQ(halfs[3], 0xC000);
+		CHECK_EQ(halfs[4], 0x3800);
+		CHECK_EQ(halfs[5], 0x7BFF);
+		CHECK_EQ(halfs[6], 0x7C00);
+		CHECK_EQ(halfs[7], 0xFC00);
+		CHECK_EQ(halfs[8], 0x0001);
+		CHECK_EQ(halfs[9], 0x7E00);
+
+		// Every half survives a round-trip unchanged.
+		std::vector<std::uint16_t> all(0x10000);
+		for (auto i = 0u; i < all.size(); ++i) {
+			all[i] = static_cast<std::uint16_t>(i);
+		}
+
+		std::vector<float> floats(all.size());
+		std::vector<std::uint16_t> again(all.size());
+		zenkit::decode_halfs(all.data(), all.size(), floats.data());
+		zenkit::encode_halfs(floats.data(), floats.size(), again.data());
+
+		for (auto i = 0u; i < all.size(); ++i) {
+			auto is_nan = (all[i] & 0x7C00) == 0x7C00 && (all[i] & 0x3FF) != 0;
+			if (is_nan) {
+				CHECK(std::isnan(floats[i]));
+			} else {
+				CHECK_EQ(again[i], all[i]);
+			}
+		}
+
+		// Values are rounded to the nearest half.
+		std::mt19937 rng {7};
+		std::uniform_real_distribution<float> dist {-4096, 4096};
+		std::vector<float> random(1001);
+		for (auto& v : random) {
+			v = dist(rng);
+		}
+
+		std::vector<std::uint16_t> encoded(random.size());
+		std::vector<float> decoded(random.size());
+		zenkit::encode_halfs(random.data(), random.size(), encoded.data());
+		zenkit::decode_halfs(encoded.data(), encoded.size(), decoded.data());
+
+		for (auto i = 0u; i < random.size(); ++i) {
+			CHECK(within_half(random[i], decoded[i]));
+		}
+	}
+
+	TEST_CASE("CompactMesh.encode") {
+		zenkit::Mesh mesh {};
+		for (auto i = 0u; i < 300; ++i) {
+			auto f = static_cast<float>(i);
+			mesh.vertices.emplace_back(f * 10.0f, -f, std::sin(f) * 100.0f);
+			mesh.features.push_back(zenkit::VertexFeature {
+			    glm::vec2 {f / 7.0f, -f / 3.0f},
+			    0xFF000000u | i,
+			    glm::normalize(glm::vec3 {std::cos(f), std::sin(f), 0.5f}),
+			});
+		}
+
+		zenkit::CompactMesh compact {};
+		compact.encode(mesh);
+		CHECK_EQ(compact.vertices.size(), 300);
+		CHECK_EQ(compact.features.size(), 300);
+
+		zenkit::Mesh decoded {};
+		compact.decode(decoded);
+		REQUIRE_EQ(decoded.vertices.size(), 300);
+		REQUIRE_EQ(decoded.features.size(), 300);
+
+		auto bound = compact.quantization.max_error() + glm::vec3 {1e-3f};
+		for (auto i = 0u; i < 300; ++i) {
+			CHECK(within(mesh.vertices[i], decoded.vertices[i], bound));
+
+			auto& a = mesh.features[i];
+			auto& b = decoded.features[i];
+			CHECK_EQ(a.light, b.light);
+			CHECK(within_half(a.texture.x, b.texture.x));
+			CHECK(within_half(a.texture.y, b.texture.y));
+			CHECK_LT(glm::distance(a.normal, b.normal), zenkit::COMPACT_NORMAL_MAX_ERROR);
+		}
+	}
+
+	TEST_CASE("CompactSoftSkinMesh.encode") {
+		auto in = zenkit::Read::from("./samples/smoke_waterpipe.mdm");
+		zenkit::ModelMesh model {};
+		model.load(in.get());
+		REQUIRE_EQ(model.meshes.size(), 1);
+
+		auto& original = model.meshes[0];
+		zenkit::CompactSoftSkinMesh compact {};
+		compact.encode(original);
+
+		zenkit::SoftSkinMesh decoded {};
+		compact.decode(decoded);
+
+		auto& mrm = original.mesh;
+		REQUIRE_EQ(decoded.mesh.positions.size(), mrm.positions.size());
+		auto bound = compact.mesh.quantization.max_error() + glm::vec3 {1e-3f};
+		for (auto i = 0u; i < mrm.positions.size(); ++i) {
+			CHECK(within(mrm.positions[i], decoded.mesh.positions[i], bound));
+		}
+
+		REQUIRE_EQ(decoded.mesh.sub_meshes.size(), mrm.sub_meshes.size());
+		for (auto i = 0u; i < mrm.sub_meshes.size(); ++i) {
+			auto& a = mrm.sub_meshes[i].wedges;
+			auto& b = decoded.mesh.sub_meshes[i].wedges;
+			REQUIRE_EQ(a.size(), b.size());
+
+			for (auto j = 0u; j < a.size(); ++j) {
+				CHECK_EQ(a[j].index, b[j].index);
+				CHECK(within_half(a[j].texture.x, b[j].texture.x));
+				CHECK(within_half(a[j].texture.y, b[j].texture.y));
+				CHECK_LT(glm::distance(glm::normalize(a[j].normal), b[j].normal), zenkit::COMPACT_NORMAL_MAX_ERROR);
+			}
+		}
+
+		REQUIRE_EQ(decoded.wedge_normals.size(), original.wedge_normals.size());
+		for (auto i = 0u; i < original.wedge_normals.size(); ++i) {
+			auto& a = original.wedge_normals[i];
+			auto& b = decoded.wedge_normals[i];
+			CHECK_EQ(a.index, b.index);
+			CHECK_LT(glm::distance(glm::normalize(a.normal), b.normal), zenkit::COMPACT_NORMAL_MAX_ERROR);
+		}
+
+		REQUIRE_EQ(decoded.weights.size(), original.weights.size());
+		bound = compact.weight_quantization.max_error() + glm::vec3 {1e-3f};
+		for (auto i = 0u; i < original.weights.size(); ++i) {
+			REQUIRE_EQ(decoded.weights[i].size(), original.weights[i].size());
+
+			for (auto j = 0u; j < original.weights[i].size(); ++j) {
+				auto& a = original.weights[i][j];
+				auto& b = decoded.weights[i][j];
+				CHECK_EQ(a.node_index, b.node_index);
+				CHECK_LT(std::abs(a.weight - b.weight), 1e-5f);
+				CHECK(within(a.position, b.position, bound));
+			}
+		}
+	}
+}
@@ -0,0 +1,60 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/Logger.hh>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("Logger") {
+	TEST_CASE("Logger.enabled") {
+		zenkit::Logger::set(zenkit::LogLevel::WARNING, {});
+		CHECK_FALSE(zenkit::Logger::enabled(zenkit::LogLevel::ERROR));
+
+		zenkit::Logger::set(zenkit::LogLevel::WARNING, [](auto, auto, auto) {});
+		CHECK(zenkit::Logger::enabled(zenkit::LogLevel::ERROR));
+		CHECK(zenkit::Logger::enabled(zenkit::LogLevel::WARNING));
+		CHECK_FALSE(zenkit::Logger::enabled(zenkit::LogLevel::INFO));
+		CHECK_FALSE(zenkit::Logger::enabled(zenkit::LogLevel::TRACE));
+
+		zenkit::Logger::set_default(zenkit::LogLevel::INFO);
+	}
+
+	TEST_CASE("Logger.log(THREADED)") {
+		std::mutex lock;
+		std::vector<std::string> messages;
+
+		zenkit::Logger::set(zenkit::LogLevel::DEBUG, [&](auto, char const* name, char const* message) {
+			std::lock_guard guard {lock};
+			messages.push_back(std::string {name} + ":" + message);
+		});
+
+		std::vector<std::thread> threads {};
+		for (auto t = 0; t < 8; ++t) {
+			threads.emplace_back([t] {
+				for (auto i = 0; i < 100; ++i) {
+					zenkit::Logger::log(zenkit::LogLevel::DEBUG, "Test", "thread %d message %d", t, i);
+					zenkit::Logger::log(zenkit::LogLevel::TRACE, "Test", "discarded");
+				}
+			});
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		zenkit::Logger::set_default(zenkit::LogLevel::INFO);
+
+		// Every message is formatted correctly even though all threads are logging at the same time.
+		REQUIRE_EQ(messages.size(), 800);
+		for (auto t = 0; t < 8; ++t) {
+			for (auto i = 0; i < 100; ++i) {
+				auto expected = "Test:thread " + std::to_string(t) + " message " + std::to_string(i);
+				CHECK_NE(std::find(messages.begin(), messages.end(), expected), messages.end());
+			}
+		}
+	}
+}
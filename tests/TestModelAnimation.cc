@@ -1,6 +1,7 @@
 // Copyright © 2021-2023 GothicKit Contributors.
 // SPDX-License-Identifier: MIT
 #include <doctest/doctest.h>
+#include <zenkit/Error.hh>
 #include <zenkit/ModelAnimation.hh>
 #include <zenkit/Stream.hh>
 
@@ -100,4 +101,108 @@ TEST_SUITE("ModelAnimation") {
 		    "\t\t\tANI\t\t\t(\"S_FISTRUN\"\t\t\t\t1\t\"S_FISTRUN\"\t\t0.0 0.1 MI\t\"HUM_AMB_FISTRUN_M01.ASC\"\tF   "
 		    "1\t50\tFPS:10)");
 	}
+
+	TEST_CASE("CompressedModelAnimation.compress") {
+		auto in = Read::from("./samples/G2/HUMANS-S_FISTRUN.MAN");
+
+		ModelAnimation anim {};
+		anim.load(in.get());
+
+		auto compressed = CompressedModelAnimation::compress(anim);
+		CHECK_EQ(compressed.name, "S_FISTRUN");
+		CHECK_EQ(compressed.frame_count, 20);
+		CHECK_EQ(compressed.node_count, 25);
+		CHECK_EQ(compressed.node_indices, G2_NODE_INDICES);
+		CHECK_LT(compressed.key_count(), anim.samples.size() * 2);
+		CHECK_LT(compressed.size_bytes(), anim.samples.size() * sizeof(AnimationSample));
+
+		auto samples = compressed.decompress();
+		REQUIRE_EQ(samples.size(), anim.samples.size());
+
+		for (auto i = 0u; i < samples.size(); ++i) {
+			auto d = samples[i].position - anim.samples[i].position;
+			CHECK_LE(std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z), 0.05f);
+
+			auto& a = samples[i].rotation;
+			auto& b = anim.samples[i].rotation;
+			auto sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0 ? -1.0f : 1.0f;
+			CHECK_LE(std::abs(a.x - b.x * sign), 0.001f);
+			CHECK_LE(std::abs(a.y - b.y * sign), 0.001f);
+			CHECK_LE(std::abs(a.z - b.z * sign), 0.001f);
+			CHECK_LE(std::abs(a.w - b.w * sign), 0.001f);
+		}
+
+		CHECK_EQ(compressed.sample(3, 7.0f), samples[7 * 25 + 3]);
+		CHECK_EQ(compressed.sample(3, 100.0f), samples[19 * 25 + 3]);
+
+		std::vector<std::byte> data {};
+		auto w = Write::to(&data);
+		compressed.save(w.get());
+
+		auto r = Read::from(&data);
+		CompressedModelAnimation loaded {};
+		loaded.load(r.get());
+
+		CHECK_EQ(loaded.name, compressed.name);
+		CHECK_EQ(loaded.checksum, compressed.checksum);
+		CHECK_EQ(loaded.key_count(), compressed.key_count());
+		CHECK_EQ(loaded.decompress(), samples);
+	}
+
+	TEST_CASE("CompressedModelAnimation.load(invalid)") {
+		auto in = Read::from("./samples/G2/HUMANS-S_FISTRUN.MAN");
+		ModelAnimation anim {};
+		anim.load(in.get());
+
+		std::vector<std::byte> data {};
+		auto w = Write::to(&data);
+		CompressedModelAnimation::compress(anim).save(w.get());
+
+		auto put_uint = [](std::vector<std::byte>& buf, std::size_t off, std::uint32_t v) {
+			for (int i = 0; i < 4; ++i) {
+				buf[off + i] = static_cast<std::byte>((v >> (i * 8)) & 0xFF);
+			}
+		};
+
+		// The tracks chunk follows the header chunk. Each chunk starts with a 2 byte type and a 4 byte size.
+		std::uint32_t header_size = 0;
+		for (int i = 0; i < 4; ++i) {
+			header_size |= static_cast<std::uint32_t>(data[2 + i]) << (i * 8);
+		}
+		auto tracks = 6 + header_size + 6;
+
+		auto load = [](std::vector<std::byte> buf) {
+			auto r = Read::from(&buf);
+			CompressedModelAnimation loaded {};
+			loaded.load(r.get());
+		};
+
+		// A track referencing keys beyond the end of the key array.
+		auto bad_track = data;
+		put_uint(bad_track, tracks, 0xFFFFFFF0);
+		CHECK_THROWS_AS(load(bad_track), ParserError);
+
+		// A key count larger than the remaining data.
+		auto bad_keys = data;
+		put_uint(bad_keys, tracks + anim.node_count * 40, 0x7FFFFFFF);
+		CHECK_THROWS_AS(load(bad_keys), ParserError);
+
+		// A second header after the tracks which declares more nodes than there are tracks.
+		std::uint32_t tracks_size = 0;
+		for (int i = 0; i < 4; ++i) {
+			tracks_size |= static_cast<std::uint32_t>(data[tracks - 4 + i]) << (i * 8);
+		}
+
+		std::vector<std::byte> header(data.begin(), data.begin() + 6 + header_size);
+		auto node_count = 6 + 2 + anim.name.size() + 1 + anim.next.size() + 1 + 4 + 4;
+		put_uint(header, 2, header_size + 4);
+		put_uint(header, node_count, anim.node_count + 1);
+		header.insert(header.end(), 4, std::byte {0});
+
+		auto late_header = data;
+		late_header.insert(late_header.begin() + tracks + tracks_size, header.begin(), header.end());
+		CHECK_THROWS_AS(load(late_header), ParserError);
+
+		CHECK_NOTHROW(load(data));
+	}
 }
@@ -0,0 +1,77 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/ModelBundle.hh>
+#include <zenkit/ModelHierarchy.hh>
+#include <zenkit/ModelMesh.hh>
+#include <zenkit/ModelScript.hh>
+#include <zenkit/Stream.hh>
+#include <zenkit/Texture.hh>
+#include <zenkit/Vfs.hh>
+
+#include <algorithm>
+#include <filesystem>
+
+static bool contains(std::vector<std::string> const& v, std::string_view s) {
+	return std::find(v.begin(), v.end(), s) != v.end();
+}
+
+TEST_SUITE("ModelBundle") {
+	TEST_CASE("ModelBundleLoader.load") {
+		zenkit::ModelScript script {};
+		script.skeleton.name = "HIERARCHY0.ASC";
+		script.meshes.emplace_back("SECRETDOOR.ASC");
+		script.animations.emplace_back().name = "S_RUN";
+
+		std::vector<std::byte> msb {};
+		auto w = zenkit::Write::to(&msb);
+		script.save(w.get());
+
+		// Mount the first texture referenced by the mesh using an arbitrary sample texture.
+		auto r = zenkit::Read::from("./samples/secretdoor.mdm");
+		zenkit::ModelMesh mesh {};
+		mesh.load(r.get());
+
+		auto& texture = mesh.attachments.begin()->second.materials[0].texture;
+		auto texture_name = texture.substr(0, texture.rfind('.')) + "-C.TEX";
+
+		zenkit::Vfs vfs {};
+		vfs.mount_host("./samples", "/");
+		vfs.mount(zenkit::VfsNode::file("TEST.MSB", zenkit::VfsFileDescriptor {msb.data(), msb.size(), false}), "/");
+
+		std::vector<std::byte> tex(std::filesystem::file_size("./samples/erz.tex"));
+		r = zenkit::Read::from("./samples/erz.tex");
+		r->read(tex.data(), tex.size());
+		vfs.mount(zenkit::VfsNode::file(texture_name, zenkit::VfsFileDescriptor {tex.data(), tex.size(), false}), "/");
+
+		zenkit::ModelBundleLoader loader {vfs, 4};
+		auto bundles = loader.load({"TEST.MDS", "test.mds", "MISSING.MDL"});
+		REQUIRE_EQ(bundles.size(), 3);
+
+		auto& bundle = bundles[0];
+		CHECK_EQ(bundle.name, "TEST.MDS");
+		REQUIRE_NE(bundle.script, nullptr);
+		CHECK_EQ(bundle.script->animations[0].name, "S_RUN");
+		REQUIRE_NE(bundle.hierarchy, nullptr);
+		CHECK_EQ(bundle.hierarchy->nodes.size(), 7);
+		REQUIRE_EQ(bundle.meshes.size(), 1);
+		CHECK_EQ(bundle.meshes.begin()->second->attachments.size(), 1);
+		CHECK_EQ(bundle.animations.size(), 0);
+		REQUIRE_EQ(bundle.textures.size(), 1);
+		CHECK_EQ(bundle.textures.at(texture)->width(), 128);
+
+		CHECK_EQ(bundle.missing.size(), 2);
+		CHECK(contains(bundle.missing, "HIERARCHY0.MDM"));
+		CHECK(contains(bundle.missing, "TEST-S_RUN.MAN"));
+
+		// Assets shared between models are only loaded once.
+		CHECK_EQ(bundles[1].script, bundle.script);
+		CHECK_EQ(bundles[1].hierarchy, bundle.hierarchy);
+		CHECK_EQ(bundles[1].meshes.begin()->second, bundle.meshes.begin()->second);
+		CHECK_EQ(bundles[1].textures.at(texture), bundle.textures.at(texture));
+
+		CHECK_EQ(bundles[2].script, nullptr);
+		CHECK_EQ(bundles[2].hierarchy, nullptr);
+		CHECK_EQ(bundles[2].missing, std::vector<std::string> {"MISSING.MDL"});
+	}
+}
@@ -5,6 +5,10 @@
 #include <zenkit/ModelScript.hh>
 #include <zenkit/Stream.hh>
 
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
 TEST_SUITE("ModelScript") {
 	TEST_CASE("ModelScript.load(GOTHIC?)") {
 		zenkit::Logger::set_default(zenkit::LogLevel::INFO);
@@ -243,6 +247,114 @@ TEST_SUITE("ModelScript") {
 		CHECK_EQ(script.animations[47].events[3].frames[1], 15);
 	}
 
+	TEST_CASE("ModelScript.load(CACHE)") {
+		zenkit::ModelScript expected {};
+		auto r = zenkit::Read::from("./samples/waran.mds");
+		expected.load(r.get());
+
+		zenkit::ModelScriptCache cache {};
+		zenkit::ModelScript first {};
+		r = zenkit::Read::from("./samples/waran.mds");
+		first.load(r.get(), &cache);
+
+		zenkit::ModelScript second {};
+		r = zenkit::Read::from("./samples/waran.mds");
+		second.load(r.get(), &cache);
+
+		CHECK_EQ(cache.misses(), 1);
+		CHECK_EQ(cache.hits(), 1);
+
+		for (auto* script : {&first, &second}) {
+			CHECK_EQ(script->skeleton.name, expected.skeleton.name);
+			CHECK_EQ(script->skeleton.disable_mesh, expected.skeleton.disable_mesh);
+			CHECK_EQ(script->meshes, expected.meshes);
+			CHECK_EQ(script->disabled_animations, expected.disabled_animations);
+			CHECK_EQ(script->aliases.size(), expected.aliases.size());
+			CHECK_EQ(script->blends.size(), expected.blends.size());
+			CHECK_EQ(script->combinations.size(), expected.combinations.size());
+			CHECK_EQ(script->model_tags.size(), expected.model_tags.size());
+			REQUIRE_EQ(script->animations.size(), expected.animations.size());
+
+			for (auto i = 0u; i < expected.animations.size(); ++i) {
+				auto& a = script->animations[i];
+				auto& b = expected.animations[i];
+
+				CHECK_EQ(a.name, b.name);
+				CHECK_EQ(a.flags, b.flags);
+				CHECK_EQ(a.direction, b.direction);
+				CHECK_EQ(a.last_frame, b.last_frame);
+				CHECK_EQ(a.sfx.size(), b.sfx.size());
+				CHECK_EQ(a.pfx.size(), b.pfx.size());
+				CHECK_EQ(a.morph.size(), b.morph.size());
+				REQUIRE_EQ(a.events.size(), b.events.size());
+
+				for (auto j = 0u; j < b.events.size(); ++j) {
+					CHECK_EQ(a.events[j].type, b.events[j].type);
+					CHECK_EQ(a.events[j].slot, b.events[j].slot);
+					CHECK_EQ(a.events[j].item, b.events[j].item);
+					CHECK_EQ(a.events[j].frames, b.events[j].frames);
+					CHECK_EQ(a.events[j].fight_mode, b.events[j].fight_mode);
+					CHECK_EQ(a.events[j].attached, b.events[j].attached);
+				}
+			}
+		}
+	}
+
+	TEST_CASE("ModelScript.load(CACHE,DAMAGED)") {
+		auto directory = std::filesystem::temp_directory_path() / "zenkit-mds-cache-test";
+		std::filesystem::remove_all(directory);
+
+		zenkit::ModelScript expected {};
+		{
+			zenkit::ModelScriptCache cache {directory};
+			auto r = zenkit::Read::from("./samples/waran.mds");
+			expected.load(r.get(), &cache);
+		}
+
+		std::vector<std::filesystem::path> entries {};
+		for (auto& entry : std::filesystem::directory_iterator {directory}) {
+			entries.push_back(entry.path());
+		}
+
+		// No temporary files are left behind.
+		REQUIRE_EQ(entries.size(), 1);
+		CHECK_NE(entries[0].filename().string().find(".msb"), std::string::npos);
+
+		// A truncated entry is discarded and replaced by parsing the source again.
+		std::filesystem::resize_file(entries[0], std::filesystem::file_size(entries[0]) / 2);
+
+		{
+			zenkit::ModelScriptCache cache {directory};
+			zenkit::ModelScript script {};
+			auto r = zenkit::Read::from("./samples/waran.mds");
+			script.load(r.get(), &cache);
+
+			CHECK_EQ(cache.misses(), 1);
+			CHECK_EQ(script.skeleton.name, expected.skeleton.name);
+			CHECK_EQ(script.meshes, expected.meshes);
+			CHECK_EQ(script.animations.size(), expected.animations.size());
+		}
+
+		{
+			zenkit::ModelScriptCache cache {directory};
+			zenkit::ModelScript script {};
+			auto r = zenkit::Read::from("./samples/waran.mds");
+			script.load(r.get(), &cache);
+
+			CHECK_EQ(cache.hits(), 1);
+			CHECK_EQ(script.animations.size(), expected.animations.size());
+
+			// Evicted entries are removed from disk.
+			std::ifstream in {"./samples/waran.mds", std::ios::binary};
+			std::string source {std::istreambuf_iterator<char> {in}, std::istreambuf_iterator<char> {}};
+			cache.evict(zenkit::ModelScriptCache::hash(reinterpret_cast<std::byte const*>(source.data()),
+			                                           source.size()));
+			CHECK(std::filesystem::is_empty(directory));
+		}
+
+		std::filesystem::remove_all(directory);
+	}
+
 	TEST_CASE("ModelScript.load(GOTHIC1)" * doctest::skip()) {
 		// TODO: Stub
 	}
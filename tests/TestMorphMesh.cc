@@ -4,6 +4,8 @@
 #include <zenkit/MorphMesh.hh>
 #include <zenkit/Stream.hh>
 
+#include <glm/geometric.hpp>
+
 TEST_SUITE("MorphMesh") {
 	TEST_CASE("MorphMesh.load(GOTHIC?)") {
 		auto in = zenkit::Read::from("./samples/morph0.mmb");
@@ -49,6 +51,35 @@ TEST_SUITE("MorphMesh") {
 		CHECK_EQ(mesh.sources[1].file_name, "ITRWSMALLBOWSHOOT.ASC");
 	}
 
+	TEST_CASE("MorphBlender.blend") {
+		auto in = zenkit::Read::from("./samples/morph0.mmb");
+		zenkit::MorphMesh mesh {};
+		mesh.load(in.get());
+
+		zenkit::MorphBlender blender {mesh};
+		CHECK_EQ(blender.vertex_count(), 28);
+
+		auto rest = blender.blend({});
+		CHECK_EQ(rest, mesh.morph_positions);
+
+		auto& anim = mesh.animations[1];
+		auto shot = blender.blend({zenkit::MorphBlend {1, 6, 1.0f}});
+		CHECK_EQ(shot[0], mesh.morph_positions[0]);
+		CHECK_EQ(shot[25], mesh.morph_positions[25] + anim.samples[6 * 3 + 0]);
+		CHECK_EQ(shot[26], mesh.morph_positions[26] + anim.samples[6 * 3 + 1]);
+		CHECK_EQ(shot[27], mesh.morph_positions[27] + anim.samples[6 * 3 + 2]);
+
+		auto half = blender.blend({
+		    zenkit::MorphBlend {1, 6.5f, 0.5f},
+		    zenkit::MorphBlend {99, 0, 1.0f},
+		});
+		auto expected = mesh.morph_positions[26] + (anim.samples[6 * 3 + 1] + anim.samples[7 * 3 + 1]) * 0.25f;
+		CHECK_LT(glm::length(half[26] - expected), 0.0001f);
+
+		auto clamped = blender.blend({zenkit::MorphBlend {1, 100, 1.0f}});
+		CHECK_EQ(clamped[27], mesh.morph_positions[27] + anim.samples[9 * 3 + 2]);
+	}
+
 	TEST_CASE("MorphMesh.load(GOTHIC1)" * doctest::skip()) {
 		// TODO: Stub
 	}
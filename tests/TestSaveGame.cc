@@ -1,9 +1,13 @@
 // Copyright © 2022-2023 GothicKit Contributors.
 // SPDX-License-Identifier: MIT
 #include <doctest/doctest.h>
+#include <zenkit/Error.hh>
 #include <zenkit/SaveGame.hh>
 #include <zenkit/World.hh>
 
+#include <atomic>
+#include <filesystem>
+
 TEST_SUITE("SaveGame") {
 	TEST_CASE("SaveGame.load(GOTHIC1)") {
 		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_1};
@@ -53,6 +57,238 @@ TEST_SUITE("SaveGame") {
 		// TODO: Add more checks
 	}
 
+	TEST_CASE("SaveGame.load(GOTHIC1,DEFERRED)") {
+		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_1};
+		save.load("./samples/G1/Save", zenkit::SaveGameLoadMode::DEFERRED);
+		auto wld = save.load_world_async();
+
+		CHECK_EQ(save.metadata.title, "sds");
+		CHECK_EQ(save.metadata.world, "WORLD");
+
+		auto& state = save.resolve_state();
+		CHECK_EQ(state.day, 0);
+		CHECK_EQ(state.hour, 8);
+		CHECK_EQ(state.minute, 6);
+		CHECK_EQ(&state, &save.state);
+
+		zenkit::SaveGame eager {zenkit::GameVersion::GOTHIC_1};
+		eager.load("./samples/G1/Save");
+		CHECK_EQ(state.infos.size(), eager.state.infos.size());
+		CHECK_EQ(state.symbols.size(), eager.state.symbols.size());
+		CHECK_EQ(state.log.size(), eager.state.log.size());
+
+		CHECK_FALSE(save.thumbnail);
+		CHECK_EQ(save.resolve_thumbnail().has_value(), eager.thumbnail.has_value());
+
+		CHECK_NE(wld.get(), nullptr);
+
+		// Copies share the pending state and each of them resolves it.
+		zenkit::SaveGame deferred {zenkit::GameVersion::GOTHIC_1};
+		deferred.load("./samples/G1/Save", zenkit::SaveGameLoadMode::DEFERRED);
+		auto copy = deferred;
+		CHECK_EQ(deferred.resolve_state().symbols.size(), eager.state.symbols.size());
+		CHECK_EQ(copy.resolve_state().symbols.size(), eager.state.symbols.size());
+	}
+
+	TEST_CASE("SaveGame.resolve_state(GOTHIC1,INVALID)") {
+		auto slot = std::filesystem::temp_directory_path() / "zenkit-save-invalid-test";
+		std::filesystem::remove_all(slot);
+		std::filesystem::copy("./samples/G1/Save", slot, std::filesystem::copy_options::recursive);
+		std::filesystem::resize_file(slot / "SAVEDAT.SAV", 16);
+
+		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_1};
+		save.load(slot, zenkit::SaveGameLoadMode::DEFERRED);
+
+		// The parser error is reported on every access, not only on the first one.
+		CHECK_THROWS(save.resolve_state());
+		CHECK_THROWS(save.resolve_state());
+
+		std::filesystem::remove_all(slot);
+	}
+
+	TEST_CASE("SaveGame.save(GOTHIC2,BINSAFE)") {
+		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_2};
+		save.load("./samples/G2/SaveFast");
+		auto wld = save.load_world();
+		REQUIRE_NE(wld, nullptr);
+
+		auto out = std::filesystem::temp_directory_path() / "zenkit-save-test";
+		std::filesystem::remove_all(out);
+
+		zenkit::SaveGameWriteOptions options {};
+		options.state_format = zenkit::ArchiveFormat::BINSAFE;
+		save.save(out, *wld, "NEWWORLD", options);
+
+		// Worlds which are not re-written are carried over and no temporary files are left behind.
+		CHECK(std::filesystem::exists(out / "OLDWORLD.SAV"));
+		CHECK_EQ(std::filesystem::file_size(out / "OLDWORLD.SAV"),
+		         std::filesystem::file_size("./samples/G2/SaveFast/OLDWORLD.SAV"));
+
+		for (auto& entry : std::filesystem::directory_iterator(out)) {
+			CHECK_NE(entry.path().extension(), ".tmp");
+		}
+
+		zenkit::SaveGame copy {zenkit::GameVersion::GOTHIC_2};
+		copy.load(out);
+		CHECK_EQ(copy.metadata.title, save.metadata.title);
+		CHECK_EQ(copy.state.day, save.state.day);
+		CHECK_EQ(copy.state.infos.size(), save.state.infos.size());
+		REQUIRE_EQ(copy.state.symbols.size(), save.state.symbols.size());
+
+		for (auto i = 0u; i < save.state.symbols.size(); ++i) {
+			CHECK_EQ(copy.state.symbols[i].name, save.state.symbols[i].name);
+			CHECK_EQ(copy.state.symbols[i].values, save.state.symbols[i].values);
+		}
+
+		std::filesystem::remove_all(out);
+	}
+
+	TEST_CASE("SaveGame.save(GOTHIC2,FAILED)") {
+		auto slot = std::filesystem::temp_directory_path() / "zenkit-save-slot-test";
+		auto other = std::filesystem::temp_directory_path() / "zenkit-save-other-test";
+		std::filesystem::remove_all(slot);
+		std::filesystem::remove_all(other);
+		std::filesystem::copy("./samples/G2/SaveFast", slot, std::filesystem::copy_options::recursive);
+		std::filesystem::copy("./samples/G2/SaveFast", other, std::filesystem::copy_options::recursive);
+
+		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_2};
+		save.load(slot);
+		auto wld = save.load_world();
+		REQUIRE_NE(wld, nullptr);
+
+		auto check_intact = [](std::filesystem::path const& path) {
+			for (auto& entry : std::filesystem::directory_iterator("./samples/G2/SaveFast")) {
+				auto copy = path / entry.path().filename();
+				REQUIRE(std::filesystem::exists(copy));
+				CHECK_EQ(std::filesystem::file_size(copy), std::filesystem::file_size(entry.path()));
+			}
+
+			for (auto& entry : std::filesystem::directory_iterator(path)) {
+				CHECK_NE(entry.path().extension(), ".tmp");
+			}
+
+			zenkit::SaveGame copy {zenkit::GameVersion::GOTHIC_2};
+			copy.load(path);
+			CHECK_EQ(copy.metadata.title, "inminevalley");
+			CHECK_NE(copy.load_world(), nullptr);
+		};
+
+		// The world file can not be created, so the save fails after all other files have been written. Neither the
+		// loaded slot, even when addressed through a different path, nor another slot may have been modified.
+		CHECK_THROWS_AS(save.save(slot / ".." / slot.filename(), *wld, "MISSING/NEWWORLD"), zenkit::Error);
+		check_intact(slot);
+
+		CHECK_THROWS_AS(save.save(other, *wld, "MISSING/NEWWORLD"), zenkit::Error);
+		check_intact(other);
+
+		std::filesystem::remove_all(slot);
+		std::filesystem::remove_all(other);
+	}
+
+	TEST_CASE("SaveGame.save_async(GOTHIC2)") {
+		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_2};
+		save.load("./samples/G2/SaveFast", zenkit::SaveGameLoadMode::DEFERRED);
+		auto wld = save.load_world();
+		REQUIRE_NE(wld, nullptr);
+
+		auto out = std::filesystem::temp_directory_path() / "zenkit-save-async-test";
+		std::filesystem::remove_all(out);
+
+		std::atomic_bool called {false};
+		auto task = save.save_async(out, *wld, "NEWWORLD", {}, [&called](auto status, auto const& error) {
+			CHECK_EQ(status, zenkit::SaveGameWriteStatus::COMPLETED);
+			CHECK(error.empty());
+			called = true;
+		});
+
+		// The snapshot is independent of the live state.
+		auto day = save.state.day;
+		save.state.day += 1;
+		save.metadata.title = "modified";
+		wld->world_vobs.clear();
+
+		REQUIRE_EQ(task.wait(), zenkit::SaveGameWriteStatus::COMPLETED);
+		CHECK(task.done());
+		CHECK(called);
+
+		zenkit::SaveGame copy {zenkit::GameVersion::GOTHIC_2};
+		copy.load(out);
+		CHECK_EQ(copy.metadata.title, "inminevalley");
+		CHECK_EQ(copy.state.day, day);
+		CHECK(std::filesystem::exists(out / "OLDWORLD.SAV"));
+		CHECK_NE(copy.load_world()->world_vobs.size(), 0);
+
+		// A cancelled write never renames its files into place.
+		task = save.save_async(out, *wld, "NEWWORLD");
+		task.cancel();
+
+		if (task.wait() == zenkit::SaveGameWriteStatus::CANCELLED) {
+			copy.load(out);
+			CHECK_EQ(copy.metadata.title, "inminevalley");
+		}
+
+		for (auto& entry : std::filesystem::directory_iterator(out)) {
+			CHECK_NE(entry.path().extension(), ".tmp");
+		}
+
+		// A failed write does not change the directory the save game refers to, so the next save still carries
+		// over the files of the previous one.
+		auto failed = std::filesystem::temp_directory_path() / "zenkit-save-async-failed-test";
+		auto next = std::filesystem::temp_directory_path() / "zenkit-save-async-next-test";
+		std::filesystem::remove_all(failed);
+		std::filesystem::remove_all(next);
+		std::filesystem::copy_file(out / "OLDWORLD.SAV", out / "MARKER.SAV");
+
+		task = save.save_async(failed, *wld, "MISSING/NEWWORLD");
+		CHECK_EQ(task.wait(), zenkit::SaveGameWriteStatus::FAILED);
+		CHECK_FALSE(std::filesystem::exists(failed));
+
+		save.save(next, *wld, "NEWWORLD");
+		CHECK(std::filesystem::exists(next / "MARKER.SAV"));
+
+		// Destroying the save game and all handles waits for the write to finish.
+		auto detached = std::filesystem::temp_directory_path() / "zenkit-save-async-detached-test";
+		std::filesystem::remove_all(detached);
+		{
+			zenkit::SaveGame other {zenkit::GameVersion::GOTHIC_2};
+			other.load(next);
+			(void) other.save_async(detached, *wld, "NEWWORLD");
+		}
+
+		CHECK(std::filesystem::exists(detached / "SAVEDAT.SAV"));
+		CHECK(std::filesystem::exists(detached / "MARKER.SAV"));
+
+		std::filesystem::remove_all(detached);
+		std::filesystem::remove_all(next);
+		std::filesystem::remove_all(out);
+	}
+
+	TEST_CASE("SaveSlotIndex.scan(GOTHIC1)") {
+		zenkit::SaveSlotIndex index {zenkit::GameVersion::GOTHIC_1};
+		auto slots = index.scan("./samples/G1", 64);
+
+		REQUIRE_EQ(slots.size(), 2);
+		CHECK_EQ(slots[0].path.filename(), "Save");
+		CHECK_EQ(slots[0].metadata.title, "sds");
+		CHECK_EQ(slots[0].metadata.play_time_seconds, 49);
+		CHECK_EQ(slots[1].path.filename(), "SaveFast");
+		CHECK_EQ(slots[1].metadata.title, "sds_fast");
+
+		CHECK_EQ(slots[0].thumbnail_width, 64);
+		CHECK_EQ(slots[0].thumbnail_height, 64);
+		CHECK_EQ(slots[0].thumbnail.size(), 64 * 64 * 4);
+
+		// Unchanged save games are served from the cache.
+		auto cached = index.scan("./samples/G1", 64);
+		REQUIRE_EQ(cached.size(), 2);
+		CHECK_EQ(cached[0].metadata.title, "sds");
+		CHECK_EQ(cached[0].thumbnail, slots[0].thumbnail);
+
+		auto without_thumbnails = index.scan("./samples/G1");
+		REQUIRE_EQ(without_thumbnails.size(), 2);
+		CHECK(without_thumbnails[0].thumbnail.empty());
+	}
+
 	TEST_CASE("SaveGame.load(GOTHIC2)") {
 		zenkit::Logger::set_default(zenkit::LogLevel::DEBUG);
 		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_2};
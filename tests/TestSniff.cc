@@ -0,0 +1,112 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/Archive.hh>
+#include <zenkit/Sniff.hh>
+#include <zenkit/Stream.hh>
+
+#include <filesystem>
+
+static zenkit::FileInfo sniff_file(std::filesystem::path const& path) {
+	auto r = zenkit::Read::from(path);
+	auto info = zenkit::sniff(r.get());
+	CHECK_EQ(r->tell(), 0);
+	return info;
+}
+
+static std::vector<std::byte> read_file(std::filesystem::path const& path) {
+	std::vector<std::byte> data(std::filesystem::file_size(path));
+	auto r = zenkit::Read::from(path);
+	r->read(data.data(), data.size());
+	return data;
+}
+
+static std::vector<std::byte> make_world(zenkit::ArchiveFormat format, std::uint32_t bsp_version) {
+	std::vector<std::byte> data {};
+	auto w = zenkit::Write::to(&data);
+	auto ar = zenkit::WriteArchive::to(w.get(), format);
+
+	ar->write_object_begin("%", "oCWorld:zCWorld", 64513);
+	ar->write_object_begin("VobTree", "", 0);
+	ar->write_string("decoy", "[MeshAndBsp % 0 0]");
+	ar->write_int("childs0", 0);
+	ar->write_object_end();
+
+	ar->write_object_begin("MeshAndBsp", "", 0);
+	ar->get_stream()->write_uint(bsp_version);
+	ar->get_stream()->write_uint(0);
+	ar->write_object_end();
+	ar->write_object_end();
+	ar->write_header();
+
+	return data;
+}
+
+TEST_SUITE("Sniff") {
+	TEST_CASE("sniff(CHUNKED)") {
+		auto info = sniff_file("./samples/mesh0.mrm");
+		CHECK_EQ(info.format, zenkit::FileFormat::MULTI_RESOLUTION_MESH);
+		CHECK_EQ(info.version, zenkit::GameVersion::GOTHIC_1);
+
+		CHECK_EQ(sniff_file("./samples/hierarchy0.mdh").format, zenkit::FileFormat::MODEL_HIERARCHY);
+		CHECK_EQ(sniff_file("./samples/secretdoor.mdm").format, zenkit::FileFormat::MODEL_MESH);
+		CHECK_EQ(sniff_file("./samples/morph0.mmb").format, zenkit::FileFormat::MORPH_MESH);
+		CHECK_EQ(sniff_file("./samples/waran.msb").format, zenkit::FileFormat::MODEL_SCRIPT);
+		CHECK_EQ(sniff_file("./samples/G1/HUMANS-S_FISTRUN.MAN").format, zenkit::FileFormat::MODEL_ANIMATION);
+
+		// A model is a hierarchy followed by a model mesh.
+		auto model = read_file("./samples/hierarchy0.mdh");
+		auto mesh = read_file("./samples/secretdoor.mdm");
+		model.insert(model.end(), mesh.begin(), mesh.end());
+
+		auto r = zenkit::Read::from(&model);
+		CHECK_EQ(zenkit::sniff(r.get()).format, zenkit::FileFormat::MODEL);
+		CHECK_EQ(r->tell(), 0);
+	}
+
+	TEST_CASE("sniff(OTHER)") {
+		auto info = sniff_file("./samples/erz.tex");
+		CHECK_EQ(info.format, zenkit::FileFormat::TEXTURE);
+		CHECK_FALSE(info.version);
+
+		CHECK_EQ(sniff_file("./samples/G1/FONT_OLD_10_WHITE_HI.FNT").format, zenkit::FileFormat::FONT);
+		CHECK_EQ(sniff_file("./samples/empty.txt").format, zenkit::FileFormat::UNKNOWN);
+		CHECK_EQ(sniff_file("./samples/basic.bin").format, zenkit::FileFormat::UNKNOWN);
+	}
+
+	TEST_CASE("sniff(ARCHIVE)") {
+		auto info = sniff_file("./samples/G1/DEMON_DIE_BODY.MAT");
+		CHECK_EQ(info.format, zenkit::FileFormat::ARCHIVE);
+		CHECK_EQ(info.archive_format, zenkit::ArchiveFormat::BINARY);
+		CHECK_FALSE(info.save);
+
+		info = sniff_file("./samples/G2/VOb/zCVob.zen");
+		CHECK_EQ(info.format, zenkit::FileFormat::ARCHIVE);
+		CHECK_EQ(info.archive_format, zenkit::ArchiveFormat::BINSAFE);
+		CHECK_EQ(info.version, zenkit::GameVersion::GOTHIC_2);
+		CHECK_EQ(sniff_file("./samples/G1/VOb/zCVob.zen").version, zenkit::GameVersion::GOTHIC_1);
+
+		info = sniff_file("./samples/G1/Save/WORLD.SAV");
+		CHECK_EQ(info.format, zenkit::FileFormat::WORLD);
+		CHECK(info.save);
+		CHECK_FALSE(info.version);
+	}
+
+	TEST_CASE("sniff(WORLD)") {
+		using zenkit::ArchiveFormat;
+
+		for (auto format : {ArchiveFormat::ASCII, ArchiveFormat::BINARY, ArchiveFormat::BINSAFE}) {
+			for (auto [bsp, version] : {std::pair {0x2090000u, zenkit::GameVersion::GOTHIC_1},
+			                            std::pair {0x4090000u, zenkit::GameVersion::GOTHIC_2}}) {
+				auto data = make_world(format, bsp);
+				auto r = zenkit::Read::from(&data);
+				auto info = zenkit::sniff(r.get());
+
+				CHECK_EQ(info.format, zenkit::FileFormat::WORLD);
+				CHECK_EQ(info.archive_format, format);
+				CHECK_EQ(info.version, version);
+				CHECK_EQ(r->tell(), 0);
+			}
+		}
+	}
+}
@@ -0,0 +1,63 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/SaveGame.hh>
+#include <zenkit/Stats.hh>
+#include <zenkit/Stream.hh>
+#include <zenkit/Texture.hh>
+#include <zenkit/World.hh>
+
+#include <algorithm>
+
+TEST_SUITE("Stats") {
+	TEST_CASE("Stats.report") {
+		zenkit::Stats::reset();
+
+		auto r = zenkit::Read::from("./samples/erz.tex");
+		zenkit::Texture tex {};
+		tex.load(r.get());
+
+		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_1};
+		save.load("./samples/G1/Save");
+		auto world = save.load_world();
+
+		auto report = zenkit::Stats::report();
+		if (!zenkit::Stats::enabled()) {
+			CHECK(report.sections.empty());
+			CHECK(report.reads.empty());
+			CHECK(report.objects.empty());
+			return;
+		}
+
+		auto texture = std::find_if(report.sections.begin(), report.sections.end(), [](auto& s) {
+			return s.name == "Texture.load";
+		});
+		REQUIRE_NE(texture, report.sections.end());
+		CHECK_EQ(texture->subsystem, zenkit::StatsSubsystem::TEXTURE);
+		CHECK_GE(texture->count, 1);
+		CHECK_GE(texture->total_ns, texture->max_ns);
+
+		auto reads = std::find_if(report.reads.begin(), report.reads.end(), [](auto& s) {
+			return s.backend != zenkit::StatsReadBackend::FILE && s.bytes > 0;
+		});
+		CHECK_NE(reads, report.reads.end());
+
+		auto items = std::find_if(report.objects.begin(), report.objects.end(), [](auto& s) {
+			return s.type == zenkit::ObjectType::oCNpc;
+		});
+		REQUIRE_NE(items, report.objects.end());
+		CHECK_GT(items->count, 0);
+
+		// Types declared after ObjectType::unknown are counted as well.
+		auto managers = std::find_if(report.objects.begin(), report.objects.end(), [](auto& s) {
+			return s.type == zenkit::ObjectType::zCEventManager;
+		});
+		REQUIRE_NE(managers, report.objects.end());
+		CHECK_GT(managers->count, 0);
+
+		zenkit::Stats::reset();
+		report = zenkit::Stats::report();
+		CHECK(report.sections.empty());
+		CHECK(report.objects.empty());
+	}
+}
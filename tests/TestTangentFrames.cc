@@ -0,0 +1,184 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/MultiResolutionMesh.hh>
+#include <zenkit/Stream.hh>
+#include <zenkit/TangentFrames.hh>
+
+#include <glm/geometric.hpp>
+
+#include <cmath>
+#include <cstring>
+
+static bool near(glm::vec3 a, glm::vec3 b) {
+	return glm::distance(a, b) < 1e-5f;
+}
+
+// A unit cube around the origin with outward-facing triangles.
+static std::vector<glm::vec3> const CUBE_POSITIONS {
+    {-1, -1, -1},
+    {1, -1, -1},
+    {1, 1, -1},
+    {-1, 1, -1},
+    {-1, -1, 1},
+    {1, -1, 1},
+    {1, 1, 1},
+    {-1, 1, 1},
+};
+
+static std::vector<std::uint32_t> const CUBE_INDICES {
+    0, 2, 1, 0, 3, 2, // -Z
+    4, 5, 6, 4, 6, 7, // +Z
+    0, 1, 5, 0, 5, 4, // -Y
+    3, 7, 6, 3, 6, 2, // +Y
+    0, 4, 7, 0, 7, 3, // -X
+    1, 2, 6, 1, 6, 5, // +X
+};
+
+TEST_SUITE("TangentFrames") {
+	TEST_CASE("TangentFrames.build(normals)") {
+		zenkit::TangentFrames frames {};
+		zenkit::TangentFrameSettings settings {};
+		settings.tangents = false;
+
+		frames.build(CUBE_POSITIONS.data(),
+		             CUBE_POSITIONS.size(),
+		             CUBE_INDICES.data(),
+		             nullptr,
+		             CUBE_INDICES.size(),
+		             settings);
+		REQUIRE_EQ(frames.normals.size(), 36);
+		CHECK(frames.tangents.empty());
+
+		// The edges of a cube are creases, so all faces are flat.
+		CHECK(near(frames.normals[0], {0, 0, -1}));
+		CHECK(near(frames.normals[7], {0, 0, 1}));
+		CHECK(near(frames.normals[14], {0, -1, 0}));
+		CHECK(near(frames.normals[20], {0, 1, 0}));
+		CHECK(near(frames.normals[25], {-1, 0, 0}));
+		CHECK(near(frames.normals[35], {1, 0, 0}));
+
+		// Without creases, every face contributes the same angle at each cube corner, even though some corners
+		// are touched by one and others by two triangles of a face.
+		settings.crease_angle = 3.14159265f;
+		frames.build(CUBE_POSITIONS.data(),
+		             CUBE_POSITIONS.size(),
+		             CUBE_INDICES.data(),
+		             nullptr,
+		             CUBE_INDICES.size(),
+		             settings);
+
+		for (auto i = 0u; i < CUBE_INDICES.size(); ++i) {
+			auto expected = glm::normalize(CUBE_POSITIONS[CUBE_INDICES[i]]);
+			CHECK_LT(glm::distance(frames.normals[i], expected), 1e-3f);
+		}
+	}
+
+	TEST_CASE("TangentFrames.build(tangents)") {
+		// Two quads in the XZ plane facing up. The second one has its texture mirrored along U.
+		std::vector<glm::vec3> positions {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}, {2, 0, 0}, {2, 0, 1}};
+		std::vector<std::uint32_t> indices {0, 2, 1, 0, 3, 2, 1, 5, 4, 1, 2, 5};
+		std::vector<glm::vec2> texcoords {
+		    {0, 0}, {1, 1}, {1, 0}, {0, 0}, {0, 1}, {1, 1}, // U along +X
+		    {1, 0}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 1}, // U along -X
+		};
+
+		zenkit::TangentFrames frames {};
+		frames.build(positions.data(), positions.size(), indices.data(), texcoords.data(), indices.size());
+		REQUIRE_EQ(frames.tangents.size(), 12);
+
+		for (auto i = 0u; i < 12; ++i) {
+			CHECK(near(frames.normals[i], {0, 1, 0}));
+
+			auto& t = frames.tangents[i];
+			auto expected = i < 6 ? glm::vec3 {1, 0, 0} : glm::vec3 {-1, 0, 0};
+			CHECK(near(glm::vec3 {t}, expected));
+
+			// The bitangent always points along +V, which is +Z here.
+			auto bitangent = t.w * glm::cross(frames.normals[i], glm::vec3 {t});
+			CHECK(near(bitangent, {0, 0, 1}));
+		}
+
+		CHECK_EQ(frames.tangents[0].w, -frames.tangents[6].w);
+
+		// Without texture coordinates any tangent perpendicular to the normal is chosen.
+		texcoords.assign(texcoords.size(), glm::vec2 {0});
+		frames.build(positions.data(), positions.size(), indices.data(), texcoords.data(), indices.size());
+
+		for (auto i = 0u; i < 12; ++i) {
+			CHECK_LT(std::abs(glm::dot(glm::vec3 {frames.tangents[i]}, frames.normals[i])), 1e-6f);
+			CHECK_LT(std::abs(glm::length(glm::vec3 {frames.tangents[i]}) - 1), 1e-6f);
+		}
+	}
+
+	TEST_CASE("TangentFrames.build(groups)") {
+		// Two triangles facing up which only share the vertex at the origin, where they also share texture
+		// coordinates. The first one has U along +X, the second one has U along +Z.
+		std::vector<glm::vec3> positions {{0, 0, 0}, {1, 0, 1}, {1, 0, 0}, {-1, 0, -1}, {-1, 0, 0}};
+		std::vector<std::uint32_t> indices {0, 1, 2, 0, 3, 4};
+		std::vector<glm::vec2> texcoords {{0, 0}, {1, 1}, {1, 0}, {0, 0}, {-1, 1}, {0, 1}};
+
+		zenkit::TangentFrames frames {};
+		frames.build(positions.data(), positions.size(), indices.data(), texcoords.data(), indices.size());
+		REQUIRE_EQ(frames.tangents.size(), 6);
+
+		// Like MikkTSpace, tangents are only averaged over faces connected by an edge, so the shared corner keeps
+		// the tangent of each face.
+		for (auto i = 0u; i < 6; ++i) {
+			CHECK(near(glm::vec3 {frames.tangents[i]}, i < 3 ? glm::vec3 {1, 0, 0} : glm::vec3 {0, 0, 1}));
+		}
+
+		// A third triangle sharing an edge with the first one, with U along (1, 0, -1), joins its group. At the shared
+		// corners, both faces span 45 degrees, so their tangents are averaged with equal weights.
+		positions.emplace_back(0, 0, 1);
+		indices.insert(indices.end(), {0, 5, 1});
+		texcoords.insert(texcoords.end(), {{0, 0}, {-0.5f, 0.5f}, {1, 1}});
+
+		frames.build(positions.data(), positions.size(), indices.data(), texcoords.data(), indices.size());
+		REQUIRE_EQ(frames.tangents.size(), 9);
+
+		glm::vec3 average {0.9238795f, 0, -0.3826834f};
+		CHECK(near(glm::vec3 {frames.tangents[0]}, average));
+		CHECK(near(glm::vec3 {frames.tangents[1]}, average));
+		CHECK(near(glm::vec3 {frames.tangents[6]}, average));
+		CHECK(near(glm::vec3 {frames.tangents[8]}, average));
+		CHECK(near(glm::vec3 {frames.tangents[2]}, {1, 0, 0}));
+		CHECK(near(glm::vec3 {frames.tangents[3]}, {0, 0, 1}));
+		CHECK(near(glm::vec3 {frames.tangents[7]}, {0.7071068f, 0, -0.7071068f}));
+	}
+
+	TEST_CASE("TangentFrames.build(MultiResolutionMesh)") {
+		auto in = zenkit::Read::from("./samples/mesh0.mrm");
+		zenkit::MultiResolutionMesh mesh {};
+		mesh.load(in.get());
+
+		zenkit::TangentFrameSettings settings {};
+		settings.threads = 1;
+
+		zenkit::TangentFrames a {};
+		a.build(mesh, settings);
+
+		auto corner_count = 0u;
+		for (auto& sub_mesh : mesh.sub_meshes) {
+			corner_count += static_cast<std::uint32_t>(sub_mesh.triangles.size() * 3);
+		}
+
+		REQUIRE_EQ(a.normals.size(), corner_count);
+		REQUIRE_EQ(a.tangents.size(), corner_count);
+
+		for (auto i = 0u; i < corner_count; ++i) {
+			auto t = glm::vec3 {a.tangents[i]};
+			CHECK_LT(std::abs(glm::length(t) - 1), 1e-4f);
+			CHECK_LT(std::abs(glm::dot(t, a.normals[i])), 1e-4f);
+			CHECK_EQ(std::abs(a.tangents[i].w), 1.0f);
+		}
+
+		// The output does not depend on the number of threads.
+		settings.threads = 4;
+		zenkit::TangentFrames b {};
+		b.build(mesh, settings);
+
+		CHECK_EQ(std::memcmp(a.normals.data(), b.normals.data(), corner_count * sizeof(glm::vec3)), 0);
+		CHECK_EQ(std::memcmp(a.tangents.data(), b.tangents.data(), corner_count * sizeof(glm::vec4)), 0);
+	}
+}
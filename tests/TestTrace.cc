@@ -0,0 +1,81 @@
+// Copyright © 2023 GothicKit Contributors.
+// SPDX-License-Identifier: MIT
+#include <doctest/doctest.h>
+#include <zenkit/Stream.hh>
+#include <zenkit/Texture.hh>
+#include <zenkit/Trace.hh>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <thread>
+
+static void load_texture() {
+	auto r = zenkit::Read::from("./samples/erz.tex");
+	zenkit::Texture texture {};
+	texture.load(r.get());
+}
+
+TEST_SUITE("Trace") {
+	TEST_CASE("Trace.start") {
+		// Nothing is recorded while tracing is inactive.
+		zenkit::Trace::start();
+		zenkit::Trace::stop();
+		load_texture();
+		CHECK_FALSE(zenkit::Trace::active());
+		CHECK(zenkit::Trace::events().empty());
+
+		zenkit::Trace::start();
+		CHECK(zenkit::Trace::active());
+
+		std::thread t {load_texture};
+		load_texture();
+		t.join();
+
+		zenkit::Trace::stop();
+
+		auto events = zenkit::Trace::events();
+		REQUIRE_EQ(events.size(), 2);
+		CHECK_EQ(std::string {events[0].name}, "Texture.load");
+		CHECK_EQ(std::string {events[0].category}, "texture");
+		CHECK_NE(events[0].thread, events[1].thread);
+		CHECK_LE(events[0].start_ns, events[1].start_ns);
+	}
+
+	TEST_CASE("Trace.start(threads)") {
+		zenkit::Trace::start();
+
+		// Threads run one after another reuse the same buffer, but are still told apart.
+		for (auto i = 0; i < 32; ++i) {
+			std::thread t {load_texture};
+			t.join();
+		}
+
+		zenkit::Trace::stop();
+
+		auto events = zenkit::Trace::events();
+		REQUIRE_EQ(events.size(), 32);
+
+		std::set<std::uint32_t> threads {};
+		for (auto& event : events) {
+			threads.insert(event.thread);
+		}
+
+		CHECK_EQ(threads.size(), 32);
+	}
+
+	TEST_CASE("Trace.write_chrome_json") {
+		zenkit::Trace::start();
+		load_texture();
+		zenkit::Trace::stop();
+
+		std::vector<std::byte> buf {};
+		auto w = zenkit::Write::to(&buf);
+		zenkit::Trace::write_chrome_json(w.get());
+
+		std::string json {reinterpret_cast<char const*>(buf.data()), buf.size()};
+		CHECK_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+		CHECK_NE(json.find("\"name\":\"Texture.load\",\"cat\":\"texture\",\"ph\":\"X\""), std::string::npos);
+		CHECK_EQ(std::count(json.begin(), json.end(), '{'), 2);
+	}
+}
@@ -1,12 +1,26 @@
 // Copyright © 2021-2023 GothicKit Contributors.
 // SPDX-License-Identifier: MIT
 #include <doctest/doctest.h>
+#include <zenkit/Error.hh>
 #include <zenkit/Material.hh>
+#include <zenkit/SaveGame.hh>
 #include <zenkit/World.hh>
+#include <zenkit/vobs/Sound.hh>
+#include <zenkit/vobs/Trigger.hh>
+#include <zenkit/vobs/Zone.hh>
+#include <zenkit/world/Meshlet.hh>
+#include <zenkit/world/PotentiallyVisibleSet.hh>
+#include <zenkit/world/VolumeIndex.hh>
+#include <zenkit/vobs/Misc.hh>
 #include <zenkit/vobs/VirtualObject.hh>
 
 #include <zenkit/Stream.hh>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+
 TEST_SUITE("World") {
 	TEST_CASE("World.load(GOTHIC1)") {
 		auto in = zenkit::Read::from("./samples/world.proprietary.zen");
@@ -367,6 +381,581 @@ TEST_SUITE("World") {
 #endif
 	}
 
+	TEST_CASE("World.memory_report") {
+		zenkit::SaveGame save {zenkit::GameVersion::GOTHIC_1};
+		save.load("./samples/G1/Save");
+		auto world = save.load_world();
+		REQUIRE_NE(world, nullptr);
+
+		auto report = world->memory_report();
+		CHECK_GT(report.vobs, 0);
+		CHECK_GT(report.npcs, 0);
+		CHECK_GT(report.way_net, 0);
+		CHECK_EQ(report.total(), report.mesh() + report.bsp_tree + report.vobs + report.npcs + report.way_net + report.other);
+
+		auto& npcs = report.vob_types.at(zenkit::VirtualObjectType::oCNpc);
+		CHECK_GE(npcs.count, world->npcs.size());
+		CHECK_GE(npcs.bytes, npcs.count * sizeof(zenkit::VNpc));
+
+		std::size_t by_type = 0;
+		for (auto& [type, memory] : report.vob_types) by_type += memory.bytes;
+		CHECK_LE(by_type, report.vobs + report.npcs);
+
+		world->trim_lightmaps();
+		world->trim_geometry();
+		world->trim_bsp_tree();
+		world->shrink_to_fit();
+
+		auto trimmed = world->memory_report();
+		CHECK_EQ(trimmed.mesh_vertices, 0);
+		CHECK_EQ(trimmed.mesh_features, 0);
+		CHECK_EQ(trimmed.mesh_polygons, 0);
+		CHECK_EQ(trimmed.mesh_lightmaps, 0);
+		CHECK_EQ(trimmed.bsp_tree, 0);
+		CHECK_LE(trimmed.vobs, report.vobs);
+	}
+
+	TEST_CASE("VobTable.build") {
+		auto make_vob = [](std::uint32_t id, std::string visual) {
+			auto vob = std::make_shared<zenkit::VirtualObject>();
+			vob->id = id;
+			vob->type = zenkit::VirtualObjectType::zCVob;
+			vob->position = glm::vec3 {static_cast<float>(id), 0, 0};
+
+			if (!visual.empty()) {
+				vob->visual = std::make_shared<zenkit::VisualMesh>();
+				vob->visual->type = zenkit::VisualType::MESH;
+				vob->visual->name = std::move(visual);
+			}
+
+			return vob;
+		};
+
+		std::vector<std::shared_ptr<zenkit::VirtualObject>> roots {make_vob(0, "A.3DS"), make_vob(3, "")};
+		roots[0]->children.push_back(make_vob(1, "B.3DS"));
+		roots[0]->children.push_back(make_vob(2, "A.3DS"));
+		roots[1]->children.push_back(make_vob(4, "B.3DS"));
+
+		zenkit::VobTable table {};
+		table.build(roots);
+
+		auto none = zenkit::VobTable::NONE;
+		REQUIRE_EQ(table.size(), 5);
+		CHECK_EQ(table.ids, std::vector<std::uint32_t> {0, 1, 2, 3, 4});
+		CHECK_EQ(table.parents, std::vector<std::uint32_t> {none, 0, 0, none, 3});
+		CHECK_EQ(table.first_children, std::vector<std::uint32_t> {1, none, none, 4, none});
+		CHECK_EQ(table.next_siblings, std::vector<std::uint32_t> {3, 2, none, none, none});
+		CHECK_EQ(table.visual_names, std::vector<std::string> {"A.3DS", "B.3DS"});
+		CHECK_EQ(table.visual_name_indices, std::vector<std::uint32_t> {0, 1, 0, none, 1});
+		CHECK_EQ(table.visual_types[0], zenkit::VisualType::MESH);
+		CHECK_EQ(table.visual_types[3], zenkit::VisualType::UNKNOWN);
+		CHECK_EQ(table.transforms[4][3], glm::vec4 {4, 0, 0, 1});
+		CHECK_EQ(table.objects[2], roots[0]->children[1].get());
+
+		table.build({});
+		CHECK_EQ(table.size(), 0);
+		CHECK(table.visual_names.empty());
+	}
+
+	TEST_CASE("World.visit_vobs") {
+		struct Visitor final : zenkit::VobVisitor {
+			zenkit::VirtualObjectType keep;
+			std::size_t entered {0};
+			std::size_t left {0};
+			std::size_t max_depth {0};
+			bool skip_roots {false};
+
+			explicit Visitor(zenkit::VirtualObjectType k) : keep(k) {}
+
+			zenkit::VobVisitAction enter(std::shared_ptr<zenkit::VirtualObject> const& vob, std::size_t depth) override {
+				entered += 1;
+				max_depth = std::max(max_depth, depth);
+
+				if (skip_roots) return zenkit::VobVisitAction::SKIP;
+				return vob->type == keep ? zenkit::VobVisitAction::KEEP : zenkit::VobVisitAction::DISCARD;
+			}
+
+			void leave(std::shared_ptr<zenkit::VirtualObject> const&, std::size_t) override {
+				left += 1;
+			}
+		};
+
+		std::function<std::size_t(std::vector<std::shared_ptr<zenkit::VirtualObject>> const&)> count;
+		count = [&count](std::vector<std::shared_ptr<zenkit::VirtualObject>> const& vobs) {
+			auto n = vobs.size();
+			for (auto& vob : vobs) n += count(vob->children);
+			return n;
+		};
+
+		auto r = zenkit::Read::from("./samples/G1/Save/WORLD.SAV");
+		zenkit::World world {};
+		world.load(r.get(), zenkit::GameVersion::GOTHIC_1);
+
+		Visitor visitor {zenkit::VirtualObjectType::zCVobLight};
+		r = zenkit::Read::from("./samples/G1/Save/WORLD.SAV");
+		auto lights = zenkit::World::visit_vobs(r.get(), zenkit::GameVersion::GOTHIC_1, visitor);
+
+		CHECK_EQ(visitor.entered, count(world.world_vobs));
+		CHECK_EQ(visitor.left, visitor.entered);
+		CHECK_GT(visitor.max_depth, 0);
+		REQUIRE_FALSE(lights.empty());
+
+		for (auto& light : lights) {
+			CHECK_EQ(light->type, zenkit::VirtualObjectType::zCVobLight);
+		}
+
+		Visitor skipper {zenkit::VirtualObjectType::zCVobLight};
+		skipper.skip_roots = true;
+		r = zenkit::Read::from("./samples/G1/Save/WORLD.SAV");
+		CHECK(zenkit::World::visit_vobs(r.get(), zenkit::GameVersion::GOTHIC_1, skipper).empty());
+		CHECK_EQ(skipper.entered, world.world_vobs.size());
+		CHECK_EQ(skipper.left, 0);
+	}
+
+	TEST_CASE("World.vob_index") {
+		auto make_vob = [](std::uint32_t id, zenkit::VirtualObjectType type, std::string name) {
+			auto vob = std::make_shared<zenkit::VirtualObject>();
+			vob->id = id;
+			vob->type = type;
+			vob->vob_name = std::move(name);
+			return vob;
+		};
+
+		zenkit::World world {};
+		world.world_vobs.push_back(make_vob(1, zenkit::VirtualObjectType::zCVobLevelCompo, "LEVEL"));
+		world.world_vobs[0]->children.push_back(make_vob(2, zenkit::VirtualObjectType::zCVobSpot, "FP_ROAM_01"));
+		world.world_vobs[0]->children.push_back(make_vob(3, zenkit::VirtualObjectType::zCVobSpot, "FP_ROAM_02"));
+
+		auto& index = world.vob_index();
+		CHECK_EQ(index.size(), 3);
+		CHECK_EQ(index.find_by_id(2), world.world_vobs[0]->children[0]);
+		CHECK_EQ(index.find_by_id(42), nullptr);
+		CHECK_EQ(index.find_by_name("fp_roam_02").size(), 1);
+		CHECK(index.find_by_name("FP_ROAM_03").empty());
+		CHECK_EQ(index.find_by_type(zenkit::VirtualObjectType::zCVobSpot).size(), 2);
+		CHECK(index.find_by_type(zenkit::VirtualObjectType::zCMover).empty());
+
+		// Insertions and removals through the world keep the index consistent.
+		auto mover = make_vob(4, zenkit::VirtualObjectType::zCMover, "Fp_Roam_02");
+		mover->children.push_back(make_vob(5, zenkit::VirtualObjectType::zCVobSpot, ""));
+		world.add_vob(mover, world.world_vobs[0].get());
+
+		CHECK_EQ(index.size(), 5);
+		CHECK_EQ(index.find_by_name("FP_ROAM_02").size(), 2);
+		CHECK_EQ(index.find_by_type(zenkit::VirtualObjectType::zCVobSpot).size(), 3);
+		CHECK_EQ(index.find_by_id(5), mover->children[0]);
+
+		CHECK_EQ(world.remove_vob(mover.get()), mover);
+		CHECK_EQ(world.remove_vob(mover.get()), nullptr);
+		CHECK_EQ(world.world_vobs[0]->children.size(), 2);
+		CHECK_EQ(index.size(), 3);
+		CHECK_EQ(index.find_by_name("FP_ROAM_02").size(), 1);
+		CHECK_EQ(index.find_by_id(5), nullptr);
+		CHECK(index.find_by_type(zenkit::VirtualObjectType::zCMover).empty());
+
+		// VObs sharing an id shadow each other until they are removed.
+		auto first = make_vob(2, zenkit::VirtualObjectType::zCVobSpot, "DUPLICATE");
+		auto second = make_vob(2, zenkit::VirtualObjectType::zCVobSpot, "DUPLICATE");
+		world.add_vob(first, nullptr);
+		world.add_vob(second, nullptr);
+		CHECK_EQ(index.size(), 5);
+		CHECK_EQ(index.find_by_id(2), second);
+
+		world.remove_vob(second.get());
+		CHECK_EQ(index.find_by_id(2), first);
+		world.remove_vob(first.get());
+		CHECK_EQ(index.find_by_id(2), world.world_vobs[0]->children[0]);
+		CHECK(index.find_by_name("DUPLICATE").empty());
+
+		// Erasing a VOb only touches the erased VOb and the one moved into its slot.
+		auto large = make_vob(100, zenkit::VirtualObjectType::zCVobLevelCompo, "LARGE");
+		for (auto i = 0u; i < 50000; ++i) {
+			large->children.push_back(make_vob(1000 + i, zenkit::VirtualObjectType::zCVobSpot, "FP_LARGE"));
+		}
+
+		zenkit::VobIndex large_index {};
+		large_index.insert(large);
+		CHECK_EQ(large_index.size(), 50001);
+		CHECK_EQ(large_index.find_by_name("fp_large").size(), 50000);
+
+		for (auto i = 0u; i < 25000; ++i) {
+			large_index.erase(*large->children[i]);
+		}
+
+		CHECK_EQ(large_index.size(), 25001);
+		CHECK_EQ(large_index.find_by_id(1000), nullptr);
+		CHECK_EQ(large_index.find_by_id(1000 + 49999), large->children.back());
+		CHECK_EQ(large_index.find_by_name("FP_LARGE").size(), 25000);
+
+		large_index.erase(*large);
+		CHECK_EQ(large_index.size(), 0);
+		CHECK(large_index.find_by_name("FP_LARGE").empty());
+		CHECK(large_index.find_by_type(zenkit::VirtualObjectType::zCVobSpot).empty());
+
+		world.world_vobs.clear();
+		world.invalidate_vob_index();
+		CHECK_EQ(world.vob_index().size(), 0);
+	}
+
+	TEST_CASE("MeshletSet.build") {
+		// A flat 10x10 grid of quads alternating between two materials and a single triangle next to a portal.
+		zenkit::Mesh mesh {};
+		for (auto y = 0; y <= 10; ++y) {
+			for (auto x = 0; x <= 10; ++x) {
+				mesh.vertices.emplace_back(x * 100, y * 100, 0);
+				mesh.features.push_back(zenkit::VertexFeature {{0, 0}, 0, {0, 0, 1}});
+			}
+		}
+
+		auto add_polygon = [&mesh](std::vector<uint32_t> const& indices, uint32_t material, bool portal) {
+			zenkit::Polygon polygon {material, -1, {}, indices.size(), mesh.polygon_vertex_indices.size()};
+			polygon.flags.is_portal = portal;
+
+			mesh.geometry.push_back(polygon);
+			mesh.polygon_vertex_indices.insert(mesh.polygon_vertex_indices.end(), indices.begin(), indices.end());
+			mesh.polygon_feature_indices.insert(mesh.polygon_feature_indices.end(), indices.begin(), indices.end());
+		};
+
+		zenkit::BspTree tree {};
+		for (uint32_t y = 0; y < 10; ++y) {
+			for (uint32_t x = 0; x < 10; ++x) {
+				auto i = y * 11 + x;
+				tree.polygon_indices.push_back(mesh.geometry.size());
+				add_polygon({i, i + 1, i + 12, i + 11}, (x + y) % 2, false);
+			}
+		}
+
+		tree.polygon_indices.push_back(mesh.geometry.size());
+		add_polygon({0, 1, 11}, 0, false);
+		tree.polygon_indices.push_back(mesh.geometry.size());
+		add_polygon({0, 11, 12, 1}, 0, true);
+
+		tree.nodes.push_back(zenkit::BspNode {glm::vec4 {0}, {}, 0, 0, 1, 2});
+		tree.nodes.push_back(zenkit::BspNode {glm::vec4 {0}, {}, 0, 100, -1, -1, 0});
+		tree.nodes.push_back(zenkit::BspNode {glm::vec4 {0}, {}, 100, 2, -1, -1, 0});
+
+		zenkit::MeshletSet set {};
+		set.build(mesh, tree, 16, 20);
+
+		REQUIRE_EQ(set.leaf_offsets.size(), 4);
+		CHECK_EQ(set.leaf_offsets[0], 0);
+		CHECK_EQ(set.leaf_offsets[1], 0);
+		CHECK_EQ(set.leaf_offsets.back(), set.meshlets.size());
+		CHECK_EQ(set.leaf_offsets[3] - set.leaf_offsets[2], 1);
+
+		std::vector<std::array<uint32_t, 3>> triangles {};
+		for (auto i = 0u; i < set.meshlets.size(); ++i) {
+			auto& meshlet = set.meshlets[i];
+			CHECK_LE(meshlet.vertex_count, 16);
+			CHECK_LE(meshlet.triangle_count, 20);
+			CHECK_EQ(meshlet.leaf, i < set.leaf_offsets[2] ? 1 : 2);
+
+			for (auto j = 0u; j < meshlet.vertex_count; ++j) {
+				auto& p = mesh.vertices[set.vertex_indices[meshlet.vertex_offset + j]];
+				CHECK_LE(glm::distance(p, meshlet.center), meshlet.radius + 0.01f);
+			}
+
+			for (auto j = 0u; j < meshlet.triangle_count; ++j) {
+				auto* t = &set.triangles[(meshlet.triangle_offset + j) * 3];
+				triangles.push_back({set.vertex_indices[meshlet.vertex_offset + t[0]],
+				                     set.vertex_indices[meshlet.vertex_offset + t[1]],
+				                     set.vertex_indices[meshlet.vertex_offset + t[2]]});
+			}
+
+			// The grid is flat, so the normal cone is as narrow as possible.
+			CHECK_LT(std::abs(meshlet.cone_axis.z - 1), 0.001f);
+			CHECK_LT(std::abs(meshlet.cone_cutoff), 0.001f);
+			CHECK(meshlet.is_backfacing(meshlet.center - glm::vec3 {0, 0, 100}));
+			CHECK_FALSE(meshlet.is_backfacing(meshlet.center + glm::vec3 {0, 0, 100}));
+		}
+
+		// Every triangle is included exactly once and the portal is skipped.
+		REQUIRE_EQ(triangles.size(), 201);
+		CHECK_EQ(triangles[0], std::array<uint32_t, 3> {0, 1, 12});
+		CHECK_EQ(triangles[1], std::array<uint32_t, 3> {0, 12, 11});
+		CHECK_EQ(triangles.back(), std::array<uint32_t, 3> {0, 1, 11});
+
+		// Meshlets never mix materials.
+		for (auto& meshlet : set.meshlets) {
+			for (auto j = 0u; j < meshlet.triangle_count; ++j) {
+				auto* t = &set.triangles[(meshlet.triangle_offset + j) * 3];
+				auto first = set.vertex_indices[meshlet.vertex_offset + t[0]];
+				auto x = first % 11;
+				auto y = first / 11;
+				if (meshlet.leaf == 1) CHECK_EQ((x + y) % 2, meshlet.material);
+			}
+		}
+	}
+
+	TEST_CASE("PotentiallyVisibleSet.build") {
+		// Three rooms forming a U-turn: A opens into B, which opens into C, which opens to the outdoors. Since the
+		// portals A|B and B|C lie in the same plane, A can not see C.
+		zenkit::Mesh mesh {};
+		auto add_portal = [&mesh](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d) {
+			auto offset = mesh.polygon_vertex_indices.size();
+			for (auto& v : {a, b, c, d}) {
+				mesh.polygon_vertex_indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+				mesh.vertices.push_back(v);
+			}
+
+			mesh.geometry.push_back(zenkit::Polygon {0, -1, {}, 4, offset});
+		};
+
+		add_portal({100, 0, 0}, {100, 100, 0}, {100, 100, 100}, {100, 0, 100});
+		add_portal({100, 100, 0}, {100, 200, 0}, {100, 200, 100}, {100, 100, 100});
+		add_portal({0, 200, 0}, {100, 200, 0}, {100, 200, 100}, {0, 200, 100});
+
+		zenkit::BspTree tree {};
+		auto add_leaf = [&tree](glm::vec3 min, glm::vec3 max) {
+			tree.leaf_node_indices.push_back(tree.nodes.size());
+			tree.nodes.push_back(zenkit::BspNode {glm::vec4 {0}, {min, max}, 0, 0});
+		};
+
+		add_leaf({0, 0, 0}, {100, 100, 100});
+		add_leaf({100, 0, 0}, {300, 200, 100});
+		add_leaf({0, 100, 0}, {100, 200, 100});
+		add_leaf({0, 200, 0}, {100, 400, 100});
+
+		tree.sectors.push_back(zenkit::BspSector {"A", {0}, {0}});
+		tree.sectors.push_back(zenkit::BspSector {"B", {1}, {0, 1}});
+		tree.sectors.push_back(zenkit::BspSector {"C", {2}, {1, 2}});
+
+		zenkit::PotentiallyVisibleSet pvs {};
+		pvs.build(tree, mesh);
+
+		auto check = [](zenkit::PotentiallyVisibleSet const& set) {
+			REQUIRE_EQ(set.cell_count(), 4);
+			CHECK_EQ(set.cell_of(3), 3);
+
+			std::vector<std::vector<bool>> expected {
+			    {true, true, false, false},
+			    {true, true, true, true},
+			    {false, true, true, true},
+			    {false, true, true, true},
+			};
+
+			for (auto i = 0u; i < 4; ++i) {
+				for (auto j = 0u; j < 4; ++j) {
+					CHECK_EQ(set.is_visible(i, j), expected[i][j]);
+					CHECK_EQ(set.is_node_visible(i, j), expected[i][j]);
+				}
+			}
+
+			CHECK_EQ(set.unique_row_count(), 3);
+		};
+
+		check(pvs);
+
+		std::vector<std::byte> data {};
+		auto w = zenkit::Write::to(&data);
+		pvs.save(w.get());
+
+		zenkit::PotentiallyVisibleSet loaded {};
+		auto r = zenkit::Read::from(&data);
+		loaded.load(r.get());
+		check(loaded);
+	}
+
+	TEST_CASE("PotentiallyVisibleSet.build(non-convex)") {
+		// A straight corridor of three rooms along Y. The outer rooms are L-shaped, so the centres of their bounding
+		// boxes lie on the wrong side of the portals they have with the middle room.
+		zenkit::Mesh mesh {};
+		auto add_portal = [&mesh](float y) {
+			auto offset = mesh.polygon_vertex_indices.size();
+			for (auto& v : {glm::vec3 {0, y, 0}, {100, y, 0}, {100, y, 100}, {0, y, 100}}) {
+				mesh.polygon_vertex_indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+				mesh.vertices.push_back(v);
+			}
+
+			mesh.geometry.push_back(zenkit::Polygon {0, -1, {}, 4, offset});
+		};
+
+		add_portal(100);
+		add_portal(200);
+
+		zenkit::BspTree tree {};
+		auto add_leaf = [&tree](glm::vec3 min, glm::vec3 max) {
+			tree.leaf_node_indices.push_back(tree.nodes.size());
+			tree.nodes.push_back(zenkit::BspNode {glm::vec4 {0}, {min, max}, 0, 0});
+		};
+
+		add_leaf({0, 0, 0}, {100, 100, 100});
+		add_leaf({200, 0, 0}, {300, 400, 100});
+		add_leaf({0, 100, 0}, {100, 200, 100});
+		add_leaf({0, 200, 0}, {100, 300, 100});
+		add_leaf({-300, -200, 0}, {-200, 300, 100});
+
+		tree.sectors.push_back(zenkit::BspSector {"A", {0, 1}, {0}});
+		tree.sectors.push_back(zenkit::BspSector {"B", {2}, {0, 1}});
+		tree.sectors.push_back(zenkit::BspSector {"C", {3, 4}, {1}});
+
+		zenkit::PotentiallyVisibleSet pvs {};
+		pvs.build(tree, mesh);
+
+		REQUIRE_EQ(pvs.cell_count(), 4);
+		CHECK(pvs.is_visible(0, 1));
+		CHECK(pvs.is_visible(0, 2));
+		CHECK(pvs.is_visible(2, 0));
+		CHECK_FALSE(pvs.is_visible(0, 3));
+	}
+
+	TEST_CASE("PotentiallyVisibleSet.build(grid)") {
+		// A grid of rooms, each connected to its neighbours. The number of portal chains grows exponentially with the
+		// size of the grid, so building only finishes in time if every portal is passed a bounded number of times.
+		constexpr std::uint32_t size = 16;
+
+		zenkit::Mesh mesh {};
+		zenkit::BspTree tree {};
+		std::vector<std::vector<std::uint32_t>> cell_portals(size * size);
+
+		auto add_portal = [&](std::uint32_t a, std::uint32_t b, std::array<glm::vec3, 4> const& corners) {
+			auto offset = mesh.polygon_vertex_indices.size();
+			for (auto& v : corners) {
+				mesh.polygon_vertex_indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+				mesh.vertices.push_back(v);
+			}
+
+			cell_portals[a].push_back(static_cast<uint32_t>(mesh.geometry.size()));
+			cell_portals[b].push_back(static_cast<uint32_t>(mesh.geometry.size()));
+			mesh.geometry.push_back(zenkit::Polygon {0, -1, {}, 4, offset});
+		};
+
+		for (auto y = 0u; y < size; ++y) {
+			for (auto x = 0u; x < size; ++x) {
+				auto fx = static_cast<float>(x) * 100;
+				auto fy = static_cast<float>(y) * 100;
+				auto cell = y * size + x;
+
+				tree.leaf_node_indices.push_back(tree.nodes.size());
+				tree.nodes.push_back(zenkit::BspNode {glm::vec4 {0}, {{fx, fy, 0}, {fx + 100, fy + 100, 100}}, 0, 0});
+
+				if (x + 1 < size) {
+					add_portal(cell, cell + 1, {{{fx + 100, fy, 0}, {fx + 100, fy + 100, 0}, {fx + 100, fy + 100, 100},
+					                            {fx + 100, fy, 100}}});
+				}
+
+				if (y + 1 < size) {
+					add_portal(cell, cell + size, {{{fx, fy + 100, 0}, {fx + 100, fy + 100, 0},
+					                               {fx + 100, fy + 100, 100}, {fx, fy + 100, 100}}});
+				}
+			}
+		}
+
+		for (auto i = 0u; i < size * size; ++i) {
+			tree.sectors.push_back(zenkit::BspSector {"R" + std::to_string(i), {i}, cell_portals[i]});
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		zenkit::PotentiallyVisibleSet pvs {};
+		pvs.build(tree, mesh);
+		auto elapsed = std::chrono::steady_clock::now() - start;
+
+		CHECK_LT(elapsed, std::chrono::seconds {10});
+		REQUIRE_EQ(pvs.cell_count(), size * size + 1);
+
+		// The rooms are open towards each other, so all of them can see each other, but not the outdoors.
+		for (auto i = 0u; i < size * size; ++i) {
+			CHECK(pvs.is_visible(0, i));
+			CHECK(pvs.is_visible(i, size * size - 1));
+			CHECK_FALSE(pvs.is_visible(i, size * size));
+		}
+	}
+
+	TEST_CASE("PotentiallyVisibleSet.load(invalid)") {
+		zenkit::PotentiallyVisibleSet empty {};
+		CHECK_EQ(empty.cell_count(), 0);
+		CHECK_EQ(empty.cell_of(5), 0);
+		CHECK(empty.is_visible(0, 1));
+		CHECK(empty.is_node_visible(3, 7));
+
+		auto load = [](std::vector<std::uint32_t> const& words) {
+			std::vector<std::byte> data {};
+			auto w = zenkit::Write::to(&data);
+			w->write_string("ZPVS");
+			for (auto word : words) {
+				w->write_uint(word);
+			}
+
+			zenkit::PotentiallyVisibleSet pvs {};
+			auto r = zenkit::Read::from(&data);
+			pvs.load(r.get());
+			return pvs;
+		};
+
+		// Version, cell count, node count, node cells, row count, cell rows and rows.
+		auto valid = load({1, 2, 1, 1, 1, 0, 0, 3});
+		CHECK(valid.is_visible(0, 1));
+		CHECK(valid.is_visible(1, 0));
+		CHECK(valid.is_visible(2, 0));
+
+		CHECK_THROWS_AS(load({1, 2, 0xFFFFFFFF}), zenkit::ParserError);
+		CHECK_THROWS_AS(load({1, 0xFFFFFFF0, 0, 1}), zenkit::ParserError);
+		CHECK_THROWS_AS(load({1, 2, 0, 0x7FFFFFFF, 0, 0}), zenkit::ParserError);
+		CHECK_THROWS_AS(load({1, 2, 1, 2, 1, 0, 0, 3}), zenkit::ParserError);
+	}
+
+	TEST_CASE("VolumeIndex.query") {
+		auto make_zone = [](zenkit::VirtualObjectType type, glm::vec3 min, glm::vec3 max, int priority) {
+			auto zone = std::make_shared<zenkit::VZoneMusic>();
+			zone->type = type;
+			zone->bbox = {min, max};
+			zone->priority = priority;
+			return std::shared_ptr<zenkit::VirtualObject> {zone};
+		};
+
+		auto fallback = make_zone(zenkit::VirtualObjectType::oCZoneMusicDefault, glm::vec3 {0}, glm::vec3 {0}, 10);
+		auto large = make_zone(zenkit::VirtualObjectType::oCZoneMusic, glm::vec3 {-5000}, glm::vec3 {5000}, 0);
+		auto small = make_zone(zenkit::VirtualObjectType::oCZoneMusic, glm::vec3 {-100}, glm::vec3 {100}, 0);
+		auto important = make_zone(zenkit::VirtualObjectType::oCZoneMusic, glm::vec3 {-4000}, glm::vec3 {4000}, 1);
+
+		auto sound = std::make_shared<zenkit::VSound>();
+		sound->type = zenkit::VirtualObjectType::zCVobSound;
+		sound->position = glm::vec3 {3000, 0, 0};
+		sound->radius = 500;
+		large->children.push_back(sound);
+
+		auto trigger = std::make_shared<zenkit::VTrigger>();
+		trigger->type = zenkit::VirtualObjectType::zCTrigger;
+		trigger->bbox = {glm::vec3 {2900, -10, -10}, glm::vec3 {3100, 10, 10}};
+
+		zenkit::VolumeIndex index {};
+		index.build({fallback, large, small, important, trigger}, 1000);
+		CHECK_EQ(index.size(), 6);
+
+		zenkit::VirtualObject* out[8];
+		auto count = index.query(glm::vec3 {0}, zenkit::VolumeKind::MUSIC, out, 8);
+		REQUIRE_EQ(count, 4);
+		CHECK_EQ(out[0], important.get());
+		CHECK_EQ(out[1], small.get());
+		CHECK_EQ(out[2], large.get());
+		CHECK_EQ(out[3], fallback.get());
+
+		// Results are truncated to the capacity but still counted.
+		CHECK_EQ(index.query(glm::vec3 {0}, zenkit::VolumeKind::MUSIC, out, 1), 4);
+		CHECK_EQ(out[0], important.get());
+
+		count = index.query(glm::vec3 {3000, 0, 0}, zenkit::VolumeKind::SOUND | zenkit::VolumeKind::TRIGGER, out, 8);
+		REQUIRE_EQ(count, 2);
+		CHECK_EQ(out[0], trigger.get());
+		CHECK_EQ(out[1], sound.get());
+
+		// Spherical sounds are tested against their radius.
+		CHECK_EQ(index.query(glm::vec3 {3400, 400, 0}, zenkit::VolumeKind::SOUND, out, 8), 0);
+
+		// Points outside the grid only hit default zones.
+		CHECK_EQ(index.query(glm::vec3 {90000}, zenkit::VolumeKind::ALL, out, 8), 1);
+
+		glm::vec3 points[] = {glm::vec3 {0}, glm::vec3 {4500, 0, 0}, glm::vec3 {-90000}};
+		std::size_t counts[3];
+		index.query(points, 3, zenkit::VolumeKind::MUSIC, out, 2, counts);
+		CHECK_EQ(counts[0], 4);
+		CHECK_EQ(counts[1], 2);
+		CHECK_EQ(out[2], large.get());
+		CHECK_EQ(out[3], fallback.get());
+		CHECK_EQ(counts[2], 1);
+		CHECK_EQ(out[4], fallback.get());
+	}
+
 	TEST_CASE("World.load(GOTHIC2)" * doctest::skip()) {
 		// TODO: Stub
 	}